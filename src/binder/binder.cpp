@@ -1,6 +1,8 @@
 // /src/binder/binder.cpp
 
 #include "binder/binder.h"
+#include "catalog/value.h"
+#include <algorithm>
 #include <sstream>
 
 using namespace venus::parser;
@@ -40,7 +42,7 @@ namespace binder {
 
 			const std::string& table_name = ast->children[1]->value;
 
-			TableRef* bound_table = catalog_->GetTableRef(table_name);
+			TableRef* bound_table = catalog_->GetTableRef(table_name, arena_);
 			if (bound_table == nullptr) {
 				throw std::runtime_error("Binder error: Table '" + table_name + "' does not exist");
 			}
@@ -72,7 +74,145 @@ namespace binder {
 				}
 			}
 
-			return std::make_unique<BoundSelectNode>(bound_table, std::move(bound_columns));
+			// ast->children[2] is the optional WHERE_CLAUSE -> CONDITION -> [COLUMN_REF, CONST_VALUE]
+			std::unique_ptr<Expression> where_clause = nullptr;
+			if (ast->children.size() > 2 && ast->children[2]->type == ASTNodeType::WHERE_CLAUSE) {
+				where_clause = BindWhereClause(bound_table, *ast->children[2]);
+			}
+
+			return std::make_unique<BoundSelectNode>(bound_table, std::move(bound_columns), std::move(where_clause));
+		}
+
+		case ASTNodeType::DELETE: {
+			// ast->children[0] is TABLE_REF, ast->children[1] the optional WHERE_CLAUSE
+			if (catalog_ == nullptr) {
+				throw std::runtime_error("Binder error: Database is not initialized");
+			}
+
+			if (ast->children.empty()) {
+				throw std::runtime_error("Binder error: Invalid DELETE AST structure");
+			}
+
+			const std::string& table_name = ast->children[0]->value;
+
+			TableRef* bound_table = catalog_->GetTableRef(table_name, arena_);
+			if (bound_table == nullptr) {
+				throw std::runtime_error("Binder error: Table '" + table_name + "' does not exist");
+			}
+
+			std::unique_ptr<Expression> where_clause = nullptr;
+			if (ast->children.size() > 1 && ast->children[1]->type == ASTNodeType::WHERE_CLAUSE) {
+				where_clause = BindWhereClause(bound_table, *ast->children[1]);
+			}
+
+			return std::make_unique<BoundDeleteNode>(bound_table, std::move(where_clause));
+		}
+
+		case ASTNodeType::UPDATE: {
+			// ast->children are ASSIGNMENT -> [COLUMN_REF, CONST_VALUE | NULL_VALUE], then the optional WHERE_CLAUSE
+			if (catalog_ == nullptr) {
+				throw std::runtime_error("Binder error: Database is not initialized");
+			}
+
+			const std::string& table_name = ast->value;
+
+			TableRef* bound_table = catalog_->GetTableRef(table_name, arena_);
+			if (bound_table == nullptr) {
+				throw std::runtime_error("Binder error: Table '" + table_name + "' does not exist");
+			}
+
+			std::vector<std::pair<ColumnRef, ConstantType>> assignments;
+			std::unique_ptr<Expression> where_clause = nullptr;
+
+			for (const auto& child : ast->children) {
+				if (child->type == ASTNodeType::WHERE_CLAUSE) {
+					where_clause = BindWhereClause(bound_table, *child);
+					continue;
+				}
+
+				const std::string& col_name = child->children[0]->value;
+				const std::string& literal = child->children[1]->value;
+
+				if (!bound_table->GetSchema()->HasColumn(col_name)) {
+					throw std::runtime_error("Binder error: Column '" + col_name + "' does not exist in table '" + table_name + "'");
+				}
+
+				const Column& column = bound_table->GetSchema()->GetColumn(col_name);
+
+				bool is_null = child->children[1]->type == ASTNodeType::NULL_VALUE;
+				if (is_null) {
+					CheckNullable(column);
+				} else {
+					try {
+						switch (column.GetType()) {
+						case ColumnType::INT:
+							std::stoi(literal);
+							break;
+						case ColumnType::FLOAT:
+							std::stof(literal);
+							break;
+						case ColumnType::CHAR:
+							break;
+						case ColumnType::VARCHAR:
+							CheckLength(column, literal);
+							break;
+						case ColumnType::BIGINT:
+						case ColumnType::DOUBLE:
+						case ColumnType::DATE:
+						case ColumnType::TIMESTAMP: {
+							char bytes[sizeof(int64_t)];
+							EncodeLiteral(column.GetType(), literal, bytes);
+							break;
+						}
+						default:
+							throw std::runtime_error("Binder error: Unsupported column type in SET");
+						}
+					} catch (const std::invalid_argument&) {
+						throw std::runtime_error("Binder error: Invalid value '" + literal + "' for column '" + col_name + "' in SET");
+					} catch (const std::out_of_range&) {
+						throw std::runtime_error("Binder error: Value '" + literal + "' out of range for column '" + col_name + "' in SET");
+					}
+				}
+
+				ColumnRef bound_col;
+				bound_col.col_id = static_cast<column_id_t>(column.GetOrdinalPosition());
+				bound_col.column_entry_ = const_cast<Column*>(&column);
+
+				ConstantType bound_const;
+				bound_const.value = literal;
+				bound_const.type = column.GetType();
+				bound_const.is_null = is_null;
+
+				assignments.emplace_back(bound_col, bound_const);
+			}
+
+			if (assignments.empty()) {
+				throw std::runtime_error("Binder error: UPDATE must set at least one column");
+			}
+
+			return std::make_unique<BoundUpdateNode>(bound_table, std::move(assignments), std::move(where_clause));
+		}
+
+		case ASTNodeType::BEGIN:
+		case ASTNodeType::COMMIT:
+		case ASTNodeType::ROLLBACK: {
+			return std::make_unique<BoundTransactionNode>(ast->type);
+		}
+
+		case ASTNodeType::VACUUM: {
+			if (catalog_ == nullptr) {
+				throw std::runtime_error("Binder error: Database is not initialized");
+			}
+
+			if (ast->value.empty()) {
+				return std::make_unique<BoundVacuumNode>();
+			}
+
+			TableRef* bound_table = catalog_->GetTableRef(ast->value, arena_);
+			if (bound_table == nullptr) {
+				throw std::runtime_error("Binder error: Table '" + ast->value + "' does not exist");
+			}
+			return std::make_unique<BoundVacuumNode>(bound_table);
 		}
 
 		case ASTNodeType::CREATE_TABLE: {
@@ -82,7 +222,7 @@ namespace binder {
 
 			const std::string& table_name = ast->value;
 
-			TableRef* bound_table = catalog_->GetTableRef(table_name);
+			TableRef* bound_table = catalog_->GetTableRef(table_name, arena_);
 			if (bound_table != nullptr) {
 				throw std::runtime_error("Binder error: Table '" + table_name + "' already exists");
 			}
@@ -110,18 +250,57 @@ namespace binder {
 					bool is_primary = (parts.size() > 2 && parts[2] == "PK");
 
 					ColumnType col_type;
+					uint32_t max_length = 0;
 					if (col_type_str == "int" || col_type_str == "INT") {
 						col_type = ColumnType::INT;
 					} else if (col_type_str == "float" || col_type_str == "FLOAT") {
 						col_type = ColumnType::FLOAT;
 					} else if (col_type_str == "char" || col_type_str == "CHAR") {
 						col_type = ColumnType::CHAR;
+					} else if (col_type_str == "bigint" || col_type_str == "BIGINT") {
+						col_type = ColumnType::BIGINT;
+					} else if (col_type_str == "double" || col_type_str == "DOUBLE") {
+						col_type = ColumnType::DOUBLE;
+					} else if (col_type_str == "date" || col_type_str == "DATE") {
+						col_type = ColumnType::DATE;
+					} else if (col_type_str == "timestamp" || col_type_str == "TIMESTAMP") {
+						col_type = ColumnType::TIMESTAMP;
+					} else if (col_type_str.compare(0, 7, "varchar") == 0 || col_type_str.compare(0, 7, "VARCHAR") == 0) {
+						col_type = ColumnType::VARCHAR;
+						max_length = ParseVarcharLength(col_type_str);
 					} else {
 						throw std::runtime_error("Binder error: Unsupported column type: " + col_type_str);
 					}
 
 					size_t ordinal_position = bound_create_table->schema.GetColumnCount();
-					bound_create_table->schema.AddColumn(col_name, col_type, is_primary, ordinal_position);
+					bound_create_table->schema.AddColumn(col_name, col_type, is_primary, ordinal_position, max_length);
+				} else if (child->type == ASTNodeType::TABLE_OPTION) {
+					size_t eq = child->value.find('=');
+					std::string option = child->value.substr(0, eq);
+					std::string value = child->value.substr(eq + 1);
+					std::transform(option.begin(), option.end(), option.begin(), ::tolower);
+
+					// bloom_filter = <column>, once per column
+					if (option == "bloom_filter") {
+						Schema& schema = bound_create_table->schema;
+						if (!schema.HasColumn(value)) {
+							throw std::runtime_error("Binder error: Bloom filter on unknown column '" + value + "'");
+						}
+						if (schema.GetColumn(value).IsVariableLength()) {
+							throw std::runtime_error("Binder error: Bloom filter on VARCHAR column '" + value + "', fixed width columns only");
+						}
+						schema.SetBloomFilter(schema.GetColumn(value).GetOrdinalPosition());
+						continue;
+					}
+
+					std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+					if (option != "format") {
+						throw std::runtime_error("Binder error: Unknown table option '" + option + "'");
+					}
+					if (value != "row" && value != "columnar") {
+						throw std::runtime_error("Binder error: Unknown table format '" + value + "', expected row or columnar");
+					}
+					bound_create_table->columnar = value == "columnar";
 				}
 			}
 
@@ -129,6 +308,22 @@ namespace binder {
 				throw std::runtime_error("Binder error: CREATE TABLE must have at least one column");
 			}
 
+			// columnar pages split rows into fixed width minipages
+			if (bound_create_table->columnar) {
+				if (bound_create_table->schema.HasVariableLength()) {
+					throw std::runtime_error("Binder error: Columnar table '" + table_name + "' cannot have VARCHAR columns");
+				}
+				if (Page::ColumnarCapacity(bound_create_table->schema.GetFieldWidths()) == 0) {
+					throw std::runtime_error("Binder error: Rows of table '" + table_name + "' do not fit a columnar page");
+				}
+			}
+
+			// a row with every VARCHAR at its longest must still fit a page
+			constexpr uint32_t max_row_size = PAGE_SIZE - sizeof(PageHeader) - sizeof(SlotDirectory);
+			if (bound_create_table->schema.GetMaxTupleSize() > max_row_size) {
+				throw std::runtime_error("Binder error: Rows of table '" + table_name + "' can be " + std::to_string(bound_create_table->schema.GetMaxTupleSize()) + " bytes, more than the " + std::to_string(max_row_size) + " that fit a page");
+			}
+
 			return std::move(bound_create_table);
 		}
 
@@ -139,7 +334,7 @@ namespace binder {
 
 			const std::string& table_name = ast->value;
 
-			TableRef* bound_table = catalog_->GetTableRef(table_name);
+			TableRef* bound_table = catalog_->GetTableRef(table_name, arena_);
 			if (bound_table == nullptr) {
 				throw std::runtime_error("Binder error: Table '" + table_name + "' does not exist");
 			}
@@ -155,7 +350,7 @@ namespace binder {
 
 			std::vector<ConstantType> bound_values;
 			for (const auto& child : ast->children) {
-				if (child->type == ASTNodeType::CONST_VALUE) {
+				if (child->type == ASTNodeType::CONST_VALUE || child->type == ASTNodeType::NULL_VALUE) {
 					std::string value_str = child->value;
 
 					size_t value_index = bound_values.size();
@@ -170,6 +365,13 @@ namespace binder {
 					bound_const.value = value_str;
 					bound_const.type = expected_type;
 
+					if (child->type == ASTNodeType::NULL_VALUE) {
+						CheckNullable(target_column);
+						bound_const.is_null = true;
+						bound_values.push_back(bound_const);
+						continue;
+					}
+
 					// checking literal validity
 					switch (expected_type) {
 					case ColumnType::INT: {
@@ -191,6 +393,22 @@ namespace binder {
 					case ColumnType::CHAR: {
 						break;
 					}
+					case ColumnType::VARCHAR: {
+						CheckLength(target_column, value_str);
+						break;
+					}
+					case ColumnType::BIGINT:
+					case ColumnType::DOUBLE:
+					case ColumnType::DATE:
+					case ColumnType::TIMESTAMP: {
+						try {
+							char bytes[sizeof(int64_t)];
+							EncodeLiteral(expected_type, value_str, bytes);
+						} catch (const std::exception& e) {
+							throw std::runtime_error("Binder error: Invalid value '" + value_str + "' for column '" + target_column.GetName() + "': " + e.what());
+						}
+						break;
+					}
 					default:
 						throw std::runtime_error("Binder error: Unsupported column type for INSERT");
 					}
@@ -213,7 +431,7 @@ namespace binder {
 
 			const std::string& table_name = ast->value;
 
-			TableRef* bound_table = catalog_->GetTableRef(table_name);
+			TableRef* bound_table = catalog_->GetTableRef(table_name, arena_);
 			if (bound_table == nullptr) {
 				throw std::runtime_error("Binder error: Table '" + table_name + "' does not exist");
 			}
@@ -234,7 +452,7 @@ namespace binder {
 					std::vector<ConstantType> bound_values;
 
 					for (const auto& value_node : value_set_node->children) {
-						if (value_node->type == ASTNodeType::CONST_VALUE) {
+						if (value_node->type == ASTNodeType::CONST_VALUE || value_node->type == ASTNodeType::NULL_VALUE) {
 							std::string value_str = value_node->value;
 
 							size_t value_index = bound_values.size();
@@ -249,6 +467,13 @@ namespace binder {
 							bound_const.value = value_str;
 							bound_const.type = expected_type;
 
+							if (value_node->type == ASTNodeType::NULL_VALUE) {
+								CheckNullable(target_column);
+								bound_const.is_null = true;
+								bound_values.push_back(bound_const);
+								continue;
+							}
+
 							switch (expected_type) {
 							case ColumnType::INT: {
 								try {
@@ -269,6 +494,22 @@ namespace binder {
 							case ColumnType::CHAR: {
 								break;
 							}
+							case ColumnType::VARCHAR: {
+								CheckLength(target_column, value_str);
+								break;
+							}
+							case ColumnType::BIGINT:
+							case ColumnType::DOUBLE:
+							case ColumnType::DATE:
+							case ColumnType::TIMESTAMP: {
+								try {
+									char bytes[sizeof(int64_t)];
+									EncodeLiteral(expected_type, value_str, bytes);
+								} catch (const std::exception& e) {
+									throw std::runtime_error("Binder error: Invalid value '" + value_str + "' for column '" + target_column.GetName() + "': " + e.what());
+								}
+								break;
+							}
 							default:
 								throw std::runtime_error("Binder error: Unsupported column type for bulk INSERT");
 							}
@@ -299,7 +540,7 @@ namespace binder {
 
 			const std::string& table_name = ast->value;
 
-			TableRef* bound_table = catalog_->GetTableRef(table_name);
+			TableRef* bound_table = catalog_->GetTableRef(table_name, arena_);
 			if (bound_table == nullptr) {
 				throw std::runtime_error("Binder error: Table '" + table_name + "' does not exist");
 			}
@@ -333,5 +574,94 @@ namespace binder {
 		return nullptr;
 	}
 
+	uint32_t Binder::ParseVarcharLength(const std::string& type) {
+		// VARCHAR without a length takes the longest one
+		if (type.size() == 7) {
+			return MAX_VARCHAR_LENGTH;
+		}
+
+		unsigned long length = 0;
+		try {
+			if (type[7] != '(' || type.back() != ')') {
+				throw std::invalid_argument(type);
+			}
+			size_t end = 0;
+			length = std::stoul(type.substr(8, type.size() - 9), &end);
+			if (end != type.size() - 9) {
+				throw std::invalid_argument(type);
+			}
+		} catch (const std::exception&) {
+			throw std::runtime_error("Binder error: Unsupported column type: " + type);
+		}
+
+		if (length == 0 || length > MAX_VARCHAR_LENGTH) {
+			throw std::runtime_error("Binder error: VARCHAR length must be between 1 and " + std::to_string(MAX_VARCHAR_LENGTH));
+		}
+		return static_cast<uint32_t>(length);
+	}
+
+	void Binder::CheckLength(const Column& column, const std::string& value) {
+		if (value.size() > column.GetMaxLength()) {
+			throw std::runtime_error("Binder error: Value too long for column '" + column.GetName() + "' (VARCHAR(" + std::to_string(column.GetMaxLength()) + "))");
+		}
+	}
+
+	void Binder::CheckNullable(const Column& column) {
+		if (!column.IsNullable()) {
+			throw std::runtime_error("Binder error: Column '" + column.GetName() + "' cannot be NULL");
+		}
+	}
+
+	std::unique_ptr<Expression> Binder::BindWhereClause(TableRef* table, const parser::ASTNode& where_clause) {
+		const auto& condition = where_clause.children[0];
+		const std::string& col_name = condition->children[0]->value;
+		const std::string& literal = condition->children[1]->value;
+
+		if (!table->GetSchema()->HasColumn(col_name)) {
+			throw std::runtime_error("Binder error: Column '" + col_name + "' does not exist in table '" + table->table_name + "'");
+		}
+
+		const Column& column = table->GetSchema()->GetColumn(col_name);
+
+		// IS [NOT] NULL has no literal
+		if (condition->children[1]->type != ASTNodeType::NULL_VALUE) {
+			try {
+				switch (column.GetType()) {
+				case ColumnType::INT:
+					std::stoi(literal);
+					break;
+				case ColumnType::FLOAT:
+					std::stof(literal);
+					break;
+				case ColumnType::CHAR:
+				case ColumnType::VARCHAR:
+					break;
+				case ColumnType::BIGINT:
+				case ColumnType::DOUBLE:
+				case ColumnType::DATE:
+				case ColumnType::TIMESTAMP: {
+					char bytes[sizeof(int64_t)];
+					EncodeLiteral(column.GetType(), literal, bytes);
+					break;
+				}
+				default:
+					throw std::runtime_error("Binder error: Unsupported column type in WHERE clause");
+				}
+			} catch (const std::invalid_argument&) {
+				throw std::runtime_error("Binder error: Invalid value '" + literal + "' for column '" + col_name + "' in WHERE clause");
+			} catch (const std::out_of_range&) {
+				throw std::runtime_error("Binder error: Value '" + literal + "' out of range for column '" + col_name + "' in WHERE clause");
+			}
+		}
+
+		auto expression = std::make_unique<Expression>();
+		expression->left.col_id = static_cast<column_id_t>(column.GetOrdinalPosition());
+		expression->left.column_entry_ = const_cast<Column*>(&column);
+		expression->op = condition->value;
+		expression->right.value = literal;
+		expression->right.type = column.GetType();
+		return expression;
+	}
+
 } // namespace binder
 } // namespace venus
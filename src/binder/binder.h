@@ -14,11 +14,13 @@
  * Resolves permissions (if any, not for venus)
  * Makes the AST ready for logical planning
  * Has complete access to the catalog
+ * Table references come from the query arena, they last until the statement ends
  */
 
 #pragma once
 
 #include "catalog/catalog.h"
+#include "common/arena.h"
 #include "parser/ast.h"
 #include "common/types.h"
 
@@ -26,14 +28,27 @@ namespace venus {
 namespace binder {
 	class Binder {
 	public:
-		void SetContext(catalog::CatalogManager* catalog) {
+		// arena: the executor's query arena, the table references are allocated there
+		void SetContext(catalog::CatalogManager* catalog, common::Arena* arena = nullptr) {
 			catalog_ = catalog;
+			arena_ = arena;
 		}
 
 		std::unique_ptr<parser::BoundASTNode> Bind(std::unique_ptr<parser::ASTNode> ast);
 
 	private:
 		catalog::CatalogManager* catalog_ = nullptr;
+		common::Arena* arena_ = nullptr;
+
+		// WHERE_CLAUSE -> CONDITION -> [COLUMN_REF, CONST_VALUE] against table
+		std::unique_ptr<Expression> BindWhereClause(TableRef* table, const parser::ASTNode& where_clause);
+
+		// n of "VARCHAR(n)", MAX_VARCHAR_LENGTH for "VARCHAR"
+		static uint32_t ParseVarcharLength(const std::string& type);
+		// VARCHAR values longer than the column are rejected, not cut
+		static void CheckLength(const Column& column, const std::string& value);
+		// only the primary key is NOT NULL
+		static void CheckNullable(const Column& column);
 	};
 }
 }
\ No newline at end of file
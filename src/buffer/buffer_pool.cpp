@@ -2,201 +2,653 @@
 
 #include "buffer/buffer_pool.h"
 
+#include <cstdlib>
+#include <thread>
+
 namespace venus {
 namespace buffer {
 
-	Page* BufferPoolManager::FetchPage(page_id_t page_id) {
-		if (page_id == INVALID_PAGE_ID) {
-			return nullptr; // Invalid page ID
+	PageGuard::PageGuard(BufferPoolManager* bpm, Frame* frame, bool exclusive)
+	    : bpm_(bpm)
+	    , frame_(frame)
+	    , exclusive_(exclusive)
+	    , is_dirty_(false) {
+		if (exclusive_) {
+			frame_->latch.lock();
+			first_lsn_ = bpm_->NextLSN();
+		} else {
+			frame_->latch.lock_shared();
 		}
+	}
 
-		// If page in bufferpool
-		auto it = pages_.find(page_id);
-		if (it != pages_.end()) {
-			lru_list_.remove(it->second);
-			lru_list_.push_front(it->second);
-			return it->second;
+	PageGuard::PageGuard(PageGuard&& other) noexcept
+	    : bpm_(other.bpm_)
+	    , frame_(other.frame_)
+	    , exclusive_(other.exclusive_)
+	    , is_dirty_(other.is_dirty_)
+	    , first_lsn_(other.first_lsn_)
+	    , mapped_page_(other.mapped_page_)
+	    , mapped_page_id_(other.mapped_page_id_) {
+		other.frame_ = nullptr;
+		other.mapped_page_ = nullptr;
+	}
+
+	PageGuard& PageGuard::operator=(PageGuard&& other) noexcept {
+		if (this != &other) {
+			Release();
+			bpm_ = other.bpm_;
+			frame_ = other.frame_;
+			exclusive_ = other.exclusive_;
+			is_dirty_ = other.is_dirty_;
+			first_lsn_ = other.first_lsn_;
+			mapped_page_ = other.mapped_page_;
+			mapped_page_id_ = other.mapped_page_id_;
+			other.frame_ = nullptr;
+			other.mapped_page_ = nullptr;
+		}
+		return *this;
+	}
+
+	void PageGuard::Release() {
+		mapped_page_ = nullptr;
+		if (frame_ == nullptr) {
+			return;
 		}
 
-		// Page not in buffer pool, and pool is full, evict a page from bp using lru
-		if (lru_list_.size() >= pool_size_) {
-			Page* victim = lru_list_.back();
-			lru_list_.pop_back();
-			pages_.erase(victim->GetPageId());
+		if (is_dirty_) {
+			bpm_->MarkDirty(frame_, first_lsn_);
+		}
+
+		if (exclusive_) {
+			frame_->latch.unlock();
+		} else {
+			frame_->latch.unlock_shared();
+		}
+
+		bpm_->UnpinFrame(frame_);
+		frame_ = nullptr;
+	}
+
+	BufferPool::BufferPool(size_t pool_size)
+	    : pool_size_(pool_size) // no. of pages
+	    , next_database_id_(0)
+	    , pool_data_(nullptr) {
+		pool_data_ = static_cast<char*>(std::aligned_alloc(PAGE_SIZE, pool_size_ * PAGE_SIZE));
+		if (pool_data_ == nullptr) {
+			throw std::runtime_error("BPM: Failed to allocate buffer pool memory");
+		}
+
+		for (size_t i = 0; i < pool_size_; i++) {
+			frames_.push_back(std::make_unique<Frame>(pool_data_ + i * PAGE_SIZE));
+			free_list_.push_back(static_cast<frame_id_t>(i));
+		}
+	}
 
-			// if victim page is dirty, write to disk
-			if (victim->IsDirty()) {
-				disk_manager_->WritePage(victim->GetPageId(), victim->GetData());
+	BufferPool::~BufferPool() {
+		// every database detached on destruction, nothing is mapped
+		frames_.clear();
+		std::free(pool_data_);
+	}
+
+	BufferPoolManager::BufferPoolManager(storage::DiskManager* disk_manager, recovery::LogManager* log_manager)
+	    : owned_pool_(std::make_unique<BufferPool>())
+	    , pool_(owned_pool_.get())
+	    , database_id_(pool_->next_database_id_++)
+	    , disk_manager_(disk_manager)
+	    , log_manager_(log_manager) {
+		// the free list is logged with the pages
+		if (log_manager_ != nullptr) {
+			disk_manager_->SetLogManager(log_manager_);
+		}
+		MapPages();
+	}
+
+	BufferPoolManager::BufferPoolManager(BufferPool* pool, storage::DiskManager* disk_manager, recovery::LogManager* log_manager)
+	    : owned_pool_(nullptr)
+	    , pool_(pool)
+	    , database_id_(pool->next_database_id_++)
+	    , disk_manager_(disk_manager)
+	    , log_manager_(log_manager) {
+		// the free list is logged with the pages
+		if (log_manager_ != nullptr) {
+			disk_manager_->SetLogManager(log_manager_);
+		}
+		MapPages();
+	}
+
+	void BufferPoolManager::MapPages() {
+		// the mapping never changes size, so every page gets its Page up front
+		for (page_id_t page_id = 0; page_id < disk_manager_->GetNumberOfMappedPages(); page_id++) {
+			mapped_pages_.emplace_back(disk_manager_->GetMappedPage(page_id));
+		}
+	}
+
+	void BufferPoolManager::CheckWritable() const {
+		if (disk_manager_->IsReadOnly()) {
+			throw std::runtime_error("BPM: Database is read only");
+		}
+	}
+
+	BufferPoolManager::~BufferPoolManager() {
+		for (auto& frame : pool_->frames_) {
+			if (frame->owner != this) {
+				continue;
 			}
 
-			// reset victim page
-			victim->NewPage(INVALID_PAGE_ID, PageType::INVALID_PAGE);
-			delete[] victim->GetData();
-			delete victim;
+			// another database may be evicting the frame right now, it unmaps it when done
+			while (true) {
+				page_id_t page_id = frame->page_id;
+				BufferPool::PageTableShard& shard = pool_->ShardFor(KeyOf(page_id));
+				std::unique_lock<std::mutex> lock(shard.latch);
+				if (frame->owner != this || frame->page_id != page_id) {
+					break;
+				}
+				if (frame->pin_count == 0) {
+					frame->pin_count = 1;
+					lock.unlock();
+
+					if (frame->is_dirty) {
+						// LOG("BPM destructor: Flushing dirty page: " + std::to_string(frame->page_id));
+						try {
+							WriteBack(frame.get());
+						} catch (const std::exception& e) {
+							LOG("BPM: Failed to flush page " + std::to_string(page_id) + ": " + e.what());
+						}
+					}
+
+					lock.lock();
+					shard.table.erase(KeyOf(page_id));
+					lock.unlock();
+					pool_->ReturnFrame(static_cast<frame_id_t>(&frame - pool_->frames_.data()));
+					break;
+				}
+				lock.unlock();
+				std::this_thread::yield();
+			}
 		}
+	}
 
-		// create new page
-		Page* new_page = new Page(new char[PAGE_SIZE]);
-		new_page->NewPage(page_id, PageType::TABLE_PAGE);
+	PageGuard BufferPoolManager::FetchPageRead(page_id_t page_id) {
+		if (page_id < mapped_pages_.size()) {
+			return PageGuard(&mapped_pages_[page_id], page_id);
+		}
 
-		// Try to read page from disk - if it doesn't exist, return nullptr
+		Frame* frame = PinPage(page_id, true);
+		if (frame == nullptr) {
+			return PageGuard();
+		}
+		return PageGuard(this, frame, false);
+	}
+
+	PageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id) {
+		CheckWritable();
+
+		Frame* frame = PinPage(page_id, true);
+		if (frame == nullptr) {
+			return PageGuard();
+		}
+		return PageGuard(this, frame, true);
+	}
+
+	PageGuard BufferPoolManager::NewPageGuarded(page_id_t extent_key) {
+		CheckWritable();
+
+		frame_id_t frame_id = pool_->AcquireFrame();
+		Frame* frame = pool_->frames_[frame_id].get();
+
+		page_id_t new_page_id;
 		try {
-			disk_manager_->ReadPage(page_id, new_page->GetData());
-		} catch (const std::out_of_range&) {
-			// Page doesn't exist on disk
-			delete[] new_page->GetData();
-			delete new_page;
-			return nullptr;
-		} catch (const std::runtime_error&) {
-			// Failed to read page from disk
-			delete[] new_page->GetData();
-			delete new_page;
+			new_page_id = disk_manager_->AllocatePage(extent_key);
+			DropStaleFrame(new_page_id);
+			frame->page.NewPage(new_page_id, PageType::TABLE_PAGE);
+			disk_manager_->WritePage(new_page_id, frame->page.GetData());
+		} catch (...) {
+			pool_->ReturnFrame(frame_id);
+			throw;
+		}
+
+		{
+			BufferPool::PageTableShard& shard = pool_->ShardFor(KeyOf(new_page_id));
+			std::lock_guard<std::mutex> lock(shard.latch);
+			frame->owner = this;
+			frame->database_id = database_id_;
+			frame->page_id = new_page_id;
+			frame->is_dirty = false;
+			shard.table[KeyOf(new_page_id)] = frame_id;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(pool_->frame_latch_);
+			pool_->replacer_.Touch(frame_id);
+		}
+
+		// frame is already pinned by AcquireFrame, guard takes over that pin
+		return PageGuard(this, frame, true);
+	}
+
+	// A reused page id may still be mapped to a frame of its previous life; its contents are
+	// garbage and must not be written over the new page when the frame is evicted
+	void BufferPoolManager::DropStaleFrame(page_id_t page_id) {
+		frame_id_t frame_id;
+		{
+			BufferPool::PageTableShard& shard = pool_->ShardFor(KeyOf(page_id));
+			std::lock_guard<std::mutex> lock(shard.latch);
+			auto it = shard.table.find(KeyOf(page_id));
+			if (it == shard.table.end()) {
+				return;
+			}
+			frame_id = it->second;
+			if (pool_->frames_[frame_id]->pin_count > 0) {
+				throw std::runtime_error("BufferPool error: Allocated page " + std::to_string(page_id) + " is still pinned");
+			}
+			shard.table.erase(it);
+			pool_->frames_[frame_id]->page_id = INVALID_PAGE_ID;
+			pool_->frames_[frame_id]->pin_count = 1;
+		}
+		pool_->ReturnFrame(frame_id);
+	}
+
+	Page* BufferPoolManager::FetchPage(page_id_t page_id) {
+		if (page_id < mapped_pages_.size()) {
+			return &mapped_pages_[page_id];
+		}
+
+		Frame* frame = PinPage(page_id, true);
+		if (frame == nullptr) {
 			return nullptr;
 		}
+		UnpinFrame(frame);
+		return &frame->page;
+	}
 
-		new_page->GetHeader()->page_id = page_id;
+	Page* BufferPoolManager::NewPage() {
+		PageGuard guard = NewPageGuarded();
+		Page* page = guard.GetPage();
+		return page;
+	}
 
-		pages_[page_id] = new_page;
-		lru_list_.push_front(new_page);
+	Page* BufferPoolManager::NewPage(page_id_t page_id) {
+		if (page_id == INVALID_PAGE_ID) {
+			return nullptr;
+		}
+		CheckWritable();
 
-		return new_page;
+		Frame* frame = PinPage(page_id, false);
+		if (frame == nullptr) {
+			return nullptr;
+		}
+		UnpinFrame(frame);
+		return &frame->page;
 	}
 
 	bool BufferPoolManager::SetDirtyPage(page_id_t page_id, bool is_dirty) {
-		auto it = pages_.find(page_id);
-		if (it == pages_.end()) {
+		BufferPool::PageTableShard& shard = pool_->ShardFor(KeyOf(page_id));
+		std::lock_guard<std::mutex> lock(shard.latch);
+
+		auto it = shard.table.find(KeyOf(page_id));
+		if (it == shard.table.end()) {
 			return false;
 		}
 
-		Page* page = it->second;
 		if (is_dirty) {
-			page->SetDirty(true);
+			// the caller changed the page at some unknown point, assume the start of the log
+			MarkDirty(pool_->frames_[it->second].get(), 0);
 		}
 		return true;
 	}
 
 	// Flush page to disk if dirty
 	bool BufferPoolManager::FlushPage(page_id_t page_id) {
-		auto it = pages_.find(page_id);
-		if (it == pages_.end()) {
-			return false; // Page not found in buffer pool
+		Frame* frame = nullptr;
+		{
+			BufferPool::PageTableShard& shard = pool_->ShardFor(KeyOf(page_id));
+			std::lock_guard<std::mutex> lock(shard.latch);
+			auto it = shard.table.find(KeyOf(page_id));
+			if (it == shard.table.end()) {
+				return false; // Page not found in buffer pool
+			}
+			frame = pool_->frames_[it->second].get();
+			frame->pin_count++;
 		}
 
-		Page* page = it->second;
-		if (page->IsDirty()) {
-			try {
-				disk_manager_->WritePage(page_id, page->GetData());
-				page->SetDirty(false);
-			} catch (const std::exception& e) {
-				LOG("BPM: Failed to flush page " + std::to_string(page_id) + ": " + e.what());
-				return false;
-			}
+		bool ok = true;
+		try {
+			WriteBack(frame);
+		} catch (const std::exception& e) {
+			LOG("BPM: Failed to flush page " + std::to_string(page_id) + ": " + e.what());
+			ok = false;
 		}
-		return true;
+
+		UnpinFrame(frame);
+		return ok;
 	}
 
 	bool BufferPoolManager::FlushAllPages() {
-		// LOG("BPM: Starting flush of all pages (" + std::to_string(pages_.size()) + " pages)");
+		// LOG("BPM: Starting flush of all pages");
 
-		for (auto& pair : pages_) {
-			page_id_t page_id = pair.first;
-			Page* page = pair.second;
+		std::vector<Frame*> pinned = PinResidentFrames(false, 0);
 
-			if (page->IsDirty()) {
+		bool ok = true;
+		for (Frame* frame : pinned) {
+			if (ok) {
 				try {
-					disk_manager_->WritePage(page_id, page->GetData());
-					page->SetDirty(false);
+					WriteBack(frame);
 				} catch (const std::exception& e) {
-					LOG("BPM: Failed to flush page " + std::to_string(page_id) + ": " + e.what());
-					return false;
+					LOG("BPM: Failed to flush page " + std::to_string(frame->page_id) + ": " + e.what());
+					ok = false;
 				}
 			}
+			UnpinFrame(frame);
 		}
 
-		return true;
+		return ok;
 	}
 
-	Page* BufferPoolManager::NewPage() {
-		page_id_t new_page_id = disk_manager_->AllocatePage();
-		Page* new_page = new Page(new char[PAGE_SIZE]);
+	std::vector<std::pair<page_id_t, lsn_t>> BufferPoolManager::GetDirtyPageTable() {
+		std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
 
-		new_page->NewPage(new_page_id, PageType::TABLE_PAGE);
+		for (auto& frame : pool_->frames_) {
+			if (frame->owner != this) {
+				continue;
+			}
+			// the shared latch waits out a writer that changed the page but has not marked it dirty yet
+			std::shared_lock<std::shared_mutex> latch(frame->latch);
+			page_id_t page_id = frame->page_id;
+			if (frame->owner == this && page_id != INVALID_PAGE_ID && frame->is_dirty) {
+				dirty_pages.emplace_back(page_id, frame->rec_lsn.load());
+			}
+		}
 
-		disk_manager_->WritePage(new_page_id, new_page->GetData());
+		return dirty_pages;
+	}
 
-		pages_[new_page_id] = new_page;
-		lru_list_.push_front(new_page);
+	bool BufferPoolManager::FlushPagesBefore(lsn_t lsn) {
+		std::vector<Frame*> pinned = PinResidentFrames(true, lsn);
 
-		return new_page;
+		bool ok = true;
+		for (Frame* frame : pinned) {
+			if (ok) {
+				try {
+					WriteBack(frame);
+				} catch (const std::exception& e) {
+					LOG("BPM: Failed to flush page " + std::to_string(frame->page_id) + ": " + e.what());
+					ok = false;
+				}
+			}
+			UnpinFrame(frame);
+		}
+
+		return ok;
 	}
 
-	Page* BufferPoolManager::NewPage(page_id_t page_id) {
-		if (page_id == INVALID_PAGE_ID) {
-			return nullptr;
+	// pages of this database, pinned; with dirty_only those with a change older than before
+	std::vector<Frame*> BufferPoolManager::PinResidentFrames(bool dirty_only, lsn_t before) {
+		std::vector<Frame*> pinned;
+		for (auto& shard : pool_->shards_) {
+			std::lock_guard<std::mutex> lock(shard.latch);
+			for (auto& entry : shard.table) {
+				if (static_cast<database_id_t>(entry.first >> 32) != database_id_) {
+					continue;
+				}
+				Frame* frame = pool_->frames_[entry.second].get();
+				if (!dirty_only || (frame->is_dirty && frame->rec_lsn < before)) {
+					frame->pin_count++;
+					pinned.push_back(frame);
+				}
+			}
 		}
+		return pinned;
+	}
 
-		auto it = pages_.find(page_id);
-		if (it != pages_.end()) {
-			return it->second;
+	size_t BufferPoolManager::GetResidentPageCount() {
+		size_t count = 0;
+		for (auto& shard : pool_->shards_) {
+			std::lock_guard<std::mutex> lock(shard.latch);
+			for (auto& entry : shard.table) {
+				count += static_cast<database_id_t>(entry.first >> 32) == database_id_ ? 1 : 0;
+			}
 		}
+		return count;
+	}
 
-		// Evict a page if buffer pool is full
-		if (lru_list_.size() >= pool_size_) {
-			Page* victim = lru_list_.back();
-			lru_list_.pop_back();
-			pages_.erase(victim->GetPageId());
+	bool BufferPoolManager::DeletePage(page_id_t page_id) {
+		CheckWritable();
+
+		frame_id_t frame_id = INVALID_FRAME_ID;
+		{
+			BufferPool::PageTableShard& shard = pool_->ShardFor(KeyOf(page_id));
+			std::lock_guard<std::mutex> lock(shard.latch);
+			auto it = shard.table.find(KeyOf(page_id));
+			if (it != shard.table.end()) {
+				frame_id = it->second;
+				if (pool_->frames_[frame_id]->pin_count > 0) {
+					return false; // still in use
+				}
 
-			if (victim->IsDirty()) {
-				disk_manager_->WritePage(victim->GetPageId(), victim->GetData());
+				// the contents are garbage now, not written back
+				shard.table.erase(it);
+				pool_->frames_[frame_id]->page_id = INVALID_PAGE_ID;
+				pool_->frames_[frame_id]->pin_count = 1;
 			}
+		}
 
-			victim->NewPage(INVALID_PAGE_ID, PageType::INVALID_PAGE);
-			delete[] victim->GetData();
-			delete victim;
+		if (frame_id != INVALID_FRAME_ID) {
+			pool_->ReturnFrame(frame_id);
 		}
+		// reusable after the next checkpoint, see DiskManager
+		disk_manager_->DeallocatePage(page_id, NextLSN());
 
-		Page* new_page = new Page(new char[PAGE_SIZE]);
-		new_page->NewPage(page_id, PageType::TABLE_PAGE);
+		return true;
+	}
+
+	// Returns the frame holding page_id with its pin count incremented
+	// If the page is not resident, a frame is acquired and the page is read from disk (or initialized empty)
+	Frame* BufferPoolManager::PinPage(page_id_t page_id, bool read_from_disk) {
+		if (page_id == INVALID_PAGE_ID) {
+			return nullptr; // Invalid page ID
+		}
 
-		pages_[page_id] = new_page;
-		lru_list_.push_front(new_page);
+		BufferPool::page_key_t key = KeyOf(page_id);
+		BufferPool::PageTableShard& shard = pool_->ShardFor(key);
 
-		return new_page;
-	}
+		// If page in bufferpool
+		{
+			std::unique_lock<std::mutex> lock(shard.latch);
+			while (true) {
+				auto it = shard.table.find(key);
+				if (it != shard.table.end()) {
+					frame_id_t frame_id = it->second;
+					pool_->frames_[frame_id]->pin_count++;
+					lock.unlock();
+
+					std::lock_guard<std::mutex> frame_lock(pool_->frame_latch_);
+					pool_->replacer_.Touch(frame_id);
+					return pool_->frames_[frame_id].get();
+				}
 
-	bool BufferPoolManager::DeletePage(page_id_t page_id) {
-		auto it = pages_.find(page_id);
-		if (it == pages_.end()) {
-			return false;
+				// only one thread loads a given page, otherwise a slow reader could map a copy
+				// that is older than one another thread loaded, modified and evicted meanwhile
+				if (shard.loading.insert(key).second) {
+					break;
+				}
+				shard.loaded.wait(lock);
+			}
 		}
 
-		Page* page = it->second;
-		pages_.erase(page_id);
-		lru_list_.remove(page);
+		// Page not in buffer pool, load it into a free or evicted frame without holding the shard latch
+		frame_id_t frame_id;
+		Frame* frame;
+		try {
+			frame_id = pool_->AcquireFrame();
+			frame = pool_->frames_[frame_id].get();
 
-		delete[] page->GetData();
-		delete page;
+			if (read_from_disk) {
+				try {
+					disk_manager_->ReadPage(page_id, frame->page.GetData());
+				} catch (const std::exception&) {
+					// Page doesn't exist on disk / failed to read
+					pool_->ReturnFrame(frame_id);
+					FinishLoad(shard, page_id, nullptr, INVALID_FRAME_ID);
+					return nullptr;
+				}
+				frame->page.GetHeader()->page_id = page_id;
+				frame->is_dirty = false;
+			} else {
+				frame->page.NewPage(page_id, PageType::TABLE_PAGE);
+				frame->rec_lsn = NextLSN();
+				frame->is_dirty = true;
+			}
+		} catch (...) {
+			FinishLoad(shard, page_id, nullptr, INVALID_FRAME_ID);
+			throw;
+		}
 
-		disk_manager_->DeallocatePage(page_id);
+		FinishLoad(shard, page_id, frame, frame_id);
 
-		return true;
+		std::lock_guard<std::mutex> frame_lock(pool_->frame_latch_);
+		pool_->replacer_.Touch(frame_id);
+		return frame;
 	}
 
-	BufferPoolManager::~BufferPoolManager() {
-		for (auto& pair : pages_) {
-			Page* page = pair.second;
-			if (page->IsDirty()) {
-				// LOG("BPM destructor: Flushing dirty page: " + std::to_string(page->GetPageId()));
-				disk_manager_->WritePage(page->GetPageId(), page->GetData());
+	// Maps the loaded frame (if any) and wakes threads waiting on the page
+	void BufferPoolManager::FinishLoad(BufferPool::PageTableShard& shard, page_id_t page_id, Frame* frame, frame_id_t frame_id) {
+		{
+			std::lock_guard<std::mutex> lock(shard.latch);
+			if (frame != nullptr) {
+				frame->owner = this;
+				frame->database_id = database_id_;
+				frame->page_id = page_id;
+				shard.table[KeyOf(page_id)] = frame_id;
+			}
+			shard.loading.erase(KeyOf(page_id));
+		}
+		shard.loaded.notify_all();
+	}
+
+	void BufferPoolManager::UnpinFrame(Frame* frame) {
+		frame->pin_count--;
+	}
+
+	// Returns a frame that is not mapped to any page, pinned once for the caller
+	// The victim may belong to any database, it is written back through its own BufferPoolManager
+	frame_id_t BufferPool::AcquireFrame() {
+		while (true) {
+			frame_id_t frame_id;
+			{
+				std::lock_guard<std::mutex> lock(frame_latch_);
+				if (!free_list_.empty()) {
+					frame_id = free_list_.front();
+					free_list_.pop_front();
+					frames_[frame_id]->pin_count = 1;
+					return frame_id;
+				}
+
+				bool found = replacer_.Victim(&frame_id, [this](frame_id_t id) {
+					return frames_[id]->pin_count == 0;
+				});
+				if (!found) {
+					throw std::runtime_error("BPM: All frames are pinned, cannot evict a page");
+				}
+			}
+
+			Frame* victim = frames_[frame_id].get();
+			database_id_t victim_database_id = victim->database_id;
+			page_id_t victim_page_id = victim->page_id;
+			if (victim_page_id == INVALID_PAGE_ID) {
+				continue;
+			}
+			page_key_t victim_key = KeyOf(victim_database_id, victim_page_id);
+			PageTableShard& shard = ShardFor(victim_key);
+
+			// claim the victim: only succeeds if nobody pinned or remapped it after it was chosen
+			// a mapped frame keeps its owner alive, the owner unmaps its frames before it goes away
+			BufferPoolManager* owner;
+			{
+				std::lock_guard<std::mutex> lock(shard.latch);
+				if (victim->page_id != victim_page_id || victim->database_id != victim_database_id || victim->pin_count != 0) {
+					continue;
+				}
+				victim->pin_count = 1;
+				owner = victim->owner;
+			}
+
+			// if victim page is dirty, write to disk - page stays mapped so concurrent fetches see it
+			try {
+				owner->WriteBack(victim);
+			} catch (...) {
+				victim->pin_count--;
+				std::lock_guard<std::mutex> lock(frame_latch_);
+				replacer_.Touch(frame_id);
+				throw;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(shard.latch);
+				if (victim->pin_count == 1 && !victim->is_dirty) {
+					shard.table.erase(victim_key);
+					victim->page_id = INVALID_PAGE_ID;
+					victim->owner = nullptr;
+
+					std::lock_guard<std::mutex> frame_lock(frame_latch_);
+					replacer_.Remove(frame_id);
+					return frame_id;
+				}
+				// pinned or re-dirtied during write back, leave it to its new user
+				victim->pin_count--;
 			}
 
-			// LOG("BPM destructor: Deallocating page: " + std::to_string(page->GetPageId()));
+			std::lock_guard<std::mutex> frame_lock(frame_latch_);
+			replacer_.Touch(frame_id);
+		}
+	}
+
+	// Caller holds the frame exclusively (or it is not shared yet)
+	void BufferPoolManager::MarkDirty(Frame* frame, lsn_t rec_lsn) {
+		if (!frame->is_dirty) {
+			frame->rec_lsn = rec_lsn;
+			frame->is_dirty = true;
+		}
+	}
+
+	lsn_t BufferPoolManager::NextLSN() const {
+		return log_manager_ != nullptr ? log_manager_->GetNextLSN() : 0;
+	}
+
+	// Puts an unmapped frame back on the free list
+	void BufferPool::ReturnFrame(frame_id_t frame_id) {
+		Frame* frame = frames_[frame_id].get();
+		frame->owner = nullptr;
+		frame->page_id = INVALID_PAGE_ID;
+		frame->is_dirty = false;
+		frame->pin_count = 0;
+
+		std::lock_guard<std::mutex> lock(frame_latch_);
+		replacer_.Remove(frame_id);
+		free_list_.push_back(frame_id);
+	}
+
+	// Writes a pinned frame to disk if dirty, under its shared latch
+	// The log is flushed up to the page LSN first (WAL-before-data)
+	void BufferPoolManager::WriteBack(Frame* frame) {
+		if (!frame->is_dirty) {
+			return;
+		}
 
-			delete[] page->GetData();
-			delete page;
+		std::shared_lock<std::shared_mutex> latch(frame->latch);
+		if (!frame->is_dirty) {
+			return;
+		}
+		frame->is_dirty = false;
+		try {
+			if (log_manager_ != nullptr) {
+				log_manager_->Flush(frame->page.GetLSN());
+			}
+			disk_manager_->WritePage(frame->page_id, frame->page.GetData());
+		} catch (...) {
+			frame->is_dirty = true;
+			throw;
 		}
-		pages_.clear();
-		lru_list_.clear();
 	}
+
 } // namespace buffer
-} // namespace venus
\ No newline at end of file
+} // namespace venus
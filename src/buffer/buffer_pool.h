@@ -25,45 +25,260 @@
  *         b. Evict it (write back via DiskManager if dirty)
  *         c. Read new page via DiskManager::ReadPage(page_id, frame_data)
  *   3. Pin the frame and return it to TableHeap
- * 
+ *
  * Pinning - bumps the page's pin count so the buffer pool won’t evict it while in use.
  * Dirty - Marking a page “dirty” just flags that it’s been modified and must be written back to disk before eviction.
- * 
+ *
+ * Concurrency
+ *   The pool is safe to use from many threads. There is no single latch over the whole pool:
+ *   - Frames live in one PAGE_SIZE aligned arena allocated up front, frame_id indexes into it.
+ *   - The page table (page_id -> frame_id) is split into BUFFER_POOL_SHARDS shards by page id,
+ *     each with its own mutex, so lookups of different pages rarely contend.
+ *   - A miss registers the page as loading in its shard; other threads missing the same page
+ *     wait for that load instead of reading their own copy from disk.
+ *   - Every frame has a reader/writer latch over the page bytes and an atomic pin count.
+ *     Pin counts only go up under the shard mutex, which is what eviction checks against.
+ *   - The free list and LRU replacer share one small frame latch, held only to pick a frame.
+ *   - Eviction claims a victim, writes it back while the page is still mapped (so a concurrent
+ *     fetch of the same page cannot read a stale copy from disk), and only then unmaps it.
+ *     No pool-wide lock is held during disk I/O.
+ *
+ * Write-ahead logging
+ *   With a LogManager, every write back first flushes the log up to the page's LSN, so a page
+ *   never reaches disk ahead of the log records describing its changes. The DiskManager logs its
+ *   free list changes to it too.
+ *   Each dirty frame also remembers a rec_lsn: a log position no later than its first change
+ *   since it was last written. Checkpoints record these as the dirty page table.
+ *
+ * Databases
+ *   The frames, page table and replacer are a BufferPool that every open database shares, so hot
+ *   pages of all databases compete for one MAX_BUFFER_POOL_SIZE budget. A BufferPoolManager is one
+ *   database's view of it: it has the database's DiskManager and LogManager and an id the pool
+ *   keys its pages with, (database id, page id). A frame remembers the view that loaded it, and
+ *   evicting it writes it back through that view. Destroying a view flushes its pages and returns
+ *   their frames. A BufferPoolManager constructed without a pool has a private one.
+ *
+ * Read-only mapped databases
+ *   When the DiskManager maps its file (DiskMode::MMAP_READ_ONLY), FetchPageRead returns a guard over
+ *   the page inside the mapping: no frame, pin or latch, nothing is copied and the pool is not used
+ *   for the database's pages at all. FetchPageWrite and the page allocating calls throw. AdvisePages
+ *   passes a scan's access pattern on to the kernel.
+ *
+ * Access
+ *   FetchPageRead / FetchPageWrite return a PageGuard that holds a pin and the frame latch
+ *   (shared or exclusive) until it goes out of scope. This is the API for anything that may run
+ *   concurrently. FetchPage / NewPage return a bare Page* that is not kept pinned, which is only
+ *   safe while no other thread can evict it (single-threaded setup code such as catalog bootstrap).
  */
 
 #pragma once
 
+#include "buffer/lru_replacer.h"
 #include "common/config.h"
 #include "common/types.h"
+#include "recovery/log_manager.h"
 #include "storage/disk_manager.h"
 #include "storage/page.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace venus {
 namespace buffer {
-	class BufferPoolManager {
+	class BufferPoolManager;
+
+	struct Frame {
+		explicit Frame(char* data)
+		    : page(data)
+		    , owner(nullptr)
+		    , database_id(0)
+		    , page_id(INVALID_PAGE_ID)
+		    , pin_count(0)
+		    , is_dirty(false)
+		    , rec_lsn(INVALID_LSN) { }
+
+		Page page;
+		std::atomic<BufferPoolManager*> owner; // database of page_id, changed with it
+		std::atomic<database_id_t> database_id; // id of owner, readable after owner is gone
+		std::atomic<page_id_t> page_id; // changed only under the shard mutex of page_id
+		std::atomic<uint32_t> pin_count;
+		std::atomic<bool> is_dirty;
+		std::atomic<lsn_t> rec_lsn; // no change older than this is missing on disk, valid while dirty
+		std::shared_mutex latch; // reader/writer latch over page contents
+	};
+
+	// RAII pin + latch on a buffer pool frame, or a page of a read-only mapping that needs neither
+	class PageGuard {
 	public:
-		BufferPoolManager(storage::DiskManager* disk_manager)
-		    : pool_size_(MAX_BUFFER_POOL_SIZE) // no. of pages
-		    , disk_manager_(disk_manager) { };
+		PageGuard() = default;
+		PageGuard(BufferPoolManager* bpm, Frame* frame, bool exclusive);
+		PageGuard(Page* mapped_page, page_id_t page_id)
+		    : mapped_page_(mapped_page)
+		    , mapped_page_id_(page_id) { }
+		~PageGuard() { Release(); }
+
+		PageGuard(PageGuard&& other) noexcept;
+		PageGuard& operator=(PageGuard&& other) noexcept;
+		PageGuard(const PageGuard&) = delete;
+		PageGuard& operator=(const PageGuard&) = delete;
+
+		bool IsValid() const { return frame_ != nullptr || mapped_page_ != nullptr; }
+		explicit operator bool() const { return IsValid(); }
+
+		Page* GetPage() const { return mapped_page_ ? mapped_page_ : &frame_->page; }
+		Page* operator->() const { return GetPage(); }
+		page_id_t GetPageId() const { return mapped_page_ ? mapped_page_id_ : frame_->page_id.load(); }
+
+		// only meaningful for exclusive guards
+		void MarkDirty() { is_dirty_ = true; }
+
+		void Release();
+
+	private:
+		BufferPoolManager* bpm_ = nullptr;
+		Frame* frame_ = nullptr;
+		bool exclusive_ = false;
+		bool is_dirty_ = false;
+		lsn_t first_lsn_ = 0; // log position when the latch was taken, lower bound for changes made under it
+		Page* mapped_page_ = nullptr;
+		page_id_t mapped_page_id_ = INVALID_PAGE_ID;
+	};
+
+	// frames shared by the databases of the process
+	class BufferPool {
+	public:
+		explicit BufferPool(size_t pool_size = MAX_BUFFER_POOL_SIZE);
+		~BufferPool();
+
+		size_t GetPoolSize() const { return pool_size_; }
+
+	private:
+		friend class BufferPoolManager;
+
+		using page_key_t = uint64_t; // database id << 32 | page id
+
+		struct PageTableShard {
+			std::mutex latch;
+			std::unordered_map<page_key_t, frame_id_t> table;
+			std::unordered_set<page_key_t> loading; // pages being read in, not yet in table
+			std::condition_variable loaded;
+		};
+
+		size_t pool_size_;
+		std::atomic<database_id_t> next_database_id_;
+
+		char* pool_data_; // PAGE_SIZE aligned arena backing every frame
+		std::vector<std::unique_ptr<Frame>> frames_;
+		std::array<PageTableShard, BUFFER_POOL_SHARDS> shards_;
+
+		std::mutex frame_latch_; // protects free_list_ and replacer_
+		std::list<frame_id_t> free_list_;
+		LRUReplacer replacer_;
+
+		static page_key_t KeyOf(database_id_t database_id, page_id_t page_id) {
+			return (static_cast<page_key_t>(database_id) << 32) | page_id;
+		}
+
+		PageTableShard& ShardFor(page_key_t key) {
+			// pages of one database spread like before, databases start at different shards
+			return shards_[(static_cast<uint32_t>(key) + static_cast<uint32_t>(key >> 32)) % BUFFER_POOL_SHARDS];
+		}
+
+		frame_id_t AcquireFrame();
+		void ReturnFrame(frame_id_t frame_id);
+
+		DISALLOW_COPY_AND_MOVE(BufferPool);
+	};
 
+	class BufferPoolManager {
+	public:
+		BufferPoolManager(storage::DiskManager* disk_manager, recovery::LogManager* log_manager = nullptr);
+		// a database in a pool shared with others
+		BufferPoolManager(BufferPool* pool, storage::DiskManager* disk_manager, recovery::LogManager* log_manager = nullptr);
 		~BufferPoolManager();
 
+		PageGuard FetchPageRead(page_id_t page_id);
+		PageGuard FetchPageWrite(page_id_t page_id);
+		// allocates a page and returns it write-latched, from the extent of the heap starting at extent_key
+		PageGuard NewPageGuarded(page_id_t extent_key = INVALID_PAGE_ID);
+
 		Page* FetchPage(page_id_t page_id);
 		bool SetDirtyPage(page_id_t page_id, bool is_dirty);
 		bool FlushPage(page_id_t page_id);
 		bool FlushAllPages();
 		Page* NewPage();
 		Page* NewPage(page_id_t page_id);  // Create page at specific ID (for system tables)
-		bool DeletePage(page_id_t page_id);
+		bool DeletePage(page_id_t page_id); // frees the page in the file, false while it is pinned
+
+		// VACUUM FILE: cuts free pages off the end of the database file, returns how many
+		uint32_t TruncateFreePages() { return disk_manager_->TruncateFreePages(); }
+
+		// a dropped heap's reserved pages go back to the free list
+		void ReleaseExtent(page_id_t extent_key) { disk_manager_->ReleaseExtent(extent_key); }
+
+		// recovery: a logged change of the file's free list
+		void RedoFreeList(const recovery::LogRecord& record) { disk_manager_->RedoFreeList(record); }
+
+		// null when the pool runs without a write-ahead log
+		recovery::LogManager* GetLogManager() const { return log_manager_; }
+
+		// page -> rec lsn of every dirty page, for fuzzy checkpoints
+		std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable();
+
+		// writes back dirty pages whose oldest unwritten change is older than lsn
+		bool FlushPagesBefore(lsn_t lsn);
+
+		// pages of this database in the pool
+		size_t GetResidentPageCount();
+
+		// the database file is mapped read only, reads do not go through the pool
+		bool IsMapped() const { return !mapped_pages_.empty(); }
+
+		// hints for mapped databases that the pages are about to be read, no-op otherwise
+		void AdvisePages(const page_id_t* page_ids, size_t count, storage::AccessHint hint) {
+			if (IsMapped()) {
+				disk_manager_->Advise(page_ids, count, hint);
+			}
+		}
 
 	private:
-		size_t pool_size_;
+		friend class PageGuard;
+		friend class BufferPool;
+
+		std::unique_ptr<BufferPool> owned_pool_;
+		BufferPool* pool_;
+		database_id_t database_id_;
 		storage::DiskManager* disk_manager_;
-		std::unordered_map<page_id_t, Page*> pages_; // Pages which are allocated and deallocated in the buffer pool
-		std::list<Page*> lru_list_; // For LRU replacement policy
+		recovery::LogManager* log_manager_;
+		std::deque<Page> mapped_pages_; // page id -> page over the mapping, read-only mapped databases only
+
+		void MapPages();
+		void CheckWritable() const;
+
+		BufferPool::page_key_t KeyOf(page_id_t page_id) const {
+			return BufferPool::KeyOf(database_id_, page_id);
+		}
+
+		Frame* PinPage(page_id_t page_id, bool read_from_disk);
+		void FinishLoad(BufferPool::PageTableShard& shard, page_id_t page_id, Frame* frame, frame_id_t frame_id);
+		void DropStaleFrame(page_id_t page_id);
+		void UnpinFrame(Frame* frame);
+		std::vector<Frame*> PinResidentFrames(bool dirty_only, lsn_t before);
+		void WriteBack(Frame* frame);
+		void MarkDirty(Frame* frame, lsn_t rec_lsn);
+		lsn_t NextLSN() const;
+
+		DISALLOW_COPY_AND_MOVE(BufferPoolManager);
 	};
 }
-}
\ No newline at end of file
+}
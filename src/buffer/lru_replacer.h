@@ -0,0 +1,68 @@
+// /src/buffer/lru_replacer.h
+
+/**
+ * LRU replacement policy over buffer pool frames.
+ *
+ * Every frame holding a page is tracked, most recently used at the front.
+ * Victim() walks from the back and returns the least recently used frame that the
+ * caller's predicate accepts (the buffer pool passes "pin count is zero").
+ *
+ * Touch/Remove/Victim are O(1) (Victim is O(pinned frames at the tail)).
+ * Not synchronized - the buffer pool calls it under its frame latch.
+ */
+
+#pragma once
+
+#include "common/config.h"
+
+#include <list>
+#include <unordered_map>
+
+namespace venus {
+namespace buffer {
+
+	class LRUReplacer {
+	public:
+		LRUReplacer() = default;
+
+		// mark frame as most recently used, inserting it if untracked
+		void Touch(frame_id_t frame_id) {
+			auto it = positions_.find(frame_id);
+			if (it != positions_.end()) {
+				lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+				return;
+			}
+			lru_list_.push_front(frame_id);
+			positions_[frame_id] = lru_list_.begin();
+		}
+
+		void Remove(frame_id_t frame_id) {
+			auto it = positions_.find(frame_id);
+			if (it == positions_.end()) {
+				return;
+			}
+			lru_list_.erase(it->second);
+			positions_.erase(it);
+		}
+
+		template <typename Evictable>
+		bool Victim(frame_id_t* frame_id, Evictable is_evictable) {
+			for (auto it = lru_list_.rbegin(); it != lru_list_.rend(); ++it) {
+				if (is_evictable(*it)) {
+					*frame_id = *it;
+					Remove(*it);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		size_t Size() const { return lru_list_.size(); }
+
+	private:
+		std::list<frame_id_t> lru_list_;
+		std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> positions_;
+	};
+
+} // namespace buffer
+} // namespace venus
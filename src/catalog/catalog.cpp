@@ -1,11 +1,17 @@
 // /src/catalog/catalog.cpp
 
 #include "catalog/catalog.h"
+#include "catalog/value.h"
 #include "common/config.h"
+#include "concurrency/garbage_collector.h"
 
 namespace venus {
 namespace catalog {
 
+	// bits of is_primary_key in master_columns
+	constexpr int COLUMN_PRIMARY_KEY = 1;
+	constexpr int COLUMN_BLOOM_FILTER = 2;
+
 	Schema* GetMasterTableSchema() {
 		Schema* schema = new Schema();
 		schema->AddColumn("table_id", ColumnType::INT, true, 0);
@@ -28,8 +34,9 @@ namespace catalog {
 		return schema;
 	}
 
-	CatalogManager::CatalogManager(buffer::BufferPoolManager* bpm)
+	CatalogManager::CatalogManager(buffer::BufferPoolManager* bpm, concurrency::GarbageCollector* gc)
 	    : bpm_(bpm)
+	    , gc_(gc)
 	    , tables_table_(nullptr)
 	    , columns_table_(nullptr)
 	    , next_table_id_(2) // Start after system tables (0, 1)
@@ -89,8 +96,22 @@ namespace catalog {
 		bpm_->FlushPage(MASTER_COLUMNS_PAGE_ID);
 	}
 
-	void CatalogManager::CreateTable(const std::string table_name, const Schema* schema) {
-		page_id_t first_page_id = bpm_->NewPage()->GetPageId();
+	void CatalogManager::CreateTable(const std::string table_name, const Schema* schema, bool columnar) {
+		std::lock_guard<std::mutex> lock(latch_);
+
+		page_id_t first_page_id;
+		{
+			buffer::PageGuard guard = bpm_->NewPageGuarded();
+			if (!guard) {
+				throw std::runtime_error("Catalog error: Failed to allocate the first page of table '" + table_name + "'");
+			}
+			first_page_id = guard.GetPageId();
+			// the format of a table is the layout of its first page, later pages copy it
+			if (columnar) {
+				guard->NewColumnarPage(first_page_id, schema->GetFieldWidths());
+				guard.MarkDirty();
+			}
+		}
 		table_id_t table_id = GetNextTableId();
 
 		column_id_t primary_key_col = 0;
@@ -117,9 +138,9 @@ namespace catalog {
 			    std::to_string(table_id),
 			    column.GetName(),
 			    std::to_string(static_cast<int>(column.GetType())),
-			    std::to_string(column.GetLength()),
+			    std::to_string(column.GetMaxLength()),
 			    std::to_string(column.GetOrdinalPosition()),
-			    std::to_string(column.IsPrimary()) });
+			    std::to_string((column.IsPrimary() ? COLUMN_PRIMARY_KEY : 0) | (column.HasBloomFilter() ? COLUMN_BLOOM_FILTER : 0)) });
 		}
 
 		if (!status) {
@@ -135,6 +156,7 @@ namespace catalog {
 		// if we have page_id and slot_id of the tuples to delete in master_tables and master_columns
 		// we can delete them using table_heap->DeleteTuple(rid)
 		// iterate through the tables
+		std::lock_guard<std::mutex> lock(latch_);
 
 		for (auto it = tables_table_->begin(); it != tables_table_->end(); ++it) {
 			const Tuple& tuple = *it;
@@ -142,6 +164,7 @@ namespace catalog {
 			if (std::string(value) == table_name) {
 				// table to drop
 				table_id_t table_id = static_cast<table_id_t>(std::stoi(GetValueAsString(tuple, 0, master_tables_schema_)));
+				page_id_t first_page_id = static_cast<page_id_t>(std::stoul(GetValueAsString(tuple, 3, master_tables_schema_)));
 				RID rid = tuple.GetRID();
 				if (!tables_table_->DeleteTuple(rid)) {
 					throw std::runtime_error("Catalog error: Failed to delete table metadata from master_tables.");
@@ -166,6 +189,21 @@ namespace catalog {
 				bpm_->FlushPage(MASTER_TABLES_PAGE_ID);
 				bpm_->FlushPage(MASTER_COLUMNS_PAGE_ID);
 
+				// the table's pages go back to the file's free list, through the garbage collector
+				// so a page still pinned by a running scan is freed once the scan lets go of it
+				if (gc_ != nullptr) {
+					gc_->FreeTablePages(first_page_id);
+				} else {
+					table::TableHeap heap(bpm_, nullptr, first_page_id);
+					for (page_id_t page_id : heap.GetPageIds()) {
+						bpm_->DeletePage(page_id);
+					}
+				}
+				bpm_->ReleaseExtent(first_page_id);
+
+				std::lock_guard<std::mutex> zone_maps_lock(zone_maps_latch_);
+				zone_maps_.erase(first_page_id);
+
 				// no need to continue since there is only one table entry
 				return true;
 			}
@@ -174,7 +212,7 @@ namespace catalog {
 		return false;
 	}
 
-	TableRef* CatalogManager::GetTableRef(const std::string& table_name) {
+	TableRef* CatalogManager::GetTableRef(const std::string& table_name, common::Arena* arena) {
 		table_id_t table_id = INVALID_TABLE_ID;
 		page_id_t first_page_id = INVALID_PAGE_ID;
 		column_id_t primary_key_col = INVALID_TABLE_ID;
@@ -194,7 +232,7 @@ namespace catalog {
 			return nullptr;
 		}
 
-		Schema* schema = new Schema();
+		Schema* schema = arena != nullptr ? arena->New<Schema>() : new Schema();
 		for (auto it = columns_table_->begin(); it != columns_table_->end(); ++it) {
 			const Tuple& tuple = *it;
 			table_id_t tuple_table_id = static_cast<table_id_t>(std::stoi(GetValueAsString(tuple, 1, master_columns_schema_)));
@@ -202,12 +240,30 @@ namespace catalog {
 				const char* col_name = tuple.GetValue(2, master_columns_schema_);
 				ColumnType col_type = static_cast<ColumnType>(std::stoi(GetValueAsString(tuple, 3, master_columns_schema_)));
 				size_t ordinal_position = std::stoi(GetValueAsString(tuple, 5, master_columns_schema_));
-				bool is_primary = std::stoi(GetValueAsString(tuple, 6, master_columns_schema_)) == 1;
-				schema->AddColumn(col_name, col_type, is_primary, ordinal_position);
+				int flags = std::stoi(GetValueAsString(tuple, 6, master_columns_schema_));
+				bool is_primary = (flags & COLUMN_PRIMARY_KEY) != 0;
+				// column_size is the n of a VARCHAR(n)
+				uint32_t max_length = col_type == ColumnType::VARCHAR ? std::stoul(GetValueAsString(tuple, 4, master_columns_schema_)) : 0;
+				schema->AddColumn(col_name, col_type, is_primary, ordinal_position, max_length);
+				if (flags & COLUMN_BLOOM_FILTER) {
+					schema->SetBloomFilter(schema->GetColumnCount() - 1);
+				}
 			}
 		}
 
-		return new TableRef(table_id, first_page_id, table_name, schema);
+		TableRef* table_ref = arena != nullptr ? arena->New<TableRef>(table_id, first_page_id, table_name, schema)
+		                                       : new TableRef(table_id, first_page_id, table_name, schema);
+		// the master tables are written by the catalog's own heaps, which keep no zones
+		if (first_page_id == MASTER_TABLES_PAGE_ID || first_page_id == MASTER_COLUMNS_PAGE_ID) {
+			return table_ref;
+		}
+		std::lock_guard<std::mutex> lock(zone_maps_latch_);
+		std::shared_ptr<table::ZoneMap>& zone_map = zone_maps_[first_page_id];
+		if (!zone_map) {
+			zone_map = std::make_shared<table::ZoneMap>(*schema);
+		}
+		table_ref->zone_map = zone_map;
+		return table_ref;
 	}
 
 	table_id_t CatalogManager::GetNextTableId() {
@@ -235,7 +291,7 @@ namespace catalog {
 	void CatalogManager::InsertSystemTableColumns() {
 		// For master_tables (table_id = 0) columns
 		// Schema: column_id(INT), table_id(INT), column_name(CHAR), column_type(INT), column_size(INT), ordinal_position(INT), is_primary_key(INT)
-		// ColumnType values: INVALID_COLUMN=0, INT=1, FLOAT=2, CHAR=3
+		// ColumnType values: INVALID_COLUMN=0, INT=1, FLOAT=2, CHAR=3, VARCHAR=4
 
 		// master_tables columns
 		columns_table_->InsertTuple({ "0", "0", "table_id", "1", "4", "0", "1" }); // INT type
@@ -273,9 +329,30 @@ namespace catalog {
 			std::memcpy(&float_value, raw_data, sizeof(float));
 			return std::to_string(float_value);
 		}
-		case ColumnType::CHAR: {
+		case ColumnType::CHAR:
+		case ColumnType::VARCHAR: {
 			return std::string(raw_data);
 		}
+		case ColumnType::BIGINT: {
+			int64_t bigint_value;
+			std::memcpy(&bigint_value, raw_data, sizeof(bigint_value));
+			return std::to_string(bigint_value);
+		}
+		case ColumnType::DOUBLE: {
+			double double_value;
+			std::memcpy(&double_value, raw_data, sizeof(double_value));
+			return std::to_string(double_value);
+		}
+		case ColumnType::DATE: {
+			int32_t days;
+			std::memcpy(&days, raw_data, sizeof(days));
+			return FormatDate(days);
+		}
+		case ColumnType::TIMESTAMP: {
+			int64_t micros;
+			std::memcpy(&micros, raw_data, sizeof(micros));
+			return FormatTimestamp(micros);
+		}
 		default:
 			return "UNKNOWN_TYPE";
 		}
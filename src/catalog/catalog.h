@@ -29,6 +29,8 @@
  * | is_primary_key   |  INT      |
  * | is_nullable      |  INT      |
  *
+ * is_primary_key holds flags: 1 the primary key, 2 pages keep a Bloom filter of the column
+ *
  * ### <dbname>_indexes
  * | Column       | Data Type |
  * |--------------|-----------|
@@ -48,29 +50,44 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "buffer/buffer_pool.h"
 #include "catalog/schema.h"
+#include "common/arena.h"
 #include "common/config.h"
 #include "table/table_heap.h"
+#include "table/zone_map.h"
 #include "storage/tuple.h"
 
 namespace venus {
+namespace concurrency {
+	class GarbageCollector;
+}
+
 namespace catalog {
 	class CatalogManager {
 	public:
-		CatalogManager(buffer::BufferPoolManager* bpm);
+		// a dropped table's pages are freed by gc, at once without one
+		CatalogManager(buffer::BufferPoolManager* bpm, concurrency::GarbageCollector* gc = nullptr);
 		~CatalogManager();
 
-		void CreateTable(const std::string table_name, const Schema* schema);
+		// columnar: the table's pages use the columnar layout (see Page), for fixed width rows only
+		void CreateTable(const std::string table_name, const Schema* schema, bool columnar = false);
 		bool DropTable(const std::string& table_name);
 
-		TableRef* GetTableRef(const std::string& table_name);
+		// the table's zone map is created with its first reference and shared by later ones
+		// with an arena the reference and its schema live until the arena is reset, else the caller
+		// deletes both
+		TableRef* GetTableRef(const std::string& table_name, common::Arena* arena = nullptr);
 
 	private:
 		buffer::BufferPoolManager* bpm_;
+		concurrency::GarbageCollector* gc_;
 		table::TableHeap* tables_table_;
 		table::TableHeap* columns_table_;
 
@@ -80,6 +97,11 @@ namespace catalog {
 		table_id_t next_table_id_;
 		column_id_t next_column_id_;
 
+		std::mutex latch_; // one CREATE / DROP TABLE at a time, lookups only read the master tables
+
+		std::mutex zone_maps_latch_; // protects zone_maps_
+		std::unordered_map<page_id_t, std::shared_ptr<table::ZoneMap>> zone_maps_; // first page id -> zone map
+
 		void InitializeSystemTables();
 		void CreateNewSystemTables();
 		void InsertSystemTableColumns();
@@ -8,15 +8,25 @@
  * Generally, a schema is stored in catalog as metadata for a table
  * Integrity constraints, Data types, are checked and type casted while inputing/outputing the data
  *
- * VenusDB offers only Int, Float, and Char data types for now.
+ * VenusDB offers Int, Bigint, Float, Double, Char, Varchar, Date and Timestamp data types for now.
+ * Dates and timestamps are stored as integers (see value.h), so they compare as integers.
  * Only primary key supported, no foreign keys or unique constraints.
  *
+ * Every column has a fixed width slot in the tuple, so the byte offset of every column and the size
+ * of the fixed part are known once the columns are; the schema keeps them for Tuple::GetValue and
+ * serialization. The slot of a VARCHAR(n) holds where its value is in the tuple, the values follow
+ * the fixed part (see tuple.h).
+ *
+ * Columns are nullable, but for the primary key. The null bitmap ends the fixed part, after the
+ * column slots, so adding columns never moves the ones before them.
+ *
  * This is a single instance of column and schema
  * For multiple tables, multiple instances of Schema and Column are created and mapped to table's
  */
 
 #pragma once
 
+#include <cstdint>
 #include <stdexcept> // for std::invalid_argument
 #include <string>
 #include <unordered_map>
@@ -30,21 +40,42 @@ enum class ColumnType : uint8_t {
 	INVALID_COLUMN = 0,
 	INT,
 	FLOAT,
-	CHAR
+	CHAR,
+	VARCHAR,
+	BIGINT,
+	DOUBLE,
+	DATE, // days since 1970-01-01
+	TIMESTAMP // microseconds since 1970-01-01 00:00:00
+};
+
+// slot of a VARCHAR value in the fixed part of a tuple
+struct VarcharSlot {
+	uint16_t offset; // from the start of the tuple
+	uint16_t length; // without the terminating NUL
 };
 
 class Column {
 public:
-	Column(std::string name, ColumnType type, bool is_primary, size_t ordinal_position)
+	// max_length: n of a VARCHAR(n), MAX_VARCHAR_LENGTH if 0; ignored for the other types
+	Column(std::string name, ColumnType type, bool is_primary, size_t ordinal_position, uint32_t max_length = 0)
 	    : name_(std::move(name))
 	    , type_(type)
 	    , is_primary_(is_primary)
-	    , ordinal_position_(ordinal_position) { }
+	    , ordinal_position_(ordinal_position)
+	    , max_length_(max_length != 0 ? max_length : MAX_VARCHAR_LENGTH) { }
 
 	const std::string& GetName() const { return name_; }
 	ColumnType GetType() const { return type_; }
 	bool IsPrimary() const { return is_primary_; }
+	bool IsNullable() const { return !is_primary_; }
 	size_t GetOrdinalPosition() const { return ordinal_position_; }
+	bool IsVariableLength() const { return type_ == ColumnType::VARCHAR; }
+
+	// pages keep a Bloom filter of the column's values (see ZoneMap)
+	bool HasBloomFilter() const { return bloom_filter_; }
+	void SetBloomFilter(bool bloom_filter) { bloom_filter_ = bloom_filter; }
+
+	// width of the column's slot in the fixed part of a tuple
 	size_t GetLength() const {
 		switch (type_) {
 		case ColumnType::INT:
@@ -53,16 +84,33 @@ public:
 			return sizeof(float);
 		case ColumnType::CHAR:
 			return sizeof(char) * MAX_CHAR_LENGTH;
+		case ColumnType::VARCHAR:
+			return sizeof(VarcharSlot);
+		case ColumnType::BIGINT:
+			return sizeof(int64_t);
+		case ColumnType::DOUBLE:
+			return sizeof(double);
+		case ColumnType::DATE:
+			return sizeof(int32_t);
+		case ColumnType::TIMESTAMP:
+			return sizeof(int64_t);
 		default:
 			return 0;
 		}
 	}
 
+	// widest value of the column: the slot width, or n for a VARCHAR(n)
+	size_t GetMaxLength() const {
+		return type_ == ColumnType::VARCHAR ? max_length_ : GetLength();
+	}
+
 private:
 	std::string name_;
 	ColumnType type_;
 	size_t ordinal_position_;
 	bool is_primary_;
+	uint32_t max_length_;
+	bool bloom_filter_ = false;
 };
 
 class Schema {
@@ -71,12 +119,21 @@ public:
 	~Schema() = default;
 
 	// columns are added in an order, for tuple serialization and deserialization
-	void AddColumn(const std::string& name, ColumnType type, bool is_primary, size_t ordinal_position) {
+	void AddColumn(const std::string& name, ColumnType type, bool is_primary, size_t ordinal_position, uint32_t max_length = 0) {
 		if (column_name_to_index_.find(name) != column_name_to_index_.end()) {
 			throw std::invalid_argument("Column with name '" + name + "' already exists in the schema.");
 		}
-		columns_.emplace_back(name, type, is_primary, ordinal_position);
+		columns_.emplace_back(name, type, is_primary, ordinal_position, max_length);
 		column_name_to_index_[name] = columns_.size() - 1;
+
+		const Column& column = columns_.back();
+		offsets_.push_back(null_bitmap_offset_);
+		null_bitmap_offset_ += static_cast<uint32_t>(column.GetLength());
+		if (column.IsVariableLength()) {
+			variable_columns_.push_back(columns_.size() - 1);
+			max_variable_size_ += static_cast<uint32_t>(column.GetMaxLength()) + 1;
+		}
+		tuple_size_ = null_bitmap_offset_ + GetNullBitmapSize();
 	}
 
 	const Column& GetColumn(const std::string& name) const {
@@ -100,9 +157,44 @@ public:
 
 	size_t GetColumnCount() const { return columns_.size(); }
 
+	void SetBloomFilter(size_t index) { columns_.at(index).SetBloomFilter(true); }
+
+	// offset of a column from the start of the tuple (its size header included), not bounds checked
+	uint32_t GetOffset(size_t index) const { return offsets_[index]; }
+
+	// size of the fixed part of every tuple of this schema, size header included; the size of
+	// every tuple if the schema has no VARCHAR column
+	uint32_t GetTupleSize() const { return tuple_size_; }
+
+	// size of a tuple with every VARCHAR at its longest
+	uint32_t GetMaxTupleSize() const { return tuple_size_ + max_variable_size_; }
+
+	// the null bitmap has a bit per column, set for NULL
+	uint32_t GetNullBitmapOffset() const { return null_bitmap_offset_; }
+	uint32_t GetNullBitmapSize() const { return static_cast<uint32_t>((columns_.size() + 7) / 8); }
+
+	// widths of the fields that follow the size header: every column slot, then the null bitmap
+	// (the minipages of a columnar page)
+	std::vector<uint16_t> GetFieldWidths() const {
+		std::vector<uint16_t> widths;
+		for (const Column& column : columns_) {
+			widths.push_back(static_cast<uint16_t>(column.GetLength()));
+		}
+		widths.push_back(static_cast<uint16_t>(GetNullBitmapSize()));
+		return widths;
+	}
+
+	bool HasVariableLength() const { return !variable_columns_.empty(); }
+	const std::vector<size_t>& GetVariableColumns() const { return variable_columns_; }
+
 private:
 	std::vector<Column> columns_;
 	std::unordered_map<std::string, size_t> column_name_to_index_;
+	std::vector<uint32_t> offsets_;
+	std::vector<size_t> variable_columns_; // indexes of the VARCHAR columns
+	uint32_t null_bitmap_offset_ = sizeof(uint32_t);
+	uint32_t tuple_size_ = sizeof(uint32_t);
+	uint32_t max_variable_size_ = 0;
 };
 
 } // namespace venus
\ No newline at end of file
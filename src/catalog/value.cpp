@@ -0,0 +1,194 @@
+// /src/catalog/value.cpp
+
+#include "catalog/value.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace venus {
+
+namespace {
+
+	constexpr int64_t MICROS_PER_SECOND = 1000000;
+	constexpr int64_t MICROS_PER_DAY = 86400 * MICROS_PER_SECOND;
+
+	// proleptic Gregorian calendar, days since 1970-01-01 (H. Hinnant's days_from_civil)
+	int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day) {
+		year -= month <= 2;
+		int64_t era = (year >= 0 ? year : year - 399) / 400;
+		unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+		unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+		unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+		return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+	}
+
+	void CivilFromDays(int64_t days, int64_t* year, unsigned* month, unsigned* day) {
+		days += 719468;
+		int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+		unsigned day_of_era = static_cast<unsigned>(days - era * 146097);
+		unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+		unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+		unsigned mp = (5 * day_of_year + 2) / 153;
+		*day = day_of_year - (153 * mp + 2) / 5 + 1;
+		*month = mp < 10 ? mp + 3 : mp - 9;
+		*year = static_cast<int64_t>(year_of_era) + era * 400 + (*month <= 2);
+	}
+
+	// exactly count digits at pos
+	bool ReadDigits(const std::string& text, size_t* pos, size_t count, int* value) {
+		if (*pos + count > text.size()) {
+			return false;
+		}
+		*value = 0;
+		for (size_t i = 0; i < count; i++) {
+			char c = text[*pos + i];
+			if (c < '0' || c > '9') {
+				return false;
+			}
+			*value = *value * 10 + (c - '0');
+		}
+		*pos += count;
+		return true;
+	}
+
+	bool Expect(const std::string& text, size_t* pos, char c) {
+		if (*pos < text.size() && text[*pos] == c) {
+			(*pos)++;
+			return true;
+		}
+		return false;
+	}
+
+	// YYYY-MM-DD at the start of text
+	int64_t ReadDate(const std::string& text, size_t* pos) {
+		int year, month, day;
+		if (!ReadDigits(text, pos, 4, &year) || !Expect(text, pos, '-') || !ReadDigits(text, pos, 2, &month)
+		    || !Expect(text, pos, '-') || !ReadDigits(text, pos, 2, &day)) {
+			throw std::invalid_argument("Invalid date '" + text + "', expected YYYY-MM-DD");
+		}
+
+		static const int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+		bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+		if (month < 1 || month > 12 || day < 1 || day > days_in_month[month - 1] + (month == 2 && leap)) {
+			throw std::invalid_argument("Invalid date '" + text + "'");
+		}
+		return DaysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+	}
+
+} // namespace
+
+void EncodeLiteral(ColumnType type, const std::string& literal, char* out) {
+	switch (type) {
+	case ColumnType::INT: {
+		int value = std::stoi(literal);
+		std::memcpy(out, &value, sizeof(value));
+		break;
+	}
+	case ColumnType::FLOAT: {
+		float value = std::stof(literal);
+		std::memcpy(out, &value, sizeof(value));
+		break;
+	}
+	case ColumnType::BIGINT: {
+		int64_t value = std::stoll(literal);
+		std::memcpy(out, &value, sizeof(value));
+		break;
+	}
+	case ColumnType::DOUBLE: {
+		double value = std::stod(literal);
+		std::memcpy(out, &value, sizeof(value));
+		break;
+	}
+	case ColumnType::DATE: {
+		int32_t value = ParseDate(literal);
+		std::memcpy(out, &value, sizeof(value));
+		break;
+	}
+	case ColumnType::TIMESTAMP: {
+		int64_t value = ParseTimestamp(literal);
+		std::memcpy(out, &value, sizeof(value));
+		break;
+	}
+	case ColumnType::CHAR:
+		// zero padded, cut to MAX_CHAR_LENGTH - 1 characters
+		std::memset(out, 0, MAX_CHAR_LENGTH);
+		std::memcpy(out, literal.c_str(), std::min(literal.size(), static_cast<size_t>(MAX_CHAR_LENGTH - 1)));
+		break;
+	default:
+		throw std::invalid_argument("Not a fixed width column type");
+	}
+}
+
+int32_t ParseDate(const std::string& literal) {
+	size_t pos = 0;
+	int64_t days = ReadDate(literal, &pos);
+	if (pos != literal.size()) {
+		throw std::invalid_argument("Invalid date '" + literal + "', expected YYYY-MM-DD");
+	}
+	return static_cast<int32_t>(days);
+}
+
+std::string FormatDate(int32_t days) {
+	int64_t year;
+	unsigned month, day;
+	CivilFromDays(days, &year, &month, &day);
+	char text[32];
+	int length = std::snprintf(text, sizeof(text), "%04lld-%02u-%02u", static_cast<long long>(year), month, day);
+	return std::string(text, static_cast<size_t>(length));
+}
+
+int64_t ParseTimestamp(const std::string& literal) {
+	size_t pos = 0;
+	int64_t micros = ReadDate(literal, &pos) * MICROS_PER_DAY;
+	if (pos == literal.size()) {
+		return micros;
+	}
+
+	int hour, minute, second;
+	if (!(Expect(literal, &pos, ' ') || Expect(literal, &pos, 'T')) || !ReadDigits(literal, &pos, 2, &hour)
+	    || !Expect(literal, &pos, ':') || !ReadDigits(literal, &pos, 2, &minute) || !Expect(literal, &pos, ':')
+	    || !ReadDigits(literal, &pos, 2, &second) || hour > 23 || minute > 59 || second > 59) {
+		throw std::invalid_argument("Invalid timestamp '" + literal + "', expected YYYY-MM-DD HH:MM:SS[.ffffff]");
+	}
+	micros += (hour * 3600 + minute * 60 + second) * MICROS_PER_SECOND;
+
+	// up to 6 digits of fraction
+	if (Expect(literal, &pos, '.')) {
+		int64_t scale = MICROS_PER_SECOND;
+		int digit;
+		while (scale > 1 && ReadDigits(literal, &pos, 1, &digit)) {
+			scale /= 10;
+			micros += digit * scale;
+		}
+		if (scale == MICROS_PER_SECOND) {
+			throw std::invalid_argument("Invalid timestamp '" + literal + "', expected digits after '.'");
+		}
+	}
+	if (pos != literal.size()) {
+		throw std::invalid_argument("Invalid timestamp '" + literal + "', expected YYYY-MM-DD HH:MM:SS[.ffffff]");
+	}
+	return micros;
+}
+
+std::string FormatTimestamp(int64_t micros) {
+	int64_t days = micros / MICROS_PER_DAY;
+	int64_t time = micros % MICROS_PER_DAY;
+	if (time < 0) {
+		days--;
+		time += MICROS_PER_DAY;
+	}
+
+	int64_t seconds = time / MICROS_PER_SECOND;
+	int fraction = static_cast<int>(time % MICROS_PER_SECOND);
+	char text[48];
+	int length = std::snprintf(text, sizeof(text), "%s %02d:%02d:%02d", FormatDate(static_cast<int32_t>(days)).c_str(),
+	    static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60), static_cast<int>(seconds % 60));
+	if (fraction != 0) {
+		length += std::snprintf(text + length, sizeof(text) - length, ".%06d", fraction);
+	}
+	return std::string(text, static_cast<size_t>(length));
+}
+
+} // namespace venus
@@ -0,0 +1,34 @@
+// /src/catalog/value.h
+
+/**
+ * Conversions between SQL literals and the bytes a fixed width column stores.
+ *
+ * BIGINT and DOUBLE are 64-bit, stored in the server's byte order like INT and FLOAT.
+ * DATE is a 32-bit count of days since 1970-01-01, written 'YYYY-MM-DD'.
+ * TIMESTAMP is a 64-bit count of microseconds since 1970-01-01 00:00:00, written
+ * 'YYYY-MM-DD HH:MM:SS[.ffffff]' (no time zone). Both are compared as integers.
+ *
+ * Malformed literals throw std::invalid_argument, values out of the type's range std::out_of_range,
+ * like std::stoi does for INT.
+ */
+
+#pragma once
+
+#include "catalog/schema.h"
+
+#include <cstdint>
+#include <string>
+
+namespace venus {
+
+// writes the literal as a value of a fixed width column, GetLength() bytes at out
+void EncodeLiteral(ColumnType type, const std::string& literal, char* out);
+
+int32_t ParseDate(const std::string& literal);
+std::string FormatDate(int32_t days);
+
+// a DATE literal is midnight of the day
+int64_t ParseTimestamp(const std::string& literal);
+std::string FormatTimestamp(int64_t micros);
+
+} // namespace venus
@@ -0,0 +1,119 @@
+// /src/common/arena.h
+
+/**
+ * Arena - a bump allocator for memory that lives as long as one statement.
+ *
+ * Allocate() hands out the next aligned bytes of the current block and starts a new block when it
+ * is full, so an allocation is a pointer bump and nothing is freed one by one. Reset() gives
+ * everything back at once: objects made by New() are destroyed in reverse order, and the first
+ * block is kept for the next statement, so a statement that fits it allocates nothing from the heap.
+ *
+ * The executor keeps one per session (ExecutorContext::arena_), the table references the binder
+ * resolves and the operators' scratch objects come from it, and the engine resets it when the
+ * statement ends, however it ends. Nothing that outlives the statement, like the rows of a
+ * ResultSet, may point into it.
+ *
+ * Not thread safe: it belongs to the query thread, scan workers do not allocate from it.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace venus {
+namespace common {
+
+	class Arena {
+	public:
+		explicit Arena(size_t block_size = QUERY_ARENA_BLOCK_SIZE)
+		    : block_size_(block_size)
+		    , cursor_(nullptr)
+		    , limit_(nullptr)
+		    , destructors_(nullptr)
+		    , allocated_(0) { }
+
+		~Arena() { Reset(); }
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+			uintptr_t start = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+			if (cursor_ == nullptr || start + size > reinterpret_cast<uintptr_t>(limit_)) {
+				// larger requests get a block of their own
+				NewBlock(std::max(block_size_, size + alignment));
+				start = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+			}
+			cursor_ = reinterpret_cast<char*>(start + size);
+			allocated_ += size;
+			return reinterpret_cast<void*>(start);
+		}
+
+		// constructs a T in the arena, destroyed by Reset()
+		template <typename T, typename... Args>
+		T* New(Args&&... args) {
+			T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				destructors_ = new (Allocate(sizeof(Destructor), alignof(Destructor))) Destructor { &Destroy<T>, object, destructors_ };
+			}
+			return object;
+		}
+
+		// destroys every object, frees every block but the first
+		void Reset() {
+			for (Destructor* destructor = destructors_; destructor != nullptr; destructor = destructor->next) {
+				destructor->destroy(destructor->object);
+			}
+			destructors_ = nullptr;
+			if (blocks_.size() > 1) {
+				blocks_.erase(blocks_.begin() + 1, blocks_.end());
+				block_sizes_.resize(1);
+			}
+			cursor_ = blocks_.empty() ? nullptr : blocks_[0].get();
+			limit_ = blocks_.empty() ? nullptr : cursor_ + block_sizes_[0];
+			allocated_ = 0;
+		}
+
+		// bytes handed out since the last Reset()
+		size_t GetAllocatedBytes() const { return allocated_; }
+
+		size_t GetBlockCount() const { return blocks_.size(); }
+
+	private:
+		struct Destructor {
+			void (*destroy)(void* object);
+			void* object;
+			Destructor* next;
+		};
+
+		size_t block_size_;
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		std::vector<size_t> block_sizes_;
+		char* cursor_;
+		char* limit_;
+		Destructor* destructors_; // latest first
+		size_t allocated_;
+
+		template <typename T>
+		static void Destroy(void* object) {
+			static_cast<T*>(object)->~T();
+		}
+
+		void NewBlock(size_t size) {
+			blocks_.emplace_back(new char[size]);
+			block_sizes_.push_back(size);
+			cursor_ = blocks_.back().get();
+			limit_ = cursor_ + size;
+		}
+
+		DISALLOW_COPY_AND_MOVE(Arena);
+	};
+
+} // namespace common
+} // namespace venus
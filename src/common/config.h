@@ -10,14 +10,51 @@ namespace venus {
 
 constexpr uint32_t PAGE_SIZE = 4096; // 4kb
 constexpr uint32_t MAX_BUFFER_POOL_SIZE = 128; // 128 pages
+constexpr uint32_t BUFFER_POOL_SHARDS = 16; // page table partitions, each with its own latch
+constexpr uint32_t EXTENT_PAGES = 64; // contiguous pages a table heap reserves at a time
 constexpr uint8_t LRUK_REPLACER_K = 5;
 
 constexpr uint32_t MAX_DATABASES = 5;
 constexpr uint32_t MAX_TABLES = 64; // per db
 constexpr uint32_t MAX_COLUMNS = 64; // per table
 constexpr uint32_t MAX_CHAR_LENGTH = 32;
+constexpr uint32_t MAX_VARCHAR_LENGTH = 1024; // bound of VARCHAR(n), and n of a VARCHAR declared without one
+
+// parallel scans
+constexpr uint32_t SCAN_WORKER_THREADS = 4; // workers per scan, including the query thread
+constexpr uint32_t SCAN_MORSEL_PAGES = 4; // pages handed to a worker at a time
+constexpr uint32_t PARALLEL_SCAN_MIN_PAGES = 8; // smaller heaps are scanned on the query thread
+constexpr uint32_t QUERY_ARENA_BLOCK_SIZE = 16 * 1024; // per statement memory, the first block is kept across statements
+
+// zone maps
+constexpr uint32_t BLOOM_FILTER_BITS = 1024; // per page and column, a power of two
+constexpr uint32_t BLOOM_FILTER_HASHES = 3; // bits set per value
+
+// write-ahead log
+constexpr uint32_t LOG_BUFFER_SIZE = 64 * 1024; // bytes appended before the flusher must run
+constexpr uint32_t LOG_FLUSH_TIMEOUT_MS = 10; // flusher wakes at least this often
+constexpr uint32_t LOG_TRUNCATE_MIN_BYTES = 4 * LOG_BUFFER_SIZE; // smaller unneeded log prefixes are kept
+constexpr uint32_t CHECKPOINT_INTERVAL_MS = 30 * 1000; // background fuzzy checkpoints
+
+// mvcc
+constexpr uint32_t GC_INTERVAL_MS = 1000; // background removal of versions no snapshot can see
+
+// locking
+constexpr uint32_t LOCK_TABLE_SHARDS = 16; // lock table partitions, each with its own latch
+constexpr uint32_t DEADLOCK_DETECTION_INTERVAL_MS = 50; // wait-for graph is checked this often
+
+// network server
+constexpr uint16_t DEFAULT_PORT = 7432;
+constexpr uint16_t POSTGRES_DEFAULT_PORT = 5432; // --pg, PostgreSQL v3 protocol
+constexpr uint32_t QUERY_WORKER_THREADS = 8; // sessions executing a request at the same time
+constexpr uint32_t NETWORK_MAX_MESSAGE_SIZE = 1024 * 1024; // larger frames close the connection
+constexpr uint32_t NETWORK_MAX_BUFFERED_INPUT = 4 * NETWORK_MAX_MESSAGE_SIZE; // per session, reading pauses above this
+constexpr uint32_t NETWORK_ROW_BATCH_SIZE = 256; // rows per ROW_BATCH message
+constexpr uint32_t NETWORK_MAX_EVENTS = 64; // epoll events handled per wakeup
+constexpr uint32_t NETWORK_SEND_TIMEOUT_MS = 30 * 1000; // a client that reads nothing for this long is dropped
 
 // Every database has a db file stored in the data directory with file name <db_name>.db
+// and its write-ahead log next to it as <db_name>.log
 constexpr const char* DATABASE_DIRECTORY = "./data";
 
 using page_id_t = uint32_t;
@@ -27,14 +64,18 @@ using database_id_t = uint32_t;
 using table_id_t = uint32_t;
 using column_id_t = uint32_t;
 using index_id_t = uint32_t;
+using lsn_t = uint64_t;
+using txn_id_t = uint32_t;
 
 constexpr table_id_t INVALID_TABLE_ID = std::numeric_limits<table_id_t>::max();
 constexpr page_id_t INVALID_PAGE_ID = std::numeric_limits<page_id_t>::max();
 constexpr frame_id_t INVALID_FRAME_ID = std::numeric_limits<frame_id_t>::max();
+constexpr lsn_t INVALID_LSN = std::numeric_limits<lsn_t>::max();
+constexpr txn_id_t INVALID_TXN_ID = std::numeric_limits<txn_id_t>::max();
 
 constexpr page_id_t MASTER_TABLES_PAGE_ID = 0;
 constexpr page_id_t MASTER_COLUMNS_PAGE_ID = 1;
-constexpr page_id_t MASTER_INDEXES_PAGE_ID = 2;
+constexpr page_id_t FREE_LIST_PAGE_ID = 2; // free pages of the file, see DiskManager
 constexpr page_id_t FIRST_USABLE_PAGE_ID = 3;
 
 constexpr const char* MASTER_TABLES_NAME = "master_tables";
@@ -4,6 +4,7 @@
 
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -18,13 +19,19 @@ enum class PageType : uint8_t {
 	TABLE_PAGE, // regular data page
 	INDEX_LEAF_PAGE,
 	INDEX_INTERNAL_PAGE,
+	COLUMNAR_PAGE, // data page with the rows split into per-column minipages (PAX)
 };
 
+namespace table {
+	class ZoneMap;
+}
+
 struct TableRef {
 	table_id_t table_id;
 	page_id_t first_page_id;
 	std::string table_name;
 	Schema* schema;
+	std::shared_ptr<table::ZoneMap> zone_map; // shared by every query of the table, may be null
 
 	TableRef(table_id_t id_, page_id_t first_page_id_, const std::string& name_, Schema* schema_)
 	    : table_id(id_)
@@ -51,6 +58,10 @@ struct TableRef {
 	const Schema* GetSchema() const {
 		return schema;
 	}
+
+	table::ZoneMap* GetZoneMap() const {
+		return zone_map.get();
+	}
 };
 
 struct ColumnRef {
@@ -65,10 +76,11 @@ struct ColumnRef {
 struct ConstantType {
 	std::string value;
 	ColumnType type;
+	bool is_null = false; // NULL, value is empty
 };
 
 struct Expression {
-	// for now this struct only supports simple equality (=, <, >, <=, >=)
+	// for now this struct only supports simple equality (=, <, >, <=, >=) and IS [NOT] NULL
 	ColumnRef left;
 	std::string op;
 	ConstantType right;
@@ -114,6 +126,17 @@ enum class TokenType : uint8_t {
 	OFFSET,
 	SET,
 	INDEX,
+	IS,
+	NOT,
+	NULL_LITERAL,
+	WITH,
+
+	// transactions
+	BEGIN,
+	COMMIT,
+	ROLLBACK,
+
+	VACUUM,
 
 	// operators
 	PLUS,
@@ -124,11 +147,18 @@ enum class TokenType : uint8_t {
 	NOT_EQUALS,
 	GREATER_THAN,
 	LESS_THAN,
+	GREATER_EQUALS,
+	LESS_EQUALS,
 
 	// types
 	INT_TYPE,
 	FLOAT_TYPE,
 	CHAR_TYPE,
+	VARCHAR_TYPE,
+	BIGINT_TYPE,
+	DOUBLE_TYPE,
+	DATE_TYPE,
+	TIMESTAMP_TYPE,
 
 	LITERAL, // string or number values
 
@@ -172,6 +202,7 @@ enum class ASTNodeType : uint8_t {
 	COLUMN_REF, // planets.id
 	COLUMN_DEF, // id INT PRIMARY_KEY
 	CONST_VALUE, // 420, '69', 420.69
+	NULL_VALUE, // NULL
 
 	PROJECTION_LIST, // planets.id, planets.name -> pi in relational model
 	CONDITION, // planets.id = 420
@@ -182,7 +213,14 @@ enum class ASTNodeType : uint8_t {
 	HAVING_CLAUSE,
 	ORDER_BY_CLAUSE,
 	LIMIT_CLAUSE,
-	ASSIGNMENT,
+	ASSIGNMENT, // SET col = literal
+	TABLE_OPTION, // format=columnar
+
+	BEGIN,
+	COMMIT,
+	ROLLBACK,
+
+	VACUUM, // value: table name, empty for VACUUM FILE
 
 	HELP,
 	EXIT,
@@ -219,6 +257,13 @@ enum class PlanNodeType : uint8_t {
 	CREATE_INDEX,
 	DROP_INDEX,
 
+	// transaction control
+	BEGIN,
+	COMMIT,
+	ROLLBACK,
+
+	VACUUM,
+
 	SHOW_DATABASES,
 	SHOW_TABLES,
 	HELP,
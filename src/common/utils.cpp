@@ -1,6 +1,10 @@
 // src/common/utils.cpp
 
 #include "common/utils.h"
+#include "catalog/value.h"
+
+#include <cstdio>
+#include <cstring>
 
 namespace venus {
 namespace utils {
@@ -33,6 +37,12 @@ namespace utils {
 			std::cout << "])\n";
 			break;
 		}
+		case PlanNodeType::FILTER: {
+			auto* filter = static_cast<const planner::FilterPlanNode*>(plan.get());
+			std::cout << "Filter(condition=" << filter->predicate_.left.GetName() << " "
+			          << filter->predicate_.op << " " << filter->predicate_.right.value << ")\n";
+			break;
+		}
 		case PlanNodeType::INSERT: {
 			auto* insert_plan = static_cast<const planner::InsertPlanNode*>(plan.get());
 			std::cout << "Insert(table=" << insert_plan->table_ref->table_name << ", values=[";
@@ -78,7 +88,13 @@ namespace utils {
 					std::cout << ", ";
 				}
 			}
-			std::cout << "])\n";
+			std::cout << "]" << (create_table->columnar_ ? ", format=columnar" : "");
+			for (size_t i = 0; i < create_table->schema_.GetColumnCount(); i++) {
+				if (create_table->schema_.GetColumn(i).HasBloomFilter()) {
+					std::cout << ", bloom_filter=" << create_table->schema_.GetColumn(i).GetName();
+				}
+			}
+			std::cout << ")\n";
 			break;
 		}
 		case PlanNodeType::CREATE_DATABASE:
@@ -102,6 +118,15 @@ namespace utils {
 			std::cout << "DropTable(table=" << drop_table->table_name_ << ")\n";
 			break;
 		}
+		case PlanNodeType::VACUUM: {
+			auto* vacuum = static_cast<const planner::VacuumPlanNode*>(plan.get());
+			if (vacuum->table_ref) {
+				std::cout << "Vacuum(table=" << vacuum->table_ref->table_name << ")\n";
+			} else {
+				std::cout << "VacuumFile()\n";
+			}
+			break;
+		}
 		default:
 			std::cout << "UnknownPlan(type=" << static_cast<int>(plan->GetType()) << ")\n";
 			break;
@@ -142,39 +167,85 @@ namespace utils {
 				}
 				std::cout << std::endl;
 
+				// rows are formatted into one buffer, large results spent most of their time in ostream
+				std::string out;
+				char value[64];
 				for (const auto& tuple : tuples) {
 					for (size_t i = 0; i < schema.GetColumnCount(); i++) {
 						const Column& col = schema.GetColumn(i);
-
 						const char* raw_value = tuple.GetValue(i, &schema);
-						std::string value;
+						size_t length;
 
-						if (raw_value != nullptr) {
+						if (raw_value == nullptr) {
+							length = 4;
+							out.append("NULL");
+						} else {
 							switch (col.GetType()) {
 							case ColumnType::INT:
-								value = std::to_string(*reinterpret_cast<const int*>(raw_value));
+								length = std::snprintf(value, sizeof(value), "%d", *reinterpret_cast<const int*>(raw_value));
+								out.append(value, length);
 								break;
 							case ColumnType::FLOAT:
-								value = std::to_string(*reinterpret_cast<const float*>(raw_value));
+								length = std::snprintf(value, sizeof(value), "%f", *reinterpret_cast<const float*>(raw_value));
+								out.append(value, length);
 								break;
 							case ColumnType::CHAR:
-								value = std::string(raw_value);
+							case ColumnType::VARCHAR:
+								length = strnlen(raw_value, col.GetMaxLength());
+								out.append(raw_value, length);
 								break;
+							case ColumnType::BIGINT: {
+								int64_t bigint_value;
+								std::memcpy(&bigint_value, raw_value, sizeof(bigint_value));
+								length = std::snprintf(value, sizeof(value), "%lld", static_cast<long long>(bigint_value));
+								out.append(value, length);
+								break;
+							}
+							case ColumnType::DOUBLE: {
+								double double_value;
+								std::memcpy(&double_value, raw_value, sizeof(double_value));
+								length = std::snprintf(value, sizeof(value), "%f", double_value);
+								out.append(value, length);
+								break;
+							}
+							case ColumnType::DATE: {
+								int32_t days;
+								std::memcpy(&days, raw_value, sizeof(days));
+								std::string date = FormatDate(days);
+								length = date.size();
+								out.append(date);
+								break;
+							}
+							case ColumnType::TIMESTAMP: {
+								int64_t micros;
+								std::memcpy(&micros, raw_value, sizeof(micros));
+								std::string timestamp = FormatTimestamp(micros);
+								length = timestamp.size();
+								out.append(timestamp);
+								break;
+							}
 							default:
-								value = "UNK";
+								length = 3;
+								out.append("UNK");
 								break;
 							}
-						} else {
-							value = "NULL";
 						}
 
-						std::cout << std::setw(18) << std::left << value;
+						if (length < 18) {
+							out.append(18 - length, ' ');
+						}
 						if (i < schema.GetColumnCount() - 1) {
-							std::cout << " | ";
+							out.append(" | ");
 						}
 					}
-					std::cout << std::endl;
+					out.push_back('\n');
+
+					if (out.size() >= 64 * 1024) {
+						std::cout.write(out.data(), out.size());
+						out.clear();
+					}
 				}
+				std::cout.write(out.data(), out.size());
 				std::cout << std::endl;
 			}
 			std::cout << rs.message_ << std::endl;
@@ -191,12 +262,16 @@ namespace utils {
 		std::cout << "  SHOW DATABASES\n\n";
 		
 		std::cout << "  CREATE TABLE <name> (\n";
-		std::cout << "    <col> <type> [PRIMARY KEY],\n";
+		std::cout << "    <col> <type> [PRIMARY KEY],    INT, BIGINT, FLOAT, DOUBLE, CHAR, VARCHAR(n), DATE, TIMESTAMP\n";
 		std::cout << "    <col> <type>,\n";
 		std::cout << "    ...\n";
-		std::cout << "  )\n";
+		std::cout << "  ) [WITH (<option> = <value>, ...)]\n";
+		std::cout << "    format = row | columnar         columnar: fixed width columns only\n";
+		std::cout << "    bloom_filter = <col>            per page Bloom filter for point lookups, once per column\n";
 		std::cout << "  DROP TABLE <name>\n";
-		std::cout << "  SHOW TABLES\n\n";
+		std::cout << "  SHOW TABLES\n";
+		std::cout << "  VACUUM FILE\n";
+		std::cout << "  VACUUM <table>\n\n";
 		
 		std::cout << "  INSERT INTO <table> VALUES (<val1>, <val2>, ...);\n";
 		std::cout << "  INSERT INTO <table> VALUES  \n";
@@ -204,7 +279,15 @@ namespace utils {
 		std::cout << "    (<val3>, <val4>, ...),\n";
 		std::cout << "    ...;\n";
 		std::cout << "  SELECT * FROM <table>     \n";
-		std::cout << "  SELECT <col1>, <col2> FROM <table> \n\n";
+		std::cout << "  SELECT <col1>, <col2> FROM <table> \n";
+		std::cout << "  SELECT * FROM <table> WHERE <col> <op> <val>\n";
+		std::cout << "  SELECT * FROM <table> WHERE <col> IS [NOT] NULL\n";
+		std::cout << "  UPDATE <table> SET <col> = <val>, ... [WHERE <col> <op> <val>]\n";
+		std::cout << "  DELETE FROM <table> [WHERE <col> <op> <val>]\n\n";
+
+		std::cout << "  BEGIN\n";
+		std::cout << "  COMMIT\n";
+		std::cout << "  ROLLBACK\n\n";
 		
 		std::cout << "  EXAMPLE:\n";
 		std::cout << "  CREATE DATABASE my_db;\n";
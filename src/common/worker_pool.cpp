@@ -0,0 +1,95 @@
+// /src/common/worker_pool.cpp
+
+#include "common/worker_pool.h"
+
+namespace venus {
+namespace common {
+
+	WorkerPool::WorkerPool(size_t num_threads)
+	    : stop_(false) {
+		for (size_t i = 0; i < num_threads; i++) {
+			threads_.emplace_back([this]() { WorkerLoop(); });
+		}
+	}
+
+	WorkerPool::~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		cv_.notify_all();
+		for (auto& thread : threads_) {
+			if (thread.joinable()) {
+				thread.join();
+			}
+		}
+	}
+
+	void WorkerPool::Submit(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			tasks_.push_back(std::move(task));
+		}
+		cv_.notify_one();
+	}
+
+	void WorkerPool::RunParallel(size_t num_tasks, const std::function<void(size_t)>& task) {
+		if (num_tasks == 0) {
+			return;
+		}
+
+		std::mutex done_mutex;
+		std::condition_variable done_cv;
+		size_t remaining = num_tasks - 1;
+		std::exception_ptr error = nullptr;
+
+		auto run = [&](size_t task_id) {
+			try {
+				task(task_id);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(done_mutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+			}
+		};
+
+		for (size_t i = 1; i < num_tasks; i++) {
+			Submit([&, i]() {
+				run(i);
+				std::lock_guard<std::mutex> lock(done_mutex);
+				if (--remaining == 0) {
+					done_cv.notify_one();
+				}
+			});
+		}
+
+		// caller thread is worker 0
+		run(0);
+
+		std::unique_lock<std::mutex> lock(done_mutex);
+		done_cv.wait(lock, [&]() { return remaining == 0; });
+
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	void WorkerPool::WorkerLoop() {
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+				if (stop_ && tasks_.empty()) {
+					return;
+				}
+				task = std::move(tasks_.front());
+				tasks_.pop_front();
+			}
+			task();
+		}
+	}
+
+} // namespace common
+} // namespace venus
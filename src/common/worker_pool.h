@@ -0,0 +1,54 @@
+// /src/common/worker_pool.h
+
+/**
+ * WorkerPool - a fixed set of threads that execute submitted tasks from a shared queue.
+ *
+ * Used by the executor for intra-query parallelism (morsel-driven scans).
+ * Threads are created once and reused across queries, so starting a parallel scan does not pay thread creation cost.
+ *
+ * RunParallel(n, task) runs task(0) on the calling thread and task(1..n-1) on the pool,
+ * then blocks until all of them return. Because the caller always participates,
+ * a parallel section still completes when every pool thread is busy (it just runs with less parallelism).
+ * The first exception thrown by any task is rethrown on the calling thread.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+
+namespace venus {
+namespace common {
+
+	class WorkerPool {
+	public:
+		explicit WorkerPool(size_t num_threads);
+		~WorkerPool();
+
+		void Submit(std::function<void()> task);
+		void RunParallel(size_t num_tasks, const std::function<void(size_t)>& task);
+
+		size_t GetNumThreads() const { return threads_.size(); }
+
+	private:
+		std::vector<std::thread> threads_;
+		std::deque<std::function<void()>> tasks_;
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		bool stop_;
+
+		void WorkerLoop();
+
+		DISALLOW_COPY_AND_MOVE(WorkerPool);
+	};
+
+} // namespace common
+} // namespace venus
@@ -0,0 +1,109 @@
+// /src/concurrency/garbage_collector.cpp
+
+#include "concurrency/garbage_collector.h"
+#include "table/table_heap.h"
+
+#include <chrono>
+#include <limits>
+
+namespace venus {
+namespace concurrency {
+
+	GarbageCollector::~GarbageCollector() {
+		Stop();
+	}
+
+	void GarbageCollector::Start() {
+		std::lock_guard<std::mutex> lock(latch_);
+		if (!stop_) {
+			return;
+		}
+		stop_ = false;
+		thread_ = std::thread(&GarbageCollector::GCLoop, this);
+	}
+
+	void GarbageCollector::Stop() {
+		{
+			std::lock_guard<std::mutex> lock(latch_);
+			stop_ = true;
+		}
+		cv_.notify_one();
+		if (thread_.joinable()) {
+			thread_.join();
+		}
+
+		// no statement runs anymore
+		std::lock_guard<std::mutex> lock(collect_latch_);
+		FreeUnlinkedPages(std::numeric_limits<txn_id_t>::max());
+	}
+
+	void GarbageCollector::FreeTablePages(page_id_t first_page_id) {
+		// a round in progress finishes with the heap before its chain is handed over
+		std::lock_guard<std::mutex> lock(collect_latch_);
+		txn_manager_->RemoveGarbageTable(first_page_id);
+		AddUnlinkedPages(table::TableHeap(bpm_, nullptr, first_page_id).GetPageIds());
+	}
+
+	void GarbageCollector::AddUnlinkedPages(const std::vector<page_id_t>& page_ids) {
+		// a transaction that begins from now on cannot reach the pages anymore
+		txn_id_t epoch = txn_manager_->GetNextTxnId();
+		for (page_id_t page_id : page_ids) {
+			unlinked_pages_.emplace_back(epoch, page_id);
+		}
+	}
+
+	void GarbageCollector::FreeUnlinkedPages(txn_id_t horizon) {
+		std::vector<std::pair<txn_id_t, page_id_t>> unlinked;
+		unlinked.swap(unlinked_pages_);
+		for (const auto& entry : unlinked) {
+			// a transaction older than the unlink may still read the page, or it is still pinned
+			if (entry.first > horizon || !bpm_->DeletePage(entry.second)) {
+				unlinked_pages_.push_back(entry);
+			}
+		}
+	}
+
+	size_t GarbageCollector::CollectGarbage() {
+		std::lock_guard<std::mutex> lock(collect_latch_);
+
+		// taken before the heaps, a version deleted later is simply left for the next round
+		txn_id_t horizon = txn_manager_->GetGCHorizon();
+		size_t reclaimed = 0;
+
+		// unlinked by earlier rounds
+		FreeUnlinkedPages(horizon);
+
+		std::vector<page_id_t> unlinked;
+		for (page_id_t first_page_id : txn_manager_->TakeGarbageTables()) {
+			table::TableHeap table_heap(bpm_, nullptr, first_page_id);
+			size_t pending = 0;
+			reclaimed += table_heap.CollectGarbage(horizon, &pending, &unlinked);
+			if (pending > 0) {
+				txn_manager_->AddGarbageTable(first_page_id);
+			}
+		}
+		AddUnlinkedPages(unlinked);
+
+		return reclaimed;
+	}
+
+	void GarbageCollector::GCLoop() {
+		std::unique_lock<std::mutex> lock(latch_);
+		while (!stop_) {
+			cv_.wait_for(lock, std::chrono::milliseconds(GC_INTERVAL_MS), [this]() { return stop_; });
+			if (stop_) {
+				break;
+			}
+
+			lock.unlock();
+			try {
+				CollectGarbage();
+			} catch (const std::exception& e) {
+				LOG(e.what());
+			}
+			lock.lock();
+		}
+	}
+
+} // namespace concurrency
+} // namespace venus
@@ -0,0 +1,85 @@
+// /src/concurrency/garbage_collector.h
+
+/**
+ * GarbageCollector for VenusDB - removes tuple versions no snapshot can see anymore.
+ *
+ * A delete inside a transaction only stamps xmax on the version, readers with older snapshots
+ * still need it. Once the deleting transaction is older than the GC horizon (the oldest snapshot
+ * of any running transaction) the version is dead and its slot is marked free.
+ *
+ * Only heaps that committed transactions deleted from are visited; a heap whose versions are
+ * still visible to someone is queued again for the next round.
+ *
+ * Pages left without a live version are taken out of their heap's chain. A scan that read the
+ * link to such a page before it was unlinked (a parallel scan lists all pages up front) may still
+ * read it, so each page is tagged with the next transaction id when it is unlinked and only freed
+ * once the GC horizon has passed it: every transaction that began before the unlink, and with it
+ * every scan, has finished. Stop frees what is left. A dropped table's pages are handed over with
+ * FreeTablePages and freed the same way; a page still pinned is kept until a later round.
+ *
+ * A background thread collects every GC_INTERVAL_MS.
+ */
+
+#pragma once
+
+#include "buffer/buffer_pool.h"
+#include "common/config.h"
+#include "concurrency/transaction_manager.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace venus {
+namespace concurrency {
+
+	class GarbageCollector {
+	public:
+		GarbageCollector(buffer::BufferPoolManager* bpm, TransactionManager* txn_manager)
+		    : bpm_(bpm)
+		    , txn_manager_(txn_manager)
+		    , stop_(true) { }
+		~GarbageCollector();
+
+		void Start();
+		void Stop();
+
+		// one round now, returns the number of versions removed
+		size_t CollectGarbage();
+
+		// all pages of a dropped heap, freed once the transactions running now have finished;
+		// the heap is no longer visited by later rounds
+		void FreeTablePages(page_id_t first_page_id);
+
+		// unlinked pages not freed yet
+		size_t GetUnlinkedPageCount() {
+			std::lock_guard<std::mutex> lock(collect_latch_);
+			return unlinked_pages_.size();
+		}
+
+	private:
+		buffer::BufferPoolManager* bpm_;
+		TransactionManager* txn_manager_;
+
+		std::mutex collect_latch_; // one round at a time, protects unlinked_pages_
+		std::vector<std::pair<txn_id_t, page_id_t>> unlinked_pages_; // next txn id at the unlink -> page
+
+		// called with collect_latch_ held, after the pages were unlinked
+		void AddUnlinkedPages(const std::vector<page_id_t>& page_ids);
+		// the pages whose transactions before the unlink are all below horizon
+		void FreeUnlinkedPages(txn_id_t horizon);
+
+		std::mutex latch_;
+		std::condition_variable cv_;
+		bool stop_;
+		std::thread thread_;
+
+		void GCLoop();
+
+		DISALLOW_COPY_AND_MOVE(GarbageCollector);
+	};
+
+} // namespace concurrency
+} // namespace venus
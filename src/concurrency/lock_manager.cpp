@@ -0,0 +1,304 @@
+// /src/concurrency/lock_manager.cpp
+
+#include "concurrency/lock_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace venus {
+namespace concurrency {
+
+	namespace {
+
+		// true if holding held already gives everything requested gives
+		bool Covers(LockMode held, LockMode requested) {
+			switch (held) {
+			case LockMode::EXCLUSIVE:
+				return true;
+			case LockMode::SHARED_INTENTION_EXCLUSIVE:
+				return requested != LockMode::EXCLUSIVE;
+			case LockMode::SHARED:
+				return requested == LockMode::SHARED || requested == LockMode::INTENTION_SHARED;
+			case LockMode::INTENTION_EXCLUSIVE:
+				return requested == LockMode::INTENTION_EXCLUSIVE || requested == LockMode::INTENTION_SHARED;
+			case LockMode::INTENTION_SHARED:
+				return requested == LockMode::INTENTION_SHARED;
+			}
+			return false;
+		}
+
+		// weakest mode covering both
+		LockMode Combine(LockMode held, LockMode requested) {
+			if (Covers(held, requested)) {
+				return held;
+			}
+			if (Covers(requested, held)) {
+				return requested;
+			}
+			// only S and IX are not ordered
+			return LockMode::SHARED_INTENTION_EXCLUSIVE;
+		}
+
+	} // namespace
+
+	LockManager::~LockManager() {
+		Stop();
+	}
+
+	void LockManager::Start() {
+		std::lock_guard<std::mutex> lock(latch_);
+		if (!stop_) {
+			return;
+		}
+		stop_ = false;
+		thread_ = std::thread(&LockManager::DetectionLoop, this);
+	}
+
+	void LockManager::Stop() {
+		{
+			std::lock_guard<std::mutex> lock(latch_);
+			stop_ = true;
+		}
+		cv_.notify_one();
+		if (thread_.joinable()) {
+			thread_.join();
+		}
+	}
+
+	bool LockManager::Compatible(LockMode held, LockMode requested) {
+		switch (held) {
+		case LockMode::INTENTION_SHARED:
+			return requested != LockMode::EXCLUSIVE;
+		case LockMode::INTENTION_EXCLUSIVE:
+			return requested == LockMode::INTENTION_SHARED || requested == LockMode::INTENTION_EXCLUSIVE;
+		case LockMode::SHARED:
+			return requested == LockMode::INTENTION_SHARED || requested == LockMode::SHARED;
+		case LockMode::SHARED_INTENTION_EXCLUSIVE:
+			return requested == LockMode::INTENTION_SHARED;
+		case LockMode::EXCLUSIVE:
+			return false;
+		}
+		return false;
+	}
+
+	void LockManager::LockTable(Transaction* txn, LockMode mode, page_id_t table_id) {
+		Lock(txn, mode, TableKey(table_id));
+	}
+
+	void LockManager::LockRow(Transaction* txn, LockMode mode, page_id_t table_id, const RID& rid) {
+		if (mode != LockMode::SHARED && mode != LockMode::EXCLUSIVE) {
+			throw std::runtime_error("Lock error: Rows can only be locked shared or exclusive");
+		}
+		Lock(txn, mode == LockMode::SHARED ? LockMode::INTENTION_SHARED : LockMode::INTENTION_EXCLUSIVE, TableKey(table_id));
+		Lock(txn, mode, RowKey(rid));
+	}
+
+	void LockManager::Lock(Transaction* txn, LockMode mode, lock_key_t key) {
+		LockTableShard& shard = ShardFor(key);
+		std::unique_lock<std::mutex> lock(shard.latch);
+		LockQueue& queue = shard.queues[key];
+		auto& requests = queue.requests;
+
+		auto first_waiting = std::find_if(requests.begin(), requests.end(), [](const LockRequest& r) { return !r.granted; });
+
+		// already held: done if it covers mode, otherwise upgrade ahead of every waiter
+		bool upgrade = false;
+		LockMode held_mode = mode;
+		for (auto it = requests.begin(); it != first_waiting; ++it) {
+			if (it->txn == txn) {
+				if (Covers(it->mode, mode)) {
+					return;
+				}
+				held_mode = it->mode;
+				mode = Combine(it->mode, mode);
+				requests.erase(it);
+				upgrade = true;
+				break;
+			}
+		}
+
+		auto request = requests.insert(upgrade ? first_waiting : requests.end(), LockRequest { txn, mode, false });
+		queue.cv.wait(lock, [&]() { return txn->IsDeadlockVictim() || Grantable(queue, request); });
+
+		if (!Grantable(queue, request)) {
+			// deadlock victim, an upgrade keeps the lock it had
+			if (upgrade) {
+				request->mode = held_mode;
+				request->granted = true;
+			} else {
+				requests.erase(request);
+				if (requests.empty()) {
+					shard.queues.erase(key);
+				}
+			}
+			queue.cv.notify_all();
+			throw std::runtime_error("Lock error: Deadlock detected, transaction " + std::to_string(txn->GetTxnId()) + " was chosen as the victim");
+		}
+
+		txn->SetDeadlockVictim(false);
+		request->granted = true;
+		if (!upgrade) {
+			txn->GetLockSet().push_back(key);
+		}
+
+		// compatible waiters behind this one may go now
+		if (std::next(request) != requests.end()) {
+			queue.cv.notify_all();
+		}
+	}
+
+	bool LockManager::Grantable(const LockQueue& queue, std::list<LockRequest>::const_iterator request) const {
+		// FIFO: every earlier request is granted and compatible
+		for (auto it = queue.requests.begin(); it != request; ++it) {
+			if (!it->granted || !Compatible(it->mode, request->mode)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void LockManager::ReleaseAll(Transaction* txn) {
+		for (lock_key_t key : txn->GetLockSet()) {
+			LockTableShard& shard = ShardFor(key);
+			std::lock_guard<std::mutex> lock(shard.latch);
+
+			auto queue_it = shard.queues.find(key);
+			if (queue_it == shard.queues.end()) {
+				continue;
+			}
+
+			auto& requests = queue_it->second.requests;
+			requests.remove_if([txn](const LockRequest& r) { return r.txn == txn; });
+			if (requests.empty()) {
+				shard.queues.erase(queue_it);
+			} else {
+				queue_it->second.cv.notify_all();
+			}
+		}
+		txn->GetLockSet().clear();
+	}
+
+	size_t LockManager::DetectDeadlocks() {
+		struct Waiter {
+			Transaction* txn;
+			LockTableShard* shard;
+			lock_key_t key;
+		};
+
+		// waiter -> transactions it waits for, every edge is read under its shard latch
+		std::unordered_map<txn_id_t, std::vector<txn_id_t>> waits_for;
+		std::unordered_map<txn_id_t, Waiter> waiters;
+
+		for (LockTableShard& shard : shards_) {
+			std::lock_guard<std::mutex> lock(shard.latch);
+			for (auto& entry : shard.queues) {
+				const auto& requests = entry.second.requests;
+				for (auto it = requests.begin(); it != requests.end(); ++it) {
+					if (it->granted) {
+						continue;
+					}
+					txn_id_t waiter = it->txn->GetTxnId();
+					waiters[waiter] = Waiter { it->txn, &shard, entry.first };
+					for (auto before = requests.begin(); before != it; ++before) {
+						if (before->txn != it->txn && (!before->granted || !Compatible(before->mode, it->mode))) {
+							waits_for[waiter].push_back(before->txn->GetTxnId());
+						}
+					}
+				}
+			}
+		}
+
+		size_t victims = 0;
+		while (true) {
+			// depth first search from the oldest transaction, deterministic victims
+			std::vector<txn_id_t> nodes;
+			for (const auto& entry : waits_for) {
+				nodes.push_back(entry.first);
+			}
+			std::sort(nodes.begin(), nodes.end());
+			for (auto& entry : waits_for) {
+				std::sort(entry.second.begin(), entry.second.end());
+			}
+
+			std::unordered_map<txn_id_t, int> state; // 0 unvisited, 1 on the stack, 2 done
+			std::vector<txn_id_t> stack;
+			std::vector<txn_id_t> cycle;
+
+			std::function<bool(txn_id_t)> visit = [&](txn_id_t node) {
+				state[node] = 1;
+				stack.push_back(node);
+				auto edges = waits_for.find(node);
+				if (edges != waits_for.end()) {
+					for (txn_id_t next : edges->second) {
+						if (state[next] == 1) {
+							cycle.assign(std::find(stack.begin(), stack.end(), next), stack.end());
+							return true;
+						}
+						if (state[next] == 0 && visit(next)) {
+							return true;
+						}
+					}
+				}
+				stack.pop_back();
+				state[node] = 2;
+				return false;
+			};
+
+			bool found = false;
+			for (txn_id_t node : nodes) {
+				if (state[node] == 0 && visit(node)) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				break;
+			}
+
+			// the youngest transaction has done the least work
+			txn_id_t victim = *std::max_element(cycle.begin(), cycle.end());
+			waits_for.erase(victim);
+			for (auto& entry : waits_for) {
+				auto& edges = entry.second;
+				edges.erase(std::remove(edges.begin(), edges.end(), victim), edges.end());
+			}
+
+			// the graph may be stale, only a transaction still waiting in the same queue is woken
+			const Waiter& waiter = waiters[victim];
+			std::lock_guard<std::mutex> lock(waiter.shard->latch);
+			auto queue_it = waiter.shard->queues.find(waiter.key);
+			if (queue_it == waiter.shard->queues.end()) {
+				continue;
+			}
+			for (const LockRequest& request : queue_it->second.requests) {
+				if (request.txn == waiter.txn && !request.granted) {
+					request.txn->SetDeadlockVictim(true);
+					queue_it->second.cv.notify_all();
+					victims++;
+					break;
+				}
+			}
+		}
+
+		return victims;
+	}
+
+	void LockManager::DetectionLoop() {
+		std::unique_lock<std::mutex> lock(latch_);
+		while (!stop_) {
+			cv_.wait_for(lock, std::chrono::milliseconds(DEADLOCK_DETECTION_INTERVAL_MS), [this]() { return stop_; });
+			if (stop_) {
+				break;
+			}
+
+			lock.unlock();
+			DetectDeadlocks();
+			lock.lock();
+		}
+	}
+
+} // namespace concurrency
+} // namespace venus
@@ -0,0 +1,130 @@
+// /src/concurrency/lock_manager.h
+
+/**
+ * LockManager for VenusDB - two-phase row locking for writers.
+ *
+ * Readers use MVCC snapshots and never lock. Writers lock the rows they delete or update
+ * exclusively and the table in an intention mode, so two writers of the same row are
+ * serialized while writers of disjoint rows run in parallel.
+ *
+ * Modes (hierarchical, table then row)
+ *   IS / IX  - the transaction reads / writes some rows of the table
+ *   S / X    - shared / exclusive lock on a table or a row
+ *   SIX      - S on the table plus IX for writing single rows
+ *
+ *        IS   IX   S    SIX  X
+ *   IS   y    y    y    y    -
+ *   IX   y    y    -    -    -
+ *   S    y    -    y    -    -
+ *   SIX  y    -    -    -    -
+ *   X    -    -    -    -    -
+ *
+ * Locks are granted FIFO per target; an upgrade (e.g. S -> X) goes ahead of the waiters.
+ * All locks are held until the transaction commits or aborts (strict 2PL), the
+ * TransactionManager releases them.
+ *
+ * Lock table
+ *   Split into LOCK_TABLE_SHARDS shards by target, each with its own mutex, so an uncontended
+ *   lock is a hash lookup under a mutex nobody else holds.
+ *
+ * Deadlocks
+ *   A background thread builds the wait-for graph (waiter -> holders and earlier waiters it
+ *   conflicts with) every DEADLOCK_DETECTION_INTERVAL_MS. For each cycle the youngest
+ *   transaction is chosen as victim, its wait ends with an exception and it must abort.
+ */
+
+#pragma once
+
+#include "common/config.h"
+#include "concurrency/transaction.h"
+#include "storage/tuple.h"
+
+#include <array>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace venus {
+namespace concurrency {
+
+	enum class LockMode : uint8_t {
+		INTENTION_SHARED,
+		INTENTION_EXCLUSIVE,
+		SHARED,
+		SHARED_INTENTION_EXCLUSIVE,
+		EXCLUSIVE
+	};
+
+	class LockManager {
+	public:
+		LockManager()
+		    : stop_(true) { }
+		~LockManager();
+
+		// deadlock detection thread
+		void Start();
+		void Stop();
+
+		// block until granted, throw if the transaction is chosen as a deadlock victim
+		// a held lock that already covers mode returns immediately, a weaker one is upgraded
+		void LockTable(Transaction* txn, LockMode mode, page_id_t table_id);
+		void LockRow(Transaction* txn, LockMode mode, page_id_t table_id, const RID& rid);
+
+		// end of the transaction
+		void ReleaseAll(Transaction* txn);
+
+		// one round of deadlock detection, returns the number of victims
+		size_t DetectDeadlocks();
+
+		static bool Compatible(LockMode held, LockMode requested);
+
+	private:
+		using lock_key_t = uint64_t; // tables and rows in one key space, see TableKey / RowKey
+
+		struct LockRequest {
+			Transaction* txn;
+			LockMode mode;
+			bool granted;
+		};
+
+		struct LockQueue {
+			std::list<LockRequest> requests; // granted requests always form a prefix
+			std::condition_variable cv;
+		};
+
+		struct LockTableShard {
+			std::mutex latch;
+			std::unordered_map<lock_key_t, LockQueue> queues;
+		};
+
+		std::array<LockTableShard, LOCK_TABLE_SHARDS> shards_;
+
+		std::mutex latch_;
+		std::condition_variable cv_;
+		bool stop_;
+		std::thread thread_;
+
+		static lock_key_t TableKey(page_id_t table_id) {
+			return (1ULL << 63) | table_id;
+		}
+		static lock_key_t RowKey(const RID& rid) {
+			return (static_cast<uint64_t>(rid.page_id) << 16) | rid.slot_id;
+		}
+
+		LockTableShard& ShardFor(lock_key_t key) {
+			return shards_[std::hash<lock_key_t> {}(key) % LOCK_TABLE_SHARDS];
+		}
+
+		void Lock(Transaction* txn, LockMode mode, lock_key_t key);
+		bool Grantable(const LockQueue& queue, std::list<LockRequest>::const_iterator request) const;
+
+		void DetectionLoop();
+
+		DISALLOW_COPY_AND_MOVE(LockManager);
+	};
+
+} // namespace concurrency
+} // namespace venus
@@ -0,0 +1,126 @@
+// /src/concurrency/transaction.h
+
+/**
+ * Transaction for VenusDB.
+ *
+ * Every statement runs inside a transaction handed out by the TransactionManager, either its own
+ * (autocommit) or one opened with BEGIN that lasts until COMMIT / ROLLBACK.
+ * The transaction remembers the LSN of its last log record, which the LogManager uses to
+ * chain the transaction's records backwards (prev_lsn) for undo during recovery.
+ *
+ * Snapshot isolation (MVCC)
+ *   Transaction ids are handed out in increasing order. At Begin the transaction takes a snapshot:
+ *   the next id to be handed out (xmax) and the ids still running at that moment.
+ *   A tuple version written by id is visible to the snapshot if id is the transaction itself,
+ *   or id < xmax and id was not running. Aborted transactions undo their changes before they
+ *   leave the running set, so "finished" always means committed here.
+ *   Readers never take locks; writers only ever add versions or set xmax.
+ *
+ * Write set
+ *   Copies of the INSERT / DELETE / UPDATE records the transaction logged, so a ROLLBACK can undo
+ *   them without reading the log back, and the heaps it deleted from (for garbage collection).
+ *
+ * Locks
+ *   Writers lock through the LockManager handed out by the TransactionManager, the transaction
+ *   remembers what it holds so everything is released at commit / abort.
+ *
+ * A transaction is used by one thread at a time, the checkpointer only reads its first and last
+ * LSN and the deadlock detector only marks it as a victim.
+ */
+
+#pragma once
+
+#include "common/config.h"
+#include "recovery/log_record.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace venus {
+namespace concurrency {
+
+	class LockManager;
+
+	class Transaction {
+	public:
+		explicit Transaction(txn_id_t txn_id)
+		    : txn_id_(txn_id)
+		    , prev_lsn_(INVALID_LSN)
+		    , first_lsn_(INVALID_LSN)
+		    , snapshot_xmin_(txn_id)
+		    , snapshot_xmax_(txn_id + 1)
+		    , lock_manager_(nullptr)
+		    , deadlock_victim_(false) { }
+
+		txn_id_t GetTxnId() const { return txn_id_; }
+
+		// INVALID_LSN until the transaction writes its first log record
+		lsn_t GetPrevLSN() const { return prev_lsn_; }
+		void SetPrevLSN(lsn_t lsn) { prev_lsn_ = lsn; }
+
+		// LSN of its BEGIN record, the log must be kept from here while the transaction runs
+		lsn_t GetFirstLSN() const { return first_lsn_; }
+		void SetFirstLSN(lsn_t lsn) { first_lsn_ = lsn; }
+
+		// running holds the ids active at begin, itself excluded
+		void SetSnapshot(txn_id_t xmax, std::vector<txn_id_t> running) {
+			std::sort(running.begin(), running.end());
+			snapshot_xmax_ = xmax;
+			snapshot_xmin_ = running.empty() ? txn_id_ : std::min(txn_id_, running.front());
+			running_ = std::move(running);
+		}
+
+		// every id below this had finished when the snapshot was taken
+		txn_id_t GetSnapshotXmin() const { return snapshot_xmin_; }
+
+		// true if changes made by txn_id are part of this transaction's snapshot
+		bool Sees(txn_id_t txn_id) const {
+			if (txn_id == INVALID_TXN_ID || txn_id == txn_id_) {
+				return true;
+			}
+			if (txn_id >= snapshot_xmax_) {
+				return false;
+			}
+			return txn_id < snapshot_xmin_ || !std::binary_search(running_.begin(), running_.end(), txn_id);
+		}
+
+		void AddWriteRecord(const recovery::LogRecord& record) { write_set_.push_back(record); }
+		const std::vector<recovery::LogRecord>& GetWriteSet() const { return write_set_; }
+
+		void AddDeletedFrom(page_id_t first_page_id) { deleted_from_.insert(first_page_id); }
+		const std::unordered_set<page_id_t>& GetDeletedFrom() const { return deleted_from_; }
+
+		// null when writers do not lock
+		LockManager* GetLockManager() const { return lock_manager_; }
+		void SetLockManager(LockManager* lock_manager) { lock_manager_ = lock_manager; }
+
+		// lock table keys of the locks held, maintained by the LockManager
+		std::vector<uint64_t>& GetLockSet() { return lock_set_; }
+
+		bool IsDeadlockVictim() const { return deadlock_victim_; }
+		void SetDeadlockVictim(bool victim) { deadlock_victim_ = victim; }
+
+	private:
+		txn_id_t txn_id_;
+		std::atomic<lsn_t> prev_lsn_;
+		std::atomic<lsn_t> first_lsn_;
+
+		txn_id_t snapshot_xmin_;
+		txn_id_t snapshot_xmax_;
+		std::vector<txn_id_t> running_; // sorted
+
+		std::vector<recovery::LogRecord> write_set_;
+		std::unordered_set<page_id_t> deleted_from_; // first page ids of heaps with versions this txn deleted
+
+		LockManager* lock_manager_;
+		std::vector<uint64_t> lock_set_;
+		std::atomic<bool> deadlock_victim_;
+
+		DISALLOW_COPY_AND_MOVE(Transaction);
+	};
+
+} // namespace concurrency
+} // namespace venus
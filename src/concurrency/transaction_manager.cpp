@@ -0,0 +1,144 @@
+// /src/concurrency/transaction_manager.cpp
+
+#include "concurrency/transaction_manager.h"
+#include "recovery/log_recovery.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace venus {
+namespace concurrency {
+
+	Transaction* TransactionManager::Begin() {
+		std::lock_guard<std::mutex> lock(latch_);
+
+		auto txn = std::make_unique<Transaction>(next_txn_id_++);
+		Transaction* raw = txn.get();
+		raw->SetLockManager(lock_manager_);
+
+		std::vector<txn_id_t> running;
+		running.reserve(active_txns_.size());
+		for (const auto& entry : active_txns_) {
+			running.push_back(entry.first);
+		}
+		raw->SetSnapshot(next_txn_id_, std::move(running));
+
+		active_txns_[raw->GetTxnId()] = std::move(txn);
+		return raw;
+	}
+
+	void TransactionManager::Commit(Transaction* txn) {
+		if (txn == nullptr) {
+			return;
+		}
+
+		// read-only transactions never touched the log
+		if (log_manager_ != nullptr && txn->GetPrevLSN() != INVALID_LSN) {
+			recovery::LogRecord record(recovery::LogRecordType::COMMIT);
+			lsn_t commit_lsn = log_manager_->AppendLogRecord(txn, &record);
+			log_manager_->Flush(commit_lsn);
+		}
+
+		if (lock_manager_ != nullptr) {
+			lock_manager_->ReleaseAll(txn);
+		}
+
+		std::lock_guard<std::mutex> lock(latch_);
+		garbage_tables_.insert(txn->GetDeletedFrom().begin(), txn->GetDeletedFrom().end());
+		active_txns_.erase(txn->GetTxnId());
+	}
+
+	void TransactionManager::Abort(Transaction* txn) {
+		if (txn == nullptr) {
+			return;
+		}
+
+		const auto& write_set = txn->GetWriteSet();
+		if (!write_set.empty() && bpm_ == nullptr) {
+			throw std::runtime_error("Transaction error: Cannot roll back transaction " + std::to_string(txn->GetTxnId()) + " without a buffer pool");
+		}
+
+		for (auto it = write_set.rbegin(); it != write_set.rend(); ++it) {
+			buffer::PageGuard guard = bpm_->FetchPageWrite(it->GetPageId());
+			if (!guard) {
+				throw std::runtime_error("Transaction error: Page " + std::to_string(it->GetPageId()) + " is missing, cannot roll back transaction " + std::to_string(txn->GetTxnId()));
+			}
+
+			recovery::LogRecord clr(*it, it->GetPrevLSN());
+			recovery::LogRecovery::ApplyUndo(guard.GetPage(), clr);
+			if (log_manager_ != nullptr) {
+				guard->SetLSN(log_manager_->AppendLogRecord(txn, &clr));
+			}
+			guard.MarkDirty();
+		}
+
+		// no flush, a lost ABORT makes recovery roll the transaction back again
+		if (log_manager_ != nullptr && txn->GetPrevLSN() != INVALID_LSN) {
+			recovery::LogRecord record(recovery::LogRecordType::ABORT);
+			log_manager_->AppendLogRecord(txn, &record);
+		}
+
+		if (lock_manager_ != nullptr) {
+			lock_manager_->ReleaseAll(txn);
+		}
+
+		std::lock_guard<std::mutex> lock(latch_);
+		active_txns_.erase(txn->GetTxnId());
+	}
+
+	std::vector<std::pair<txn_id_t, lsn_t>> TransactionManager::GetActiveTransactions() {
+		std::vector<std::pair<txn_id_t, lsn_t>> active;
+
+		std::lock_guard<std::mutex> lock(latch_);
+		for (const auto& entry : active_txns_) {
+			lsn_t last_lsn = entry.second->GetPrevLSN();
+			if (last_lsn != INVALID_LSN) {
+				active.emplace_back(entry.first, last_lsn);
+			}
+		}
+		return active;
+	}
+
+	lsn_t TransactionManager::GetOldestActiveLSN() {
+		lsn_t oldest = INVALID_LSN;
+
+		std::lock_guard<std::mutex> lock(latch_);
+		for (const auto& entry : active_txns_) {
+			oldest = std::min(oldest, entry.second->GetFirstLSN());
+		}
+		return oldest;
+	}
+
+	txn_id_t TransactionManager::GetGCHorizon() {
+		std::lock_guard<std::mutex> lock(latch_);
+		txn_id_t horizon = next_txn_id_;
+		for (const auto& entry : active_txns_) {
+			horizon = std::min(horizon, entry.second->GetSnapshotXmin());
+		}
+		return horizon;
+	}
+
+	std::unordered_set<page_id_t> TransactionManager::TakeGarbageTables() {
+		std::lock_guard<std::mutex> lock(latch_);
+		std::unordered_set<page_id_t> tables;
+		tables.swap(garbage_tables_);
+		return tables;
+	}
+
+	void TransactionManager::AddGarbageTable(page_id_t first_page_id) {
+		std::lock_guard<std::mutex> lock(latch_);
+		garbage_tables_.insert(first_page_id);
+	}
+
+	void TransactionManager::RemoveGarbageTable(page_id_t first_page_id) {
+		std::lock_guard<std::mutex> lock(latch_);
+		garbage_tables_.erase(first_page_id);
+	}
+
+	size_t TransactionManager::GetActiveCount() {
+		std::lock_guard<std::mutex> lock(latch_);
+		return active_txns_.size();
+	}
+
+} // namespace concurrency
+} // namespace venus
@@ -0,0 +1,88 @@
+// /src/concurrency/transaction_manager.h
+
+/**
+ * TransactionManager for VenusDB.
+ *
+ * Hands out transactions, makes them durable on commit and rolls them back on abort.
+ * Begin assigns the id and takes the transaction's snapshot under one latch, so a snapshot never
+ * misses a transaction that started before it.
+ * Commit appends a COMMIT record and waits for the log to be flushed up to it; concurrent commits
+ * share one log sync through the LogManager's group commit. A transaction that changed nothing
+ * never wrote to the log and commits without waiting.
+ * Abort undoes the write set newest first, logging a CLR for each change, then an ABORT record.
+ * Locks are released last in both, after the outcome is durable / the changes are undone.
+ *
+ * The GC horizon is the oldest snapshot xmin of any running transaction: a version deleted by a
+ * transaction below it is invisible to everyone and can be reclaimed.
+ */
+
+#pragma once
+
+#include "buffer/buffer_pool.h"
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "recovery/log_manager.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace venus {
+namespace concurrency {
+
+	class TransactionManager {
+	public:
+		// bpm is needed to roll back transactions that changed pages, writers lock only with a lock manager
+		explicit TransactionManager(recovery::LogManager* log_manager, buffer::BufferPoolManager* bpm = nullptr,
+		    LockManager* lock_manager = nullptr)
+		    : log_manager_(log_manager)
+		    , bpm_(bpm)
+		    , lock_manager_(lock_manager)
+		    , next_txn_id_(0) { }
+
+		// the returned transaction is owned by the manager until it commits or aborts
+		Transaction* Begin();
+		void Commit(Transaction* txn);
+		void Abort(Transaction* txn);
+
+		size_t GetActiveCount();
+
+		// txn -> last lsn for transactions that have logged something, for checkpoints
+		std::vector<std::pair<txn_id_t, lsn_t>> GetActiveTransactions();
+
+		// smallest first LSN of the active transactions, INVALID_LSN if none has logged anything
+		lsn_t GetOldestActiveLSN();
+
+		// versions deleted by a transaction below this id are invisible to every snapshot
+		txn_id_t GetGCHorizon();
+
+		// first page ids of heaps with deleted versions of committed transactions
+		std::unordered_set<page_id_t> TakeGarbageTables();
+		void AddGarbageTable(page_id_t first_page_id);
+		// a dropped heap, its pages are freed and must not be visited anymore
+		void RemoveGarbageTable(page_id_t first_page_id);
+
+		// recovery continues numbering after the last transaction found in the log
+		txn_id_t GetNextTxnId() const { return next_txn_id_; }
+		void SetNextTxnId(txn_id_t txn_id) { next_txn_id_ = txn_id; }
+
+	private:
+		recovery::LogManager* log_manager_;
+		buffer::BufferPoolManager* bpm_;
+		LockManager* lock_manager_;
+		std::atomic<txn_id_t> next_txn_id_;
+
+		std::mutex latch_; // protects active_txns_, garbage_tables_ and id assignment in Begin
+		std::unordered_map<txn_id_t, std::unique_ptr<Transaction>> active_txns_;
+		std::unordered_set<page_id_t> garbage_tables_;
+
+		DISALLOW_COPY_AND_MOVE(TransactionManager);
+	};
+
+} // namespace concurrency
+} // namespace venus
@@ -1,6 +1,9 @@
 // /src/database/database_manager.cpp
 
 #include "database/database_manager.h"
+#include "recovery/log_recovery.h"
+
+#include <algorithm>
 
 using namespace venus::database;
 using namespace venus::storage;
@@ -8,134 +11,322 @@ using namespace venus::buffer;
 using namespace venus::catalog;
 using namespace venus::engine;
 using namespace venus::network;
+using namespace venus::recovery;
+using namespace venus::concurrency;
 
-DatabaseManager::DatabaseManager()
-    : db_path_("")
-    , is_open_(false)
-    , disk_manager_(nullptr)
-    , bpm_(nullptr)
-    , catalog_(nullptr)
-    , network_(nullptr) {
+DatabaseManager::DatabaseManager(DiskMode disk_mode)
+    : disk_mode_(disk_mode)
+    , db_path_("")
+    , current_(nullptr)
+    , buffer_pool_(std::make_unique<BufferPool>())
+    , network_(nullptr)
+    , executor_(nullptr) {
 	InitializeExecutor();
 }
 
 DatabaseManager::~DatabaseManager() {
-	if (is_open_) {
-		Close();
-	}
+	// sessions roll back and detach while the databases are still open
+	network_->Stop();
+
+	Close();
+
+	delete network_;
 }
 
 void DatabaseManager::InitializeExecutor() {
 	executor_ = new ExecutionEngine();
-	network_ = new NetworkManager();
 
 	executor_->InitializeCallback(
 	    [this](const std::string& db_name) {
 		    this->Initialize(db_name);
 	    });
 
+	executor_->SetDropDBCallback(
+	    [this](const std::string& db_name) {
+		    this->DropDatabase(db_name);
+	    });
+
 	executor_->SetStopDBCallback(
 	    [this]() {
-		    if (is_open_) {
-			    this->Close();
-		    }
 		    network_->Stop();
+		    this->Close();
 	    });
 
+	network_ = new NetworkManager();
 	network_->SetExecuteCallback([this](const std::string& q) -> executor::ResultSet {
 		return executor_->Execute(q);
 	});
 }
 
-// Initialize() and InitializeExecutor() are cyclic
-// I myself am embarrassed writing this part of code, it works though
-
+// USE from the console
 void DatabaseManager::Initialize(const std::string& db_name) {
 	if (db_name.empty()) {
 		throw std::invalid_argument("Database name cannot be empty");
 	}
 
-	if (is_open_) {
-		// situation where user is using a db, and greedily switches to another db (use command)
-		// need to carefully reinitialize all the components especially executor
-		Close();
-		InitializeExecutor();
+	if (!executor_) {
+		throw std::runtime_error("DatabaseManager: ExecutionEngine is not initialized");
+	}
+
+	if (executor_->InTransaction()) {
+		throw std::runtime_error("DatabaseManager: Cannot switch databases inside a transaction");
+	}
+
+	std::lock_guard<std::mutex> lock(databases_latch_);
+	Database* db = AcquireDatabase(db_name);
+	if (current_) {
+		ReleaseDatabase(current_->name);
 	}
+	current_ = db;
 
 	// full path: DATABASE_DIRECTORY + "/" + db_name + ".db"
 	db_path_ = std::string(venus::DATABASE_DIRECTORY) + "/" + db_name + ".db";
+	executor_->SetLocalContext(db->bpm, db->catalog, db->txn_manager);
+}
 
-	disk_manager_ = new DiskManager(db_path_);
-	if (!disk_manager_) {
-		throw std::runtime_error("DatabaseManager: Failed to create DiskManager");
+Database* DatabaseManager::AcquireDatabase(const std::string& db_name) {
+	auto it = databases_.find(db_name);
+	if (it != databases_.end()) {
+		it->second->users++;
+		return it->second.get();
 	}
 
-	bpm_ = new BufferPoolManager(disk_manager_);
-	if (!bpm_) {
-		throw std::runtime_error("DatabaseManager: Failed to create BufferPoolManager");
+	if (databases_.size() >= MAX_DATABASES) {
+		auto idle = std::find_if(databases_.begin(), databases_.end(),
+		    [](const auto& entry) { return entry.second->users == 0; });
+		if (idle == databases_.end()) {
+			throw std::runtime_error("DatabaseManager: Too many open databases, at most " + std::to_string(MAX_DATABASES));
+		}
+		CloseDatabase(idle->second.get());
+		databases_.erase(idle);
 	}
 
-	catalog_ = new CatalogManager(bpm_);
-	if (!catalog_) {
-		throw std::runtime_error("DatabaseManager: Failed to create CatalogManager");
+	std::unique_ptr<Database> db = OpenDatabase(db_name);
+	db->users = 1;
+	Database* opened = db.get();
+	databases_[db_name] = std::move(db);
+	return opened;
+}
+
+void DatabaseManager::ReleaseDatabase(const std::string& db_name) {
+	auto it = databases_.find(db_name);
+	if (it != databases_.end() && it->second->users > 0) {
+		it->second->users--;
 	}
+}
 
-	if (!executor_) {
-		throw std::runtime_error("DatabaseManager: ExecutionEngine is not initialized");
+std::unique_ptr<Database> DatabaseManager::OpenDatabase(const std::string& db_name) {
+	auto db = std::make_unique<Database>();
+	db->name = db_name;
+
+	std::string db_path = std::string(venus::DATABASE_DIRECTORY) + "/" + db_name + ".db";
+	db->disk_manager = new DiskManager(db_path, disk_mode_);
+
+	try {
+		// <db_name>.log next to the db file
+		std::string log_path = std::string(venus::DATABASE_DIRECTORY) + "/" + db_name + ".log";
+		txn_id_t next_txn_id = 0;
+		if (!IsReadOnly()) {
+			db->log_manager = new LogManager(log_path);
+		} else if (LogManager::NeedsRecovery(log_path, &next_txn_id)) {
+			// redo and undo write pages and the log, a cleanly closed database needs neither
+			throw std::runtime_error("DatabaseManager: " + db_name + " needs recovery, open it read-write first");
+		}
+
+		db->bpm = new BufferPoolManager(buffer_pool_.get(), db->disk_manager, db->log_manager);
+
+		db->lock_manager = new LockManager();
+		db->lock_manager->Start();
+
+		// rollback undoes changes through the buffer pool
+		db->txn_manager = new TransactionManager(db->log_manager, db->bpm, db->lock_manager);
+		// snapshots must see every transaction that wrote the file, recovery sets this otherwise
+		if (IsReadOnly()) {
+			db->txn_manager->SetNextTxnId(next_txn_id);
+		}
+
+		db->garbage_collector = new GarbageCollector(db->bpm, db->txn_manager);
+
+		// a read-only database never changes and has no log: there is nothing to recover,
+		// checkpoint or collect
+		if (!IsReadOnly()) {
+			// bring the pages back to the state of the log before anything reads them
+			LogRecovery recovery(db->bpm, db->log_manager, db->txn_manager);
+			recovery.Recover();
+
+			db->checkpoint_manager = new CheckpointManager(db->bpm, db->disk_manager, db->log_manager, db->txn_manager);
+			if (recovery.GetRedoCount() > 0 || recovery.GetLoserCount() > 0) {
+				db->checkpoint_manager->Checkpoint();
+			}
+			db->checkpoint_manager->Start();
+			db->garbage_collector->Start();
+		}
+
+		db->catalog = new CatalogManager(db->bpm, db->garbage_collector);
+	} catch (...) {
+		CloseDatabase(db.get());
+		throw;
 	}
 
-	executor_->SetLocalContext(bpm_, catalog_);
+	return db;
+}
+
+void DatabaseManager::CloseDatabase(Database* db) {
+	try {
+		// frees the pages it unlinked, before the checkpoint makes them reusable
+		if (db->garbage_collector) {
+			db->garbage_collector->Stop();
+		}
 
-	is_open_ = true;
+		if (db->catalog && !db->bpm->FlushAllPages()) {
+			throw std::runtime_error("Failed to flush all pages to disk");
+		}
+
+		// nothing is dirty now, the next open starts recovery at this checkpoint
+		if (db->catalog && !IsReadOnly()) {
+			db->checkpoint_manager->Stop();
+			db->checkpoint_manager->Checkpoint();
+		}
+	} catch (const std::exception& e) {
+		std::cerr << "Error during database close: " << e.what() << std::endl;
+	}
+
+	delete db->garbage_collector;
+	db->garbage_collector = nullptr;
+
+	delete db->checkpoint_manager;
+	db->checkpoint_manager = nullptr;
+
+	delete db->catalog;
+	db->catalog = nullptr;
+
+	// bpm flushes dirty pages on destruction, which needs the log
+	delete db->bpm;
+	db->bpm = nullptr;
+
+	delete db->txn_manager;
+	db->txn_manager = nullptr;
+
+	delete db->lock_manager;
+	db->lock_manager = nullptr;
+
+	delete db->log_manager;
+	db->log_manager = nullptr;
+
+	delete db->disk_manager;
+	db->disk_manager = nullptr;
+}
+
+// before DROP DATABASE removes the files
+void DatabaseManager::DropDatabase(const std::string& db_name) {
+	if (IsReadOnly()) {
+		throw std::runtime_error("DatabaseManager: Databases are opened read only");
+	}
+
+	std::lock_guard<std::mutex> lock(databases_latch_);
+	auto it = databases_.find(db_name);
+	if (it == databases_.end()) {
+		return;
+	}
+	if (it->second->users > 0) {
+		throw std::runtime_error("DatabaseManager: Database " + db_name + " is in use");
+	}
+	CloseDatabase(it->second.get());
+	databases_.erase(it);
+}
+
+size_t DatabaseManager::GetOpenDatabaseCount() {
+	std::lock_guard<std::mutex> lock(databases_latch_);
+	return databases_.size();
 }
 
 void DatabaseManager::Start() {
 	network_->Start();
 }
 
-void DatabaseManager::Cleanup() {
-	if (executor_) {
-		delete executor_;
-		executor_ = nullptr;
-	}
+uint16_t DatabaseManager::Serve(uint16_t port, bool loopback_only, venus::network::Protocol protocol) {
+	// the callbacks are read by the event loop once it runs
+	if (!network_->IsServing()) {
+		if (SCAN_WORKER_THREADS > 1 && !scan_pool_) {
+			scan_pool_ = std::make_unique<venus::common::WorkerPool>(SCAN_WORKER_THREADS - 1);
+		}
 
-	if (catalog_) {
-		delete catalog_;
-		catalog_ = nullptr;
+		network_->SetSessionCallbacks(
+		    [this](Session* session) { return OpenSession(session); },
+		    [this](Session* session) { CloseSession(session); });
 	}
+	return network_->Listen(port, loopback_only, protocol);
+}
 
-	if (bpm_) {
-		delete bpm_;
-		bpm_ = nullptr;
+std::unique_ptr<ExecutionEngine> DatabaseManager::OpenSession(Session* session) {
+	auto engine = std::make_unique<ExecutionEngine>(scan_pool_.get());
+
+	engine->InitializeCallback(
+	    [this, session](const std::string& db_name) {
+		    this->UseDatabase(session, db_name);
+	    });
+
+	engine->SetDropDBCallback(
+	    [this](const std::string& db_name) {
+		    this->DropDatabase(db_name);
+	    });
+
+	// EXIT ends the session, not the server
+	engine->SetStopDBCallback(
+	    [session]() {
+		    session->Close();
+	    });
+
+	return engine;
+}
+
+void DatabaseManager::UseDatabase(Session* session, const std::string& db_name) {
+	if (session->GetEngine()->InTransaction()) {
+		throw std::runtime_error("DatabaseManager: Cannot switch databases inside a transaction");
 	}
 
-	if (disk_manager_) {
-		delete disk_manager_;
-		disk_manager_ = nullptr;
+	std::lock_guard<std::mutex> lock(databases_latch_);
+	Database* db = AcquireDatabase(db_name);
+	if (!session->GetDatabase().empty()) {
+		ReleaseDatabase(session->GetDatabase());
 	}
 
-	is_open_ = false;
+	session->GetEngine()->SetLocalContext(db->bpm, db->catalog, db->txn_manager);
+	session->SetDatabase(db_name);
+}
+
+void DatabaseManager::CloseSession(Session* session) {
+	// an open transaction is rolled back while the database is known to be open
+	session->ResetEngine();
+
+	std::lock_guard<std::mutex> lock(databases_latch_);
+	if (!session->GetDatabase().empty()) {
+		ReleaseDatabase(session->GetDatabase());
+	}
 }
 
 void DatabaseManager::FlushAllPages() {
-	if (!is_open_ || !bpm_) {
+	std::lock_guard<std::mutex> lock(databases_latch_);
+	if (databases_.empty()) {
 		throw std::runtime_error("Database is not open");
 	}
 
-	if (!bpm_->FlushAllPages()) {
-		throw std::runtime_error("Failed to flush all pages to disk");
+	for (auto& entry : databases_) {
+		if (!entry.second->bpm->FlushAllPages()) {
+			throw std::runtime_error("Failed to flush all pages to disk");
+		}
 	}
 }
 
 void DatabaseManager::Close() {
-	if (!is_open_) {
-		return;
-	}
+	// the console's open transaction rolls back first
+	delete executor_;
+	executor_ = nullptr;
+	current_ = nullptr;
 
-	try {
-		FlushAllPages();
-		Cleanup();
-	} catch (const std::exception& e) {
-		std::cerr << "Error during database close: " << e.what() << std::endl;
+	std::lock_guard<std::mutex> lock(databases_latch_);
+	for (auto& entry : databases_) {
+		CloseDatabase(entry.second.get());
 	}
+	databases_.clear();
 }
@@ -14,11 +14,29 @@
  *   - Resource coordination
  *
  * DatabaseManager
- * ├── DiskManager (disk I/O)
- * ├── BufferPoolManager (memory management)
- * ├── BufferPoolManager (memory management)
- * ├── CatalogManager (metadata management)
- * └── ExecutionManager (query execution)
+ * ├── BufferPool (frames shared by every open database)
+ * ├── Database, for every open database
+ * │   ├── DiskManager (disk I/O)
+ * │   ├── LogManager (write-ahead log, group commit)
+ * │   ├── CheckpointManager (fuzzy checkpoints, crash recovery runs on open)
+ * │   ├── TransactionManager (MVCC transactions, snapshot reads)
+ * │   ├── LockManager (row locks for writers, deadlock detection)
+ * │   ├── GarbageCollector (removes versions no snapshot can see)
+ * │   ├── BufferPoolManager (the database's view of the buffer pool)
+ * │   └── CatalogManager (metadata management)
+ * ├── ExecutionManager (query execution)
+ * └── NetworkManager (local console, TCP server with one engine per session)
+ *
+ * A database is opened by the first USE and stays open, so USE of an open database only points
+ * the engine at it. The console and every session of the TCP server have their own current
+ * database. At most MAX_DATABASES are open; opening one more closes a database no engine uses.
+ * DROP DATABASE closes the database first and fails while an engine uses it.
+ *
+ * Constructed with DiskMode::MMAP_READ_ONLY, every database is opened as a read-only snapshot: its file
+ * is mapped and queries read pages from the mapping, statements that write fail. The log is only
+ * read, to tell whether the database needs crash recovery, in which case it must be opened
+ * read-write first. No log manager, checkpoints or garbage collection run.
+ * With DiskMode::DIRECT database files bypass the page cache, the buffer pool is their only cache.
  */
 
 #pragma once
@@ -26,8 +44,13 @@
 #include "buffer/buffer_pool.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
+#include "concurrency/garbage_collector.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
 #include "engine/execution_engine.h"
 #include "network/network.h"
+#include "recovery/checkpoint_manager.h"
+#include "recovery/log_manager.h"
 #include "storage/disk_manager.h"
 
 #include <filesystem>
@@ -35,6 +58,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 namespace venus {
 namespace storage {
@@ -53,37 +77,81 @@ namespace engine {
 
 namespace venus {
 namespace database {
+	// components of one open database
+	struct Database {
+		std::string name;
+		storage::DiskManager* disk_manager = nullptr;
+		recovery::LogManager* log_manager = nullptr;
+		concurrency::LockManager* lock_manager = nullptr;
+		concurrency::TransactionManager* txn_manager = nullptr;
+		buffer::BufferPoolManager* bpm = nullptr;
+		recovery::CheckpointManager* checkpoint_manager = nullptr;
+		concurrency::GarbageCollector* garbage_collector = nullptr;
+		catalog::CatalogManager* catalog = nullptr;
+		size_t users = 0; // engines whose current database this is
+	};
+
 	class DatabaseManager {
 	public:
-		DatabaseManager();
+		explicit DatabaseManager(storage::DiskMode disk_mode = storage::DiskMode::READ_WRITE);
 
 		~DatabaseManager();
 
-		buffer::BufferPoolManager* GetBufferPoolManager() const { return bpm_; }
-		catalog::CatalogManager* GetCatalogManager() const { return catalog_; }
-		storage::DiskManager* GetDiskManager() const { return disk_manager_; }
+		// components of the console's current database, null before USE
+		buffer::BufferPoolManager* GetBufferPoolManager() const { return current_ ? current_->bpm : nullptr; }
+		catalog::CatalogManager* GetCatalogManager() const { return current_ ? current_->catalog : nullptr; }
+		storage::DiskManager* GetDiskManager() const { return current_ ? current_->disk_manager : nullptr; }
+		recovery::LogManager* GetLogManager() const { return current_ ? current_->log_manager : nullptr; }
+		concurrency::TransactionManager* GetTransactionManager() const { return current_ ? current_->txn_manager : nullptr; }
+		concurrency::LockManager* GetLockManager() const { return current_ ? current_->lock_manager : nullptr; }
+		recovery::CheckpointManager* GetCheckpointManager() const { return current_ ? current_->checkpoint_manager : nullptr; }
+		concurrency::GarbageCollector* GetGarbageCollector() const { return current_ ? current_->garbage_collector : nullptr; }
+		buffer::BufferPool* GetBufferPool() const { return buffer_pool_.get(); }
 		engine::ExecutionEngine* GetExecutionEngine() const { return executor_; }
+		network::NetworkManager* GetNetworkManager() const { return network_; }
 
-		bool IsOpen() const { return is_open_; }
+		bool IsOpen() const { return current_ != nullptr; }
+		bool IsReadOnly() const { return disk_mode_ == storage::DiskMode::MMAP_READ_ONLY; }
 		const std::string& GetDatabasePath() const { return db_path_; }
 
+		size_t GetOpenDatabaseCount();
+
+		// every open database
 		void FlushAllPages();
 		void Close();
 		void Start();
 
+		// starts the TCP server, or adds a listener to it, returns the bound port
+		uint16_t Serve(uint16_t port, bool loopback_only = false, network::Protocol protocol = network::Protocol::NATIVE);
+
 	private:
+		storage::DiskMode disk_mode_; // of every database opened
 		std::string db_path_;
-		bool is_open_;
+		Database* current_; // the console's
+
+		std::unique_ptr<buffer::BufferPool> buffer_pool_;
+		std::mutex databases_latch_; // protects databases_ and users of every database
+		std::unordered_map<std::string, std::unique_ptr<Database>> databases_;
 
-		storage::DiskManager* disk_manager_;
-		buffer::BufferPoolManager* bpm_;
-		catalog::CatalogManager* catalog_;
 		network::NetworkManager* network_;
 		engine::ExecutionEngine* executor_;
 
-		void Initialize(const std::string& db_path);
+		void Initialize(const std::string& db_name);
 		void InitializeExecutor();
-		void Cleanup();
+
+		// called with databases_latch_ held
+		Database* AcquireDatabase(const std::string& db_name);
+		void ReleaseDatabase(const std::string& db_name);
+		std::unique_ptr<Database> OpenDatabase(const std::string& db_name);
+		void CloseDatabase(Database* db);
+		void DropDatabase(const std::string& db_name);
+
+		// network sessions
+		std::unique_ptr<common::WorkerPool> scan_pool_; // shared by the sessions' executors
+
+		std::unique_ptr<engine::ExecutionEngine> OpenSession(network::Session* session);
+		void UseDatabase(network::Session* session, const std::string& db_name);
+		void CloseSession(network::Session* session);
 
 		DISALLOW_COPY_AND_MOVE(DatabaseManager);
 	};
@@ -15,6 +15,16 @@ namespace venus {
 namespace engine {
 
 	executor::ResultSet ExecutionEngine::Execute(const std::string& query) {
+		// resets the query arena once the statement's plan and executors are gone
+		struct ArenaReset {
+			common::Arena* arena;
+			~ArenaReset() {
+				if (arena != nullptr) {
+					arena->Reset();
+				}
+			}
+		} arena_reset { executor_.GetArena() };
+
 		try {
 			auto ast = parser_.Parse(query);
 
@@ -24,7 +34,13 @@ namespace engine {
 				return executor::ResultSet::Success("Database initialized: " + db_name);
 			}
 
+			if (ast->type == ASTNodeType::DROP_DATABASE && drop_db_callback_) {
+				drop_db_callback_(ast->value);
+			}
+
 			if (ast->type == ASTNodeType::EXIT) {
+				// the console's callback deletes this engine, and its arena with it
+				arena_reset.arena = nullptr;
 				stop_db_callback_();
 				return executor::ResultSet::Success("");
 			}
@@ -10,6 +10,9 @@
  * ExecutionEngine owns the REPL interface and coordinates query execution among parser, planner, and various executors
  * Will integrate with parser and planner once they are implemented
  *
+ * What a statement allocates from the executor's query arena (see Arena) is released when
+ * Execute returns, whether the statement succeeded or threw
+ *
  * Ownership
  * ExecutionEngine
  * ├── Parser (contains Lexer)
@@ -44,6 +47,9 @@ namespace venus {
 namespace engine {
 	class ExecutionEngine {
 	public:
+		// scan_pool is passed on to the executor, see Executor
+		explicit ExecutionEngine(common::WorkerPool* scan_pool = nullptr)
+		    : executor_(scan_pool) { }
 		~ExecutionEngine() = default;
 
 		void InitializeCallback(std::function<void(const std::string&)> cb) {
@@ -51,19 +57,29 @@ namespace engine {
 		}
 
 		void SetLocalContext(buffer::BufferPoolManager* bpm,
-		    catalog::CatalogManager* catalog) {
+		    catalog::CatalogManager* catalog,
+		    concurrency::TransactionManager* txn_manager = nullptr) {
 			bpm_ = bpm;
 			catalog_ = catalog;
-			binder_.SetContext(catalog);
-			executor_.SetContext(bpm, catalog);
+			executor_.SetContext(bpm, catalog, txn_manager);
+			binder_.SetContext(catalog, executor_.GetArena());
 		}
 
 		void SetStopDBCallback(std::function<void()> cb) {
 			stop_db_callback_ = std::move(cb);
 		}
 
+		// runs before DROP DATABASE removes the files, throws to refuse
+		void SetDropDBCallback(std::function<void(const std::string&)> cb) {
+			drop_db_callback_ = std::move(cb);
+		}
+
 		executor::ResultSet Execute(const std::string& query);
 
+		bool InTransaction() const { return executor_.InTransaction(); }
+
+		const common::Arena* GetQueryArena() const { return executor_.GetArena(); }
+
 	private:
 		buffer::BufferPoolManager* bpm_ = nullptr;
 		catalog::CatalogManager* catalog_ = nullptr;
@@ -75,6 +91,7 @@ namespace engine {
 
 		std::function<void(const std::string&)> init_callback_;
 		std::function<void()> stop_db_callback_;
+		std::function<void(const std::string&)> drop_db_callback_;
 	};
 } // namespace engine
 } // namespace venus
@@ -6,7 +6,94 @@
 namespace venus {
 namespace executor {
 
+	Executor::~Executor() {
+		// a transaction left open by the session is rolled back
+		if (in_transaction_) {
+			try {
+				context_->txn_manager_->Abort(context_->txn_);
+			} catch (const std::exception& e) {
+				LOG(e.what());
+			}
+		}
+		delete context_;
+	}
+
 	ResultSet Executor::ExecutePlan(const planner::PlanNode* plan) {
+		if (plan != nullptr
+		    && (plan->type_ == PlanNodeType::BEGIN || plan->type_ == PlanNodeType::COMMIT || plan->type_ == PlanNodeType::ROLLBACK)) {
+			return ExecuteTransactionControl(plan->type_);
+		}
+
+		if (context_ == nullptr || context_->txn_manager_ == nullptr) {
+			return RunPlan(plan);
+		}
+
+		concurrency::TransactionManager* txn_manager = context_->txn_manager_;
+		bool autocommit = !in_transaction_;
+		if (autocommit) {
+			context_->txn_ = txn_manager->Begin();
+		}
+
+		ResultSet result = RunPlan(plan);
+
+		try {
+			if (!result.success_) {
+				txn_manager->Abort(context_->txn_);
+				if (!autocommit) {
+					result.message_ += " (transaction rolled back)";
+				}
+			} else if (autocommit) {
+				txn_manager->Commit(context_->txn_);
+			}
+		} catch (const std::exception& e) {
+			result = ResultSet::Failure(std::string("Executor commit failed: ") + e.what());
+		}
+
+		if (autocommit || !result.success_) {
+			context_->txn_ = nullptr;
+			in_transaction_ = false;
+		}
+
+		return result;
+	}
+
+	ResultSet Executor::ExecuteTransactionControl(PlanNodeType type) {
+		if (context_ == nullptr || context_->txn_manager_ == nullptr) {
+			return ResultSet::Failure("Executor error: Transactions are not available, no database is open");
+		}
+
+		concurrency::TransactionManager* txn_manager = context_->txn_manager_;
+
+		if (type == PlanNodeType::BEGIN) {
+			if (in_transaction_) {
+				return ResultSet::Failure("Executor error: A transaction is already in progress");
+			}
+			context_->txn_ = txn_manager->Begin();
+			in_transaction_ = true;
+			return ResultSet::Success("Transaction started");
+		}
+
+		if (!in_transaction_) {
+			return ResultSet::Failure("Executor error: No transaction in progress");
+		}
+
+		concurrency::Transaction* txn = context_->txn_;
+		context_->txn_ = nullptr;
+		in_transaction_ = false;
+
+		try {
+			if (type == PlanNodeType::COMMIT) {
+				txn_manager->Commit(txn);
+				return ResultSet::Success("Transaction committed");
+			}
+			txn_manager->Abort(txn);
+			return ResultSet::Success("Transaction rolled back");
+		} catch (const std::exception& e) {
+			return ResultSet::Failure(std::string("Executor error: ") + e.what());
+		}
+	}
+
+	ResultSet Executor::RunPlan(const planner::PlanNode* plan) {
 		if (plan == nullptr) {
 			return ResultSet::Failure("Executor error: Plan node is null");
 		}
@@ -82,10 +169,32 @@ namespace executor {
 			if (p->children_.size() != 1) {
 				throw std::runtime_error("Projection expects exactly one child");
 			}
+
+			// Projection -> [Filter] -> SeqScan is fused into a single morsel-driven pipeline
+			const planner::PlanNode* child_plan = p->children_[0].get();
+			const planner::FilterPlanNode* filter_plan = nullptr;
+			if (child_plan->type_ == PlanNodeType::FILTER && child_plan->children_.size() == 1) {
+				filter_plan = static_cast<const planner::FilterPlanNode*>(child_plan);
+				child_plan = child_plan->children_[0].get();
+			}
+			if (child_plan->type_ == PlanNodeType::SEQ_SCAN) {
+				auto scan_plan = static_cast<const planner::SeqScanPlanNode*>(child_plan);
+				return std::make_unique<ParallelScanExecutor>(context_, scan_plan, filter_plan, p);
+			}
+
 			auto child = BuildExecutorTree(p->children_[0].get());
 			return std::make_unique<ProjectionExecutor>(context_, p, std::move(child));
 		}
 
+		case PlanNodeType::FILTER: {
+			auto p = static_cast<const planner::FilterPlanNode*>(plan);
+			if (p->children_.size() != 1) {
+				throw std::runtime_error("Filter expects exactly one child");
+			}
+			auto child = BuildExecutorTree(p->children_[0].get());
+			return std::make_unique<FilterExecutor>(context_, p, std::move(child));
+		}
+
 		case PlanNodeType::INSERT: {
 			auto p = static_cast<const planner::InsertPlanNode*>(plan);
 			return std::make_unique<InsertExecutor>(context_, p);
@@ -96,6 +205,24 @@ namespace executor {
 			return std::make_unique<BulkInsertExecutor>(context_, p);
 		}
 
+		case PlanNodeType::DELETE: {
+			auto p = static_cast<const planner::DeletePlanNode*>(plan);
+			if (p->children_.size() != 1) {
+				throw std::runtime_error("Delete expects exactly one child");
+			}
+			auto child = BuildExecutorTree(p->children_[0].get());
+			return std::make_unique<DeleteExecutor>(context_, p, std::move(child));
+		}
+
+		case PlanNodeType::UPDATE: {
+			auto p = static_cast<const planner::UpdatePlanNode*>(plan);
+			if (p->children_.size() != 1) {
+				throw std::runtime_error("Update expects exactly one child");
+			}
+			auto child = BuildExecutorTree(p->children_[0].get());
+			return std::make_unique<UpdateExecutor>(context_, p, std::move(child));
+		}
+
 		case PlanNodeType::CREATE_TABLE: {
 			auto p = static_cast<const planner::CreateTablePlanNode*>(plan);
 			return std::make_unique<CreateTableExecutor>(context_, p);
@@ -119,6 +246,11 @@ namespace executor {
 			return std::make_unique<ShowTablesExecutor>(context_, p);
 		}
 
+		case PlanNodeType::VACUUM: {
+			auto p = static_cast<const planner::VacuumPlanNode*>(plan);
+			return std::make_unique<VacuumExecutor>(context_, p);
+		}
+
 		default:
 			throw std::runtime_error("Executor: Unsupported plan node type");
 		}
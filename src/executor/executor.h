@@ -41,6 +41,7 @@
  *   - DropIndexExecutor      — DROP INDEX.
  *   - ShowDatabasesExecutor  — SHOW DATABASES.
  *   - ShowTablesExecutor     — SHOW TABLES.
+ *   - VacuumExecutor         — VACUUM FILE, VACUUM <table>.
  *   - HelpExecutor           — HELP command.
  *   - ExitExecutor           — EXIT command.
  *   - ExecFileExecutor       — EXEC <file>.
@@ -53,7 +54,10 @@
 
 #include "buffer/buffer_pool.h"
 #include "catalog/catalog.h"
+#include "common/arena.h"
 #include "common/types.h"
+#include "common/worker_pool.h"
+#include "concurrency/transaction_manager.h"
 #include "planner/planner.h"
 #include "storage/tuple.h"
 #include "table/table_heap.h"
@@ -166,26 +170,67 @@ namespace executor {
 	public:
 		catalog::CatalogManager* catalog_manager_;
 		buffer::BufferPoolManager* bpm_;
+		common::WorkerPool* worker_pool_; // intra-query parallelism, may be null
+		concurrency::TransactionManager* txn_manager_; // may be null
+		concurrency::Transaction* txn_; // transaction of the running statement, may be null
+		common::Arena* arena_; // memory of the running statement, owned by the Executor
 
-		ExecutorContext(catalog::CatalogManager* catalog, buffer::BufferPoolManager* bpm)
+		ExecutorContext(catalog::CatalogManager* catalog, buffer::BufferPoolManager* bpm, common::Arena* arena,
+		    common::WorkerPool* worker_pool = nullptr, concurrency::TransactionManager* txn_manager = nullptr)
 		    : catalog_manager_(catalog)
-		    , bpm_(bpm) { }
+		    , bpm_(bpm)
+		    , worker_pool_(worker_pool)
+		    , txn_manager_(txn_manager)
+		    , txn_(nullptr)
+		    , arena_(arena) { }
 	};
 
 	class Executor {
 	public:
-		Executor() = default;
+		// worker_pool is shared with other executors (one per network session), without one the
+		// executor starts its own
+		explicit Executor(common::WorkerPool* worker_pool = nullptr)
+		    : context_(nullptr)
+		    , worker_pool_(worker_pool)
+		    , in_transaction_(false) {
+			// the query thread is one of the scan workers
+			if (worker_pool_ == nullptr && SCAN_WORKER_THREADS > 1) {
+				owned_worker_pool_ = std::make_unique<common::WorkerPool>(SCAN_WORKER_THREADS - 1);
+				worker_pool_ = owned_worker_pool_.get();
+			}
+		}
 
-		// volcano driver
+		~Executor();
+
+		// runs the plan in the open explicit transaction, or as its own transaction that is
+		// committed (and durable) before the result is returned
+		// a failed statement rolls back the transaction it ran in
 		ResultSet ExecutePlan(const planner::PlanNode* plan);
 
-		void SetContext(buffer::BufferPoolManager* bpm, catalog::CatalogManager* catalog) {
-			context_ = new ExecutorContext(catalog, bpm);
+		bool InTransaction() const { return in_transaction_; }
+
+		void SetContext(buffer::BufferPoolManager* bpm, catalog::CatalogManager* catalog,
+		    concurrency::TransactionManager* txn_manager = nullptr) {
+			delete context_;
+			context_ = new ExecutorContext(catalog, bpm, &arena_, worker_pool_, txn_manager);
 		}
 
+		// the query arena, reset by the engine when a statement ends; SetContext (USE) keeps it
+		common::Arena* GetArena() { return &arena_; }
+		const common::Arena* GetArena() const { return &arena_; }
+
 	private:
+		common::Arena arena_; // declared before context_, which points to it
 		ExecutorContext* context_;
+		common::WorkerPool* worker_pool_;
+		std::unique_ptr<common::WorkerPool> owned_worker_pool_;
+		bool in_transaction_; // context_->txn_ was opened by BEGIN
+
+		// BEGIN / COMMIT / ROLLBACK
+		ResultSet ExecuteTransactionControl(PlanNodeType type);
 
+		// volcano driver
+		ResultSet RunPlan(const planner::PlanNode* plan);
 		std::unique_ptr<AbstractExecutor> BuildExecutorTree(const planner::PlanNode* plan);
 	};
 
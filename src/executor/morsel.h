@@ -0,0 +1,97 @@
+// /src/executor/morsel.h
+
+/**
+ * Morsel-driven scheduling for parallel scans
+ *
+ * A table heap's page chain is split into morsels - small contiguous ranges of pages.
+ * Morsels are dealt round-robin into one deque per worker.
+ * A worker pops morsels from the front of its own deque, and once that is empty it steals
+ * from the back of another worker's deque. Uneven work (filters that drop most rows on some pages,
+ * slow page fetches) is thereby balanced without a central queue every worker contends on.
+ *
+ * Each morsel carries its index in the page chain, so per-morsel results can be merged back
+ * in heap order and the output of a parallel scan matches the serial scan.
+ */
+
+#pragma once
+
+#include "common/config.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace venus {
+namespace executor {
+
+	struct Morsel {
+		size_t index; // position of the morsel in the page chain
+		size_t begin; // index of first page (into the page id list)
+		size_t end; // one past the last page
+	};
+
+	class MorselQueue {
+	public:
+		MorselQueue(size_t num_pages, size_t morsel_pages, size_t num_workers)
+		    : num_morsels_(0) {
+			if (morsel_pages == 0) {
+				morsel_pages = 1;
+			}
+			if (num_workers == 0) {
+				num_workers = 1;
+			}
+
+			for (size_t i = 0; i < num_workers; i++) {
+				queues_.push_back(std::make_unique<WorkerQueue>());
+			}
+
+			for (size_t begin = 0; begin < num_pages; begin += morsel_pages) {
+				size_t end = std::min(begin + morsel_pages, num_pages);
+				queues_[num_morsels_ % num_workers]->morsels.push_back({ num_morsels_, begin, end });
+				num_morsels_++;
+			}
+		}
+
+		// Next morsel for a worker: own queue first, then steal from the others
+		bool Next(size_t worker_id, Morsel* out) {
+			WorkerQueue& own = *queues_[worker_id % queues_.size()];
+			{
+				std::lock_guard<std::mutex> lock(own.mutex);
+				if (!own.morsels.empty()) {
+					*out = own.morsels.front();
+					own.morsels.pop_front();
+					return true;
+				}
+			}
+
+			for (size_t i = 1; i < queues_.size(); i++) {
+				WorkerQueue& victim = *queues_[(worker_id + i) % queues_.size()];
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (!victim.morsels.empty()) {
+					*out = victim.morsels.back();
+					victim.morsels.pop_back();
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		size_t GetNumMorsels() const { return num_morsels_; }
+
+	private:
+		struct WorkerQueue {
+			std::mutex mutex;
+			std::deque<Morsel> morsels;
+		};
+
+		std::vector<std::unique_ptr<WorkerQueue>> queues_;
+		size_t num_morsels_;
+
+		DISALLOW_COPY_AND_MOVE(MorselQueue);
+	};
+
+} // namespace executor
+} // namespace venus
@@ -9,7 +9,11 @@
 
 #pragma once
 
+#include "catalog/value.h"
+#include "common/worker_pool.h"
 #include "executor/executor.h"
+#include "executor/morsel.h"
+#include "executor/predicate.h"
 
 namespace venus {
 namespace executor {
@@ -33,12 +37,19 @@ namespace executor {
 				throw std::runtime_error("SeqScanExecutor::Open - Table schema is null");
 			}
 
-			table_heap_ = new table::TableHeap(
+			table_heap_ = context_->arena_->New<table::TableHeap>(
 			    context_->bpm_,
 			    plan_->table_ref_->GetSchema(),
 			    plan_->table_ref_->GetFirstPageId());
 
-			curr_iterator_ = std::make_unique<table::TableHeap::Iterator>(table_heap_->begin());
+			// a mapped database reads the chain straight from the file, let the kernel read ahead
+			if (context_->bpm_->IsMapped()) {
+				std::vector<page_id_t> page_ids = table_heap_->GetPageIds();
+				context_->bpm_->AdvisePages(page_ids.data(), page_ids.size(), storage::AccessHint::SEQUENTIAL);
+			}
+
+			// only versions visible to the statement's snapshot
+			curr_iterator_ = std::make_unique<table::TableHeap::Iterator>(table_heap_->begin(context_->txn_));
 			end_iterator_ = std::make_unique<table::TableHeap::Iterator>(table_heap_->end());
 			is_open_ = true;
 		}
@@ -62,8 +73,7 @@ namespace executor {
 
 			curr_iterator_.reset();
 			end_iterator_.reset();
-			delete table_heap_;
-			table_heap_ = nullptr;
+			table_heap_ = nullptr; // the query arena frees it
 			is_open_ = false;
 		}
 
@@ -75,6 +85,303 @@ namespace executor {
 		bool is_open_;
 	};
 
+	class FilterExecutor : public AbstractExecutor {
+	public:
+		FilterExecutor(ExecutorContext* context, const planner::FilterPlanNode* plan,
+		    std::unique_ptr<AbstractExecutor> child)
+		    : AbstractExecutor(context)
+		    , plan_(plan)
+		    , predicate_(plan->predicate_)
+		    , child_(std::move(child)) { }
+
+		void Open() override {
+			if (child_) {
+				child_->Open();
+			}
+		}
+
+		bool Next(OperatorOutput* out) override {
+			if (!child_) {
+				return false;
+			}
+
+			while (child_->Next(out)) {
+				if (out->type_ != OperatorOutput::OutputType::TUPLE) {
+					return true;
+				}
+				if (out->schema_ != nullptr && predicate_.Evaluate(out->tuple_, out->schema_)) {
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void Close() override {
+			if (child_) {
+				child_->Close();
+			}
+		}
+
+	private:
+		const planner::FilterPlanNode* plan_;
+		Predicate predicate_;
+		std::unique_ptr<AbstractExecutor> child_;
+	};
+
+	/**
+	 * Morsel-driven parallel scan
+	 *
+	 * Fuses SeqScan -> [Filter] -> [Projection] into one pipeline that every worker runs independently
+	 * over the morsels it takes from the MorselQueue. Each worker copies a page out of the buffer pool,
+	 * walks its live slots, applies the predicate and projects the surviving tuples into the
+	 * result buffer of that morsel. Nothing is shared between workers except the queue, so
+	 * per-row work needs no synchronization.
+	 *
+	 * Once all workers finish, Next() merges the per-morsel buffers in page-chain order.
+ * On a read-only mapped database the pages are read in place in the mapping, and each morsel is
+ * advised to the kernel (WILLNEED) when a worker takes it.
+	 * Heaps smaller than PARALLEL_SCAN_MIN_PAGES run the same pipeline on the query thread alone.
+	 * With a predicate, pages whose zone (see ZoneMap) cannot match are skipped.
+	 */
+	class ParallelScanExecutor : public AbstractExecutor {
+	public:
+		ParallelScanExecutor(ExecutorContext* context,
+		    const planner::SeqScanPlanNode* scan_plan,
+		    const planner::FilterPlanNode* filter_plan,
+		    const planner::ProjectionPlanNode* projection_plan)
+		    : AbstractExecutor(context)
+		    , scan_plan_(scan_plan)
+		    , filter_plan_(filter_plan)
+		    , projection_plan_(projection_plan)
+		    , table_schema_(nullptr)
+		    , output_schema_(nullptr)
+		    , zone_map_(nullptr)
+		    , morsel_idx_(0)
+		    , tuple_idx_(0) { }
+
+		void Open() override {
+			if (!scan_plan_->table_ref_ || !scan_plan_->table_ref_->GetSchema()) {
+				throw std::runtime_error("ParallelScanExecutor::Open - Table reference is null");
+			}
+
+			table_schema_ = scan_plan_->table_ref_->GetSchema();
+			output_schema_ = table_schema_;
+
+			if (filter_plan_) {
+				predicate_ = std::make_unique<Predicate>(filter_plan_->predicate_, table_schema_);
+				zone_map_ = scan_plan_->table_ref_->GetZoneMap();
+			}
+
+			if (projection_plan_) {
+				projected_schema_ = std::make_unique<Schema>();
+				for (size_t i = 0; i < projection_plan_->column_refs_.size(); i++) {
+					const std::string& name = projection_plan_->column_refs_[i].GetName();
+					if (!table_schema_->HasColumn(name)) {
+						throw std::runtime_error("ParallelScanExecutor: Column '" + name + "' not found in table schema");
+					}
+					const Column& col = table_schema_->GetColumn(name);
+					projected_schema_->AddColumn(col.GetName(), col.GetType(), col.IsPrimary(), i, static_cast<uint32_t>(col.GetMaxLength()));
+					projection_map_.push_back(static_cast<uint32_t>(col.GetOrdinalPosition()));
+				}
+				projector_ = RowProjector(*table_schema_, projection_map_);
+				output_schema_ = projected_schema_.get();
+			}
+
+			table::TableHeap table_heap(context_->bpm_, table_schema_, scan_plan_->table_ref_->GetFirstPageId());
+			std::vector<page_id_t> page_ids = table_heap.GetPageIds();
+
+			size_t num_workers = 1;
+			if (context_->worker_pool_ != nullptr && page_ids.size() >= PARALLEL_SCAN_MIN_PAGES) {
+				num_workers = SCAN_WORKER_THREADS;
+			}
+
+			MorselQueue queue(page_ids.size(), SCAN_MORSEL_PAGES, num_workers);
+			results_.assign(queue.GetNumMorsels(), {});
+
+			auto worker = [&](size_t worker_id) {
+				Morsel morsel;
+				while (queue.Next(worker_id, &morsel)) {
+					// mapped databases: the rest of the morsel is read in while its first pages are scanned
+					context_->bpm_->AdvisePages(&page_ids[morsel.begin], morsel.end - morsel.begin, storage::AccessHint::WILLNEED);
+					for (size_t i = morsel.begin; i < morsel.end; i++) {
+						ScanPage(page_ids[i], &results_[morsel.index]);
+					}
+				}
+			};
+
+			if (num_workers > 1) {
+				context_->worker_pool_->RunParallel(num_workers, worker);
+			} else {
+				worker(0);
+			}
+
+			morsel_idx_ = 0;
+			tuple_idx_ = 0;
+		}
+
+		bool Next(OperatorOutput* out) override {
+			while (morsel_idx_ < results_.size()) {
+				if (tuple_idx_ < results_[morsel_idx_].size()) {
+					out->SetResponse("", OperatorOutput::OutputType::TUPLE, true, results_[morsel_idx_][tuple_idx_++], output_schema_);
+					return true;
+				}
+				morsel_idx_++;
+				tuple_idx_ = 0;
+			}
+			return false;
+		}
+
+		void Close() override {
+			results_.clear();
+		}
+
+	private:
+		const planner::SeqScanPlanNode* scan_plan_;
+		const planner::FilterPlanNode* filter_plan_;
+		const planner::ProjectionPlanNode* projection_plan_;
+
+		const Schema* table_schema_;
+		const Schema* output_schema_;
+		std::unique_ptr<Schema> projected_schema_;
+		std::unique_ptr<Predicate> predicate_;
+		table::ZoneMap* zone_map_; // with a predicate only, may be null
+		std::vector<uint32_t> projection_map_; // output column -> table column
+		RowProjector projector_;
+
+		std::vector<std::vector<Tuple>> results_; // one buffer per morsel
+		size_t morsel_idx_;
+		size_t tuple_idx_;
+
+		// scan -> filter -> projection for a single page, runs on a worker thread
+		// the page is read in place under a shared latch, the predicate and the projection read the
+		// slots there and only qualifying tuples are copied out
+		// a page whose zone (or Bloom filter, for a point lookup) rules the predicate out is skipped
+		// without being latched or read, one without a zone gets it recorded
+		void ScanPage(page_id_t page_id, std::vector<Tuple>* out) const {
+			if (zone_map_ != nullptr) {
+				table::ColumnZone zone;
+				uint32_t column = predicate_->GetColumnIndex();
+				if (zone_map_->GetZone(page_id, column, &zone) && !predicate_->MayMatch(zone)) {
+					return;
+				}
+				if (predicate_->IsPointLookup() && !zone_map_->MayContain(page_id, column, predicate_->GetValueHash())) {
+					return;
+				}
+			}
+
+			buffer::PageGuard guard = context_->bpm_->FetchPageRead(page_id);
+			if (!guard) {
+				throw std::runtime_error("ParallelScanExecutor: Failed to read page " + std::to_string(page_id));
+			}
+
+			Page* page = guard.GetPage();
+			if (zone_map_ != nullptr && !zone_map_->HasZone(page_id)) {
+				zone_map_->Record(page_id, page);
+			}
+			if (page->IsColumnar()) {
+				ScanColumnarPage(page, page_id, out);
+				return;
+			}
+
+			for (slot_id_t slot_id = 0; slot_id < page->GetHeader()->num_slots; slot_id++) {
+				SlotDirectory* slot = page->GetSlotDirectory(slot_id);
+				if (slot == nullptr || !table::TableHeap::IsVisible(*slot, context_->txn_)) {
+					continue;
+				}
+
+				char* row = page->GetData() + slot->tuple_offset;
+				if (predicate_ && !predicate_->EvaluateRow(row)) {
+					continue;
+				}
+
+				if (projection_plan_) {
+					out->push_back(projector_.Project(row));
+				} else {
+					out->emplace_back(row, RID(page_id, slot_id));
+				}
+			}
+		}
+
+		// a columnar page is processed a column at a time: the visible slots are filtered by running
+		// the predicate down the minipage of its column, then the matches read only the minipages of
+		// the projected columns
+		void ScanColumnarPage(Page* page, page_id_t page_id, std::vector<Tuple>* out) const {
+			std::vector<slot_id_t> selected;
+			for (slot_id_t slot_id = 0; slot_id < page->GetHeader()->num_slots; slot_id++) {
+				SlotDirectory* slot = page->GetSlotDirectory(slot_id);
+				if (slot != nullptr && table::TableHeap::IsVisible(*slot, context_->txn_)) {
+					selected.push_back(slot_id);
+				}
+			}
+
+			std::vector<char> null_scratch;
+			uint16_t null_field = static_cast<uint16_t>(table_schema_->GetColumnCount());
+			const char* null_bits = page->GetValues(null_field, &null_scratch);
+			uint32_t null_width = page->GetMinipage(null_field).width;
+			if (predicate_) {
+				FilterColumn(page, null_bits, null_width, &selected);
+			}
+
+			char scratch[MAX_CHAR_LENGTH]; // the widest fixed width field
+			for (slot_id_t slot_id : selected) {
+				if (projection_plan_) {
+					auto field = [&](uint32_t column) {
+						return page->GetField(slot_id, static_cast<uint16_t>(column), scratch);
+					};
+					out->push_back(projector_.ProjectFields(field, null_bits + slot_id * null_width));
+				} else {
+					out->push_back(page->ReadTuple(slot_id, RID(page_id, slot_id)));
+				}
+			}
+		}
+
+		// keeps the selected slots whose field matches the predicate; a dictionary entry or a run of a
+		// compressed minipage is matched once for all of its rows, other encodings are decoded first
+		void FilterColumn(const Page* page, const char* null_bits, uint32_t null_width, std::vector<slot_id_t>* selected) const {
+			uint32_t column = predicate_->GetColumnIndex();
+			const Minipage& minipage = page->GetMinipage(static_cast<uint16_t>(column));
+			EncodedMinipage encoded(page->GetData() + minipage.offset, minipage.encoding, minipage.width);
+
+			std::vector<char> matches; // per entry or run
+			std::vector<char> scratch;
+			const char* values = nullptr;
+			if (minipage.encoding == ColumnEncoding::DICTIONARY) {
+				for (uint32_t code = 0; code < encoded.GetEntryCount(); code++) {
+					matches.push_back(predicate_->EvaluateValue(encoded.GetEntry(code), 0));
+				}
+			} else if (minipage.encoding == ColumnEncoding::RUN_LENGTH) {
+				for (uint32_t run = 0; run < encoded.GetRunCount(); run++) {
+					matches.push_back(predicate_->EvaluateValue(encoded.GetRunValue(run), 0));
+				}
+			} else {
+				values = page->GetValues(static_cast<uint16_t>(column), &scratch);
+			}
+
+			size_t kept = 0;
+			uint32_t run = 0; // slots are in order
+			for (slot_id_t slot_id : *selected) {
+				bool match;
+				if (Tuple::IsNull(null_bits + slot_id * null_width, 0, column)) {
+					match = predicate_->MatchesNull();
+				} else if (minipage.encoding == ColumnEncoding::DICTIONARY) {
+					match = matches[encoded.GetCode(slot_id)];
+				} else if (minipage.encoding == ColumnEncoding::RUN_LENGTH) {
+					while (encoded.GetRunEnd(run) <= slot_id) {
+						run++;
+					}
+					match = matches[run];
+				} else {
+					match = predicate_->EvaluateValue(values, slot_id * minipage.width);
+				}
+				if (match) {
+					(*selected)[kept++] = slot_id;
+				}
+			}
+			selected->resize(kept);
+		}
+	};
+
 	class ProjectionExecutor : public AbstractExecutor {
 	public:
 		ProjectionExecutor(ExecutorContext* context, const planner::ProjectionPlanNode* plan,
@@ -108,10 +415,34 @@ namespace executor {
 				throw std::runtime_error("ProjectionExecutor: child did not return a valid tuple");
 			}
 
-			const Schema* child_schema = child_out.schema_;
-			std::vector<const char*> values;
+			if (child_out.schema_ != child_schema_) {
+				Compile(child_out.schema_);
+			}
+
+			Tuple projected_tuple = projector_.Project(child_out.tuple_.GetData());
+			out->SetResponse("", OperatorOutput::OutputType::TUPLE, true, projected_tuple, output_schema_.get());
+
+			return true;
+		}
+
+		void Close() override {
+			if (child_) {
+				child_->Close();
+			}
+		}
+
+	private:
+		const planner::ProjectionPlanNode* plan_;
+		std::unique_ptr<AbstractExecutor> child_;
+
+		const Schema* child_schema_ = nullptr;
+		std::unique_ptr<Schema> output_schema_;
+		RowProjector projector_;
 
-			Schema* output_schema = new Schema();
+		// resolves the projected columns in the child schema once, rows are then copied by offset
+		void Compile(const Schema* child_schema) {
+			auto output_schema = std::make_unique<Schema>();
+			std::vector<uint32_t> columns;
 
 			for (size_t i = 0; i < plan_->column_refs_.size(); i++) {
 				const auto& col_ref = plan_->column_refs_[i];
@@ -120,36 +451,22 @@ namespace executor {
 				for (size_t j = 0; j < child_schema->GetColumnCount(); j++) {
 					const Column& child_col = child_schema->GetColumn(j);
 					if (child_col.GetName() == col_ref.GetName()) {
-						const char* value = child_out.tuple_.GetValue(j, child_schema);
-						values.push_back(value);
-
-						output_schema->AddColumn(child_col.GetName(), child_col.GetType(), child_col.IsPrimary(), i);
+						columns.push_back(static_cast<uint32_t>(j));
+						output_schema->AddColumn(child_col.GetName(), child_col.GetType(), child_col.IsPrimary(), i, static_cast<uint32_t>(child_col.GetMaxLength()));
 						found = true;
 						break;
 					}
 				}
 
 				if (!found) {
-					delete output_schema;
 					throw std::runtime_error("ProjectionExecutor: Column '" + col_ref.GetName() + "' not found in child schema");
 				}
 			}
 
-			Tuple projected_tuple(values, output_schema);
-			out->SetResponse("", OperatorOutput::OutputType::TUPLE, true, projected_tuple, output_schema);
-
-			return true;
+			projector_ = RowProjector(*child_schema, columns);
+			output_schema_ = std::move(output_schema);
+			child_schema_ = child_schema;
 		}
-
-		void Close() override {
-			if (child_) {
-				child_->Close();
-			}
-		}
-
-	private:
-		const planner::ProjectionPlanNode* plan_;
-		std::unique_ptr<AbstractExecutor> child_;
 	};
 
 	class InsertExecutor : public AbstractExecutor {
@@ -159,10 +476,11 @@ namespace executor {
 		    , plan_(plan) { }
 
 		void Open() override {
-			table_heap_ = new table::TableHeap(
+			table_heap_ = context_->arena_->New<table::TableHeap>(
 			    context_->bpm_,
 			    plan_->table_ref->GetSchema(),
-			    plan_->table_ref->GetFirstPageId());
+			    plan_->table_ref->GetFirstPageId(),
+			    plan_->table_ref->GetZoneMap());
 		}
 
 		bool Next(OperatorOutput* out) override {
@@ -171,12 +489,14 @@ namespace executor {
 			}
 
 			std::vector<std::string> insert_values;
+			std::vector<bool> nulls;
 			for (const ConstantType& v : plan_->values) {
 				insert_values.push_back(v.value);
+				nulls.push_back(v.is_null);
 			}
 
 			try {
-				if (table_heap_->InsertTuple(insert_values)) {
+				if (table_heap_->InsertTuple(insert_values, context_->txn_, nulls)) {
 					out->SetResponse("Inserted 1 row into " + plan_->table_ref->table_name, OperatorOutput::OutputType::MESSAGE, true);
 					return true;
 				} else {
@@ -203,40 +523,42 @@ namespace executor {
 		    , current_set_(0) { }
 
 		void Open() override {
-			table_heap_ = new table::TableHeap(
+			table_heap_ = context_->arena_->New<table::TableHeap>(
 			    context_->bpm_,
 			    plan_->table_ref->GetSchema(),
-			    plan_->table_ref->GetFirstPageId());
+			    plan_->table_ref->GetFirstPageId(),
+			    plan_->table_ref->GetZoneMap());
 			current_set_ = 0;
 		}
 
+		// inserts every row in one call, the only output is the message
 		bool Next(OperatorOutput* out) override {
 			if (plan_ == nullptr || current_set_ >= plan_->value_sets.size()) {
-				if (current_set_ > 0) {
-					out->SetResponse("Inserted " + std::to_string(current_set_) + " rows into " + plan_->table_ref->table_name, OperatorOutput::OutputType::MESSAGE, true);
-					current_set_++;
-					return true;
-				}
 				return false;
 			}
 
-			const auto& current_values = plan_->value_sets[current_set_];
-			std::vector<std::string> insert_values;
-			for (const ConstantType& v : current_values) {
-				insert_values.push_back(v.value);
-			}
+			while (current_set_ < plan_->value_sets.size()) {
+				const auto& current_values = plan_->value_sets[current_set_];
+				std::vector<std::string> insert_values;
+				std::vector<bool> nulls;
+				for (const ConstantType& v : current_values) {
+					insert_values.push_back(v.value);
+					nulls.push_back(v.is_null);
+				}
 
-			try {
-				if (table_heap_->InsertTuple(insert_values)) {
-					current_set_++;
-					return true; 
-				} else {
-					out->SetResponse("Failed to insert row " + std::to_string(current_set_ + 1) + " into " + plan_->table_ref->table_name, OperatorOutput::OutputType::MESSAGE, false);
-					return true;
+				try {
+					if (!table_heap_->InsertTuple(insert_values, context_->txn_, nulls)) {
+						out->SetResponse("Failed to insert row " + std::to_string(current_set_ + 1) + " into " + plan_->table_ref->table_name, OperatorOutput::OutputType::MESSAGE, false);
+						return true;
+					}
+				} catch (const std::exception& e) {
+					throw std::runtime_error("BulkInsertExecutor::Next - Failed to insert tuple " + std::to_string(current_set_ + 1) + ": " + std::string(e.what()));
 				}
-			} catch (const std::exception& e) {
-				throw std::runtime_error("BulkInsertExecutor::Next - Failed to insert tuple " + std::to_string(current_set_ + 1) + ": " + std::string(e.what()));
+				current_set_++;
 			}
+
+			out->SetResponse("Inserted " + std::to_string(current_set_) + " rows into " + plan_->table_ref->table_name, OperatorOutput::OutputType::MESSAGE, true);
+			return true;
 		}
 
 		void Close() override { }
@@ -247,6 +569,188 @@ namespace executor {
 		size_t current_set_;
 	};
 
+	/**
+	 * Delete and Update read all qualifying rows in Open() before changing anything,
+	 * so a row they write is never seen again by their own scan (Halloween problem).
+	 */
+	class DeleteExecutor : public AbstractExecutor {
+	public:
+		DeleteExecutor(ExecutorContext* context, const planner::DeletePlanNode* plan,
+		    std::unique_ptr<AbstractExecutor> child)
+		    : AbstractExecutor(context)
+		    , plan_(plan)
+		    , child_(std::move(child))
+		    , table_heap_(nullptr)
+		    , done_(false) { }
+
+		void Open() override {
+			rids_.clear();
+			done_ = false;
+
+			child_->Open();
+			OperatorOutput child_out;
+			while (child_->Next(&child_out)) {
+				if (child_out.type_ == OperatorOutput::OutputType::TUPLE) {
+					rids_.push_back(child_out.tuple_.GetRID());
+				}
+			}
+			child_->Close();
+
+			table_heap_ = context_->arena_->New<table::TableHeap>(
+			    context_->bpm_,
+			    plan_->table_ref->GetSchema(),
+			    plan_->table_ref->GetFirstPageId(),
+			    plan_->table_ref->GetZoneMap());
+		}
+
+		bool Next(OperatorOutput* out) override {
+			if (done_) {
+				return false;
+			}
+			done_ = true;
+
+			size_t deleted = 0;
+			for (const RID& rid : rids_) {
+				if (table_heap_->DeleteTuple(rid, context_->txn_)) {
+					deleted++;
+				}
+			}
+
+			out->SetResponse("Deleted " + std::to_string(deleted) + " rows from " + plan_->table_ref->table_name, OperatorOutput::OutputType::MESSAGE, true);
+			return true;
+		}
+
+		void Close() override {
+			rids_.clear();
+			table_heap_ = nullptr; // the query arena frees it
+		}
+
+	private:
+		const planner::DeletePlanNode* plan_;
+		std::unique_ptr<AbstractExecutor> child_;
+		table::TableHeap* table_heap_;
+		std::vector<RID> rids_;
+		bool done_;
+	};
+
+	class UpdateExecutor : public AbstractExecutor {
+	public:
+		UpdateExecutor(ExecutorContext* context, const planner::UpdatePlanNode* plan,
+		    std::unique_ptr<AbstractExecutor> child)
+		    : AbstractExecutor(context)
+		    , plan_(plan)
+		    , child_(std::move(child))
+		    , table_heap_(nullptr)
+		    , done_(false) { }
+
+		void Open() override {
+			tuples_.clear();
+			done_ = false;
+
+			const Schema* schema = plan_->table_ref->GetSchema();
+
+			// the SET literals in their on-page encoding, column -> bytes, no bytes for NULL
+			values_.clear();
+			for (const auto& assignment : plan_->assignments) {
+				if (assignment.second.is_null) {
+					values_.emplace_back(assignment.first.col_id, std::vector<char>());
+					continue;
+				}
+				const Column& column = schema->GetColumn(assignment.first.col_id);
+				std::vector<char> bytes(column.GetLength(), 0);
+				switch (column.GetType()) {
+				case ColumnType::INT:
+				case ColumnType::FLOAT:
+				case ColumnType::CHAR:
+				case ColumnType::BIGINT:
+				case ColumnType::DOUBLE:
+				case ColumnType::DATE:
+				case ColumnType::TIMESTAMP:
+					EncodeLiteral(column.GetType(), assignment.second.value, bytes.data());
+					break;
+				case ColumnType::VARCHAR: {
+					// a C string, the tuple is serialized again around it
+					const std::string& value = assignment.second.value;
+					bytes.assign(value.begin(), value.begin() + std::min(value.length(), column.GetMaxLength()));
+					bytes.push_back('\0');
+					break;
+				}
+				default:
+					throw std::runtime_error("UpdateExecutor: Unsupported column type");
+				}
+				values_.emplace_back(assignment.first.col_id, std::move(bytes));
+			}
+
+			child_->Open();
+			OperatorOutput child_out;
+			while (child_->Next(&child_out)) {
+				if (child_out.type_ == OperatorOutput::OutputType::TUPLE) {
+					tuples_.push_back(child_out.tuple_);
+				}
+			}
+			child_->Close();
+
+			table_heap_ = context_->arena_->New<table::TableHeap>(context_->bpm_, schema, plan_->table_ref->GetFirstPageId(), plan_->table_ref->GetZoneMap());
+		}
+
+		bool Next(OperatorOutput* out) override {
+			if (done_) {
+				return false;
+			}
+			done_ = true;
+
+			const Schema* schema = plan_->table_ref->GetSchema();
+			size_t updated = 0;
+
+			for (const Tuple& old_tuple : tuples_) {
+				Tuple new_tuple;
+				if (schema->HasVariableLength()) {
+					// VARCHAR values move when one before them changes length
+					std::vector<const char*> raw_values(schema->GetColumnCount());
+					for (size_t i = 0; i < raw_values.size(); i++) {
+						raw_values[i] = old_tuple.GetValue(static_cast<uint32_t>(i), schema);
+					}
+					for (const auto& value : values_) {
+						raw_values[value.first] = value.second.empty() ? nullptr : value.second.data();
+					}
+					new_tuple = Tuple(raw_values, schema);
+				} else {
+					std::vector<char> data(old_tuple.GetData(), old_tuple.GetData() + old_tuple.GetSize());
+					for (const auto& value : values_) {
+						char* field = data.data() + schema->GetOffset(value.first);
+						if (value.second.empty()) {
+							std::memset(field, 0, schema->GetColumn(value.first).GetLength());
+						} else {
+							std::memcpy(field, value.second.data(), value.second.size());
+						}
+						Tuple::SetNull(data.data(), schema->GetNullBitmapOffset(), value.first, value.second.empty());
+					}
+					new_tuple = Tuple(std::move(data), RID());
+				}
+
+				if (table_heap_->UpdateTuple(new_tuple, old_tuple.GetRID(), context_->txn_)) {
+					updated++;
+				}
+			}
+
+			out->SetResponse("Updated " + std::to_string(updated) + " rows in " + plan_->table_ref->table_name, OperatorOutput::OutputType::MESSAGE, true);
+			return true;
+		}
+
+		void Close() override {
+			tuples_.clear();
+			table_heap_ = nullptr; // the query arena frees it
+		}
+
+	private:
+		const planner::UpdatePlanNode* plan_;
+		std::unique_ptr<AbstractExecutor> child_;
+		table::TableHeap* table_heap_;
+		std::vector<std::pair<column_id_t, std::vector<char>>> values_;
+		std::vector<Tuple> tuples_;
+		bool done_;
+	};
+
 	class CreateTableExecutor : public AbstractExecutor {
 	public:
 		CreateTableExecutor(ExecutorContext* context, const planner::CreateTablePlanNode* plan)
@@ -257,7 +761,7 @@ namespace executor {
 
 		bool Next(OperatorOutput* out) override {
 			try {
-				context_->catalog_manager_->CreateTable(plan_->table_name_, &plan_->schema_);
+				context_->catalog_manager_->CreateTable(plan_->table_name_, &plan_->schema_, plan_->columnar_);
 				out->SetResponse("Table " + plan_->table_name_ + " created successfully.", OperatorOutput::OutputType::MESSAGE, true);
 				return false; 
 			} catch (const std::exception& e) {
@@ -302,6 +806,51 @@ namespace executor {
 		const planner::DropTablePlanNode* plan_;
 	};
 
+	// VACUUM FILE: free pages at the end of the database file are cut off
+	class VacuumExecutor : public AbstractExecutor {
+	public:
+		VacuumExecutor(ExecutorContext* context, const planner::VacuumPlanNode* plan)
+		    : AbstractExecutor(context)
+		    , plan_(plan) { }
+
+		void Open() override { }
+
+		bool Next(OperatorOutput* out) override {
+			try {
+				if (plan_->table_ref != nullptr) {
+					out->SetResponse(VacuumTable(), OperatorOutput::OutputType::MESSAGE, true);
+					return true;
+				}
+				uint32_t truncated = context_->bpm_->TruncateFreePages();
+				out->SetResponse("Truncated " + std::to_string(truncated) + " free pages", OperatorOutput::OutputType::MESSAGE, true);
+				return true;
+			} catch (const std::exception& e) {
+				throw std::runtime_error("VacuumExecutor::Next - Failed to vacuum: " + std::string(e.what()));
+			}
+		}
+
+		void Close() override { }
+
+	private:
+		const planner::VacuumPlanNode* plan_;
+
+		// reclaims the dead versions first so their space can take the moved rows; empty pages are
+		// unlinked by the garbage collector once this statement has committed
+		std::string VacuumTable() {
+			if (context_->txn_manager_ == nullptr || context_->txn_ == nullptr) {
+				throw std::runtime_error("VACUUM of a table needs a transaction");
+			}
+
+			table::TableHeap table_heap(context_->bpm_, plan_->table_ref->GetSchema(), plan_->table_ref->GetFirstPageId(), plan_->table_ref->GetZoneMap());
+			size_t reclaimed = table_heap.CollectGarbage(context_->txn_manager_->GetGCHorizon());
+			size_t moved = table_heap.MergePages(context_->txn_);
+			context_->txn_manager_->AddGarbageTable(plan_->table_ref->GetFirstPageId());
+
+			return "Vacuumed " + plan_->table_ref->table_name + ": reclaimed " + std::to_string(reclaimed) + " versions, moved "
+			    + std::to_string(moved) + " rows";
+		}
+	};
+
 	class ShowTablesExecutor : public AbstractExecutor {
 	public:
 		ShowTablesExecutor(ExecutorContext* context, const planner::ShowTablesPlanNode* plan)
@@ -310,7 +859,7 @@ namespace executor {
 		    , seq_scan_executor_(nullptr)
 		    , seq_scan_plan_(nullptr)
 		    , output_schema_(nullptr) {
-			output_schema_ = new Schema();
+			output_schema_ = context_->arena_->New<Schema>();
 			output_schema_->AddColumn("table_name", ColumnType::CHAR, false, 0);
 		}
 
@@ -319,7 +868,7 @@ namespace executor {
 				return;
 			}
 
-			TableRef* master_tables_ref = context_->catalog_manager_->GetTableRef("master_tables");
+			TableRef* master_tables_ref = context_->catalog_manager_->GetTableRef("master_tables", context_->arena_);
 			if (!master_tables_ref) {
 				throw std::runtime_error("master_tables not found in catalog");
 			}
@@ -365,17 +914,11 @@ namespace executor {
 			seq_scan_plan_.reset();
 		}
 
-		~ShowTablesExecutor() {
-			if (output_schema_) {
-				delete output_schema_;
-			}
-		}
-
 	private:
 		const planner::ShowTablesPlanNode* plan_;
 		std::unique_ptr<SeqScanExecutor> seq_scan_executor_;
 		std::unique_ptr<planner::SeqScanPlanNode> seq_scan_plan_;
-		Schema* output_schema_;
+		Schema* output_schema_; // in the query arena
 	};
 
 	class DatabaseOpExecutor : public AbstractExecutor {
@@ -409,9 +952,10 @@ namespace executor {
 			}
 
 			case PlanNodeType::DROP_DATABASE: {
-				// delete that file
+				// delete that file and its log
 				if (std::filesystem::exists(db_path)) {
 					std::filesystem::remove(db_path);
+					std::filesystem::remove(std::string(venus::DATABASE_DIRECTORY) + "/" + db_name + ".log");
 					out->SetResponse("Ok", OperatorOutput::OutputType::MESSAGE, true);
 				} else {
 					out->SetResponse("Database does not exist: " + db_name, OperatorOutput::OutputType::MESSAGE, false);
@@ -0,0 +1,338 @@
+// /src/executor/predicate.h
+
+/**
+ * Predicate evaluates a bound WHERE condition (column <op> literal, or column IS [NOT] NULL)
+ * against a tuple.
+ *
+ * The literal is converted to the column's native type once at construction,
+ * so evaluating a tuple is a single typed comparison instead of re-parsing the literal per row;
+ * a DATE or TIMESTAMP range is an integer comparison.
+ * The comparison itself is a Match kernel instantiated for the column type and operator, picked at
+ * construction too; per row there is one indirect call and no switch.
+ *
+ * A comparison with a NULL field is never true. The kernels test the field's null bit first, its
+ * byte and mask are resolved with the offset, so a NULL costs one load and no branch on the type.
+ *
+ * Given the schema of the rows, the column offset is cached and EvaluateRow reads serialized rows,
+ * e.g. straight from a page, without building a Tuple. Where a field's null bit is kept apart from
+ * it (a columnar page), the caller tests the bit and EvaluateValue matches a value that is not NULL;
+ * an encoded minipage is filtered by matching each dictionary entry or run once.
+ * MayMatch tests a page's zone (the min and max of the column) the same way, with the typed kernels
+ * applied to its bounds. An equality on a fixed width column also hashes its literal once, for
+ * the pages' Bloom filters.
+ *
+ * Predicates are immutable after construction and safe to share across scan worker threads.
+ */
+
+#pragma once
+
+#include "catalog/schema.h"
+#include "catalog/value.h"
+#include "common/types.h"
+#include "executor/tuple_accessor.h"
+#include "storage/tuple.h"
+#include "table/zone_map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace venus {
+namespace executor {
+
+	class Predicate {
+	public:
+		enum class CompareOp : uint8_t {
+			EQ,
+			NE,
+			LT,
+			GT,
+			LE,
+			GE,
+			IS_NULL,
+			IS_NOT_NULL
+		};
+
+		explicit Predicate(const Expression& expr, const Schema* schema = nullptr)
+		    : col_idx_(expr.left.col_id)
+		    , offset_(0)
+		    , null_offset_(0)
+		    , null_mask_(static_cast<uint8_t>(1u << (expr.left.col_id % 8)))
+		    , type_(expr.right.type)
+		    , op_(ParseOp(expr.op))
+		    , int_value_(0)
+		    , float_value_(0.0f)
+		    , bigint_value_(0)
+		    , double_value_(0.0)
+		    , kernel_(nullptr)
+		    , value_kernel_(nullptr)
+		    , zone_kernel_(nullptr)
+		    , value_hash_(0) {
+			if (op_ == CompareOp::IS_NULL) {
+				kernel_ = &MatchNull<true>;
+				value_kernel_ = &MatchNotNull<true>;
+			} else if (op_ == CompareOp::IS_NOT_NULL) {
+				kernel_ = &MatchNull<false>;
+				value_kernel_ = &MatchNotNull<false>;
+			} else {
+				switch (type_) {
+				case ColumnType::INT:
+					int_value_ = std::stoi(expr.right.value);
+					SelectKernels<ColumnType::INT>();
+					break;
+				case ColumnType::FLOAT:
+					float_value_ = std::stof(expr.right.value);
+					SelectKernels<ColumnType::FLOAT>();
+					break;
+				case ColumnType::CHAR:
+					char_value_ = expr.right.value;
+					SelectKernels<ColumnType::CHAR>();
+					break;
+				case ColumnType::VARCHAR:
+					char_value_ = expr.right.value;
+					SelectKernels<ColumnType::VARCHAR>();
+					break;
+				case ColumnType::BIGINT:
+					bigint_value_ = std::stoll(expr.right.value);
+					SelectKernels<ColumnType::BIGINT>();
+					break;
+				case ColumnType::DOUBLE:
+					double_value_ = std::stod(expr.right.value);
+					SelectKernels<ColumnType::DOUBLE>();
+					break;
+				case ColumnType::DATE:
+					int_value_ = ParseDate(expr.right.value);
+					SelectKernels<ColumnType::DATE>();
+					break;
+				case ColumnType::TIMESTAMP:
+					bigint_value_ = ParseTimestamp(expr.right.value);
+					SelectKernels<ColumnType::TIMESTAMP>();
+					break;
+				default:
+					throw std::runtime_error("Predicate: Unsupported column type");
+				}
+			}
+
+			if (op_ == CompareOp::EQ && type_ != ColumnType::VARCHAR) {
+				value_hash_ = HashLiteral();
+			}
+
+			if (schema != nullptr) {
+				if (col_idx_ >= schema->GetColumnCount()) {
+					throw std::runtime_error("Predicate: Column index out of range");
+				}
+				offset_ = schema->GetOffset(col_idx_);
+				null_offset_ = NullByte(*schema);
+			}
+		}
+
+		bool Evaluate(const Tuple& tuple, const Schema* schema) const {
+			if (col_idx_ >= schema->GetColumnCount() || tuple.GetSize() == 0) {
+				return false;
+			}
+			return kernel_(tuple.GetData(), schema->GetOffset(col_idx_), NullByte(*schema), *this);
+		}
+
+		// row: a serialized tuple of the schema given at construction
+		bool EvaluateRow(const char* row) const {
+			return kernel_(row, offset_, null_offset_, *this);
+		}
+
+		// whether a NULL field matches (only IS NULL does)
+		bool MatchesNull() const { return op_ == CompareOp::IS_NULL; }
+
+		// a field known not to be NULL, its value at row + offset
+		bool EvaluateValue(const char* row, uint32_t offset) const {
+			return value_kernel_(row, offset, *this);
+		}
+
+		// false if no row of a page with this zone of the column can match
+		bool MayMatch(const table::ColumnZone& zone) const {
+			if (op_ == CompareOp::IS_NULL) {
+				return zone.has_nulls;
+			}
+			if (op_ == CompareOp::IS_NOT_NULL) {
+				return zone.has_values;
+			}
+			return zone.has_values && zone_kernel_(zone, *this);
+		}
+
+		// column = literal on a fixed width column, GetValueHash is the literal's ZoneMap::HashValue
+		bool IsPointLookup() const { return op_ == CompareOp::EQ && type_ != ColumnType::VARCHAR; }
+		uint64_t GetValueHash() const { return value_hash_; }
+
+		uint32_t GetColumnIndex() const { return col_idx_; }
+
+	private:
+		using Kernel = bool (*)(const char* row, uint32_t offset, uint32_t null_offset, const Predicate& predicate);
+		using ValueKernel = bool (*)(const char* row, uint32_t offset, const Predicate& predicate);
+		using ZoneKernel = bool (*)(const table::ColumnZone& zone, const Predicate& predicate);
+
+		uint32_t col_idx_;
+		uint32_t offset_;
+		uint32_t null_offset_; // byte of the column's null bit
+		uint8_t null_mask_;
+		ColumnType type_;
+		CompareOp op_;
+
+		int int_value_; // INT, DATE
+		float float_value_;
+		int64_t bigint_value_; // BIGINT, TIMESTAMP
+		double double_value_;
+		std::string char_value_;
+
+		Kernel kernel_;
+		ValueKernel value_kernel_;
+		ZoneKernel zone_kernel_;
+		uint64_t value_hash_;
+
+		template <CompareOp Op, typename T>
+		static bool Compare(const T& lhs, const T& rhs) {
+			if constexpr (Op == CompareOp::EQ) {
+				return lhs == rhs;
+			} else if constexpr (Op == CompareOp::NE) {
+				return lhs != rhs;
+			} else if constexpr (Op == CompareOp::LT) {
+				return lhs < rhs;
+			} else if constexpr (Op == CompareOp::GT) {
+				return lhs > rhs;
+			} else if constexpr (Op == CompareOp::LE) {
+				return lhs <= rhs;
+			} else {
+				return lhs >= rhs;
+			}
+		}
+
+		// the literal laid out as the column stores it
+		uint64_t HashLiteral() const {
+			char value[MAX_CHAR_LENGTH] = {};
+			switch (type_) {
+			case ColumnType::INT:
+			case ColumnType::DATE:
+				std::memcpy(value, &int_value_, sizeof(int_value_));
+				break;
+			case ColumnType::FLOAT:
+				std::memcpy(value, &float_value_, sizeof(float_value_));
+				break;
+			case ColumnType::BIGINT:
+			case ColumnType::TIMESTAMP:
+				std::memcpy(value, &bigint_value_, sizeof(bigint_value_));
+				break;
+			case ColumnType::DOUBLE:
+				std::memcpy(value, &double_value_, sizeof(double_value_));
+				break;
+			default:
+				std::memcpy(value, char_value_.data(), std::min(char_value_.size(), static_cast<size_t>(MAX_CHAR_LENGTH)));
+				break;
+			}
+			return table::ZoneMap::HashValue(type_, value);
+		}
+
+		uint32_t NullByte(const Schema& schema) const {
+			return schema.GetNullBitmapOffset() + col_idx_ / 8;
+		}
+
+		template <ColumnType T, CompareOp Op>
+		static bool Match(const char* row, uint32_t offset, uint32_t null_offset, const Predicate& predicate) {
+			if (row[null_offset] & predicate.null_mask_) {
+				return false;
+			}
+			return MatchValue<T, Op>(row, offset, predicate);
+		}
+
+		template <ColumnType T, CompareOp Op>
+		static bool MatchValue(const char* row, uint32_t offset, const Predicate& predicate) {
+			auto value = ReadColumn<T>(row, offset);
+			if constexpr (T == ColumnType::INT || T == ColumnType::DATE) {
+				return Compare<Op>(value, predicate.int_value_);
+			} else if constexpr (T == ColumnType::FLOAT) {
+				return Compare<Op>(value, predicate.float_value_);
+			} else if constexpr (T == ColumnType::BIGINT || T == ColumnType::TIMESTAMP) {
+				return Compare<Op>(value, predicate.bigint_value_);
+			} else if constexpr (T == ColumnType::DOUBLE) {
+				return Compare<Op>(value, predicate.double_value_);
+			} else if constexpr (T == ColumnType::CHAR) {
+				return Compare<Op>(std::strncmp(value, predicate.char_value_.c_str(), MAX_CHAR_LENGTH), 0);
+			} else {
+				return Compare<Op>(std::strcmp(value, predicate.char_value_.c_str()), 0);
+			}
+		}
+
+		template <bool IsNull>
+		static bool MatchNull(const char* row, uint32_t, uint32_t null_offset, const Predicate& predicate) {
+			return ((row[null_offset] & predicate.null_mask_) != 0) == IsNull;
+		}
+
+		// some value between min and max may match
+		template <ColumnType T, CompareOp Op>
+		static bool MatchZone(const table::ColumnZone& zone, const Predicate& predicate) {
+			if constexpr (T == ColumnType::VARCHAR) {
+				return true; // no zone
+			} else if constexpr (Op == CompareOp::EQ) {
+				return MatchValue<T, CompareOp::LE>(zone.min, 0, predicate) && MatchValue<T, CompareOp::GE>(zone.max, 0, predicate);
+			} else if constexpr (Op == CompareOp::NE) {
+				return !(MatchValue<T, CompareOp::EQ>(zone.min, 0, predicate) && MatchValue<T, CompareOp::EQ>(zone.max, 0, predicate));
+			} else if constexpr (Op == CompareOp::LT || Op == CompareOp::LE) {
+				return MatchValue<T, Op>(zone.min, 0, predicate);
+			} else {
+				return MatchValue<T, Op>(zone.max, 0, predicate);
+			}
+		}
+
+		template <bool IsNull>
+		static bool MatchNotNull(const char*, uint32_t, const Predicate&) {
+			return !IsNull;
+		}
+
+		template <ColumnType T, CompareOp Op>
+		void SetKernels() {
+			kernel_ = &Match<T, Op>;
+			value_kernel_ = &MatchValue<T, Op>;
+			zone_kernel_ = &MatchZone<T, Op>;
+		}
+
+		template <ColumnType T>
+		void SelectKernels() {
+			switch (op_) {
+			case CompareOp::EQ:
+				return SetKernels<T, CompareOp::EQ>();
+			case CompareOp::NE:
+				return SetKernels<T, CompareOp::NE>();
+			case CompareOp::LT:
+				return SetKernels<T, CompareOp::LT>();
+			case CompareOp::GT:
+				return SetKernels<T, CompareOp::GT>();
+			case CompareOp::LE:
+				return SetKernels<T, CompareOp::LE>();
+			case CompareOp::GE:
+				return SetKernels<T, CompareOp::GE>();
+			default:
+				break;
+			}
+			throw std::runtime_error("Predicate: Unsupported operator");
+		}
+
+		static CompareOp ParseOp(const std::string& op) {
+			if (op == "=")
+				return CompareOp::EQ;
+			if (op == "!=")
+				return CompareOp::NE;
+			if (op == "<")
+				return CompareOp::LT;
+			if (op == ">")
+				return CompareOp::GT;
+			if (op == "<=")
+				return CompareOp::LE;
+			if (op == ">=")
+				return CompareOp::GE;
+			if (op == "IS NULL")
+				return CompareOp::IS_NULL;
+			if (op == "IS NOT NULL")
+				return CompareOp::IS_NOT_NULL;
+			throw std::runtime_error("Predicate: Unsupported operator '" + op + "'");
+		}
+	};
+
+} // namespace executor
+} // namespace venus
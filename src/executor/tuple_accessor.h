@@ -0,0 +1,195 @@
+// /src/executor/tuple_accessor.h
+
+/**
+ * Typed field access for executor inner loops.
+ *
+ * Every column has a fixed width slot, so a column of a schema sits at the same offset in every
+ * row. Operators resolve column types once, when they are opened, by picking a template
+ * instantiation; per row they only load from row + offset, without switching on ColumnType.
+ * A VARCHAR is one more load, its slot gives where the value is in the row. Whether a value is
+ * NULL is a bit test at a fixed offset too (the null bitmap follows the column slots).
+ *
+ * ColumnTraits<T> - the C++ type a column of type T is read as
+ * ReadColumn<T>   - loads a field at a fixed offset of a serialized row
+ * RowProjector    - copies a list of columns of one schema into rows of the projected schema,
+ *                   adjacent fixed width columns are copied as one run; or, for rows split into
+ *                   minipages, each column from wherever its field is
+ */
+
+#pragma once
+
+#include "catalog/schema.h"
+#include "common/types.h"
+#include "storage/tuple.h"
+
+#include <cstring>
+#include <vector>
+
+namespace venus {
+namespace executor {
+
+	template <ColumnType T>
+	struct ColumnTraits;
+
+	template <>
+	struct ColumnTraits<ColumnType::INT> {
+		using value_type = int;
+	};
+
+	template <>
+	struct ColumnTraits<ColumnType::FLOAT> {
+		using value_type = float;
+	};
+
+	template <>
+	struct ColumnTraits<ColumnType::BIGINT> {
+		using value_type = int64_t;
+	};
+
+	template <>
+	struct ColumnTraits<ColumnType::DOUBLE> {
+		using value_type = double;
+	};
+
+	// days since 1970-01-01
+	template <>
+	struct ColumnTraits<ColumnType::DATE> {
+		using value_type = int32_t;
+	};
+
+	// microseconds since 1970-01-01 00:00:00
+	template <>
+	struct ColumnTraits<ColumnType::TIMESTAMP> {
+		using value_type = int64_t;
+	};
+
+	// CHAR fields are read in place, NUL padded to MAX_CHAR_LENGTH
+	template <>
+	struct ColumnTraits<ColumnType::CHAR> {
+		using value_type = const char*;
+	};
+
+	// VARCHAR values are read in place, NUL terminated
+	template <>
+	struct ColumnTraits<ColumnType::VARCHAR> {
+		using value_type = const char*;
+	};
+
+	// row: the start of the tuple, its size header included
+	template <ColumnType T>
+	inline typename ColumnTraits<T>::value_type ReadColumn(const char* row, uint32_t offset) {
+		if constexpr (T == ColumnType::CHAR) {
+			return row + offset;
+		} else if constexpr (T == ColumnType::VARCHAR) {
+			VarcharSlot slot;
+			std::memcpy(&slot, row + offset, sizeof(slot));
+			return row + slot.offset;
+		} else {
+			typename ColumnTraits<T>::value_type value;
+			std::memcpy(&value, row + offset, sizeof(value));
+			return value;
+		}
+	}
+
+	class RowProjector {
+	public:
+		RowProjector() = default;
+
+		// columns: input column index of every output column
+		RowProjector(const Schema& input, const std::vector<uint32_t>& columns)
+		    : columns_(columns)
+		    , in_bitmap_(input.GetNullBitmapOffset())
+		    , tuple_size_(sizeof(uint32_t)) {
+			for (uint32_t column : columns) {
+				uint32_t offset = input.GetOffset(column);
+				uint32_t length = static_cast<uint32_t>(input.GetColumn(column).GetLength());
+				fields_.push_back({ offset, tuple_size_, length });
+				if (input.GetColumn(column).IsVariableLength()) {
+					varchars_.push_back({ offset, tuple_size_, length });
+				} else if (!runs_.empty() && runs_.back().from + runs_.back().length == offset
+				    && runs_.back().to + runs_.back().length == tuple_size_) {
+					runs_.back().length += length;
+				} else {
+					runs_.push_back({ offset, tuple_size_, length });
+				}
+				tuple_size_ += length;
+			}
+			out_bitmap_ = tuple_size_;
+			tuple_size_ += static_cast<uint32_t>((columns.size() + 7) / 8);
+		}
+
+		Tuple Project(const char* row) const {
+			uint32_t size = tuple_size_;
+			for (const Run& varchar : varchars_) {
+				VarcharSlot slot = ReadSlot(row, varchar.from);
+				size += slot.offset != 0 ? slot.length + 1u : 0;
+			}
+
+			std::vector<char> data(size);
+			std::memcpy(data.data(), &size, sizeof(uint32_t));
+			for (const Run& run : runs_) {
+				std::memcpy(data.data() + run.to, row + run.from, run.length);
+			}
+			for (uint32_t i = 0; i < columns_.size(); i++) {
+				if (Tuple::IsNull(row, in_bitmap_, columns_[i])) {
+					Tuple::SetNull(data.data(), out_bitmap_, i, true);
+				}
+			}
+
+			// VARCHAR values are appended in output column order, a NULL keeps the slot (0, 0)
+			uint32_t var_offset = tuple_size_;
+			for (const Run& varchar : varchars_) {
+				VarcharSlot slot = ReadSlot(row, varchar.from);
+				if (slot.offset == 0) {
+					continue;
+				}
+				std::memcpy(data.data() + var_offset, row + slot.offset, slot.length + 1u);
+				slot.offset = static_cast<uint16_t>(var_offset);
+				std::memcpy(data.data() + varchar.to, &slot, sizeof(slot));
+				var_offset += slot.length + 1u;
+			}
+			return Tuple(std::move(data), RID());
+		}
+
+		// a row of fixed width columns whose fields are apart, e.g. on a columnar page:
+		// field(column) is where the value of an input column is, null_bits the row's null bitmap
+		template <typename FieldOf>
+		Tuple ProjectFields(FieldOf field, const char* null_bits) const {
+			std::vector<char> data(tuple_size_);
+			std::memcpy(data.data(), &tuple_size_, sizeof(uint32_t));
+			for (uint32_t i = 0; i < columns_.size(); i++) {
+				std::memcpy(data.data() + fields_[i].to, field(columns_[i]), fields_[i].length);
+				if (Tuple::IsNull(null_bits, 0, columns_[i])) {
+					Tuple::SetNull(data.data(), out_bitmap_, i, true);
+				}
+			}
+			return Tuple(std::move(data), RID());
+		}
+
+		// size of the fixed part of the projected rows
+		uint32_t GetTupleSize() const { return tuple_size_; }
+
+	private:
+		struct Run {
+			uint32_t from; // offset in the input row
+			uint32_t to; // offset in the output row
+			uint32_t length;
+		};
+
+		std::vector<Run> runs_;
+		std::vector<Run> varchars_; // slots of the projected VARCHAR columns
+		std::vector<Run> fields_; // every projected column, in output order
+		std::vector<uint32_t> columns_;
+		uint32_t in_bitmap_ = 0;
+		uint32_t out_bitmap_ = sizeof(uint32_t);
+		uint32_t tuple_size_ = sizeof(uint32_t);
+
+		static VarcharSlot ReadSlot(const char* row, uint32_t offset) {
+			VarcharSlot slot;
+			std::memcpy(&slot, row + offset, sizeof(slot));
+			return slot;
+		}
+	};
+
+} // namespace executor
+} // namespace venus
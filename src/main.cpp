@@ -1,10 +1,119 @@
 // src/main.cpp
 
 #include "database/database_manager.h"
+#include "network/client.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
 
 using namespace venus::database;
 
-int main() {
-	DatabaseManager db_manager;
-	db_manager.Start();
-}
\ No newline at end of file
+namespace {
+
+	uint16_t ParsePort(const char* value) {
+		int port = std::stoi(value);
+		if (port < 0 || port > 65535) {
+			throw std::invalid_argument("invalid port " + std::string(value));
+		}
+		return static_cast<uint16_t>(port);
+	}
+
+	// venus --connect [host:]port, the console runs against a server
+	int RunClient(const std::string& target) {
+		std::string host = "127.0.0.1";
+		std::string port = target;
+		size_t colon = target.rfind(':');
+		if (colon != std::string::npos) {
+			host = target.substr(0, colon);
+			port = target.substr(colon + 1);
+		}
+
+		venus::network::Client client;
+		client.Connect(host, ParsePort(port.c_str()));
+
+		venus::network::NetworkManager console;
+		console.SetExecuteCallback([&](const std::string& query) {
+			auto result = client.Query(query);
+			if (!client.IsConnected()) {
+				console.Stop();
+				// the server ends the session on EXIT
+				std::string statement = query;
+				std::transform(statement.begin(), statement.end(), statement.begin(), ::toupper);
+				if (statement == "EXIT") {
+					return venus::executor::ResultSet::Success("");
+				}
+			}
+			return result;
+		});
+		console.Start();
+		return 0;
+	}
+
+} // namespace
+
+// venus                     local console
+// venus --listen [port]     TCP server, DEFAULT_PORT if no port is given
+// venus --pg [port]         PostgreSQL protocol server, POSTGRES_DEFAULT_PORT if no port is given
+//                           --listen and --pg can be combined
+// venus --binary file       local console, results are written to file as protocol frames
+// venus --connect [host:]port
+// venus --read-only ...     any of the above but --connect, databases are mapped read only
+// venus --direct ...        any of the above but --connect, database files are opened with O_DIRECT
+int main(int argc, char** argv) {
+	try {
+		if (argc >= 3 && std::strcmp(argv[1], "--connect") == 0) {
+			return RunClient(argv[2]);
+		}
+
+		int first = 1;
+		venus::storage::DiskMode disk_mode = venus::storage::DiskMode::READ_WRITE;
+		if (argc >= 2 && std::strcmp(argv[1], "--read-only") == 0) {
+			disk_mode = venus::storage::DiskMode::MMAP_READ_ONLY;
+			first = 2;
+		} else if (argc >= 2 && std::strcmp(argv[1], "--direct") == 0) {
+			disk_mode = venus::storage::DiskMode::DIRECT;
+			first = 2;
+		}
+
+		DatabaseManager db_manager(disk_mode);
+		if (argc >= first + 2 && std::strcmp(argv[first], "--binary") == 0) {
+			int fd = open(argv[first + 1], O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			if (fd < 0) {
+				throw std::runtime_error("cannot open " + std::string(argv[first + 1]) + ": " + std::strerror(errno));
+			}
+			db_manager.GetNetworkManager()->SetBinaryOutput(fd);
+			db_manager.Start();
+			close(fd);
+			return 0;
+		}
+
+		bool serving = false;
+		for (int i = first; i < argc; i++) {
+			bool native = std::strcmp(argv[i], "--listen") == 0;
+			bool postgres = std::strcmp(argv[i], "--pg") == 0;
+			if (!native && !postgres) {
+				throw std::invalid_argument("unknown option " + std::string(argv[i]));
+			}
+
+			uint16_t port = native ? venus::DEFAULT_PORT : venus::POSTGRES_DEFAULT_PORT;
+			if (i + 1 < argc && argv[i + 1][0] != '-') {
+				port = ParsePort(argv[++i]);
+			}
+			db_manager.Serve(port, false, postgres ? venus::network::Protocol::POSTGRES : venus::network::Protocol::NATIVE);
+			serving = true;
+		}
+		if (serving) {
+			db_manager.GetNetworkManager()->Wait();
+			return 0;
+		}
+
+		db_manager.Start();
+	} catch (const std::exception& e) {
+		std::cerr << "venus: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,290 @@
+// /src/network/client.cpp
+
+#include "network/client.h"
+#include "network/protocol.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace venus {
+namespace network {
+
+	namespace {
+
+		// the NULL trailer of a batch, if any: per column its row bitmap, nullptr if it has no NULLs
+		std::vector<const char*> ReadNulls(MessageReader* reader, size_t columns, uint32_t count) {
+			std::vector<const char*> nulls(columns, nullptr);
+			if (reader->AtEnd()) {
+				return nulls;
+			}
+			uint16_t with_nulls = reader->GetU16();
+			for (uint16_t i = 0; i < with_nulls; i++) {
+				uint16_t column = reader->GetU16();
+				if (column >= columns) {
+					throw std::runtime_error("Protocol error: NULLs of an unknown column");
+				}
+				nulls[column] = reader->GetBytes((static_cast<size_t>(count) + 7) / 8);
+			}
+			return nulls;
+		}
+
+		bool RowIsNull(const std::vector<const char*>& nulls, size_t column, uint32_t row) {
+			return nulls[column] != nullptr && Tuple::IsNull(nulls[column], 0, row);
+		}
+
+		// a batch with VARCHAR columns: the values of every row are collected and serialized again
+		void ReadVarcharRows(MessageReader* reader, uint32_t count, executor::TupleSet* rows) {
+			const Schema& schema = rows->GetSchema();
+			std::vector<std::vector<std::string>> values(count, std::vector<std::string>(schema.GetColumnCount()));
+
+			for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+				const Column& column = schema.GetColumn(i);
+				if (column.IsVariableLength()) {
+					std::vector<uint16_t> lengths(count);
+					for (uint32_t row = 0; row < count; row++) {
+						lengths[row] = reader->GetU16();
+					}
+					for (uint32_t row = 0; row < count; row++) {
+						values[row][i].assign(reader->GetBytes(lengths[row]), lengths[row]);
+					}
+				} else {
+					const char* bytes = reader->GetBytes(static_cast<size_t>(count) * column.GetLength());
+					for (uint32_t row = 0; row < count; row++) {
+						values[row][i].assign(bytes + row * column.GetLength(), column.GetLength());
+					}
+				}
+			}
+
+			std::vector<const char*> nulls = ReadNulls(reader, schema.GetColumnCount(), count);
+			std::vector<const char*> raw(schema.GetColumnCount());
+			for (uint32_t row = 0; row < count; row++) {
+				for (size_t i = 0; i < raw.size(); i++) {
+					raw[i] = RowIsNull(nulls, i, row) ? nullptr : values[row][i].c_str();
+				}
+				rows->AddTuple(Tuple(raw, &schema));
+			}
+		}
+
+	} // namespace
+
+	Client::~Client() {
+		Disconnect();
+	}
+
+	void Client::Connect(const std::string& host, uint16_t port) {
+		Disconnect();
+
+		addrinfo hints {};
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_STREAM;
+		addrinfo* addrs = nullptr;
+		if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addrs) != 0 || addrs == nullptr) {
+			throw std::runtime_error("Client error: Cannot resolve " + host);
+		}
+
+		int fd = socket(addrs->ai_family, addrs->ai_socktype | SOCK_CLOEXEC, addrs->ai_protocol);
+		if (fd < 0 || connect(fd, addrs->ai_addr, addrs->ai_addrlen) < 0) {
+			std::string error = std::strerror(errno);
+			freeaddrinfo(addrs);
+			if (fd >= 0) {
+				close(fd);
+			}
+			throw std::runtime_error("Client error: Cannot connect to " + host + ":" + std::to_string(port) + ": " + error);
+		}
+		freeaddrinfo(addrs);
+
+		int no_delay = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+		fd_ = fd;
+		in_transaction_ = false;
+		in_buffer_.clear();
+	}
+
+	void Client::Disconnect() {
+		if (fd_ < 0) {
+			return;
+		}
+
+		std::string out;
+		MessageWriter writer(&out);
+		writer.Begin(static_cast<uint8_t>(RequestType::TERMINATE));
+		writer.End();
+		send(fd_, out.data(), out.size(), MSG_NOSIGNAL);
+
+		close(fd_);
+		fd_ = -1;
+	}
+
+	executor::ResultSet Client::Query(const std::string& sql) {
+		std::string out;
+		MessageWriter writer(&out);
+		writer.Begin(static_cast<uint8_t>(RequestType::QUERY));
+		writer.PutString(sql);
+		writer.End();
+		return Request(out);
+	}
+
+	executor::ResultSet Client::Prepare(const std::string& name, const std::string& sql) {
+		std::string out;
+		MessageWriter writer(&out);
+		writer.Begin(static_cast<uint8_t>(RequestType::PREPARE));
+		writer.PutString(name);
+		writer.PutString(sql);
+		writer.End();
+		return Request(out);
+	}
+
+	executor::ResultSet Client::Execute(const std::string& name, const std::vector<std::string>& params) {
+		std::string out;
+		MessageWriter writer(&out);
+		writer.Begin(static_cast<uint8_t>(RequestType::EXECUTE));
+		writer.PutString(name);
+		writer.PutU16(static_cast<uint16_t>(params.size()));
+		for (const auto& param : params) {
+			writer.PutString(param);
+		}
+		writer.End();
+		return Request(out);
+	}
+
+	executor::ResultSet Client::CloseStatement(const std::string& name) {
+		std::string out;
+		MessageWriter writer(&out);
+		writer.Begin(static_cast<uint8_t>(RequestType::CLOSE));
+		writer.PutString(name);
+		writer.End();
+		return Request(out);
+	}
+
+	executor::ResultSet Client::Request(const std::string& frame) {
+		if (fd_ < 0) {
+			return executor::ResultSet::Failure("Client error: Not connected");
+		}
+
+		size_t sent = 0;
+		while (sent < frame.size()) {
+			ssize_t n = send(fd_, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				close(fd_);
+				fd_ = -1;
+				return executor::ResultSet::Failure("Client error: Connection lost");
+			}
+			sent += static_cast<size_t>(n);
+		}
+
+		// the response ends with READY
+		executor::ResultSet result(true);
+		std::unique_ptr<executor::TupleSet> rows;
+		uint8_t type;
+		std::string payload;
+
+		while (ReadFrame(&type, &payload)) {
+			MessageReader reader(payload.data(), payload.size());
+
+			switch (static_cast<ResponseType>(type)) {
+			case ResponseType::ROW_DESCRIPTION: {
+				Schema schema;
+				uint16_t count = reader.GetU16();
+				for (uint16_t i = 0; i < count; i++) {
+					std::string name = reader.GetString();
+					ColumnType type = static_cast<ColumnType>(reader.GetU8());
+					uint16_t width = reader.GetU16();
+					schema.AddColumn(name, type, false, i, type == ColumnType::VARCHAR ? width : 0);
+					if (width != schema.GetColumn(i).GetMaxLength()) {
+						throw std::runtime_error("Protocol error: Unexpected width of column " + name);
+					}
+				}
+				rows = std::make_unique<executor::TupleSet>(schema);
+				break;
+			}
+
+			case ResponseType::ROW_BATCH: {
+				if (rows == nullptr) {
+					throw std::runtime_error("Protocol error: Rows without a description");
+				}
+				const Schema& schema = rows->GetSchema();
+				uint32_t count = reader.GetU32();
+
+				// rows are put back together from the column arrays
+				std::vector<const char*> columns(schema.GetColumnCount());
+				uint32_t tuple_size = schema.GetTupleSize();
+				if (schema.HasVariableLength()) {
+					ReadVarcharRows(&reader, count, rows.get());
+					break;
+				}
+				for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+					columns[i] = reader.GetBytes(static_cast<size_t>(count) * schema.GetColumn(i).GetLength());
+				}
+				std::vector<const char*> nulls = ReadNulls(&reader, schema.GetColumnCount(), count);
+
+				std::vector<char> data(tuple_size);
+				std::memcpy(data.data(), &tuple_size, sizeof(tuple_size));
+				for (uint32_t row = 0; row < count; row++) {
+					for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+						size_t width = schema.GetColumn(i).GetLength();
+						std::memcpy(data.data() + schema.GetOffset(i), columns[i] + row * width, width);
+						Tuple::SetNull(data.data(), schema.GetNullBitmapOffset(), static_cast<uint32_t>(i), RowIsNull(nulls, i, row));
+					}
+					rows->AddTuple(Tuple(data.data(), RID()));
+				}
+				break;
+			}
+
+			case ResponseType::COMPLETE:
+				result.message_ = reader.GetString();
+				break;
+
+			case ResponseType::ERROR:
+				result.success_ = false;
+				result.message_ = reader.GetString();
+				break;
+
+			case ResponseType::READY:
+				in_transaction_ = reader.GetU8() == STATUS_IN_TRANSACTION;
+				if (result.success_) {
+					result.data_ = std::move(rows);
+				}
+				return result;
+
+			default:
+				throw std::runtime_error("Protocol error: Unknown message type " + std::to_string(type));
+			}
+		}
+
+		// the server closes the session after EXIT and after protocol errors
+		if (!result.success_) {
+			return result;
+		}
+		return executor::ResultSet::Failure("Client error: Connection closed by the server");
+	}
+
+	bool Client::ReadFrame(uint8_t* type, std::string* payload) {
+		char buffer[64 * 1024];
+		while (!TakeFrame(&in_buffer_, type, payload)) {
+			ssize_t n = recv(fd_, buffer, sizeof(buffer), 0);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				close(fd_);
+				fd_ = -1;
+				in_buffer_.clear();
+				return false;
+			}
+			in_buffer_.append(buffer, static_cast<size_t>(n));
+		}
+		return true;
+	}
+
+} // namespace network
+} // namespace venus
@@ -0,0 +1,56 @@
+// /src/network/client.h
+
+/**
+ * Client for the VenusDB server, blocking, one request at a time.
+ *
+ * Results come back as the same ResultSet the engine returns locally, so the console
+ * (venus --connect) prints them with the same code as the local REPL.
+ */
+
+#pragma once
+
+#include "common/config.h"
+#include "executor/executor.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace venus {
+namespace network {
+
+	class Client {
+	public:
+		Client()
+		    : fd_(-1)
+		    , in_transaction_(false) { }
+		~Client();
+
+		// throws if the server cannot be reached
+		void Connect(const std::string& host, uint16_t port);
+		void Disconnect();
+		bool IsConnected() const { return fd_ >= 0; }
+
+		executor::ResultSet Query(const std::string& sql);
+
+		// sql uses ? for parameters, numbers are bound as numbers and everything else as strings
+		executor::ResultSet Prepare(const std::string& name, const std::string& sql);
+		executor::ResultSet Execute(const std::string& name, const std::vector<std::string>& params);
+		executor::ResultSet CloseStatement(const std::string& name);
+
+		// as of the last response
+		bool InTransaction() const { return in_transaction_; }
+
+	private:
+		int fd_;
+		bool in_transaction_;
+		std::string in_buffer_;
+
+		executor::ResultSet Request(const std::string& frame);
+		bool ReadFrame(uint8_t* type, std::string* payload);
+
+		DISALLOW_COPY_AND_MOVE(Client);
+	};
+
+} // namespace network
+} // namespace venus
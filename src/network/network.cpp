@@ -3,19 +3,37 @@
 #include "network/network.h"
 #include "common/config.h"
 #include "common/utils.h"
+#include "network/protocol.h"
 #include <cstdlib>
 
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 namespace venus {
 namespace network {
+
+	NetworkManager::~NetworkManager() {
+		Stop();
+	}
+
 	void NetworkManager::Start() {
-		std::cout << "===== Venus DB =====" << std::endl;
+		bool interactive = binary_fd_ < 0;
+		if (interactive) {
+			std::cout << "===== Venus DB =====" << std::endl;
+		}
 		std::string accumulated_input;
 
 		while (open_) {
-			if (accumulated_input.empty()) {
-				std::cout << "venus> ";
-			} else {
-				std::cout << "     > ";
+			if (interactive) {
+				std::cout << (accumulated_input.empty() ? "venus> " : "     > ");
 			}
 
 			std::string current_line;
@@ -39,9 +57,275 @@ namespace network {
 		if (!accumulated_input.empty() && accumulated_input.back() == ';') {
 			std::string statement = accumulated_input.substr(0, accumulated_input.length() - 1);
 			auto result = execute(statement);
-			utils::PrintResultSet(result);
+			if (binary_fd_ >= 0) {
+				WriteBinary(result);
+			} else {
+				utils::PrintResultSet(result);
+			}
 			accumulated_input.clear();
 		}
 	}
+
+	void NetworkManager::WriteBinary(const executor::ResultSet& result) {
+		std::string out;
+		EncodeResult(result, &out, [this](std::string* frames) {
+			size_t written = 0;
+			while (written < frames->size()) {
+				ssize_t n = write(binary_fd_, frames->data() + written, frames->size() - written);
+				if (n < 0 && errno == EINTR) {
+					continue;
+				}
+				if (n <= 0) {
+					LOG("Network error: Failed to write results: " << std::strerror(errno));
+					open_ = false;
+					return false;
+				}
+				written += static_cast<size_t>(n);
+			}
+			frames->clear();
+			return true;
+		});
+	}
+
+	uint16_t NetworkManager::Listen(uint16_t port, bool loopback_only, Protocol protocol) {
+		std::lock_guard<std::mutex> lock(serving_latch_);
+
+		int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listen_fd < 0) {
+			throw std::runtime_error(std::string("Network error: Failed to create socket: ") + std::strerror(errno));
+		}
+
+		int reuse = 1;
+		setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+		sockaddr_in addr {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(loopback_only ? INADDR_LOOPBACK : INADDR_ANY);
+
+		if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd, SOMAXCONN) < 0) {
+			std::string error = std::strerror(errno);
+			close(listen_fd);
+			throw std::runtime_error("Network error: Failed to listen on port " + std::to_string(port) + ": " + error);
+		}
+
+		socklen_t addr_len = sizeof(addr);
+		getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+
+		// the first listener starts the event loop, later ones join it
+		if (!serving_) {
+			epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+			wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+			epoll_event event {};
+			event.events = EPOLLIN;
+			event.data.fd = wake_fd_;
+			epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+
+			query_pool_ = std::make_unique<common::WorkerPool>(QUERY_WORKER_THREADS);
+		}
+
+		{
+			std::lock_guard<std::mutex> listeners_lock(listeners_latch_);
+			listeners_[listen_fd] = protocol;
+		}
+
+		epoll_event event {};
+		event.events = EPOLLIN;
+		event.data.fd = listen_fd;
+		epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd, &event);
+
+		if (!serving_) {
+			serving_ = true;
+			loop_thread_ = std::thread(&NetworkManager::EventLoop, this);
+		}
+
+		uint16_t bound_port = ntohs(addr.sin_port);
+		LOG("Listening on port " << bound_port << (protocol == Protocol::POSTGRES ? " (PostgreSQL protocol)" : ""));
+		return bound_port;
+	}
+
+	void NetworkManager::Wait() {
+		std::unique_lock<std::mutex> lock(serving_latch_);
+		serving_cv_.wait(lock, [this]() { return !serving_; });
+	}
+
+	void NetworkManager::Stop() {
+		open_ = false;
+
+		std::lock_guard<std::mutex> lock(serving_latch_);
+		if (!serving_) {
+			return;
+		}
+
+		uint64_t one = 1;
+		if (write(wake_fd_, &one, sizeof(one)) < 0) {
+			LOG("Network error: Failed to wake the event loop");
+		}
+		loop_thread_.join();
+
+		// requests still running finish first, the last reference to a session goes with them
+		query_pool_.reset();
+
+		close(epoll_fd_);
+		close(wake_fd_);
+		epoll_fd_ = -1;
+		wake_fd_ = -1;
+
+		serving_ = false;
+		serving_cv_.notify_all();
+	}
+
+	void NetworkManager::EventLoop() {
+		epoll_event events[NETWORK_MAX_EVENTS];
+		bool running = true;
+
+		while (running) {
+			int n = epoll_wait(epoll_fd_, events, NETWORK_MAX_EVENTS, -1);
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				LOG("Network error: epoll_wait failed: " << std::strerror(errno));
+				break;
+			}
+
+			for (int i = 0; i < n; i++) {
+				int fd = events[i].data.fd;
+				if (fd == wake_fd_) {
+					running = false;
+					continue;
+				}
+
+				auto it = sessions_.find(fd);
+				if (it != sessions_.end()) {
+					ReadSession(it->second);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> listeners_lock(listeners_latch_);
+				auto listener = listeners_.find(fd);
+				if (listener != listeners_.end()) {
+					Protocol protocol = listener->second;
+					listeners_lock.unlock();
+					AcceptConnections(fd, protocol);
+				}
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> listeners_lock(listeners_latch_);
+			for (const auto& listener : listeners_) {
+				close(listener.first);
+			}
+			listeners_.clear();
+		}
+
+		for (auto& entry : sessions_) {
+			entry.second->Close();
+			shutdown(entry.first, SHUT_RDWR);
+		}
+		while (!sessions_.empty()) {
+			DropSession(sessions_.begin()->first);
+		}
+	}
+
+	void NetworkManager::AcceptConnections(int listen_fd, Protocol protocol) {
+		while (true) {
+			sockaddr_in addr {};
+			socklen_t addr_len = sizeof(addr);
+			int fd = accept4(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0) {
+				if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+					LOG("Network error: accept failed: " << std::strerror(errno));
+				}
+				return;
+			}
+
+			// responses are small frames written as soon as they are ready
+			int no_delay = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+			char host[INET_ADDRSTRLEN] = {};
+			inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+			std::string peer = std::string(host) + ":" + std::to_string(ntohs(addr.sin_port));
+			std::shared_ptr<Session> session;
+			if (protocol == Protocol::POSTGRES) {
+				session = std::make_shared<PostgresSession>(fd, epoll_fd_, std::move(peer));
+			} else {
+				session = std::make_shared<NativeSession>(fd, epoll_fd_, std::move(peer));
+			}
+
+			try {
+				session->SetEngine(open_session_ ? open_session_(session.get()) : std::make_unique<engine::ExecutionEngine>());
+			} catch (const std::exception& e) {
+				LOG("Network error: Failed to open session for " << session->GetPeer() << ": " << e.what());
+				continue;
+			}
+			if (close_session_) {
+				session->SetCloseCallback(close_session_);
+			}
+
+			epoll_event event {};
+			event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+			event.data.fd = fd;
+			if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+				LOG("Network error: Failed to watch connection: " << std::strerror(errno));
+				continue;
+			}
+
+			sessions_[fd] = std::move(session);
+			session_count_++;
+		}
+	}
+
+	void NetworkManager::ReadSession(const std::shared_ptr<Session>& session) {
+		int fd = session->GetFd();
+		char buffer[64 * 1024];
+		bool schedule = false;
+		bool pause = false;
+		bool hangup = session->IsClosed();
+
+		while (!hangup && !pause) {
+			ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+			if (n > 0) {
+				schedule |= session->Receive(buffer, static_cast<size_t>(n), &pause);
+				continue;
+			}
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
+			}
+			hangup = true; // closed by the client, or by the session after an error
+		}
+
+		if (schedule) {
+			std::shared_ptr<Session> ref = session;
+			query_pool_->Submit([ref]() { ref->ProcessRequests(); });
+		}
+
+		if (hangup) {
+			session->Close();
+			DropSession(fd);
+			return;
+		}
+
+		// a paused session is re-armed by its worker
+		if (!pause) {
+			epoll_event event {};
+			event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+			event.data.fd = fd;
+			epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+		}
+	}
+
+	void NetworkManager::DropSession(int fd) {
+		// the descriptor stays open until the session is destroyed, so it is never reused early
+		epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+		sessions_.erase(fd);
+		session_count_--;
+	}
 } // namespace network
-} // namespace venus
\ No newline at end of file
+} // namespace venus
@@ -7,38 +7,113 @@
  * This has 2 main advantages (for me atleast)
  * - Multi-thread execution using thread pool (queue)
  * - Network protocols (HTTP, gRPC)
+ *
+ * Start() is the local console on stdin. Results are printed as a table, or with SetBinaryOutput
+ * written as protocol frames (protocol.h) to a descriptor, for tools exporting large results.
+ *
+ * Listen() starts the TCP server:
+ *   - one event loop thread accepts connections and reads them, on epoll; a connection is armed
+ *     one-shot and re-armed after its bytes are buffered
+ *   - every connection is a Session with its own engine, see session.h
+ *   - requests run on a pool of QUERY_WORKER_THREADS threads, a session uses one worker at a time
+ *   - the wire protocol is in protocol.h, or PostgreSQL v3 (postgres_session.h) on a listener
+ *     started with Protocol::POSTGRES; Listen can be called again to serve both
  */
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
+#include "common/worker_pool.h"
+#include "engine/execution_engine.h"
 #include "executor/executor.h"
+#include "network/postgres_session.h"
+#include "network/session.h"
 
 namespace venus {
 namespace network {
+	enum class Protocol : uint8_t {
+		NATIVE,
+		POSTGRES,
+	};
+
 	class NetworkManager {
 	public:
 		NetworkManager() = default;
-		~NetworkManager() = default;
+		~NetworkManager();
 
 		void Start();
-		
+
 		void SetExecuteCallback(std::function<executor::ResultSet(const std::string&)> cb) {
 			execute = std::move(cb);
 		}
 
-		void Stop() {
-			open_ = false;
+		// the console writes every result as ROW_DESCRIPTION, ROW_BATCH* and COMPLETE / ERROR frames to
+		// fd and prints nothing else
+		void SetBinaryOutput(int fd) { binary_fd_ = fd; }
+
+		// creates the engine of a new session, and tears it down when the session ends
+		void SetSessionCallbacks(std::function<std::unique_ptr<engine::ExecutionEngine>(Session*)> open,
+		    std::function<void(Session*)> close) {
+			open_session_ = std::move(open);
+			close_session_ = std::move(close);
+		}
+
+		// listens on all interfaces, or 127.0.0.1 only, and returns the bound port
+		// port 0 picks a free one; the first call starts the server
+		uint16_t Listen(uint16_t port, bool loopback_only = false, Protocol protocol = Protocol::NATIVE);
+
+		bool IsServing() {
+			std::lock_guard<std::mutex> lock(serving_latch_);
+			return serving_;
 		}
 
+		// blocks until Stop
+		void Wait();
+
+		// ends the console loop and the server, open sessions are closed
+		void Stop();
+
+		size_t GetSessionCount() const { return session_count_; }
+
 	private:
 		void HandleInput(const std::string& input, std::string& accumulated_input);
 		std::function<executor::ResultSet(const std::string&)> execute;
 
 		bool open_ = true;
+		int binary_fd_ = -1;
+
+		void WriteBinary(const executor::ResultSet& result);
+
+		std::function<std::unique_ptr<engine::ExecutionEngine>(Session*)> open_session_;
+		std::function<void(Session*)> close_session_;
+
+		std::mutex listeners_latch_;
+		std::unordered_map<int, Protocol> listeners_; // listening descriptor -> protocol of its sessions
+		int epoll_fd_ = -1;
+		int wake_fd_ = -1; // eventfd, wakes the event loop for Stop
+		std::thread loop_thread_;
+		std::unique_ptr<common::WorkerPool> query_pool_;
+
+		std::unordered_map<int, std::shared_ptr<Session>> sessions_; // event loop thread only
+		std::atomic<size_t> session_count_ { 0 };
+
+		std::mutex serving_latch_;
+		std::condition_variable serving_cv_;
+		bool serving_ = false;
+
+		void EventLoop();
+		void AcceptConnections(int listen_fd, Protocol protocol);
+		void ReadSession(const std::shared_ptr<Session>& session);
+		void DropSession(int fd);
 	};
 } // namespace network
-} // namespace venus
\ No newline at end of file
+} // namespace venus
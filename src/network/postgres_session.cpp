@@ -0,0 +1,874 @@
+// /src/network/postgres_session.cpp
+
+#include "network/postgres_session.h"
+#include "catalog/schema.h"
+#include "catalog/value.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace venus {
+namespace network {
+
+	namespace {
+
+		constexpr uint32_t PROTOCOL_VERSION_3 = 196608;
+		constexpr uint32_t SSL_REQUEST_CODE = 80877103;
+		constexpr uint32_t GSSENC_REQUEST_CODE = 80877104;
+		constexpr uint32_t CANCEL_REQUEST_CODE = 80877102;
+		constexpr uint32_t MAX_STARTUP_PACKET_SIZE = 10000;
+
+		// type oids
+		constexpr uint32_t INT2_OID = 21;
+		constexpr uint32_t INT4_OID = 23;
+		constexpr uint32_t INT8_OID = 20;
+		constexpr uint32_t FLOAT4_OID = 700;
+		constexpr uint32_t FLOAT8_OID = 701;
+		constexpr uint32_t VARCHAR_OID = 1043;
+		constexpr uint32_t DATE_OID = 1082;
+		constexpr uint32_t TIMESTAMP_OID = 1114;
+
+		// binary dates and timestamps count from 2000-01-01, ours from 1970-01-01
+		constexpr int32_t POSTGRES_EPOCH_DAYS = 10957;
+		constexpr int64_t POSTGRES_EPOCH_MICROS = POSTGRES_EPOCH_DAYS * 86400LL * 1000000LL;
+
+		constexpr int16_t TEXT_FORMAT = 0;
+		constexpr int16_t BINARY_FORMAT = 1;
+
+		constexpr size_t FLUSH_THRESHOLD = 64 * 1024; // queued bytes sent before a result is complete
+
+		uint32_t ReadU32(const char* data) {
+			const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+			return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+			    | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+		}
+
+		class PgReader {
+		public:
+			explicit PgReader(const std::string& data)
+			    : data_(data)
+			    , pos_(0) { }
+
+			uint8_t GetU8() {
+				Need(1);
+				return static_cast<uint8_t>(data_[pos_++]);
+			}
+			int16_t GetI16() {
+				Need(2);
+				auto high = static_cast<uint8_t>(data_[pos_]);
+				auto low = static_cast<uint8_t>(data_[pos_ + 1]);
+				pos_ += 2;
+				return static_cast<int16_t>((high << 8) | low);
+			}
+			int32_t GetI32() {
+				Need(4);
+				uint32_t value = ReadU32(data_.data() + pos_);
+				pos_ += 4;
+				return static_cast<int32_t>(value);
+			}
+			std::string GetCString() {
+				size_t end = data_.find('\0', pos_);
+				if (end == std::string::npos) {
+					throw std::runtime_error("Protocol error: Unterminated string");
+				}
+				std::string value = data_.substr(pos_, end - pos_);
+				pos_ = end + 1;
+				return value;
+			}
+			std::string GetBytes(size_t size) {
+				Need(size);
+				std::string value = data_.substr(pos_, size);
+				pos_ += size;
+				return value;
+			}
+			bool AtEnd() const { return pos_ >= data_.size(); }
+
+		private:
+			const std::string& data_;
+			size_t pos_;
+
+			void Need(size_t bytes) const {
+				if (data_.size() - pos_ < bytes) {
+					throw std::runtime_error("Protocol error: Message is truncated");
+				}
+			}
+		};
+
+		class PgWriter {
+		public:
+			void PutU8(uint8_t value) { body_.push_back(static_cast<char>(value)); }
+			void PutI16(int16_t value) {
+				PutU8(static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8));
+				PutU8(static_cast<uint8_t>(value));
+			}
+			void PutI32(int32_t value) {
+				PutI16(static_cast<int16_t>(static_cast<uint32_t>(value) >> 16));
+				PutI16(static_cast<int16_t>(value));
+			}
+			void PutCString(const std::string& value) {
+				body_.append(value);
+				body_.push_back('\0');
+			}
+			void PutBytes(const char* data, size_t size) { body_.append(data, size); }
+
+			const std::string& Body() const { return body_; }
+
+		private:
+			std::string body_;
+		};
+
+		std::string Trim(const std::string& value) {
+			size_t start = value.find_first_not_of(" \t\r\n");
+			if (start == std::string::npos) {
+				return "";
+			}
+			size_t end = value.find_last_not_of(" \t\r\n");
+			return value.substr(start, end - start + 1);
+		}
+
+		// statements of a simple query, ';' inside string literals does not split
+		std::vector<std::string> SplitStatements(const std::string& sql) {
+			std::vector<std::string> statements;
+			std::string current;
+			bool in_string = false;
+			for (char c : sql) {
+				if (c == '\'') {
+					in_string = !in_string;
+				}
+				if (c == ';' && !in_string) {
+					statements.push_back(Trim(current));
+					current.clear();
+				} else {
+					current += c;
+				}
+			}
+			statements.push_back(Trim(current));
+
+			statements.erase(std::remove(statements.begin(), statements.end(), std::string()), statements.end());
+			return statements;
+		}
+
+		std::string FirstWords(const std::string& sql, size_t count) {
+			std::string words;
+			size_t pos = 0;
+			for (size_t i = 0; i < count; i++) {
+				size_t start = sql.find_first_not_of(" \t\r\n", pos);
+				if (start == std::string::npos) {
+					break;
+				}
+				size_t end = sql.find_first_of(" \t\r\n(", start);
+				std::string word = sql.substr(start, end == std::string::npos ? std::string::npos : end - start);
+				std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+				words += (words.empty() ? "" : " ") + word;
+				pos = end == std::string::npos ? sql.size() : end;
+			}
+			return words;
+		}
+
+		// first number in an engine message, "Inserted 3 rows into t" -> 3
+		std::string CountIn(const std::string& message) {
+			size_t start = message.find_first_of("0123456789");
+			if (start == std::string::npos) {
+				return "0";
+			}
+			size_t end = message.find_first_not_of("0123456789", start);
+			return message.substr(start, end == std::string::npos ? std::string::npos : end - start);
+		}
+
+		bool IsSelect(const std::string& sql) {
+			return FirstWords(sql, 1) == "SELECT";
+		}
+
+		// SQLSTATE for an engine error, drivers retry on the 40xxx class
+		const char* SqlState(const std::string& message) {
+			if (message.find("Deadlock") != std::string::npos) {
+				return "40P01";
+			}
+			if (message.find("Write-write conflict") != std::string::npos) {
+				return "40001";
+			}
+			if (message.find("does not exist") != std::string::npos) {
+				return "42P01";
+			}
+			if (message.find("Parser error") != std::string::npos) {
+				return "42601";
+			}
+			if (message.find("Protocol error") != std::string::npos) {
+				return "08P01";
+			}
+			return "XX000";
+		}
+
+		int16_t FormatOf(const std::vector<int16_t>& formats, size_t column) {
+			if (formats.empty()) {
+				return TEXT_FORMAT;
+			}
+			return formats.size() == 1 ? formats[0] : formats.at(column);
+		}
+
+		// a parameter as SQL text
+		std::string ParameterLiteral(const std::string& value, int16_t format, uint32_t type) {
+			std::string text = value;
+
+			if (format == BINARY_FORMAT) {
+				char buffer[64];
+				if (type == INT4_OID && value.size() == 4) {
+					text = std::to_string(static_cast<int32_t>(ReadU32(value.data())));
+				} else if (type == INT2_OID && value.size() == 2) {
+					auto bits = static_cast<uint16_t>((static_cast<uint8_t>(value[0]) << 8) | static_cast<uint8_t>(value[1]));
+					text = std::to_string(static_cast<int16_t>(bits));
+				} else if (type == INT8_OID && value.size() == 8) {
+					uint64_t bits = (static_cast<uint64_t>(ReadU32(value.data())) << 32) | ReadU32(value.data() + 4);
+					text = std::to_string(static_cast<int64_t>(bits));
+				} else if (type == FLOAT4_OID && value.size() == 4) {
+					uint32_t bits = ReadU32(value.data());
+					float f;
+					std::memcpy(&f, &bits, sizeof(f));
+					std::snprintf(buffer, sizeof(buffer), "%.9g", f);
+					text = buffer;
+				} else if (type == FLOAT8_OID && value.size() == 8) {
+					uint64_t bits = (static_cast<uint64_t>(ReadU32(value.data())) << 32) | ReadU32(value.data() + 4);
+					double d;
+					std::memcpy(&d, &bits, sizeof(d));
+					std::snprintf(buffer, sizeof(buffer), "%.17g", d);
+					text = buffer;
+				} else if (type == DATE_OID && value.size() == 4) {
+					text = FormatDate(static_cast<int32_t>(ReadU32(value.data())) + POSTGRES_EPOCH_DAYS);
+				} else if (type == TIMESTAMP_OID && value.size() == 8) {
+					uint64_t bits = (static_cast<uint64_t>(ReadU32(value.data())) << 32) | ReadU32(value.data() + 4);
+					text = FormatTimestamp(static_cast<int64_t>(bits) + POSTGRES_EPOCH_MICROS);
+				}
+			}
+
+			if (text.find('\'') != std::string::npos) {
+				throw std::runtime_error("Session error: Parameters cannot contain quotes");
+			}
+			return IsNumber(text) ? text : "'" + text + "'";
+		}
+
+		// replaces $1, $2 ... outside string literals
+		std::string BindParameters(const std::string& sql, const std::vector<std::string>& literals) {
+			std::string bound;
+			bool in_string = false;
+			for (size_t i = 0; i < sql.size(); i++) {
+				char c = sql[i];
+				if (c == '\'') {
+					in_string = !in_string;
+				}
+				if (c != '$' || in_string || i + 1 >= sql.size() || !std::isdigit(static_cast<unsigned char>(sql[i + 1]))) {
+					bound += c;
+					continue;
+				}
+
+				size_t end = i + 1;
+				while (end < sql.size() && std::isdigit(static_cast<unsigned char>(sql[end]))) {
+					end++;
+				}
+				size_t index = std::stoul(sql.substr(i + 1, end - i - 1));
+				if (index == 0 || index > literals.size()) {
+					throw std::runtime_error("Session error: No value for parameter $" + std::to_string(index));
+				}
+				bound += literals[index - 1];
+				i = end - 1;
+			}
+			return bound;
+		}
+
+	} // namespace
+
+	bool PostgresSession::HasRequest(const std::string& buffer) const {
+		if (!started_) {
+			if (buffer.size() < 4) {
+				return false;
+			}
+			uint32_t length = ReadU32(buffer.data());
+			return length < 8 || length > MAX_STARTUP_PACKET_SIZE || buffer.size() >= length;
+		}
+
+		if (buffer.size() < 5) {
+			return false;
+		}
+		// an invalid length is reported by the worker
+		uint32_t length = ReadU32(buffer.data() + 1);
+		return length < 4 || length > NETWORK_MAX_MESSAGE_SIZE || buffer.size() >= 1 + length;
+	}
+
+	bool PostgresSession::TakeRequest(std::string* buffer, uint8_t* type, std::string* payload) {
+		if (!started_) {
+			if (buffer->size() < 4) {
+				return false;
+			}
+			uint32_t length = ReadU32(buffer->data());
+			if (length < 8 || length > MAX_STARTUP_PACKET_SIZE) {
+				throw std::runtime_error("Protocol error: Invalid startup packet length " + std::to_string(length));
+			}
+			if (buffer->size() < length) {
+				return false;
+			}
+			*type = 0;
+			payload->assign(buffer->data() + 4, length - 4);
+			buffer->erase(0, length);
+			return true;
+		}
+
+		if (buffer->size() < 5) {
+			return false;
+		}
+		uint32_t length = ReadU32(buffer->data() + 1);
+		if (length < 4 || length > NETWORK_MAX_MESSAGE_SIZE) {
+			throw std::runtime_error("Protocol error: Invalid message length " + std::to_string(length));
+		}
+		if (buffer->size() < 1 + length) {
+			return false;
+		}
+		*type = static_cast<uint8_t>((*buffer)[0]);
+		payload->assign(buffer->data() + 5, length - 4);
+		buffer->erase(0, 1 + length);
+		return true;
+	}
+
+	void PostgresSession::SendFatal(const std::string& message) {
+		SendError(message, "FATAL");
+		Flush();
+	}
+
+	void PostgresSession::HandleRequest(uint8_t type, const std::string& payload) {
+		try {
+			if (!started_) {
+				HandleStartup(payload);
+				Flush();
+				return;
+			}
+
+			// after an error the rest of an extended query is skipped
+			if (skip_until_sync_ && type != 'S' && type != 'X') {
+				return;
+			}
+
+			switch (type) {
+			case 'Q':
+				HandleQuery(payload);
+				break;
+			case 'P':
+				HandleParse(payload);
+				break;
+			case 'B':
+				HandleBind(payload);
+				break;
+			case 'D':
+				HandleDescribe(payload);
+				break;
+			case 'E':
+				HandleExecute(payload);
+				break;
+			case 'C':
+				HandleClose(payload);
+				break;
+			case 'H':
+				Flush();
+				break;
+			case 'S':
+				// the implicit transaction of the extended query ends here
+				skip_until_sync_ = false;
+				if (!engine_->InTransaction()) {
+					portals_.clear();
+				}
+				SendReady();
+				Flush();
+				break;
+			case 'X':
+				Close();
+				break;
+			default:
+				throw std::runtime_error("Protocol error: Unsupported message type " + std::string(1, static_cast<char>(type)));
+			}
+		} catch (const std::exception& e) {
+			if (!started_) {
+				SendFatal(e.what());
+				Close();
+				return;
+			}
+			SendError(e.what());
+			if (type == 'Q') {
+				SendReady();
+			} else {
+				skip_until_sync_ = true;
+			}
+			Flush();
+		}
+	}
+
+	void PostgresSession::HandleStartup(const std::string& payload) {
+		PgReader reader(payload);
+		uint32_t code = static_cast<uint32_t>(reader.GetI32());
+
+		if (code == SSL_REQUEST_CODE || code == GSSENC_REQUEST_CODE) {
+			// not supported, the client continues in plain text
+			out_ += 'N';
+			return;
+		}
+		if (code == CANCEL_REQUEST_CODE) {
+			Close();
+			return;
+		}
+		if (code != PROTOCOL_VERSION_3) {
+			SendFatal("Protocol error: Unsupported protocol version " + std::to_string(code >> 16) + "." + std::to_string(code & 0xFFFF));
+			Close();
+			return;
+		}
+
+		std::string database;
+		std::string application_name;
+		while (!reader.AtEnd()) {
+			std::string name = reader.GetCString();
+			if (name.empty()) {
+				break;
+			}
+			std::string value = reader.GetCString();
+			if (name == "database") {
+				database = value;
+			} else if (name == "application_name") {
+				application_name = value;
+			}
+		}
+
+		if (!database.empty()) {
+			executor::ResultSet result = engine_->Execute("USE " + database);
+			if (!result.success_) {
+				SendFatal(result.message_);
+				Close();
+				return;
+			}
+		}
+
+		started_ = true;
+
+		PgWriter auth;
+		auth.PutI32(0); // AuthenticationOk
+		Queue('R', auth.Body());
+
+		const std::pair<const char*, std::string> parameters[] = {
+			{ "server_version", "14.0" },
+			{ "server_encoding", "UTF8" },
+			{ "client_encoding", "UTF8" },
+			{ "DateStyle", "ISO, MDY" },
+			{ "TimeZone", "UTC" },
+			{ "integer_datetimes", "on" },
+			{ "standard_conforming_strings", "on" },
+			{ "application_name", application_name },
+		};
+		for (const auto& parameter : parameters) {
+			PgWriter status;
+			status.PutCString(parameter.first);
+			status.PutCString(parameter.second);
+			Queue('S', status.Body());
+		}
+
+		// cancel requests are not supported, the key only has to be well formed
+		PgWriter key;
+		key.PutI32(static_cast<int32_t>(getpid()));
+		key.PutI32(GetFd());
+		Queue('K', key.Body());
+
+		SendReady();
+	}
+
+	void PostgresSession::HandleQuery(const std::string& payload) {
+		PgReader reader(payload);
+		std::vector<std::string> statements = SplitStatements(reader.GetCString());
+
+		if (statements.empty()) {
+			Queue('I', "");
+		}
+
+		for (const auto& sql : statements) {
+			executor::ResultSet result = engine_->Execute(sql);
+			if (!result.success_) {
+				// the rest of the message is not run
+				SendError(result.message_);
+				break;
+			}
+			SendRowDescription(sql, result, {});
+			if (result.data_) {
+				SendRows(result, {}, 0, result.data_->GetSize());
+			}
+			SendCommandComplete(sql, result);
+		}
+
+		SendReady();
+		Flush();
+	}
+
+	void PostgresSession::HandleParse(const std::string& payload) {
+		PgReader reader(payload);
+		std::string name = reader.GetCString();
+		Statement statement;
+		statement.sql = reader.GetCString();
+
+		int16_t count = reader.GetI16();
+		for (int16_t i = 0; i < count; i++) {
+			statement.param_types.push_back(static_cast<uint32_t>(reader.GetI32()));
+		}
+
+		// the unnamed statement is replaced, a named one must be closed first
+		if (!name.empty() && statements_.count(name) > 0) {
+			throw std::runtime_error("Session error: Prepared statement " + name + " already exists");
+		}
+		statements_[name] = std::move(statement);
+		Queue('1', "");
+	}
+
+	void PostgresSession::HandleBind(const std::string& payload) {
+		PgReader reader(payload);
+		std::string portal_name = reader.GetCString();
+		std::string statement_name = reader.GetCString();
+
+		auto it = statements_.find(statement_name);
+		if (it == statements_.end()) {
+			throw std::runtime_error("Session error: Unknown prepared statement " + statement_name);
+		}
+		const Statement& statement = it->second;
+
+		std::vector<int16_t> param_formats(static_cast<size_t>(reader.GetI16()));
+		for (auto& format : param_formats) {
+			format = reader.GetI16();
+		}
+
+		std::vector<std::string> literals(static_cast<size_t>(reader.GetI16()));
+		for (size_t i = 0; i < literals.size(); i++) {
+			int32_t length = reader.GetI32();
+			if (length < 0) {
+				throw std::runtime_error("Session error: NULL parameters are not supported");
+			}
+			uint32_t type = i < statement.param_types.size() ? statement.param_types[i] : 0;
+			literals[i] = ParameterLiteral(reader.GetBytes(static_cast<size_t>(length)), FormatOf(param_formats, i), type);
+		}
+
+		Portal portal;
+		portal.sql = BindParameters(statement.sql, literals);
+		portal.result_formats.resize(static_cast<size_t>(reader.GetI16()));
+		for (auto& format : portal.result_formats) {
+			format = reader.GetI16();
+		}
+		portal.sent = 0;
+
+		portals_[portal_name] = std::move(portal);
+		Queue('2', "");
+	}
+
+	void PostgresSession::HandleDescribe(const std::string& payload) {
+		PgReader reader(payload);
+		uint8_t kind = reader.GetU8();
+		std::string name = reader.GetCString();
+
+		if (kind == 'S') {
+			auto it = statements_.find(name);
+			if (it == statements_.end()) {
+				throw std::runtime_error("Session error: Unknown prepared statement " + name);
+			}
+
+			// types the client left open are sent as text, the columns are only known once it runs
+			size_t count = 0;
+			for (size_t i = 0; i + 1 < it->second.sql.size(); i++) {
+				if (it->second.sql[i] == '$' && std::isdigit(static_cast<unsigned char>(it->second.sql[i + 1]))) {
+					count = std::max(count, static_cast<size_t>(std::stoul(it->second.sql.substr(i + 1))));
+				}
+			}
+			PgWriter description;
+			description.PutI16(static_cast<int16_t>(count));
+			for (size_t i = 0; i < count; i++) {
+				uint32_t type = i < it->second.param_types.size() ? it->second.param_types[i] : 0;
+				description.PutI32(static_cast<int32_t>(type != 0 ? type : VARCHAR_OID));
+			}
+			Queue('t', description.Body());
+			Queue('n', "");
+			return;
+		}
+
+		auto it = portals_.find(name);
+		if (it == portals_.end()) {
+			throw std::runtime_error("Session error: Unknown portal " + name);
+		}
+		RunPortal(&it->second);
+		SendRowDescription(it->second.sql, *it->second.result, it->second.result_formats);
+	}
+
+	void PostgresSession::HandleExecute(const std::string& payload) {
+		PgReader reader(payload);
+		std::string name = reader.GetCString();
+		int32_t max_rows = reader.GetI32();
+
+		auto it = portals_.find(name);
+		if (it == portals_.end()) {
+			throw std::runtime_error("Session error: Unknown portal " + name);
+		}
+		Portal& portal = it->second;
+		RunPortal(&portal);
+
+		const executor::ResultSet& result = *portal.result;
+		size_t total = result.data_ ? result.data_->GetSize() : 0;
+		size_t end = max_rows > 0 ? std::min(total, portal.sent + static_cast<size_t>(max_rows)) : total;
+
+		SendRows(result, portal.result_formats, portal.sent, end);
+		portal.sent = end;
+
+		if (max_rows > 0 && end < total) {
+			Queue('s', ""); // PortalSuspended, the client executes again for more
+			return;
+		}
+		SendCommandComplete(portal.sql, result);
+	}
+
+	void PostgresSession::HandleClose(const std::string& payload) {
+		PgReader reader(payload);
+		uint8_t kind = reader.GetU8();
+		std::string name = reader.GetCString();
+
+		if (kind == 'S') {
+			statements_.erase(name);
+		} else {
+			portals_.erase(name);
+		}
+		Queue('3', "");
+	}
+
+	void PostgresSession::RunPortal(Portal* portal) {
+		if (portal->result == nullptr) {
+			portal->result = std::make_unique<executor::ResultSet>(engine_->Execute(portal->sql));
+		}
+		if (!portal->result->success_) {
+			throw std::runtime_error(portal->result->message_);
+		}
+	}
+
+	void PostgresSession::SendRowDescription(const std::string& sql, const executor::ResultSet& result, const std::vector<int16_t>& formats) {
+		if (!result.data_) {
+			// an empty SELECT has no schema, it is described without columns
+			if (IsSelect(sql)) {
+				PgWriter empty;
+				empty.PutI16(0);
+				Queue('T', empty.Body());
+			} else {
+				Queue('n', "");
+			}
+			return;
+		}
+
+		const Schema& schema = result.data_->GetSchema();
+		PgWriter description;
+		description.PutI16(static_cast<int16_t>(schema.GetColumnCount()));
+		for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+			const Column& column = schema.GetColumn(i);
+			description.PutCString(column.GetName());
+			description.PutI32(0); // table oid
+			description.PutI16(0); // column number
+			switch (column.GetType()) {
+			case ColumnType::INT:
+				description.PutI32(INT4_OID);
+				description.PutI16(4);
+				description.PutI32(-1);
+				break;
+			case ColumnType::FLOAT:
+				description.PutI32(FLOAT4_OID);
+				description.PutI16(4);
+				description.PutI32(-1);
+				break;
+			case ColumnType::BIGINT:
+				description.PutI32(INT8_OID);
+				description.PutI16(8);
+				description.PutI32(-1);
+				break;
+			case ColumnType::DOUBLE:
+				description.PutI32(FLOAT8_OID);
+				description.PutI16(8);
+				description.PutI32(-1);
+				break;
+			case ColumnType::DATE:
+				description.PutI32(DATE_OID);
+				description.PutI16(4);
+				description.PutI32(-1);
+				break;
+			case ColumnType::TIMESTAMP:
+				description.PutI32(TIMESTAMP_OID);
+				description.PutI16(8);
+				description.PutI32(-1);
+				break;
+			default:
+				description.PutI32(VARCHAR_OID);
+				description.PutI16(-1);
+				description.PutI32(static_cast<int32_t>(column.GetMaxLength() + 4)); // typmod of varchar(n)
+				break;
+			}
+			description.PutI16(FormatOf(formats, i));
+		}
+		Queue('T', description.Body());
+	}
+
+	void PostgresSession::SendRows(const executor::ResultSet& result, const std::vector<int16_t>& formats, size_t from, size_t to) {
+		if (!result.data_) {
+			return;
+		}
+
+		const Schema& schema = result.data_->GetSchema();
+		const auto& tuples = result.data_->GetTuples();
+		char text[64];
+
+		for (size_t row = from; row < to; row++) {
+			PgWriter data;
+			data.PutI16(static_cast<int16_t>(schema.GetColumnCount()));
+
+			for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+				const Column& column = schema.GetColumn(i);
+				const char* raw = tuples[row].GetValue(i, &schema);
+				bool binary = FormatOf(formats, i) == BINARY_FORMAT;
+
+				if (raw == nullptr) {
+					data.PutI32(-1); // NULL
+					continue;
+				}
+
+				switch (column.GetType()) {
+				case ColumnType::INT:
+				case ColumnType::FLOAT: {
+					if (binary) {
+						uint32_t bits;
+						std::memcpy(&bits, raw, sizeof(bits));
+						data.PutI32(4);
+						data.PutI32(static_cast<int32_t>(bits));
+						break;
+					}
+					int length;
+					if (column.GetType() == ColumnType::INT) {
+						int value;
+						std::memcpy(&value, raw, sizeof(value));
+						length = std::snprintf(text, sizeof(text), "%d", value);
+					} else {
+						float value;
+						std::memcpy(&value, raw, sizeof(value));
+						length = std::snprintf(text, sizeof(text), "%g", value);
+					}
+					data.PutI32(length);
+					data.PutBytes(text, static_cast<size_t>(length));
+					break;
+				}
+				case ColumnType::BIGINT:
+				case ColumnType::DOUBLE:
+				case ColumnType::TIMESTAMP: {
+					uint64_t bits;
+					std::memcpy(&bits, raw, sizeof(bits));
+					if (binary) {
+						if (column.GetType() == ColumnType::TIMESTAMP) {
+							bits = static_cast<uint64_t>(static_cast<int64_t>(bits) - POSTGRES_EPOCH_MICROS);
+						}
+						data.PutI32(8);
+						data.PutI32(static_cast<int32_t>(bits >> 32));
+						data.PutI32(static_cast<int32_t>(bits));
+						break;
+					}
+					std::string value;
+					if (column.GetType() == ColumnType::BIGINT) {
+						value = std::to_string(static_cast<int64_t>(bits));
+					} else if (column.GetType() == ColumnType::DOUBLE) {
+						double d;
+						std::memcpy(&d, &bits, sizeof(d));
+						int length = std::snprintf(text, sizeof(text), "%.15g", d);
+						value.assign(text, static_cast<size_t>(length));
+					} else {
+						value = FormatTimestamp(static_cast<int64_t>(bits));
+					}
+					data.PutI32(static_cast<int32_t>(value.size()));
+					data.PutBytes(value.data(), value.size());
+					break;
+				}
+				case ColumnType::DATE: {
+					int32_t days;
+					std::memcpy(&days, raw, sizeof(days));
+					if (binary) {
+						data.PutI32(4);
+						data.PutI32(days - POSTGRES_EPOCH_DAYS);
+						break;
+					}
+					std::string value = FormatDate(days);
+					data.PutI32(static_cast<int32_t>(value.size()));
+					data.PutBytes(value.data(), value.size());
+					break;
+				}
+				default: {
+					// varchar is the same in both formats
+					size_t length = strnlen(raw, column.GetMaxLength());
+					data.PutI32(static_cast<int32_t>(length));
+					data.PutBytes(raw, length);
+					break;
+				}
+				}
+			}
+
+			Queue('D', data.Body());
+			if (out_.size() >= FLUSH_THRESHOLD && !Flush()) {
+				return;
+			}
+		}
+	}
+
+	void PostgresSession::SendCommandComplete(const std::string& sql, const executor::ResultSet& result) {
+		std::string keyword = FirstWords(sql, 1);
+		std::string tag;
+
+		if (keyword == "SELECT") {
+			tag = "SELECT " + std::to_string(result.data_ ? result.data_->GetSize() : 0);
+		} else if (keyword == "INSERT") {
+			tag = "INSERT 0 " + CountIn(result.message_);
+		} else if (keyword == "UPDATE" || keyword == "DELETE") {
+			tag = keyword + " " + CountIn(result.message_);
+		} else if (keyword == "CREATE" || keyword == "DROP" || keyword == "SHOW") {
+			tag = FirstWords(sql, 2);
+		} else {
+			tag = keyword;
+		}
+
+		PgWriter complete;
+		complete.PutCString(tag);
+		Queue('C', complete.Body());
+	}
+
+	void PostgresSession::SendError(const std::string& message, const char* severity) {
+		PgWriter error;
+		error.PutU8('S');
+		error.PutCString(severity);
+		error.PutU8('V');
+		error.PutCString(severity);
+		error.PutU8('C');
+		error.PutCString(SqlState(message));
+		error.PutU8('M');
+		error.PutCString(message);
+		error.PutU8(0);
+		Queue('E', error.Body());
+	}
+
+	void PostgresSession::SendReady() {
+		PgWriter ready;
+		ready.PutU8(engine_ != nullptr && engine_->InTransaction() ? 'T' : 'I');
+		Queue('Z', ready.Body());
+	}
+
+	void PostgresSession::Queue(uint8_t type, const std::string& body) {
+		out_ += static_cast<char>(type);
+		uint32_t length = static_cast<uint32_t>(body.size() + 4);
+		for (int shift = 24; shift >= 0; shift -= 8) {
+			out_ += static_cast<char>(length >> shift);
+		}
+		out_ += body;
+	}
+
+	bool PostgresSession::Flush() {
+		bool ok = out_.empty() || Send(out_);
+		out_.clear();
+		return ok;
+	}
+
+} // namespace network
+} // namespace venus
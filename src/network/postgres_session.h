@@ -0,0 +1,88 @@
+// /src/network/postgres_session.h
+
+/**
+ * PostgresSession for VenusDB - the PostgreSQL v3 frontend/backend protocol on a Session,
+ * so psql, libpq based drivers and load tools can connect.
+ *
+ * Supported
+ *   - startup without authentication (AuthenticationOk), SSL / GSS requests are declined, the
+ *     database startup parameter is USEd
+ *   - simple query, several statements separated by ';' in one message
+ *   - extended query: Parse / Bind / Describe / Execute / Close / Sync / Flush, named and unnamed
+ *     statements and portals, $n parameters in text or binary format, row limits on Execute
+ *   - text and binary result format for INT (int4), FLOAT (float4), CHAR and VARCHAR (varchar)
+ *
+ * Statements run through the session's engine as SQL, so a Parse keeps the text and Bind substitutes
+ * the parameters as literals. The engine materializes a result, a portal keeps it between a Describe
+ * (which needs the row description) and its Executes.
+ *
+ * After an error in an extended query, messages are skipped until the next Sync, as in PostgreSQL.
+ */
+
+#pragma once
+
+#include "network/session.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace venus {
+namespace network {
+
+	class PostgresSession : public Session {
+	public:
+		PostgresSession(int fd, int epoll_fd, std::string peer)
+		    : Session(fd, epoll_fd, std::move(peer))
+		    , started_(false)
+		    , skip_until_sync_(false) { }
+
+	protected:
+		bool HasRequest(const std::string& buffer) const override;
+		bool TakeRequest(std::string* buffer, uint8_t* type, std::string* payload) override;
+		void HandleRequest(uint8_t type, const std::string& payload) override;
+		void SendFatal(const std::string& message) override;
+
+	private:
+		struct Statement {
+			std::string sql;
+			std::vector<uint32_t> param_types; // oids, 0 when the client left it open
+		};
+
+		struct Portal {
+			std::string sql;
+			std::vector<int16_t> result_formats; // none: all text, one: for every column
+			std::unique_ptr<executor::ResultSet> result; // run by Describe or the first Execute
+			size_t sent; // rows already sent
+		};
+
+		std::atomic<bool> started_; // startup packets have no type byte, read by the event loop
+		bool skip_until_sync_;
+		std::string out_; // responses not yet sent
+
+		std::unordered_map<std::string, Statement> statements_;
+		std::unordered_map<std::string, Portal> portals_;
+
+		void HandleStartup(const std::string& payload);
+		void HandleQuery(const std::string& payload);
+		void HandleParse(const std::string& payload);
+		void HandleBind(const std::string& payload);
+		void HandleDescribe(const std::string& payload);
+		void HandleExecute(const std::string& payload);
+		void HandleClose(const std::string& payload);
+
+		void RunPortal(Portal* portal);
+		void SendRowDescription(const std::string& sql, const executor::ResultSet& result, const std::vector<int16_t>& formats);
+		void SendRows(const executor::ResultSet& result, const std::vector<int16_t>& formats, size_t from, size_t to);
+		void SendCommandComplete(const std::string& sql, const executor::ResultSet& result);
+		void SendError(const std::string& message, const char* severity = "ERROR");
+		void SendReady();
+
+		void Queue(uint8_t type, const std::string& body);
+		bool Flush();
+	};
+
+} // namespace network
+} // namespace venus
@@ -0,0 +1,301 @@
+// /src/network/protocol.h
+
+/**
+ * Wire protocol of the VenusDB server.
+ *
+ * Every message is a frame, integers are big endian:
+ *   +--------------+-----------+-----------------+
+ *   | length (u32) | type (u8) | payload         |
+ *   +--------------+-----------+-----------------+
+ *   length counts the type byte and the payload and is at most NETWORK_MAX_MESSAGE_SIZE.
+ *   A string is a u32 length followed by its bytes.
+ *
+ * Client -> server
+ *   QUERY      'Q'  sql
+ *   PREPARE    'P'  name, sql with ? placeholders for parameters
+ *   EXECUTE    'E'  name, u16 count, count parameters as strings
+ *   CLOSE      'C'  name, drops a prepared statement
+ *   TERMINATE  'X'  ends the session
+ *
+ * Server -> client, every request is answered with
+ *   [ROW_DESCRIPTION ROW_BATCH*] (COMPLETE | ERROR) READY
+ *   ROW_DESCRIPTION  'T'  u16 count, per column: name, u8 ColumnType, u16 width (n of a VARCHAR(n))
+ *   ROW_BATCH        'D'  u32 rows, then column by column the rows' values, [NULL trailer]
+ *   COMPLETE         'C'  message
+ *   ERROR            'E'  message
+ *   READY            'Z'  u8 'I' idle or 'T' inside a transaction
+ *
+ * Values in a row batch are the fixed width bytes stored in the tuple, width bytes each: INT and
+ * FLOAT in the server's byte order (little endian), CHAR zero padded. Nothing is formatted, a batch
+ * is copied out of the tuples and a client reads a column as an array. A VARCHAR column is the
+ * rows' u16 lengths, then their bytes back to back.
+ *
+ * A NULL is sent as zero bytes, or a VARCHAR of length 0. Only a batch holding NULLs has the
+ * trailer: u16 count, then per column with NULLs its u16 index and a bitmap of ceil(rows / 8)
+ * bytes, bit row % 8 of byte row / 8 set for a NULL.
+ *
+ * Row batches hold up to NETWORK_ROW_BATCH_SIZE rows and are sent as soon as they are encoded,
+ * a client can consume the first batch while the rest is still on the way.
+ */
+
+#pragma once
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "executor/executor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace venus {
+namespace network {
+
+	enum class RequestType : uint8_t {
+		QUERY = 'Q',
+		PREPARE = 'P',
+		EXECUTE = 'E',
+		CLOSE = 'C',
+		TERMINATE = 'X'
+	};
+
+	enum class ResponseType : uint8_t {
+		ROW_DESCRIPTION = 'T',
+		ROW_BATCH = 'D',
+		COMPLETE = 'C',
+		ERROR = 'E',
+		READY = 'Z'
+	};
+
+	constexpr uint8_t STATUS_IDLE = 'I';
+	constexpr uint8_t STATUS_IN_TRANSACTION = 'T';
+
+	constexpr size_t FRAME_HEADER_SIZE = sizeof(uint32_t);
+
+	// appends frames to a byte buffer
+	class MessageWriter {
+	public:
+		explicit MessageWriter(std::string* out)
+		    : out_(out)
+		    , start_(0) { }
+
+		void Begin(uint8_t type) {
+			start_ = out_->size();
+			out_->append(FRAME_HEADER_SIZE, '\0');
+			PutU8(type);
+		}
+
+		void End() {
+			uint32_t length = static_cast<uint32_t>(out_->size() - start_ - FRAME_HEADER_SIZE);
+			for (size_t i = 0; i < FRAME_HEADER_SIZE; i++) {
+				(*out_)[start_ + i] = static_cast<char>(length >> (8 * (FRAME_HEADER_SIZE - 1 - i)));
+			}
+		}
+
+		void PutU8(uint8_t value) { out_->push_back(static_cast<char>(value)); }
+		void PutU16(uint16_t value) {
+			PutU8(static_cast<uint8_t>(value >> 8));
+			PutU8(static_cast<uint8_t>(value));
+		}
+		void PutU32(uint32_t value) {
+			PutU16(static_cast<uint16_t>(value >> 16));
+			PutU16(static_cast<uint16_t>(value));
+		}
+		void PutString(const char* data, size_t size) {
+			PutU32(static_cast<uint32_t>(size));
+			out_->append(data, size);
+		}
+		void PutString(const std::string& value) { PutString(value.data(), value.size()); }
+
+		void PutRowDescription(const Schema& schema) {
+			Begin(static_cast<uint8_t>(ResponseType::ROW_DESCRIPTION));
+			PutU16(static_cast<uint16_t>(schema.GetColumnCount()));
+			for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+				const Column& column = schema.GetColumn(i);
+				PutString(column.GetName());
+				PutU8(static_cast<uint8_t>(column.GetType()));
+				PutU16(static_cast<uint16_t>(column.GetMaxLength()));
+			}
+			End();
+		}
+
+		// tuples [from, to) column by column, each value copied as it is stored
+		void PutRowBatch(const Schema& schema, const std::vector<Tuple>& tuples, size_t from, size_t to) {
+			Begin(static_cast<uint8_t>(ResponseType::ROW_BATCH));
+			PutU32(static_cast<uint32_t>(to - from));
+
+			size_t rows = to - from;
+			for (size_t i = 0; i < schema.GetColumnCount(); i++) {
+				size_t width = schema.GetColumn(i).GetLength();
+				size_t offset = schema.GetOffset(i);
+				if (schema.GetColumn(i).IsVariableLength()) {
+					PutVarcharColumn(tuples, from, to, offset);
+					continue;
+				}
+
+				size_t pos = out_->size();
+				out_->resize(pos + rows * width);
+
+				char* dest = &(*out_)[pos];
+				for (size_t row = from; row < to; row++) {
+					std::memcpy(dest, tuples[row].GetData() + offset, width);
+					dest += width;
+				}
+			}
+			PutNulls(schema, tuples, from, to);
+			End();
+		}
+
+	private:
+		std::string* out_;
+		size_t start_; // frame being written
+
+		void PutNulls(const Schema& schema, const std::vector<Tuple>& tuples, size_t from, size_t to) {
+			uint32_t bitmap_offset = schema.GetNullBitmapOffset();
+			std::vector<uint32_t> columns;
+			for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+				for (size_t row = from; row < to; row++) {
+					if (Tuple::IsNull(tuples[row].GetData(), bitmap_offset, i)) {
+						columns.push_back(i);
+						break;
+					}
+				}
+			}
+			if (columns.empty()) {
+				return;
+			}
+
+			PutU16(static_cast<uint16_t>(columns.size()));
+			for (uint32_t column : columns) {
+				PutU16(static_cast<uint16_t>(column));
+				size_t pos = out_->size();
+				out_->resize(pos + (to - from + 7) / 8, 0);
+				for (size_t row = from; row < to; row++) {
+					if (Tuple::IsNull(tuples[row].GetData(), bitmap_offset, column)) {
+						Tuple::SetNull(&(*out_)[pos], 0, static_cast<uint32_t>(row - from), true);
+					}
+				}
+			}
+		}
+
+		void PutVarcharColumn(const std::vector<Tuple>& tuples, size_t from, size_t to, size_t offset) {
+			for (size_t row = from; row < to; row++) {
+				VarcharSlot slot;
+				std::memcpy(&slot, tuples[row].GetData() + offset, sizeof(slot));
+				PutU16(slot.length);
+			}
+			for (size_t row = from; row < to; row++) {
+				VarcharSlot slot;
+				std::memcpy(&slot, tuples[row].GetData() + offset, sizeof(slot));
+				out_->append(tuples[row].GetData() + slot.offset, slot.length);
+			}
+		}
+	};
+
+	// reads the payload of one frame
+	class MessageReader {
+	public:
+		MessageReader(const char* data, size_t size)
+		    : data_(data)
+		    , size_(size)
+		    , pos_(0) { }
+
+		uint8_t GetU8() {
+			Need(1);
+			return static_cast<uint8_t>(data_[pos_++]);
+		}
+		uint16_t GetU16() {
+			uint16_t high = GetU8();
+			return static_cast<uint16_t>((high << 8) | GetU8());
+		}
+		uint32_t GetU32() {
+			uint32_t high = GetU16();
+			return (high << 16) | GetU16();
+		}
+		std::string GetString() {
+			uint32_t size = GetU32();
+			Need(size);
+			std::string value(data_ + pos_, size);
+			pos_ += size;
+			return value;
+		}
+
+		// size bytes in place, valid while the payload is
+		const char* GetBytes(size_t size) {
+			Need(size);
+			const char* bytes = data_ + pos_;
+			pos_ += size;
+			return bytes;
+		}
+
+		bool AtEnd() const { return pos_ == size_; }
+
+	private:
+		const char* data_;
+		size_t size_;
+		size_t pos_;
+
+		void Need(size_t bytes) const {
+			if (size_ - pos_ < bytes) {
+				throw std::runtime_error("Protocol error: Message is truncated");
+			}
+		}
+	};
+
+	// a whole result as frames, without READY. emit is called with the frames encoded so far after every
+	// row batch and at the end, so a large result is never held encoded; it returns false to stop
+	inline bool EncodeResult(const executor::ResultSet& result, std::string* out, const std::function<bool(std::string*)>& emit) {
+		MessageWriter writer(out);
+
+		if (!result.success_ || result.data_ == nullptr) {
+			writer.Begin(static_cast<uint8_t>(result.success_ ? ResponseType::COMPLETE : ResponseType::ERROR));
+			writer.PutString(result.message_);
+			writer.End();
+			return emit(out);
+		}
+
+		const Schema& schema = result.data_->GetSchema();
+		const auto& tuples = result.data_->GetTuples();
+
+		writer.PutRowDescription(schema);
+		for (size_t start = 0; start < tuples.size(); start += NETWORK_ROW_BATCH_SIZE) {
+			size_t end = std::min(tuples.size(), start + static_cast<size_t>(NETWORK_ROW_BATCH_SIZE));
+			writer.PutRowBatch(schema, tuples, start, end);
+			if (!emit(out)) {
+				return false;
+			}
+		}
+
+		writer.Begin(static_cast<uint8_t>(ResponseType::COMPLETE));
+		writer.PutString("Selected " + std::to_string(tuples.size()) + " rows");
+		writer.End();
+		return emit(out);
+	}
+
+	// removes the first frame from buffer, false if it is not complete yet
+	inline bool TakeFrame(std::string* buffer, uint8_t* type, std::string* payload) {
+		if (buffer->size() < FRAME_HEADER_SIZE) {
+			return false;
+		}
+
+		MessageReader header(buffer->data(), FRAME_HEADER_SIZE);
+		uint32_t length = header.GetU32();
+		if (length == 0 || length > NETWORK_MAX_MESSAGE_SIZE) {
+			throw std::runtime_error("Protocol error: Invalid message length " + std::to_string(length));
+		}
+		if (buffer->size() < FRAME_HEADER_SIZE + length) {
+			return false;
+		}
+
+		*type = static_cast<uint8_t>((*buffer)[FRAME_HEADER_SIZE]);
+		payload->assign(buffer->data() + FRAME_HEADER_SIZE + 1, length - 1);
+		buffer->erase(0, FRAME_HEADER_SIZE + length);
+		return true;
+	}
+
+} // namespace network
+} // namespace venus
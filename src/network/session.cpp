@@ -0,0 +1,273 @@
+// /src/network/session.cpp
+
+#include "network/session.h"
+#include "network/protocol.h"
+
+#include <cerrno>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace venus {
+namespace network {
+
+	Session::Session(int fd, int epoll_fd, std::string peer)
+	    : fd_(fd)
+	    , epoll_fd_(epoll_fd)
+	    , peer_(std::move(peer))
+	    , busy_(false)
+	    , paused_(false)
+	    , closed_(false) { }
+
+	Session::~Session() {
+		if (on_close_) {
+			on_close_(this);
+		}
+		engine_.reset();
+		close(fd_);
+	}
+
+	bool Session::Receive(const char* data, size_t size, bool* pause) {
+		std::lock_guard<std::mutex> lock(latch_);
+		in_buffer_.append(data, size);
+
+		paused_ = in_buffer_.size() >= NETWORK_MAX_BUFFERED_INPUT;
+		*pause = paused_;
+
+		if (busy_ || !HasRequest(in_buffer_)) {
+			return false;
+		}
+
+		busy_ = true;
+		return true;
+	}
+
+	void Session::ProcessRequests() {
+		while (!closed_) {
+			uint8_t type;
+			std::string payload;
+			std::string error;
+			{
+				std::lock_guard<std::mutex> lock(latch_);
+				try {
+					if (!TakeRequest(&in_buffer_, &type, &payload)) {
+						busy_ = false;
+						break;
+					}
+				} catch (const std::exception& e) {
+					error = e.what();
+				}
+
+				if (paused_ && in_buffer_.size() < NETWORK_MAX_BUFFERED_INPUT) {
+					paused_ = false;
+					Rearm();
+				}
+			}
+
+			if (!error.empty()) {
+				// the stream cannot be resynchronized
+				SendFatal(error);
+				Close();
+				break;
+			}
+
+			HandleRequest(type, payload);
+		}
+
+		if (closed_) {
+			// wakes the event loop, which drops the session
+			shutdown(fd_, SHUT_RDWR);
+		}
+	}
+
+	bool Session::Send(const std::string& bytes) {
+		size_t sent = 0;
+		while (sent < bytes.size() && !closed_) {
+			ssize_t n = send(fd_, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+			if (n > 0) {
+				sent += static_cast<size_t>(n);
+				continue;
+			}
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				// the worker waits for the client to read, a slow client only slows down itself
+				pollfd pfd { fd_, POLLOUT, 0 };
+				if (poll(&pfd, 1, NETWORK_SEND_TIMEOUT_MS) > 0) {
+					continue;
+				}
+			}
+			closed_ = true;
+		}
+		return !closed_;
+	}
+
+	void Session::Rearm() {
+		epoll_event event {};
+		event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+		event.data.fd = fd_;
+		// fails harmlessly once the event loop has dropped the session
+		epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd_, &event);
+	}
+
+	bool NativeSession::HasRequest(const std::string& buffer) const {
+		if (buffer.size() < FRAME_HEADER_SIZE) {
+			return false;
+		}
+
+		// an invalid length is reported by the worker
+		uint32_t length = MessageReader(buffer.data(), FRAME_HEADER_SIZE).GetU32();
+		return length == 0 || length > NETWORK_MAX_MESSAGE_SIZE || buffer.size() >= FRAME_HEADER_SIZE + length;
+	}
+
+	bool NativeSession::TakeRequest(std::string* buffer, uint8_t* type, std::string* payload) {
+		return TakeFrame(buffer, type, payload);
+	}
+
+	void NativeSession::SendFatal(const std::string& message) {
+		SendMessage(static_cast<uint8_t>(ResponseType::ERROR), message);
+	}
+
+	void NativeSession::HandleRequest(uint8_t type, const std::string& payload) {
+		try {
+			MessageReader reader(payload.data(), payload.size());
+
+			switch (static_cast<RequestType>(type)) {
+			case RequestType::QUERY: {
+				std::string sql = reader.GetString();
+				SendResult(engine_->Execute(sql));
+				break;
+			}
+
+			case RequestType::PREPARE: {
+				std::string name = reader.GetString();
+				std::string sql = reader.GetString();
+				prepared_[name] = PreparedStatement { sql, CountParameters(sql) };
+				SendMessage(static_cast<uint8_t>(ResponseType::COMPLETE), "Statement prepared: " + name);
+				break;
+			}
+
+			case RequestType::EXECUTE: {
+				std::string name = reader.GetString();
+				std::vector<std::string> params(reader.GetU16());
+				for (auto& param : params) {
+					param = reader.GetString();
+				}
+
+				auto it = prepared_.find(name);
+				if (it == prepared_.end()) {
+					throw std::runtime_error("Session error: Unknown prepared statement " + name);
+				}
+				SendResult(engine_->Execute(BindParameters(it->second, params)));
+				break;
+			}
+
+			case RequestType::CLOSE: {
+				std::string name = reader.GetString();
+				prepared_.erase(name);
+				SendMessage(static_cast<uint8_t>(ResponseType::COMPLETE), "Statement closed: " + name);
+				break;
+			}
+
+			case RequestType::TERMINATE:
+				Close();
+				return;
+
+			default:
+				throw std::runtime_error("Protocol error: Unknown message type " + std::to_string(type));
+			}
+		} catch (const std::exception& e) {
+			SendMessage(static_cast<uint8_t>(ResponseType::ERROR), e.what());
+		}
+
+		SendReady();
+	}
+
+	void NativeSession::SendResult(const executor::ResultSet& result) {
+		std::string out;
+		EncodeResult(result, &out, [this](std::string* frames) {
+			bool sent = Send(*frames);
+			frames->clear();
+			return sent;
+		});
+	}
+
+	void NativeSession::SendMessage(uint8_t type, const std::string& message) {
+		std::string out;
+		MessageWriter writer(&out);
+		writer.Begin(type);
+		writer.PutString(message);
+		writer.End();
+		Send(out);
+	}
+
+	void NativeSession::SendReady() {
+		std::string out;
+		MessageWriter writer(&out);
+		writer.Begin(static_cast<uint8_t>(ResponseType::READY));
+		writer.PutU8(engine_ != nullptr && engine_->InTransaction() ? STATUS_IN_TRANSACTION : STATUS_IDLE);
+		writer.End();
+		Send(out);
+	}
+
+	size_t NativeSession::CountParameters(const std::string& sql) {
+		size_t count = 0;
+		bool in_string = false;
+		for (char c : sql) {
+			if (c == '\'') {
+				in_string = !in_string;
+			} else if (c == '?' && !in_string) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	std::string NativeSession::BindParameters(const PreparedStatement& statement, const std::vector<std::string>& params) {
+		if (params.size() != statement.param_count) {
+			throw std::runtime_error("Session error: Expected " + std::to_string(statement.param_count) + " parameters, got "
+			    + std::to_string(params.size()));
+		}
+
+		std::string sql;
+		size_t next = 0;
+		bool in_string = false;
+		for (char c : statement.sql) {
+			if (c == '\'') {
+				in_string = !in_string;
+			}
+			if (c != '?' || in_string) {
+				sql += c;
+				continue;
+			}
+
+			// numbers are bound as they are, everything else as a string literal
+			const std::string& param = params[next++];
+			if (param.find('\'') != std::string::npos) {
+				throw std::runtime_error("Session error: Parameters cannot contain quotes");
+			}
+			sql += IsNumber(param) ? param : "'" + param + "'";
+		}
+		return sql;
+	}
+
+	bool IsNumber(const std::string& value) {
+		size_t i = (!value.empty() && value[0] == '-') ? 1 : 0;
+		size_t digits = 0;
+		bool dot = false;
+		for (; i < value.size(); i++) {
+			if (value[i] == '.' && !dot) {
+				dot = true;
+			} else if (value[i] >= '0' && value[i] <= '9') {
+				digits++;
+			} else {
+				return false;
+			}
+		}
+		return digits > 0;
+	}
+
+} // namespace network
+} // namespace venus
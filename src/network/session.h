@@ -0,0 +1,133 @@
+// /src/network/session.h
+
+/**
+ * Session for VenusDB - server side state of one client connection.
+ *
+ * A session owns its ExecutionEngine, so the database it uses and its open transaction are its own.
+ * Session handles the connection, the subclasses speak a protocol:
+ *   NativeSession   - the VenusDB protocol (protocol.h)
+ *   PostgresSession - the PostgreSQL v3 protocol (postgres_session.h)
+ *
+ * Threads
+ *   The event loop appends received bytes with Receive. When a complete request is waiting and no
+ *   worker is busy with the session, Receive asks the loop to schedule ProcessRequests on the query
+ *   pool; that worker handles requests in order until the buffer holds no complete request, so one
+ *   session never runs on two workers. Responses are written by the worker directly to the socket.
+ *
+ *   Reading is paused (the descriptor is not re-armed) once NETWORK_MAX_BUFFERED_INPUT bytes are
+ *   waiting, and resumed by the worker when it has consumed them.
+ */
+
+#pragma once
+
+#include "common/config.h"
+#include "engine/execution_engine.h"
+#include "executor/executor.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace venus {
+namespace network {
+
+	class Session {
+	public:
+		Session(int fd, int epoll_fd, std::string peer);
+		virtual ~Session();
+
+		int GetFd() const { return fd_; }
+		const std::string& GetPeer() const { return peer_; }
+
+		engine::ExecutionEngine* GetEngine() const { return engine_.get(); }
+		void SetEngine(std::unique_ptr<engine::ExecutionEngine> engine) { engine_ = std::move(engine); }
+		void ResetEngine() { engine_.reset(); }
+
+		// runs when the session is destroyed, before the engine goes away
+		void SetCloseCallback(std::function<void(Session*)> cb) { on_close_ = std::move(cb); }
+
+		// empty until USE succeeds
+		const std::string& GetDatabase() const { return database_; }
+		void SetDatabase(const std::string& database) { database_ = database; }
+
+		// event loop: true if the caller must schedule ProcessRequests
+		// sets *pause when reading must stop until the worker catches up
+		bool Receive(const char* data, size_t size, bool* pause);
+
+		// worker: handles buffered requests until none is complete
+		void ProcessRequests();
+
+		// the connection is shut down after the request being processed
+		void Close() { closed_ = true; }
+		bool IsClosed() const { return closed_; }
+
+	protected:
+		std::unique_ptr<engine::ExecutionEngine> engine_;
+
+		// called with latch_ held: true if the first request in buffer is complete, or malformed
+		virtual bool HasRequest(const std::string& buffer) const = 0;
+		// removes the first request from buffer, false if it is incomplete, throws if it is malformed
+		virtual bool TakeRequest(std::string* buffer, uint8_t* type, std::string* payload) = 0;
+		virtual void HandleRequest(uint8_t type, const std::string& payload) = 0;
+		// last words before a malformed stream is closed
+		virtual void SendFatal(const std::string& message) = 0;
+
+		// blocks while the client is not reading, false once the connection is gone
+		bool Send(const std::string& bytes);
+
+	private:
+		int fd_;
+		int epoll_fd_;
+		std::string peer_;
+
+		std::mutex latch_; // protects in_buffer_, busy_ and paused_
+		std::string in_buffer_;
+		bool busy_; // a worker is processing requests
+		bool paused_; // the descriptor was not re-armed for reading
+		std::atomic<bool> closed_;
+
+		std::function<void(Session*)> on_close_;
+		std::string database_;
+
+		void Rearm();
+
+		DISALLOW_COPY_AND_MOVE(Session);
+	};
+
+	// Prepared statements are kept as SQL with ? placeholders and parameters are bound as literals
+	// when they are executed.
+	class NativeSession : public Session {
+	public:
+		using Session::Session;
+
+	protected:
+		bool HasRequest(const std::string& buffer) const override;
+		bool TakeRequest(std::string* buffer, uint8_t* type, std::string* payload) override;
+		void HandleRequest(uint8_t type, const std::string& payload) override;
+		void SendFatal(const std::string& message) override;
+
+	private:
+		struct PreparedStatement {
+			std::string sql;
+			size_t param_count;
+		};
+
+		std::unordered_map<std::string, PreparedStatement> prepared_;
+
+		void SendResult(const executor::ResultSet& result);
+		void SendMessage(uint8_t type, const std::string& message);
+		void SendReady();
+
+		static std::string BindParameters(const PreparedStatement& statement, const std::vector<std::string>& params);
+		static size_t CountParameters(const std::string& sql);
+	};
+
+	// parameters bound into SQL are numbers as they are and everything else as a string literal
+	bool IsNumber(const std::string& value);
+
+} // namespace network
+} // namespace venus
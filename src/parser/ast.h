@@ -47,6 +47,10 @@ namespace parser {
 				return "INSERT";
 			case ASTNodeType::INSERT_BULK:
 				return "INSERT_BULK";
+			case ASTNodeType::UPDATE:
+				return "UPDATE";
+			case ASTNodeType::DELETE:
+				return "DELETE";
 			case ASTNodeType::TABLE_REF:
 				return "TABLE_REF";
 			case ASTNodeType::COLUMN_REF:
@@ -55,12 +59,26 @@ namespace parser {
 				return "COLUMN_DEF";
 			case ASTNodeType::CONST_VALUE:
 				return "CONST_VALUE";
+			case ASTNodeType::NULL_VALUE:
+				return "NULL_VALUE";
 			case ASTNodeType::PROJECTION_LIST:
 				return "PROJECTION_LIST";
 			case ASTNodeType::CONDITION:
 				return "CONDITION";
 			case ASTNodeType::WHERE_CLAUSE:
 				return "WHERE_CLAUSE";
+			case ASTNodeType::ASSIGNMENT:
+				return "ASSIGNMENT";
+			case ASTNodeType::TABLE_OPTION:
+				return "TABLE_OPTION";
+			case ASTNodeType::BEGIN:
+				return "BEGIN";
+			case ASTNodeType::COMMIT:
+				return "COMMIT";
+			case ASTNodeType::ROLLBACK:
+				return "ROLLBACK";
+			case ASTNodeType::VACUUM:
+				return "VACUUM";
 			case ASTNodeType::EXIT:
 				return "EXIT";
 			case ASTNodeType::EXEC:
@@ -157,9 +175,53 @@ namespace parser {
 		}
 	};
 
+	struct BoundDeleteNode : BoundASTNode {
+		TableRef* table_ref;
+		std::unique_ptr<Expression> where_clause;
+
+		BoundDeleteNode(TableRef* table, std::unique_ptr<Expression> where = nullptr)
+		    : table_ref(table)
+		    , where_clause(std::move(where)) {
+			type = ASTNodeType::DELETE;
+		}
+	};
+
+	struct BoundUpdateNode : BoundASTNode {
+		TableRef* table_ref;
+		std::vector<std::pair<ColumnRef, ConstantType>> assignments; // SET column = value
+		std::unique_ptr<Expression> where_clause;
+
+		BoundUpdateNode(
+		    TableRef* table,
+		    std::vector<std::pair<ColumnRef, ConstantType>> assigns,
+		    std::unique_ptr<Expression> where = nullptr)
+		    : table_ref(table)
+		    , assignments(std::move(assigns))
+		    , where_clause(std::move(where)) {
+			type = ASTNodeType::UPDATE;
+		}
+	};
+
+	struct BoundTransactionNode : BoundASTNode {
+		// BEGIN, COMMIT or ROLLBACK
+		BoundTransactionNode(ASTNodeType node_type) {
+			type = node_type;
+		}
+	};
+
+	struct BoundVacuumNode : BoundASTNode {
+		TableRef* table_ref; // nullptr for VACUUM FILE
+
+		explicit BoundVacuumNode(TableRef* table = nullptr)
+		    : table_ref(table) {
+			type = ASTNodeType::VACUUM;
+		}
+	};
+
 	struct BoundCreateTableNode : BoundASTNode {
 		std::string table_name;
 		Schema schema;
+		bool columnar = false; // WITH (format = columnar)
 
 		BoundCreateTableNode(const std::string& table_name)
 		    : table_name(table_name) {
@@ -49,10 +49,25 @@ namespace parser {
 		{ "offset", TokenType::OFFSET },
 		{ "set", TokenType::SET },
 		{ "index", TokenType::INDEX },
+		{ "is", TokenType::IS },
+		{ "not", TokenType::NOT },
+		{ "null", TokenType::NULL_LITERAL },
+		{ "with", TokenType::WITH },
+
+		{ "begin", TokenType::BEGIN },
+		{ "commit", TokenType::COMMIT },
+		{ "rollback", TokenType::ROLLBACK },
+
+		{ "vacuum", TokenType::VACUUM },
 
 		{ "int", TokenType::INT_TYPE },
 		{ "float", TokenType::FLOAT_TYPE },
 		{ "char", TokenType::CHAR_TYPE },
+		{ "varchar", TokenType::VARCHAR_TYPE },
+		{ "bigint", TokenType::BIGINT_TYPE },
+		{ "double", TokenType::DOUBLE_TYPE },
+		{ "date", TokenType::DATE_TYPE },
+		{ "timestamp", TokenType::TIMESTAMP_TYPE },
 
 		{ "help", TokenType::HELP },
 		{ "exit", TokenType::EXIT },
@@ -102,13 +117,31 @@ namespace parser {
 				continue;
 			}
 			if (c == '<') {
-				result.emplace_back(TokenType::LESS_THAN, "<");
-				i++;
+				if (i + 1 < query.length() && query[i + 1] == '=') {
+					result.emplace_back(TokenType::LESS_EQUALS, "<=");
+					i += 2;
+				} else if (i + 1 < query.length() && query[i + 1] == '>') {
+					result.emplace_back(TokenType::NOT_EQUALS, "!=");
+					i += 2;
+				} else {
+					result.emplace_back(TokenType::LESS_THAN, "<");
+					i++;
+				}
 				continue;
 			}
 			if (c == '>') {
-				result.emplace_back(TokenType::GREATER_THAN, ">");
-				i++;
+				if (i + 1 < query.length() && query[i + 1] == '=') {
+					result.emplace_back(TokenType::GREATER_EQUALS, ">=");
+					i += 2;
+				} else {
+					result.emplace_back(TokenType::GREATER_THAN, ">");
+					i++;
+				}
+				continue;
+			}
+			if (c == '!' && i + 1 < query.length() && query[i + 1] == '=') {
+				result.emplace_back(TokenType::NOT_EQUALS, "!=");
+				i += 2;
 				continue;
 			}
 			if (c == '+') {
@@ -298,7 +331,7 @@ namespace parser {
 		}
 
 		case TokenType::CREATE: {
-			// CREATE TABLE <table_name> (col_name col_type constraint)
+			// CREATE TABLE <table_name> (col_name col_type constraint) [WITH (format = row | columnar)]
 			advance();
 			if (check(TokenType::DATABASE)) {
 				advance();
@@ -321,9 +354,21 @@ namespace parser {
 							if (check(TokenType::IDENTIFIER)) {
 								std::string col_name = advance().value;
 
-								if (check(TokenType::INT_TYPE) || check(TokenType::FLOAT_TYPE) || check(TokenType::CHAR_TYPE)) {
+								if (check(TokenType::INT_TYPE) || check(TokenType::FLOAT_TYPE) || check(TokenType::CHAR_TYPE) || check(TokenType::VARCHAR_TYPE)
+								    || check(TokenType::BIGINT_TYPE) || check(TokenType::DOUBLE_TYPE) || check(TokenType::DATE_TYPE) || check(TokenType::TIMESTAMP_TYPE)) {
+									bool is_varchar = check(TokenType::VARCHAR_TYPE);
 									std::string col_type = advance().value;
 
+									// VARCHAR(n), kept as one word for the binder
+									if (is_varchar && check(TokenType::LPAREN)) {
+										advance();
+										if (!check(TokenType::LITERAL)) {
+											invalidToken("Expected length after VARCHAR(");
+										}
+										col_type += "(" + advance().value + ")";
+										consume(TokenType::RPAREN, "Expected ')' after VARCHAR length");
+									}
+
 									bool is_primary_key = false;
 									if (check(TokenType::PRIMARY)) {
 										advance();
@@ -353,6 +398,27 @@ namespace parser {
 						invalidToken("Expected '(' after table name");
 					}
 
+					// WITH (option = value, ...), checked by the binder
+					if (check(TokenType::WITH)) {
+						advance();
+						consume(TokenType::LPAREN, "Expected '(' after WITH");
+						while (!isAtEnd() && !check(TokenType::RPAREN)) {
+							if (!check(TokenType::IDENTIFIER)) {
+								invalidToken("Expected table option name");
+							}
+							std::string option = advance().value;
+							consume(TokenType::EQUALS, "Expected '=' after table option '" + option + "'");
+							if (!check(TokenType::IDENTIFIER) && !check(TokenType::LITERAL)) {
+								invalidToken("Expected value of table option '" + option + "'");
+							}
+							root->children.emplace_back(std::make_unique<ASTNode>(ASTNodeType::TABLE_OPTION, option + "=" + advance().value));
+							if (check(TokenType::COMMA)) {
+								advance();
+							}
+						}
+						consume(TokenType::RPAREN, "Expected ')' after table options");
+					}
+
 					return root;
 				} else {
 					invalidToken("Expected table name after CREATE TABLE");
@@ -378,6 +444,9 @@ namespace parser {
 						projection_list->add_child(std::make_shared<ASTNode>(ASTNodeType::COLUMN_REF, "*"));
 						root->add_child(projection_list);
 						root->add_child(std::make_shared<ASTNode>(ASTNodeType::TABLE_REF, table_name));
+						if (check(TokenType::WHERE)) {
+							root->add_child(parseWhereClause());
+						}
 						return root;
 					} else {
 						invalidToken("Expected table name after FROM");
@@ -407,6 +476,9 @@ namespace parser {
 						}
 						root->add_child(projection_list);
 						root->add_child(std::make_shared<ASTNode>(ASTNodeType::TABLE_REF, table_name));
+						if (check(TokenType::WHERE)) {
+							root->add_child(parseWhereClause());
+						}
 						return root;
 					} else {
 						invalidToken("Expected table exe after FROM");
@@ -431,18 +503,13 @@ namespace parser {
 					if (check(TokenType::VALUES)) {
 						advance();
 
-						std::vector<std::vector<std::string>> value_sets;
+						std::vector<std::vector<std::shared_ptr<ASTNode>>> value_sets;
 
 						if (check(TokenType::LPAREN)) {
 							advance();
-							std::vector<std::string> current_values;
+							std::vector<std::shared_ptr<ASTNode>> current_values;
 							while (!isAtEnd() && !check(TokenType::RPAREN)) {
-								if (check(TokenType::LITERAL)) {
-									std::string value = advance().value;
-									current_values.push_back(value);
-								} else {
-									invalidToken("Expected a literal in VALUES");
-								}
+								current_values.push_back(parseValue("Expected a literal in VALUES"));
 								if (check(TokenType::COMMA)) {
 									advance();
 								}
@@ -455,14 +522,9 @@ namespace parser {
 								advance();
 								if (check(TokenType::LPAREN)) {
 									advance();
-									std::vector<std::string> next_values;
+									std::vector<std::shared_ptr<ASTNode>> next_values;
 									while (!isAtEnd() && !check(TokenType::RPAREN)) {
-										if (check(TokenType::LITERAL)) {
-											std::string value = advance().value;
-											next_values.push_back(value);
-										} else {
-											invalidToken("Expected a literal in VALUES");
-										}
+										next_values.push_back(parseValue("Expected a literal in VALUES"));
 										if (check(TokenType::COMMA)) {
 											advance();
 										}
@@ -477,7 +539,7 @@ namespace parser {
 							if (value_sets.size() == 1) {
 								auto root = std::make_unique<ASTNode>(ASTNodeType::INSERT, table_name);
 								for (const auto& value : value_sets[0]) {
-									root->add_child(std::make_shared<ASTNode>(ASTNodeType::CONST_VALUE, value));
+									root->add_child(value);
 								}
 								return root;
 							} else {
@@ -485,7 +547,7 @@ namespace parser {
 								for (const auto& value_set : value_sets) {
 									auto value_set_node = std::make_shared<ASTNode>(ASTNodeType::CONST_VALUE, "");
 									for (const auto& value : value_set) {
-										value_set_node->add_child(std::make_shared<ASTNode>(ASTNodeType::CONST_VALUE, value));
+										value_set_node->add_child(value);
 									}
 									root->add_child(value_set_node);
 								}
@@ -505,6 +567,86 @@ namespace parser {
 			}
 		}
 
+		case TokenType::DELETE: {
+			// DELETE FROM <table_name> [WHERE ...]
+			advance();
+			consume(TokenType::FROM, "Expected FROM after DELETE");
+			if (!check(TokenType::IDENTIFIER)) {
+				invalidToken("Expected table name after DELETE FROM");
+			}
+			auto root = std::make_unique<ASTNode>(ASTNodeType::DELETE);
+			root->add_child(std::make_shared<ASTNode>(ASTNodeType::TABLE_REF, advance().value));
+			if (check(TokenType::WHERE)) {
+				root->add_child(parseWhereClause());
+			}
+			return root;
+		}
+
+		case TokenType::UPDATE: {
+			// UPDATE <table_name> SET <column> = <literal | NULL>, ... [WHERE ...]
+			// AST: UPDATE(table) -> ASSIGNMENT -> [COLUMN_REF, CONST_VALUE | NULL_VALUE], ..., [WHERE_CLAUSE]
+			advance();
+			if (!check(TokenType::IDENTIFIER)) {
+				invalidToken("Expected table name after UPDATE");
+			}
+			auto root = std::make_unique<ASTNode>(ASTNodeType::UPDATE, advance().value);
+			consume(TokenType::SET, "Expected SET after table name");
+
+			do {
+				if (!check(TokenType::IDENTIFIER)) {
+					invalidToken("Expected column name in SET");
+				}
+				std::string col_name = advance().value;
+				consume(TokenType::EQUALS, "Expected '=' after column name in SET");
+				auto assignment = std::make_shared<ASTNode>(ASTNodeType::ASSIGNMENT);
+				assignment->add_child(std::make_shared<ASTNode>(ASTNodeType::COLUMN_REF, col_name));
+				assignment->add_child(parseValue("Expected a literal after '=' in SET"));
+				root->add_child(assignment);
+			} while (match(TokenType::COMMA));
+
+			if (check(TokenType::WHERE)) {
+				root->add_child(parseWhereClause());
+			}
+			return root;
+		}
+
+		case TokenType::BEGIN:
+		case TokenType::COMMIT:
+		case TokenType::ROLLBACK: {
+			ASTNodeType node_type = first_token.type == TokenType::BEGIN ? ASTNodeType::BEGIN
+			    : first_token.type == TokenType::COMMIT                  ? ASTNodeType::COMMIT
+			                                                             : ASTNodeType::ROLLBACK;
+			std::string keyword = advance().value;
+			if (check(TokenType::SEMICOLON)) {
+				advance();
+			}
+			if (!isAtEnd()) {
+				invalidToken("Unexpected token after " + keyword);
+			}
+			return std::make_unique<ASTNode>(node_type);
+		}
+
+		case TokenType::VACUUM: {
+			// VACUUM FILE | VACUUM <table_name>
+			advance();
+			if (!check(TokenType::IDENTIFIER)) {
+				invalidToken("Expected FILE or a table name after VACUUM");
+			}
+			std::string target = advance().value;
+			std::string lowered = target;
+			std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+			if (lowered == "file") {
+				target.clear();
+			}
+			if (check(TokenType::SEMICOLON)) {
+				advance();
+			}
+			if (!isAtEnd()) {
+				invalidToken("Unexpected token after VACUUM");
+			}
+			return std::make_unique<ASTNode>(ASTNodeType::VACUUM, target);
+		}
+
 		case TokenType::HELP: {
 			advance();
 			if (check(TokenType::SEMICOLON)) {
@@ -538,6 +680,62 @@ namespace parser {
 		}
 	}
 
+	// WHERE <column> <op> <literal>
+	// WHERE <column> IS [NOT] NULL
+	// AST: WHERE_CLAUSE -> CONDITION(op) -> [COLUMN_REF, CONST_VALUE | NULL_VALUE]
+	std::shared_ptr<ASTNode> Parser::parseWhereClause() {
+		consume(TokenType::WHERE, "Expected WHERE");
+
+		if (!check(TokenType::IDENTIFIER)) {
+			invalidToken("Expected column name after WHERE");
+		}
+		std::string col_name = advance().value;
+
+		if (match(TokenType::IS)) {
+			std::string op = match(TokenType::NOT) ? "IS NOT NULL" : "IS NULL";
+			consume(TokenType::NULL_LITERAL, "Expected NULL after IS");
+			auto condition = std::make_shared<ASTNode>(ASTNodeType::CONDITION, op);
+			condition->add_child(std::make_shared<ASTNode>(ASTNodeType::COLUMN_REF, col_name));
+			condition->add_child(std::make_shared<ASTNode>(ASTNodeType::NULL_VALUE));
+
+			auto where_clause = std::make_shared<ASTNode>(ASTNodeType::WHERE_CLAUSE);
+			where_clause->add_child(condition);
+			return where_clause;
+		}
+
+		std::string op;
+		if (check(TokenType::EQUALS) || check(TokenType::NOT_EQUALS) || check(TokenType::LESS_THAN)
+		    || check(TokenType::GREATER_THAN) || check(TokenType::LESS_EQUALS) || check(TokenType::GREATER_EQUALS)) {
+			op = advance().value;
+		} else {
+			invalidToken("Expected comparison operator in WHERE clause");
+		}
+
+		if (!check(TokenType::LITERAL)) {
+			invalidToken("Expected a literal after comparison operator");
+		}
+		std::string literal = advance().value;
+
+		auto condition = std::make_shared<ASTNode>(ASTNodeType::CONDITION, op);
+		condition->add_child(std::make_shared<ASTNode>(ASTNodeType::COLUMN_REF, col_name));
+		condition->add_child(std::make_shared<ASTNode>(ASTNodeType::CONST_VALUE, literal));
+
+		auto where_clause = std::make_shared<ASTNode>(ASTNodeType::WHERE_CLAUSE);
+		where_clause->add_child(condition);
+		return where_clause;
+	}
+
+	// <literal> | NULL
+	std::shared_ptr<ASTNode> Parser::parseValue(const std::string& message) {
+		if (match(TokenType::NULL_LITERAL)) {
+			return std::make_shared<ASTNode>(ASTNodeType::NULL_VALUE);
+		}
+		if (!check(TokenType::LITERAL)) {
+			invalidToken(message);
+		}
+		return std::make_shared<ASTNode>(ASTNodeType::CONST_VALUE, advance().value);
+	}
+
 	bool Parser::isAlpha(char c) {
 		return std::isalpha(c) || c == '_';
 	}
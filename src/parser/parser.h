@@ -64,6 +64,9 @@ namespace parser {
 
 		// Lexer
 		std::vector<Token> tokenize(const std::string& query);
+
+		std::shared_ptr<ASTNode> parseWhereClause();
+		std::shared_ptr<ASTNode> parseValue(const std::string& message);
 		
 		bool isAlpha(char c);
 		bool isDigit(char c);
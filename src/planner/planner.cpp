@@ -19,16 +19,13 @@ namespace planner {
 				throw std::runtime_error("Planner error: Null select node");
 			}
 
-			auto scan_plan = std::make_unique<SeqScanPlanNode>(select_node->table_ref);
-
 			auto projection_plan = std::make_unique<ProjectionPlanNode>(select_node->projections);
+			projection_plan->AddChild(PlanScan(select_node->table_ref, select_node->where_clause.get()));
 
-			projection_plan->AddChild(std::move(scan_plan));
-
-			// where clause and limit will come under filter -> TODO
+			// limit will come under filter -> TODO
 			// can also add joins, aggregations, sorting
 
-			return std::move(projection_plan);
+			return projection_plan;
 		}
 
 		case ASTNodeType::INSERT: {
@@ -55,6 +52,38 @@ namespace planner {
 			    bulk_insert_node->values);
 		}
 
+		case ASTNodeType::DELETE: {
+			auto delete_node = static_cast<BoundDeleteNode*>(bound_ast.get());
+			if (!delete_node) {
+				throw std::runtime_error("Planner error: Null delete node");
+			}
+
+			auto delete_plan = std::make_unique<DeletePlanNode>(delete_node->table_ref);
+			delete_plan->AddChild(PlanScan(delete_node->table_ref, delete_node->where_clause.get()));
+			return delete_plan;
+		}
+
+		case ASTNodeType::UPDATE: {
+			auto update_node = static_cast<BoundUpdateNode*>(bound_ast.get());
+			if (!update_node) {
+				throw std::runtime_error("Planner error: Null update node");
+			}
+
+			auto update_plan = std::make_unique<UpdatePlanNode>(update_node->table_ref, update_node->assignments);
+			update_plan->AddChild(PlanScan(update_node->table_ref, update_node->where_clause.get()));
+			return update_plan;
+		}
+
+		case ASTNodeType::BEGIN:
+			return std::make_unique<TransactionPlanNode>(PlanNodeType::BEGIN);
+		case ASTNodeType::COMMIT:
+			return std::make_unique<TransactionPlanNode>(PlanNodeType::COMMIT);
+		case ASTNodeType::ROLLBACK:
+			return std::make_unique<TransactionPlanNode>(PlanNodeType::ROLLBACK);
+
+		case ASTNodeType::VACUUM:
+			return std::make_unique<VacuumPlanNode>(static_cast<BoundVacuumNode*>(bound_ast.get())->table_ref);
+
 		case ASTNodeType::CREATE_TABLE: {
 			auto create_table_node = static_cast<BoundCreateTableNode*>(bound_ast.get());
 			if (!create_table_node) {
@@ -63,7 +92,8 @@ namespace planner {
 
 			return std::make_unique<CreateTablePlanNode>(
 			    create_table_node->table_name,
-			    create_table_node->schema);
+			    create_table_node->schema,
+			    create_table_node->columnar);
 		}
 
 		case ASTNodeType::CREATE_DATABASE:
@@ -121,5 +151,16 @@ namespace planner {
 		}
 	}
 
+	std::unique_ptr<PlanNode> Planner::PlanScan(TableRef* table_ref, const Expression* where_clause) {
+		auto scan_plan = std::make_unique<SeqScanPlanNode>(table_ref);
+		if (where_clause == nullptr) {
+			return scan_plan;
+		}
+
+		auto filter_plan = std::make_unique<FilterPlanNode>(*where_clause);
+		filter_plan->AddChild(std::move(scan_plan));
+		return filter_plan;
+	}
+
 } // namespace planner
 } // namespace venus
\ No newline at end of file
@@ -45,9 +45,14 @@
  *   CREATE_INDEX    — Create an index on table columns
  *   DROP_INDEX      — Remove an index
  *
+ * Transaction Control:
+ *   BEGIN / COMMIT / ROLLBACK — explicit transaction spanning several statements
+ *
  * Utility / Meta Commands:
  *   SHOW_DATABASES — List available databases
  *   SHOW_TABLES    — List tables in current database
+ *   VACUUM         — VACUUM FILE, give free pages at the end of the file back to the OS
+ *                    VACUUM <table>, move the rows of sparse pages into earlier pages
  *   HELP           — Display help message
  *   EXIT           — Exit the shell
  *   EXEC_FILE      — Execute SQL from a file
@@ -71,7 +76,14 @@
  *   → INSERT(table=employees, columns=[name, age], values=[["Alice", "30"]])
  *
  * UPDATE employees SET age=31 WHERE name='Alice'
- *   → UPDATE(table=employees, set_clauses={age=31}, condition="name='Alice'")
+ *   → UPDATE(table=employees, set_clauses={age=31})
+ *        → FILTER(condition="name='Alice'")
+ *             → SEQ_SCAN(table=employees)
+ *
+ * DELETE FROM employees WHERE age > 60
+ *   → DELETE(table=employees)
+ *        → FILTER(condition="age > 60")
+ *             → SEQ_SCAN(table=employees)
  */
 
 #pragma once
@@ -126,6 +138,15 @@ namespace planner {
 		    , table_ref_(table_ref) { }
 	};
 
+	class FilterPlanNode : public PlanNode {
+	public:
+		Expression predicate_;
+
+		explicit FilterPlanNode(const Expression& predicate)
+		    : PlanNode(PlanNodeType::FILTER)
+		    , predicate_(predicate) { }
+	};
+
 	class ProjectionPlanNode : public PlanNode {
 	public:
 		std::vector<ColumnRef> column_refs_;
@@ -163,15 +184,55 @@ namespace planner {
 		    , value_sets(value_sets) { }
 	};
 
+	// child produces the rows to delete
+	class DeletePlanNode : public PlanNode {
+	public:
+		TableRef* table_ref;
+
+		explicit DeletePlanNode(TableRef* table_ref)
+		    : PlanNode(PlanNodeType::DELETE)
+		    , table_ref(table_ref) { }
+	};
+
+	// child produces the rows to update
+	class UpdatePlanNode : public PlanNode {
+	public:
+		TableRef* table_ref;
+		std::vector<std::pair<ColumnRef, ConstantType>> assignments;
+
+		UpdatePlanNode(TableRef* table_ref, const std::vector<std::pair<ColumnRef, ConstantType>>& assignments)
+		    : PlanNode(PlanNodeType::UPDATE)
+		    , table_ref(table_ref)
+		    , assignments(assignments) { }
+	};
+
+	class TransactionPlanNode : public PlanNode {
+	public:
+		explicit TransactionPlanNode(PlanNodeType type)
+		    : PlanNode(type) { }
+	};
+
+	// VACUUM FILE, or VACUUM <table> with table_ref
+	class VacuumPlanNode : public PlanNode {
+	public:
+		TableRef* table_ref;
+
+		explicit VacuumPlanNode(TableRef* table_ref = nullptr)
+		    : PlanNode(PlanNodeType::VACUUM)
+		    , table_ref(table_ref) { }
+	};
+
 	class CreateTablePlanNode : public PlanNode {
 	public:
 		std::string table_name_;
 		Schema schema_;
+		bool columnar_;
 
-		CreateTablePlanNode(const std::string& table_name, const Schema& schema)
+		CreateTablePlanNode(const std::string& table_name, const Schema& schema, bool columnar = false)
 		    : PlanNode(PlanNodeType::CREATE_TABLE)
 		    , table_name_(table_name)
-		    , schema_(schema) { }
+		    , schema_(schema)
+		    , columnar_(columnar) { }
 	};
 
 	class DatabaseOpPlanNode : public PlanNode {
@@ -219,6 +280,10 @@ namespace planner {
 		~Planner() = default;
 
 		std::unique_ptr<PlanNode> Plan(std::unique_ptr<BoundASTNode> bound_ast);
+
+	private:
+		// SEQ_SCAN with an optional FILTER on top, the input of SELECT, UPDATE and DELETE
+		std::unique_ptr<PlanNode> PlanScan(TableRef* table_ref, const Expression* where_clause);
 	};
 
 } // namespace planner
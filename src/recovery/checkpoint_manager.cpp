@@ -0,0 +1,103 @@
+// /src/recovery/checkpoint_manager.cpp
+
+#include "recovery/checkpoint_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace venus {
+namespace recovery {
+
+	CheckpointManager::CheckpointManager(buffer::BufferPoolManager* bpm, storage::DiskManager* disk_manager,
+	    LogManager* log_manager, concurrency::TransactionManager* txn_manager)
+	    : bpm_(bpm)
+	    , disk_manager_(disk_manager)
+	    , log_manager_(log_manager)
+	    , txn_manager_(txn_manager)
+	    , last_begin_lsn_(FIRST_LSN)
+	    , last_end_lsn_(INVALID_LSN)
+	    , stop_(true) { }
+
+	CheckpointManager::~CheckpointManager() {
+		Stop();
+	}
+
+	void CheckpointManager::Start() {
+		std::lock_guard<std::mutex> lock(latch_);
+		if (!stop_) {
+			return;
+		}
+		stop_ = false;
+		thread_ = std::thread(&CheckpointManager::CheckpointLoop, this);
+	}
+
+	void CheckpointManager::Stop() {
+		{
+			std::lock_guard<std::mutex> lock(latch_);
+			stop_ = true;
+		}
+		cv_.notify_one();
+		if (thread_.joinable()) {
+			thread_.join();
+		}
+	}
+
+	lsn_t CheckpointManager::Checkpoint() {
+		std::lock_guard<std::mutex> lock(checkpoint_latch_);
+
+		lsn_t begin_lsn = log_manager_->GetNextLSN();
+
+		if (!bpm_->FlushPagesBefore(last_begin_lsn_)) {
+			throw std::runtime_error("Checkpoint error: Failed to write back old dirty pages");
+		}
+
+		auto dirty_pages = bpm_->GetDirtyPageTable();
+		disk_manager_->Sync();
+
+		// the oldest record recovery can still read: analysis starts at begin_lsn, redo at the
+		// oldest rec lsn and undo follows the transactions in the table back to their BEGIN.
+		// Read before the table is taken, a transaction that logs later does so after begin_lsn
+		lsn_t keep_lsn = std::min(begin_lsn, txn_manager_->GetOldestActiveLSN());
+		for (const auto& entry : dirty_pages) {
+			keep_lsn = std::min(keep_lsn, entry.second);
+		}
+
+		LogRecord record(begin_lsn, txn_manager_->GetNextTxnId(), txn_manager_->GetActiveTransactions(), std::move(dirty_pages));
+		lsn_t checkpoint_lsn = log_manager_->AppendLogRecord(nullptr, &record);
+		log_manager_->Flush(checkpoint_lsn);
+		log_manager_->WriteCheckpointLSN(checkpoint_lsn);
+
+		// recovery starts at begin_lsn from now on, pages freed before it can be reused
+		disk_manager_->ReleasePages(begin_lsn);
+
+		last_begin_lsn_ = begin_lsn;
+		last_end_lsn_ = checkpoint_lsn + record.GetSize();
+
+		log_manager_->Truncate(keep_lsn);
+		return checkpoint_lsn;
+	}
+
+	void CheckpointManager::CheckpointLoop() {
+		std::unique_lock<std::mutex> lock(latch_);
+		while (!stop_) {
+			cv_.wait_for(lock, std::chrono::milliseconds(CHECKPOINT_INTERVAL_MS), [this]() { return stop_; });
+			if (stop_) {
+				break;
+			}
+
+			lock.unlock();
+			try {
+				// nothing logged since the last checkpoint, it would be identical
+				if (log_manager_->GetNextLSN() != last_end_lsn_) {
+					Checkpoint();
+				}
+			} catch (const std::exception& e) {
+				LOG(e.what());
+			}
+			lock.lock();
+		}
+	}
+
+} // namespace recovery
+} // namespace venus
@@ -0,0 +1,72 @@
+// /src/recovery/checkpoint_manager.h
+
+/**
+ * CheckpointManager for VenusDB - fuzzy checkpoints that bound recovery time.
+ *
+ * A checkpoint does not stop the world: transactions keep running while it is taken.
+ *   1. begin_lsn = next LSN of the log, every later change is covered by the log scan
+ *   2. write back pages dirty since before the previous checkpoint, so redo never has to
+ *      go further back than one checkpoint interval
+ *   3. snapshot the dirty page table (page -> rec lsn), then fsync the db file so pages that
+ *      are not in the snapshot are really on disk
+ *   4. snapshot the active transaction table (txn -> last lsn)
+ *   5. log a CHECKPOINT record with both tables, flush it, and point the log's master record at it
+ *   6. truncate the log below the oldest of begin_lsn, the rec lsns in the dirty page table and
+ *      the first LSN of every active transaction, nothing below it is read by recovery again
+ *
+ * Recovery starts its analysis at begin_lsn with the two tables; a crash before step 5
+ * finishes leaves the master record at the previous checkpoint.
+ *
+ * A background thread takes a checkpoint every CHECKPOINT_INTERVAL_MS if anything was logged.
+ */
+
+#pragma once
+
+#include "buffer/buffer_pool.h"
+#include "common/config.h"
+#include "concurrency/transaction_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk_manager.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace venus {
+namespace recovery {
+
+	class CheckpointManager {
+	public:
+		CheckpointManager(buffer::BufferPoolManager* bpm, storage::DiskManager* disk_manager,
+		    LogManager* log_manager, concurrency::TransactionManager* txn_manager);
+		~CheckpointManager();
+
+		void Start();
+		void Stop();
+
+		// takes a checkpoint now, returns the LSN of its CHECKPOINT record
+		lsn_t Checkpoint();
+
+	private:
+		buffer::BufferPoolManager* bpm_;
+		storage::DiskManager* disk_manager_;
+		LogManager* log_manager_;
+		concurrency::TransactionManager* txn_manager_;
+
+		std::mutex checkpoint_latch_; // one checkpoint at a time
+		lsn_t last_begin_lsn_; // begin_lsn of the previous checkpoint
+		std::atomic<lsn_t> last_end_lsn_; // next LSN right after the previous checkpoint record
+
+		std::mutex latch_;
+		std::condition_variable cv_;
+		bool stop_;
+		std::thread thread_;
+
+		void CheckpointLoop();
+
+		DISALLOW_COPY_AND_MOVE(CheckpointManager);
+	};
+
+} // namespace recovery
+} // namespace venus
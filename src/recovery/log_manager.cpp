@@ -0,0 +1,426 @@
+// /src/recovery/log_manager.cpp
+
+#include "recovery/log_manager.h"
+#include "concurrency/transaction.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace venus {
+namespace recovery {
+
+	namespace {
+
+		void WriteAll(int fd, const char* data, size_t len, off_t offset, const std::string& log_file) {
+			size_t written = 0;
+			while (written < len) {
+				ssize_t n = ::pwrite(fd, data + written, len - written, offset + static_cast<off_t>(written));
+				if (n < 0) {
+					throw std::runtime_error("LogManager error: Failed to write log file: " + log_file);
+				}
+				written += static_cast<size_t>(n);
+			}
+		}
+
+		// the intact record at offset of fd, false if there is none
+		bool ReadRecordAt(int fd, off_t offset, LogRecord* record) {
+			LogRecordHeader header;
+			if (::pread(fd, &header, sizeof(header), offset) != static_cast<ssize_t>(sizeof(header))) {
+				return false;
+			}
+			if (header.size < sizeof(LogRecordHeader) || header.size > LOG_BUFFER_SIZE) {
+				return false;
+			}
+
+			std::vector<char> buf(header.size);
+			if (::pread(fd, buf.data(), header.size, offset) != static_cast<ssize_t>(header.size)) {
+				return false;
+			}
+			return LogRecord::DeserializeFrom(buf.data(), buf.size(), record);
+		}
+
+		// makes a rename in the directory durable
+		void SyncDirectory(const std::string& file) {
+			size_t slash = file.find_last_of('/');
+			std::string directory = slash == std::string::npos ? "." : file.substr(0, slash);
+			int fd = ::open(directory.c_str(), O_RDONLY);
+			if (fd >= 0) {
+				::fsync(fd);
+				::close(fd);
+			}
+		}
+
+	} // namespace
+
+	LogManager::LogManager(const std::string& log_file)
+	    : log_file_(log_file)
+	    , fd_(-1)
+	    , base_lsn_(FIRST_LSN)
+	    , written_lsn_(FIRST_LSN)
+	    , log_buffer_(LOG_BUFFER_SIZE)
+	    , flush_buffer_(LOG_BUFFER_SIZE)
+	    , log_buffer_used_(0)
+	    , next_lsn_(FIRST_LSN)
+	    , last_buffered_lsn_(0)
+	    , persistent_lsn_(0)
+	    , checkpoint_lsn_(INVALID_LSN)
+	    , num_syncs_(0)
+	    , flush_requested_(false)
+	    , stop_(false)
+	    , io_error_(false) {
+		fd_ = ::open(log_file_.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd_ < 0) {
+			throw std::runtime_error("LogManager error: Failed to open log file: " + log_file_);
+		}
+
+		struct stat st;
+		if (::fstat(fd_, &st) != 0) {
+			::close(fd_);
+			throw std::runtime_error("LogManager error: Failed to stat log file: " + log_file_);
+		}
+
+		if (st.st_size < static_cast<off_t>(sizeof(LogFileHeader))) {
+			// new log
+			LogFileHeader header { LOG_FILE_MAGIC, LOG_FILE_VERSION, INVALID_LSN, FIRST_LSN };
+			WriteAndSync(reinterpret_cast<const char*>(&header), sizeof(header), 0);
+		} else {
+			LogFileHeader header;
+			if (::pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || header.magic != LOG_FILE_MAGIC) {
+				::close(fd_);
+				throw std::runtime_error("LogManager error: Not a VenusDB log file: " + log_file_);
+			}
+			if (header.version != LOG_FILE_VERSION) {
+				::close(fd_);
+				throw std::runtime_error("LogManager error: Unsupported log file version " + std::to_string(header.version) + ": " + log_file_);
+			}
+			checkpoint_lsn_ = header.checkpoint_lsn;
+			base_lsn_ = header.base_lsn;
+			RecoverLogEnd(static_cast<lsn_t>(st.st_size));
+		}
+
+		flush_thread_ = std::thread(&LogManager::FlushLoop, this);
+	}
+
+	LogManager::~LogManager() {
+		{
+			std::lock_guard<std::mutex> lock(latch_);
+			stop_ = true;
+			flush_requested_ = true;
+		}
+		flush_cv_.notify_one();
+		flush_thread_.join();
+
+		if (fd_ >= 0) {
+			::close(fd_);
+		}
+	}
+
+	lsn_t LogManager::AppendLogRecord(concurrency::Transaction* txn, LogRecord* record) {
+		std::unique_lock<std::mutex> lock(latch_);
+
+		if (txn == nullptr) {
+			record->SetTxn(INVALID_TXN_ID, INVALID_LSN);
+			return Append(record, lock);
+		}
+
+		if (txn->GetPrevLSN() == INVALID_LSN && record->GetType() != LogRecordType::BEGIN) {
+			LogRecord begin(LogRecordType::BEGIN);
+			begin.SetTxn(txn->GetTxnId(), INVALID_LSN);
+			txn->SetPrevLSN(Append(&begin, lock));
+			txn->SetFirstLSN(txn->GetPrevLSN());
+		}
+
+		record->SetTxn(txn->GetTxnId(), txn->GetPrevLSN());
+		lsn_t lsn = Append(record, lock);
+		if (txn->GetFirstLSN() == INVALID_LSN) {
+			txn->SetFirstLSN(lsn);
+		}
+		txn->SetPrevLSN(lsn);
+		return lsn;
+	}
+
+	// latch_ must be held
+	lsn_t LogManager::Append(LogRecord* record, std::unique_lock<std::mutex>& lock) {
+		uint32_t size = record->GetSize();
+		if (size > LOG_BUFFER_SIZE) {
+			throw std::runtime_error("LogManager error: Log record larger than the log buffer");
+		}
+
+		// buffer full -> hand it to the flusher and wait for the swap
+		while (log_buffer_used_ + size > LOG_BUFFER_SIZE) {
+			if (io_error_) {
+				throw std::runtime_error("LogManager error: Log is not writable");
+			}
+			flush_requested_ = true;
+			flush_cv_.notify_one();
+			flushed_cv_.wait(lock);
+		}
+
+		lsn_t lsn = next_lsn_;
+		next_lsn_ = lsn + size;
+
+		record->SetLSN(lsn);
+		record->SerializeTo(log_buffer_.data() + log_buffer_used_);
+		log_buffer_used_ += size;
+		last_buffered_lsn_ = lsn;
+
+		return lsn;
+	}
+
+	void LogManager::Flush(lsn_t lsn) {
+		if (lsn == INVALID_LSN || persistent_lsn_ >= lsn) {
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(latch_);
+		while (persistent_lsn_ < lsn) {
+			if (io_error_) {
+				throw std::runtime_error("LogManager error: Failed to write log file: " + log_file_);
+			}
+			flush_requested_ = true;
+			flush_cv_.notify_one();
+			flushed_cv_.wait(lock);
+		}
+	}
+
+	void LogManager::FlushAll() {
+		lsn_t last_lsn;
+		{
+			std::lock_guard<std::mutex> lock(latch_);
+			last_lsn = last_buffered_lsn_;
+		}
+		Flush(last_lsn);
+	}
+
+	void LogManager::WriteCheckpointLSN(lsn_t lsn) {
+		if (lsn != INVALID_LSN && lsn > persistent_lsn_) {
+			throw std::runtime_error("LogManager error: Checkpoint record is not durable yet");
+		}
+
+		std::shared_lock<std::shared_mutex> file_lock(file_latch_);
+		LogFileHeader header { LOG_FILE_MAGIC, LOG_FILE_VERSION, lsn, base_lsn_ };
+		WriteAndSync(reinterpret_cast<const char*>(&header), sizeof(header), 0);
+		checkpoint_lsn_ = lsn;
+	}
+
+	void LogManager::Truncate(lsn_t lsn) {
+		std::unique_lock<std::shared_mutex> file_lock(file_latch_);
+
+		lsn = std::min(lsn, written_lsn_);
+		if (lsn <= base_lsn_ || lsn - base_lsn_ < LOG_TRUNCATE_MIN_BYTES || lsn - base_lsn_ < written_lsn_ - lsn) {
+			return;
+		}
+
+		std::string temp_file = log_file_ + ".tmp";
+		int fd = ::open(temp_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			throw std::runtime_error("LogManager error: Failed to create log file: " + temp_file);
+		}
+
+		try {
+			LogFileHeader header { LOG_FILE_MAGIC, LOG_FILE_VERSION, checkpoint_lsn_, lsn };
+			WriteAll(fd, reinterpret_cast<const char*>(&header), sizeof(header), 0, temp_file);
+
+			std::vector<char> buf(LOG_BUFFER_SIZE);
+			for (lsn_t pos = lsn; pos < written_lsn_;) {
+				size_t len = static_cast<size_t>(std::min<lsn_t>(buf.size(), written_lsn_ - pos));
+				if (::pread(fd_, buf.data(), len, FileOffset(pos)) != static_cast<ssize_t>(len)) {
+					throw std::runtime_error("LogManager error: Failed to read log file: " + log_file_);
+				}
+				WriteAll(fd, buf.data(), len, static_cast<off_t>(FIRST_LSN + (pos - lsn)), temp_file);
+				pos += len;
+			}
+
+			if (::fdatasync(fd) != 0 || ::rename(temp_file.c_str(), log_file_.c_str()) != 0) {
+				throw std::runtime_error("LogManager error: Failed to replace log file: " + log_file_);
+			}
+		} catch (...) {
+			::close(fd);
+			::unlink(temp_file.c_str());
+			throw;
+		}
+		SyncDirectory(log_file_);
+
+		::close(fd_);
+		fd_ = fd;
+		base_lsn_ = lsn;
+	}
+
+	lsn_t LogManager::GetBaseLSN() const {
+		std::shared_lock<std::shared_mutex> file_lock(file_latch_);
+		return base_lsn_;
+	}
+
+	bool LogManager::ReadLogRecord(lsn_t lsn, LogRecord* record) const {
+		if (lsn == INVALID_LSN || lsn < FIRST_LSN || lsn > persistent_lsn_) {
+			return false;
+		}
+
+		std::shared_lock<std::shared_mutex> file_lock(file_latch_);
+		if (lsn < base_lsn_) {
+			return false;
+		}
+		return ReadRecordAt(fd_, FileOffset(lsn), record);
+	}
+
+	bool LogManager::NeedsRecovery(const std::string& log_file, txn_id_t* next_txn_id) {
+		*next_txn_id = 0;
+		int fd = ::open(log_file.c_str(), O_RDONLY);
+		if (fd < 0) {
+			if (errno == ENOENT) {
+				return false; // nothing was ever logged
+			}
+			throw std::runtime_error("LogManager error: Failed to open log file: " + log_file);
+		}
+
+		LogFileHeader header;
+		ssize_t n = ::pread(fd, &header, sizeof(header), 0);
+		if (n < static_cast<ssize_t>(sizeof(header))) {
+			::close(fd);
+			return false;
+		}
+		if (header.magic != LOG_FILE_MAGIC || header.version != LOG_FILE_VERSION) {
+			::close(fd);
+			throw std::runtime_error("LogManager error: Not a VenusDB log file: " + log_file);
+		}
+
+		auto offset = [&](lsn_t lsn) { return static_cast<off_t>(FIRST_LSN + (lsn - header.base_lsn)); };
+		LogRecord record;
+		bool needs_recovery;
+		if (header.checkpoint_lsn == INVALID_LSN) {
+			needs_recovery = ReadRecordAt(fd, offset(header.base_lsn), &record);
+		} else if (header.checkpoint_lsn < header.base_lsn || !ReadRecordAt(fd, offset(header.checkpoint_lsn), &record)
+		    || record.GetType() != LogRecordType::CHECKPOINT) {
+			needs_recovery = true;
+		} else {
+			*next_txn_id = record.GetNextTxnId();
+			// a clean close flushes every page and takes a checkpoint, after it only the pages the
+			// checkpoint made reusable are logged, which the stored free list has too
+			needs_recovery = !record.GetActiveTxns().empty() || !record.GetDirtyPages().empty();
+			for (lsn_t lsn = header.checkpoint_lsn + record.GetSize(); !needs_recovery && ReadRecordAt(fd, offset(lsn), &record); lsn += record.GetSize()) {
+				needs_recovery = !record.IsFreeListChange();
+			}
+		}
+		::close(fd);
+		return needs_recovery;
+	}
+
+	void LogManager::FlushLoop() {
+		std::unique_lock<std::mutex> lock(latch_);
+
+		while (true) {
+			flush_cv_.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_TIMEOUT_MS), [this]() {
+				return flush_requested_;
+			});
+			flush_requested_ = false;
+
+			if (log_buffer_used_ > 0 && !io_error_) {
+				// swap buffers so appenders keep going while this batch is written
+				std::swap(log_buffer_, flush_buffer_);
+				size_t len = log_buffer_used_;
+				lsn_t offset = next_lsn_ - len;
+				lsn_t flush_lsn = last_buffered_lsn_;
+				log_buffer_used_ = 0;
+				flushed_cv_.notify_all(); // appenders waiting for space
+
+				lock.unlock();
+				bool ok = true;
+				try {
+					std::shared_lock<std::shared_mutex> file_lock(file_latch_);
+					WriteAndSync(flush_buffer_.data(), len, FileOffset(offset));
+					written_lsn_ = offset + len;
+				} catch (const std::exception& e) {
+					LOG(e.what());
+					ok = false;
+				}
+				lock.lock();
+
+				if (ok) {
+					persistent_lsn_ = flush_lsn;
+				} else {
+					io_error_ = true;
+				}
+				flushed_cv_.notify_all();
+			}
+
+			if (stop_ && (log_buffer_used_ == 0 || io_error_)) {
+				break;
+			}
+		}
+	}
+
+	void LogManager::WriteAndSync(const char* data, size_t len, off_t offset) {
+		WriteAll(fd_, data, len, offset, log_file_);
+
+		if (::fdatasync(fd_) != 0) {
+			throw std::runtime_error("LogManager error: Failed to sync log file: " + log_file_);
+		}
+		num_syncs_++;
+	}
+
+	// Finds the end of the last intact record and cuts off anything after it. Everything before
+	// the last checkpoint record was durable when the master record was written, so the scan
+	// starts at that record and reads the log a buffer at a time.
+	void LogManager::RecoverLogEnd(lsn_t file_size) {
+		lsn_t file_end = base_lsn_ + (file_size - FIRST_LSN);
+		lsn_t start = base_lsn_;
+		if (checkpoint_lsn_ != INVALID_LSN && checkpoint_lsn_ >= base_lsn_ && checkpoint_lsn_ < file_end) {
+			start = checkpoint_lsn_;
+		}
+
+		std::vector<char> buf(LOG_BUFFER_SIZE);
+		lsn_t buf_lsn = start;
+		size_t buf_len = 0;
+		auto fill = [&](lsn_t from) {
+			size_t len = static_cast<size_t>(std::min<lsn_t>(buf.size(), file_end - from));
+			ssize_t n = ::pread(fd_, buf.data(), len, FileOffset(from));
+			if (n < 0) {
+				throw std::runtime_error("LogManager error: Failed to read log file: " + log_file_);
+			}
+			buf_lsn = from;
+			buf_len = static_cast<size_t>(n);
+		};
+
+		lsn_t lsn = start;
+		LogRecord record;
+		fill(lsn);
+		while (true) {
+			size_t pos = static_cast<size_t>(lsn - buf_lsn);
+			if (!LogRecord::DeserializeFrom(buf.data() + pos, buf_len - pos, &record)) {
+				// records are never larger than the buffer, one starting at buf_lsn is torn
+				if (pos == 0) {
+					break;
+				}
+				fill(lsn);
+				continue;
+			}
+			if (record.GetLSN() != lsn) {
+				break; // stale bytes from before a previous truncation
+			}
+			persistent_lsn_ = lsn;
+			last_buffered_lsn_ = lsn;
+			lsn += record.GetSize();
+		}
+
+		if (lsn == start && start != base_lsn_) {
+			// the master record points at a record that is not there, fall back to the whole log
+			checkpoint_lsn_ = INVALID_LSN;
+			RecoverLogEnd(file_size);
+			return;
+		}
+
+		next_lsn_ = lsn;
+		written_lsn_ = lsn;
+		if (static_cast<lsn_t>(FileOffset(lsn)) != file_size && ::ftruncate(fd_, FileOffset(lsn)) != 0) {
+			throw std::runtime_error("LogManager error: Failed to truncate torn log tail: " + log_file_);
+		}
+	}
+
+} // namespace recovery
+} // namespace venus
@@ -0,0 +1,148 @@
+// /src/recovery/log_manager.h
+
+/**
+ * LogManager for VenusDB - the write-ahead log of one database.
+ *
+ * The log lives next to the database file as <db_name>.log:
+ *   +------------------+----------+----------+-----
+ *   | LogFileHeader    | record 1 | record 2 | ...
+ *   +------------------+----------+----------+-----
+ * A record's LSN is its byte offset in the log as if nothing had ever been truncated: the record
+ * at file offset FIRST_LSN has the header's base_lsn, FIRST_LSN in a log that was never truncated.
+ * The header keeps LSN 0 unused so a fresh page (page_lsn 0) is older than every record.
+ *
+ * Appending
+ *   AppendLogRecord() serializes the record into an in-memory log buffer and assigns its LSN.
+ *   Nothing is written to disk on the calling thread.
+ *
+ * Group commit
+ *   A background flusher owns all log I/O. It swaps the full log buffer with an empty one,
+ *   writes it and issues a single fdatasync. Flush(lsn) only asks the flusher to run and waits,
+ *   so every commit that arrives while a sync is in flight is made durable by the next one.
+ *   The flusher also runs every LOG_FLUSH_TIMEOUT_MS and whenever the buffer fills up.
+ *
+ * WAL-before-data
+ *   Pages carry the LSN of their last change. The buffer pool calls Flush(page_lsn) before it
+ *   writes a page back, so a page on disk never holds a change whose log record is not durable.
+ *
+ * Opening an existing log scans it from the last checkpoint record to find the end of the last
+ * intact record; a torn tail from a crash during a write is cut off before anything new is appended.
+ *
+ * Checkpoints
+ *   The file header doubles as the master record: it holds the LSN of the last complete
+ *   CHECKPOINT record, which is where recovery starts reading.
+ *
+ * Truncation
+ *   Truncate(lsn) drops the records below lsn once recovery can no longer need them. The records
+ *   kept are copied into <db_name>.log.tmp behind a header with the new base_lsn, synced, and
+ *   renamed over the log, so a crash leaves either the old log or the new one. The copy only
+ *   happens when it frees LOG_TRUNCATE_MIN_BYTES and at least as many bytes as it copies.
+ */
+
+#pragma once
+
+#include "common/config.h"
+#include "recovery/log_record.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+namespace venus {
+namespace concurrency {
+	class Transaction;
+}
+}
+
+namespace venus {
+namespace recovery {
+
+	struct LogFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		lsn_t checkpoint_lsn; // INVALID_LSN until a checkpoint is taken
+		lsn_t base_lsn; // LSN of the first record in the file, the one at offset FIRST_LSN
+	};
+
+	constexpr uint32_t LOG_FILE_MAGIC = 0x564c4f47; // "VLOG"
+	constexpr uint32_t LOG_FILE_VERSION = 2;
+	constexpr lsn_t FIRST_LSN = sizeof(LogFileHeader);
+
+	class LogManager {
+	public:
+		explicit LogManager(const std::string& log_file);
+		~LogManager();
+
+		// true if opening the database needs recovery: the log has records other than free list
+		// changes after its last checkpoint, or that checkpoint saw dirty pages or running
+		// transactions. Only reads the log, if any.
+		// Otherwise next_txn_id is set to the next transaction id the checkpoint recorded
+		static bool NeedsRecovery(const std::string& log_file, txn_id_t* next_txn_id);
+
+		// Assigns the record its LSN and buffers it. With a transaction the record is chained to
+		// the transaction's previous record, and a BEGIN is logged first if this is its first record.
+		lsn_t AppendLogRecord(concurrency::Transaction* txn, LogRecord* record);
+
+		// Blocks until every record up to lsn is on disk
+		void Flush(lsn_t lsn);
+		void FlushAll();
+
+		// Reads one durable record, false if there is no intact record at lsn
+		bool ReadLogRecord(lsn_t lsn, LogRecord* record) const;
+
+		// master record, updated after the CHECKPOINT record itself is durable
+		lsn_t GetCheckpointLSN() const { return checkpoint_lsn_; }
+		void WriteCheckpointLSN(lsn_t lsn);
+
+		// drops the durable records below lsn, a record boundary; see Truncation above
+		void Truncate(lsn_t lsn);
+		lsn_t GetBaseLSN() const; // records below this were truncated
+
+		lsn_t GetPersistentLSN() const { return persistent_lsn_; } // 0 if nothing is durable yet
+		lsn_t GetNextLSN() const { return next_lsn_; } // every record appended later has an LSN >= this
+		uint64_t GetNumSyncs() const { return num_syncs_; }
+		const std::string& GetLogFile() const { return log_file_; }
+
+	private:
+		std::string log_file_;
+		int fd_;
+
+		// fd_, base_lsn_ and written_lsn_; shared to read or write the file, exclusive to truncate it
+		mutable std::shared_mutex file_latch_;
+		lsn_t base_lsn_;
+		lsn_t written_lsn_; // end of the records written to the file
+
+		std::mutex latch_; // protects the non-atomic members below
+		std::condition_variable flush_cv_; // wakes the flusher
+		std::condition_variable flushed_cv_; // flusher swapped or synced a buffer
+
+		std::vector<char> log_buffer_; // records being appended
+		std::vector<char> flush_buffer_; // records being written by the flusher
+		size_t log_buffer_used_;
+		std::atomic<lsn_t> next_lsn_;
+		lsn_t last_buffered_lsn_; // LSN of the last record in log_buffer_
+		std::atomic<lsn_t> persistent_lsn_;
+		std::atomic<lsn_t> checkpoint_lsn_;
+		std::atomic<uint64_t> num_syncs_;
+
+		bool flush_requested_;
+		bool stop_;
+		bool io_error_;
+		std::thread flush_thread_;
+
+		void FlushLoop();
+		void WriteAndSync(const char* data, size_t len, off_t offset);
+		off_t FileOffset(lsn_t lsn) const { return static_cast<off_t>(FIRST_LSN + (lsn - base_lsn_)); }
+		lsn_t Append(LogRecord* record, std::unique_lock<std::mutex>& lock);
+		void RecoverLogEnd(lsn_t file_size);
+
+		DISALLOW_COPY_AND_MOVE(LogManager);
+	};
+
+} // namespace recovery
+} // namespace venus
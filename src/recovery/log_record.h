@@ -0,0 +1,467 @@
+// /src/recovery/log_record.h
+
+/**
+ * Write-ahead log records for VenusDB.
+ *
+ * Every change to a table page is described by a log record before the page may reach disk.
+ * Records are physiological: they name a page and slot, and carry the tuple image needed
+ * to redo and undo the change on that page.
+ *
+ * Record Layout
+ * +-----------------------------------------------------------+
+ * | size | checksum | type | txn_id | lsn | prev_lsn          |  LogRecordHeader
+ * +-----------------------------------------------------------+
+ * | payload (depends on type)                                 |
+ * +-----------------------------------------------------------+
+ *
+ * Payloads
+ * - BEGIN / COMMIT / ABORT: none
+ * - INSERT / DELETE:        rid, tuple image
+ * - UPDATE:                 rid, old tuple image, new tuple image (same size, in place)
+ * - NEW_PAGE:               page_id, prev_page_id (page appended to a heap chain),
+ *                           field count and widths if the page is columnar
+ * - UNLINK_PAGE:            page_id, prev_page_id, next_page_id (empty page taken out of a heap chain)
+ * - ALLOCATE_PAGES /
+ *   FREE_PAGES:             first page_id, page count (pages taken from / put on the file's free list)
+ * - CLR:                    undo_next_lsn, undone type, rid, image to restore
+ *                           (compensation record written while undoing, redo-only)
+ * - CHECKPOINT:             begin_lsn, next_txn_id, active transaction table, dirty page table
+ *
+ * LSN is the byte offset of the record in the log (see LogManager for truncation), so records
+ * can be located directly from an LSN. prev_lsn chains the records of one transaction backwards (for undo).
+ * Changes made outside a transaction (catalog bootstrap, garbage collection, the free list) use
+ * INVALID_TXN_ID and are redo-only.
+ */
+
+#pragma once
+
+#include "common/config.h"
+#include "storage/tuple.h"
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace venus {
+namespace recovery {
+
+	enum class LogRecordType : uint8_t {
+		INVALID = 0,
+		BEGIN,
+		COMMIT,
+		ABORT,
+		INSERT,
+		DELETE,
+		UPDATE,
+		NEW_PAGE,
+		CLR,
+		CHECKPOINT,
+		UNLINK_PAGE,
+		ALLOCATE_PAGES,
+		FREE_PAGES,
+	};
+
+	struct LogRecordHeader {
+		uint32_t size; // whole record, header included
+		uint32_t checksum; // over the record with this field zeroed
+		LogRecordType type;
+		txn_id_t txn_id;
+		lsn_t lsn;
+		lsn_t prev_lsn;
+	};
+
+	class LogRecord {
+	public:
+		LogRecord() = default;
+
+		// BEGIN / COMMIT / ABORT
+		explicit LogRecord(LogRecordType type)
+		    : type_(type) { }
+
+		// INSERT / DELETE
+		LogRecord(LogRecordType type, const RID& rid, const Tuple& tuple)
+		    : type_(type)
+		    , rid_(rid)
+		    , tuple_(tuple) { }
+
+		// UPDATE
+		LogRecord(const RID& rid, const Tuple& old_tuple, const Tuple& new_tuple)
+		    : type_(LogRecordType::UPDATE)
+		    , rid_(rid)
+		    , tuple_(new_tuple)
+		    , old_tuple_(old_tuple) { }
+
+		// NEW_PAGE, field_widths of a columnar page
+		LogRecord(page_id_t page_id, page_id_t prev_page_id, std::vector<uint16_t> field_widths = {})
+		    : type_(LogRecordType::NEW_PAGE)
+		    , page_id_(page_id)
+		    , prev_page_id_(prev_page_id)
+		    , field_widths_(std::move(field_widths)) { }
+
+		// UNLINK_PAGE
+		LogRecord(page_id_t page_id, page_id_t prev_page_id, page_id_t next_page_id)
+		    : type_(LogRecordType::UNLINK_PAGE)
+		    , page_id_(page_id)
+		    , prev_page_id_(prev_page_id)
+		    , next_page_id_(next_page_id) { }
+
+		// ALLOCATE_PAGES / FREE_PAGES, page_count pages from first_page_id
+		LogRecord(LogRecordType type, page_id_t first_page_id, uint32_t page_count)
+		    : type_(type)
+		    , page_id_(first_page_id)
+		    , page_count_(page_count) { }
+
+		// CLR, undoing the change made by undone
+		LogRecord(const LogRecord& undone, lsn_t undo_next_lsn)
+		    : type_(LogRecordType::CLR)
+		    , rid_(undone.rid_)
+		    , tuple_(undone.type_ == LogRecordType::UPDATE ? undone.old_tuple_ : undone.tuple_)
+		    , undone_type_(undone.type_)
+		    , undo_next_lsn_(undo_next_lsn) { }
+
+		// CHECKPOINT, changes logged at or after begin_lsn are not reflected in the tables
+		LogRecord(lsn_t begin_lsn, txn_id_t next_txn_id,
+		    std::vector<std::pair<txn_id_t, lsn_t>> active_txns,
+		    std::vector<std::pair<page_id_t, lsn_t>> dirty_pages)
+		    : type_(LogRecordType::CHECKPOINT)
+		    , begin_lsn_(begin_lsn)
+		    , next_txn_id_(next_txn_id)
+		    , active_txns_(std::move(active_txns))
+		    , dirty_pages_(std::move(dirty_pages)) { }
+
+		LogRecordType GetType() const { return type_; }
+		txn_id_t GetTxnId() const { return txn_id_; }
+		lsn_t GetLSN() const { return lsn_; }
+		lsn_t GetPrevLSN() const { return prev_lsn_; }
+		const RID& GetRID() const { return rid_; }
+		const Tuple& GetTuple() const { return tuple_; } // inserted, deleted or new image
+		const Tuple& GetOldTuple() const { return old_tuple_; }
+		page_id_t GetPageId() const { return IsChainChange() || IsFreeListChange() ? page_id_ : rid_.page_id; }
+		page_id_t GetPrevPageId() const { return prev_page_id_; }
+		page_id_t GetNextPageId() const { return next_page_id_; }
+		const std::vector<uint16_t>& GetFieldWidths() const { return field_widths_; } // empty for a row page
+		uint32_t GetPageCount() const { return page_count_; }
+
+		LogRecordType GetUndoneType() const { return undone_type_; }
+		lsn_t GetUndoNextLSN() const { return undo_next_lsn_; }
+
+		lsn_t GetBeginLSN() const { return begin_lsn_; }
+		txn_id_t GetNextTxnId() const { return next_txn_id_; }
+		const std::vector<std::pair<txn_id_t, lsn_t>>& GetActiveTxns() const { return active_txns_; } // txn -> last lsn
+		const std::vector<std::pair<page_id_t, lsn_t>>& GetDirtyPages() const { return dirty_pages_; } // page -> rec lsn
+
+		// INSERT, DELETE, UPDATE and CLR change a single page
+		bool IsPageChange() const {
+			return type_ == LogRecordType::INSERT || type_ == LogRecordType::DELETE
+			    || type_ == LogRecordType::UPDATE || type_ == LogRecordType::CLR;
+		}
+
+		// NEW_PAGE and UNLINK_PAGE change the links of a heap chain
+		bool IsChainChange() const {
+			return type_ == LogRecordType::NEW_PAGE || type_ == LogRecordType::UNLINK_PAGE;
+		}
+
+		// ALLOCATE_PAGES and FREE_PAGES change the free list, not a page (see DiskManager)
+		bool IsFreeListChange() const {
+			return type_ == LogRecordType::ALLOCATE_PAGES || type_ == LogRecordType::FREE_PAGES;
+		}
+
+		// filled in by the LogManager when the record is appended
+		void SetLSN(lsn_t lsn) { lsn_ = lsn; }
+		void SetTxn(txn_id_t txn_id, lsn_t prev_lsn) {
+			txn_id_ = txn_id;
+			prev_lsn_ = prev_lsn;
+		}
+
+		uint32_t GetSize() const {
+			uint32_t size = sizeof(LogRecordHeader);
+			switch (type_) {
+			case LogRecordType::INSERT:
+			case LogRecordType::DELETE:
+				size += sizeof(page_id_t) + sizeof(slot_id_t) + tuple_.GetSize();
+				break;
+			case LogRecordType::UPDATE:
+				size += sizeof(page_id_t) + sizeof(slot_id_t) + old_tuple_.GetSize() + tuple_.GetSize();
+				break;
+			case LogRecordType::NEW_PAGE:
+				size += sizeof(page_id_t) * 2;
+				if (!field_widths_.empty()) {
+					size += sizeof(uint16_t) * (field_widths_.size() + 1);
+				}
+				break;
+			case LogRecordType::UNLINK_PAGE:
+				size += sizeof(page_id_t) * 3;
+				break;
+			case LogRecordType::ALLOCATE_PAGES:
+			case LogRecordType::FREE_PAGES:
+				size += sizeof(page_id_t) + sizeof(uint32_t);
+				break;
+			case LogRecordType::CLR:
+				size += sizeof(lsn_t) + sizeof(LogRecordType) + sizeof(page_id_t) + sizeof(slot_id_t) + tuple_.GetSize();
+				break;
+			case LogRecordType::CHECKPOINT:
+				size += sizeof(lsn_t) + sizeof(txn_id_t)
+				    + sizeof(uint32_t) + active_txns_.size() * (sizeof(txn_id_t) + sizeof(lsn_t))
+				    + sizeof(uint32_t) + dirty_pages_.size() * (sizeof(page_id_t) + sizeof(lsn_t));
+				break;
+			default:
+				break;
+			}
+			return size;
+		}
+
+		// buf must hold GetSize() bytes
+		void SerializeTo(char* buf) const {
+			LogRecordHeader header;
+			std::memset(&header, 0, sizeof(header));
+			header.size = GetSize();
+			header.type = type_;
+			header.txn_id = txn_id_;
+			header.lsn = lsn_;
+			header.prev_lsn = prev_lsn_;
+			std::memcpy(buf, &header, sizeof(header));
+
+			char* pos = buf + sizeof(header);
+			switch (type_) {
+			case LogRecordType::INSERT:
+			case LogRecordType::DELETE:
+				pos = WriteRID(pos);
+				pos = WriteTuple(pos, tuple_);
+				break;
+			case LogRecordType::UPDATE:
+				pos = WriteRID(pos);
+				pos = WriteTuple(pos, old_tuple_);
+				pos = WriteTuple(pos, tuple_);
+				break;
+			case LogRecordType::NEW_PAGE:
+				std::memcpy(pos, &page_id_, sizeof(page_id_t));
+				std::memcpy(pos + sizeof(page_id_t), &prev_page_id_, sizeof(page_id_t));
+				pos += sizeof(page_id_t) * 2;
+				if (!field_widths_.empty()) {
+					pos = Write(pos, static_cast<uint16_t>(field_widths_.size()));
+					for (uint16_t width : field_widths_) {
+						pos = Write(pos, width);
+					}
+				}
+				break;
+			case LogRecordType::UNLINK_PAGE:
+				pos = Write(pos, page_id_);
+				pos = Write(pos, prev_page_id_);
+				pos = Write(pos, next_page_id_);
+				break;
+			case LogRecordType::ALLOCATE_PAGES:
+			case LogRecordType::FREE_PAGES:
+				pos = Write(pos, page_id_);
+				pos = Write(pos, page_count_);
+				break;
+			case LogRecordType::CLR:
+				pos = Write(pos, undo_next_lsn_);
+				pos = Write(pos, undone_type_);
+				pos = WriteRID(pos);
+				pos = WriteTuple(pos, tuple_);
+				break;
+			case LogRecordType::CHECKPOINT:
+				pos = Write(pos, begin_lsn_);
+				pos = Write(pos, next_txn_id_);
+				pos = Write(pos, static_cast<uint32_t>(active_txns_.size()));
+				for (const auto& entry : active_txns_) {
+					pos = Write(pos, entry.first);
+					pos = Write(pos, entry.second);
+				}
+				pos = Write(pos, static_cast<uint32_t>(dirty_pages_.size()));
+				for (const auto& entry : dirty_pages_) {
+					pos = Write(pos, entry.first);
+					pos = Write(pos, entry.second);
+				}
+				break;
+			default:
+				break;
+			}
+
+			uint32_t checksum = Checksum(buf, header.size);
+			std::memcpy(buf + offsetof(LogRecordHeader, checksum), &checksum, sizeof(checksum));
+		}
+
+		// Returns false if buf does not start with a complete, intact record (e.g. torn log tail)
+		static bool DeserializeFrom(const char* buf, size_t available, LogRecord* record) {
+			if (available < sizeof(LogRecordHeader)) {
+				return false;
+			}
+
+			LogRecordHeader header;
+			std::memcpy(&header, buf, sizeof(header));
+			if (header.size < sizeof(LogRecordHeader) || header.size > available) {
+				return false;
+			}
+			if (header.type == LogRecordType::INVALID || header.type > LogRecordType::FREE_PAGES) {
+				return false;
+			}
+
+			if (Checksum(buf, header.size) != header.checksum) {
+				return false;
+			}
+
+			*record = LogRecord();
+			record->type_ = header.type;
+			record->txn_id_ = header.txn_id;
+			record->lsn_ = header.lsn;
+			record->prev_lsn_ = header.prev_lsn;
+
+			const char* pos = buf + sizeof(header);
+			const char* end = buf + header.size;
+			switch (header.type) {
+			case LogRecordType::INSERT:
+			case LogRecordType::DELETE:
+				return record->ReadRID(&pos, end) && ReadTuple(&pos, end, &record->tuple_);
+			case LogRecordType::UPDATE:
+				return record->ReadRID(&pos, end) && ReadTuple(&pos, end, &record->old_tuple_) && ReadTuple(&pos, end, &record->tuple_);
+			case LogRecordType::NEW_PAGE:
+				if (end - pos < static_cast<std::ptrdiff_t>(sizeof(page_id_t) * 2)) {
+					return false;
+				}
+				std::memcpy(&record->page_id_, pos, sizeof(page_id_t));
+				std::memcpy(&record->prev_page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+				pos += sizeof(page_id_t) * 2;
+				if (pos < end) {
+					uint16_t count;
+					if (!Read(&pos, end, &count) || count == 0) {
+						return false;
+					}
+					record->field_widths_.resize(count);
+					for (uint16_t& width : record->field_widths_) {
+						if (!Read(&pos, end, &width)) {
+							return false;
+						}
+					}
+				}
+				return true;
+			case LogRecordType::UNLINK_PAGE:
+				return Read(&pos, end, &record->page_id_) && Read(&pos, end, &record->prev_page_id_) && Read(&pos, end, &record->next_page_id_);
+			case LogRecordType::ALLOCATE_PAGES:
+			case LogRecordType::FREE_PAGES:
+				return Read(&pos, end, &record->page_id_) && Read(&pos, end, &record->page_count_);
+			case LogRecordType::CLR:
+				return Read(&pos, end, &record->undo_next_lsn_) && Read(&pos, end, &record->undone_type_)
+				    && record->ReadRID(&pos, end) && ReadTuple(&pos, end, &record->tuple_);
+			case LogRecordType::CHECKPOINT: {
+				uint32_t count;
+				if (!Read(&pos, end, &record->begin_lsn_) || !Read(&pos, end, &record->next_txn_id_) || !Read(&pos, end, &count)) {
+					return false;
+				}
+				for (uint32_t i = 0; i < count; i++) {
+					std::pair<txn_id_t, lsn_t> entry;
+					if (!Read(&pos, end, &entry.first) || !Read(&pos, end, &entry.second)) {
+						return false;
+					}
+					record->active_txns_.push_back(entry);
+				}
+				if (!Read(&pos, end, &count)) {
+					return false;
+				}
+				for (uint32_t i = 0; i < count; i++) {
+					std::pair<page_id_t, lsn_t> entry;
+					if (!Read(&pos, end, &entry.first) || !Read(&pos, end, &entry.second)) {
+						return false;
+					}
+					record->dirty_pages_.push_back(entry);
+				}
+				return true;
+			}
+			default:
+				return true;
+			}
+		}
+
+	private:
+		LogRecordType type_ = LogRecordType::INVALID;
+		txn_id_t txn_id_ = INVALID_TXN_ID;
+		lsn_t lsn_ = INVALID_LSN;
+		lsn_t prev_lsn_ = INVALID_LSN;
+
+		RID rid_;
+		Tuple tuple_;
+		Tuple old_tuple_;
+
+		page_id_t page_id_ = INVALID_PAGE_ID;
+		page_id_t prev_page_id_ = INVALID_PAGE_ID;
+		page_id_t next_page_id_ = INVALID_PAGE_ID;
+		std::vector<uint16_t> field_widths_;
+		uint32_t page_count_ = 0;
+
+		LogRecordType undone_type_ = LogRecordType::INVALID;
+		lsn_t undo_next_lsn_ = INVALID_LSN;
+
+		lsn_t begin_lsn_ = INVALID_LSN;
+		txn_id_t next_txn_id_ = 0;
+		std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+		std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+
+		template <typename T>
+		static char* Write(char* pos, const T& value) {
+			std::memcpy(pos, &value, sizeof(T));
+			return pos + sizeof(T);
+		}
+
+		template <typename T>
+		static bool Read(const char** pos, const char* end, T* value) {
+			if (end - *pos < static_cast<std::ptrdiff_t>(sizeof(T))) {
+				return false;
+			}
+			std::memcpy(value, *pos, sizeof(T));
+			*pos += sizeof(T);
+			return true;
+		}
+
+		// FNV-1a over the record, reading the checksum field as zero
+		// enough to reject a partially written tail
+		static uint32_t Checksum(const char* data, size_t len) {
+			const size_t skip_begin = offsetof(LogRecordHeader, checksum);
+			const size_t skip_end = skip_begin + sizeof(uint32_t);
+			uint32_t hash = 2166136261u;
+			for (size_t i = 0; i < len; i++) {
+				uint8_t byte = (i >= skip_begin && i < skip_end) ? 0 : static_cast<uint8_t>(data[i]);
+				hash ^= byte;
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+
+		char* WriteRID(char* pos) const {
+			std::memcpy(pos, &rid_.page_id, sizeof(page_id_t));
+			std::memcpy(pos + sizeof(page_id_t), &rid_.slot_id, sizeof(slot_id_t));
+			return pos + sizeof(page_id_t) + sizeof(slot_id_t);
+		}
+
+		static char* WriteTuple(char* pos, const Tuple& tuple) {
+			std::memcpy(pos, tuple.GetData(), tuple.GetSize());
+			return pos + tuple.GetSize();
+		}
+
+		bool ReadRID(const char** pos, const char* end) {
+			if (end - *pos < static_cast<std::ptrdiff_t>(sizeof(page_id_t) + sizeof(slot_id_t))) {
+				return false;
+			}
+			std::memcpy(&rid_.page_id, *pos, sizeof(page_id_t));
+			std::memcpy(&rid_.slot_id, *pos + sizeof(page_id_t), sizeof(slot_id_t));
+			*pos += sizeof(page_id_t) + sizeof(slot_id_t);
+			return true;
+		}
+
+		static bool ReadTuple(const char** pos, const char* end, Tuple* tuple) {
+			uint32_t size;
+			if (end - *pos < static_cast<std::ptrdiff_t>(sizeof(uint32_t))) {
+				return false;
+			}
+			std::memcpy(&size, *pos, sizeof(uint32_t));
+			if (size < sizeof(uint32_t) || end - *pos < static_cast<std::ptrdiff_t>(size)) {
+				return false;
+			}
+			*tuple = Tuple(const_cast<char*>(*pos), RID());
+			*pos += size;
+			return true;
+		}
+	};
+
+} // namespace recovery
+} // namespace venus
@@ -0,0 +1,305 @@
+// /src/recovery/log_recovery.cpp
+
+#include "recovery/log_recovery.h"
+
+#include <algorithm>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace venus {
+namespace recovery {
+
+	namespace {
+
+		SlotDirectory* SlotFor(Page* page, const RID& rid) {
+			SlotDirectory* slot = page->GetSlotDirectory(rid.slot_id);
+			if (slot == nullptr) {
+				throw std::runtime_error("Recovery error: Slot " + std::to_string(rid.slot_id) + " does not exist on page " + std::to_string(rid.page_id));
+			}
+			return slot;
+		}
+
+		void ApplyRedo(Page* page, page_id_t page_id, const LogRecord& record) {
+			PageHeader* header = page->GetHeader();
+
+			switch (record.GetType()) {
+			case LogRecordType::INSERT: {
+				// an insert appended a slot or reused a dead one, so the page must be exactly where it was
+				// before the insert (compaction moves bytes but frees the same space)
+				const Tuple& tuple = record.GetTuple();
+				SlotDirectory* slot = page->PlaceTuple(record.GetRID().slot_id, tuple.GetData(), tuple.GetSize());
+				if (slot == nullptr) {
+					throw std::runtime_error("Recovery error: Page " + std::to_string(page_id) + " has " + std::to_string(header->num_slots)
+					    + " slots, cannot redo insert into slot " + std::to_string(record.GetRID().slot_id));
+				}
+				slot->xmin = record.GetTxnId();
+				slot->xmax = INVALID_TXN_ID;
+				break;
+			}
+			case LogRecordType::DELETE: {
+				// deletes outside a transaction are physical, inside one they end the version
+				SlotDirectory* slot = SlotFor(page, record.GetRID());
+				if (record.GetTxnId() == INVALID_TXN_ID) {
+					page->KillSlot(slot);
+				} else {
+					slot->xmax = record.GetTxnId();
+				}
+				break;
+			}
+			case LogRecordType::UPDATE: {
+				SlotFor(page, record.GetRID());
+				page->WriteTuple(record.GetRID().slot_id, record.GetTuple().GetData());
+				break;
+			}
+			case LogRecordType::CLR:
+				LogRecovery::ApplyUndo(page, record);
+				break;
+			case LogRecordType::NEW_PAGE:
+				if (page_id == record.GetPageId()) {
+					if (record.GetFieldWidths().empty()) {
+						page->NewPage(page_id, PageType::TABLE_PAGE);
+					} else {
+						page->NewColumnarPage(page_id, record.GetFieldWidths());
+					}
+					header->prev_page_id = record.GetPrevPageId();
+				} else {
+					header->next_page_id = record.GetPageId();
+				}
+				break;
+			case LogRecordType::UNLINK_PAGE:
+				if (page_id == record.GetPrevPageId()) {
+					header->next_page_id = record.GetNextPageId();
+				} else {
+					header->prev_page_id = record.GetPrevPageId();
+				}
+				break;
+			default:
+				break;
+			}
+		}
+
+	} // namespace
+
+	void LogRecovery::ApplyUndo(Page* page, const LogRecord& clr) {
+		SlotDirectory* slot = SlotFor(page, clr.GetRID());
+		switch (clr.GetUndoneType()) {
+		case LogRecordType::INSERT:
+			page->KillSlot(slot);
+			break;
+		case LogRecordType::DELETE:
+			slot->is_live = true;
+			slot->xmax = INVALID_TXN_ID;
+			break;
+		case LogRecordType::UPDATE:
+			page->WriteTuple(clr.GetRID().slot_id, clr.GetTuple().GetData());
+			break;
+		default:
+			break;
+		}
+	}
+
+	void LogRecovery::Recover() {
+		active_txns_.clear();
+		dirty_pages_.clear();
+		next_txn_id_ = 0;
+		redo_count_ = 0;
+		loser_count_ = 0;
+
+		Analysis();
+		Redo();
+		Undo();
+
+		if (txn_manager_ != nullptr) {
+			txn_manager_->SetNextTxnId(std::max(next_txn_id_, txn_manager_->GetNextTxnId()));
+		}
+
+		// redone pages were marked dirty with a rec lsn at the end of the log, write them out
+		// so a crash right after recovery does not depend on it
+		log_manager_->FlushAll();
+		bpm_->FlushAllPages();
+
+		if (redo_count_ > 0 || loser_count_ > 0) {
+			LOG("Recovery: Redid " + std::to_string(redo_count_) + " changes, rolled back " + std::to_string(loser_count_) + " transactions");
+		}
+	}
+
+	void LogRecovery::Analysis() {
+		analysis_start_lsn_ = log_manager_->GetBaseLSN();
+		LogRecord record;
+
+		lsn_t checkpoint_lsn = log_manager_->GetCheckpointLSN();
+		if (checkpoint_lsn != INVALID_LSN) {
+			if (log_manager_->ReadLogRecord(checkpoint_lsn, &record) && record.GetType() == LogRecordType::CHECKPOINT) {
+				for (const auto& entry : record.GetActiveTxns()) {
+					active_txns_[entry.first] = entry.second;
+				}
+				for (const auto& entry : record.GetDirtyPages()) {
+					dirty_pages_[entry.first] = entry.second;
+				}
+				next_txn_id_ = record.GetNextTxnId();
+				analysis_start_lsn_ = std::max(record.GetBeginLSN(), log_manager_->GetBaseLSN());
+			} else {
+				LOG("Recovery: Checkpoint at LSN " + std::to_string(checkpoint_lsn) + " is unreadable, scanning the whole log");
+			}
+		}
+
+		for (lsn_t lsn = analysis_start_lsn_; log_manager_->ReadLogRecord(lsn, &record); lsn += record.GetSize()) {
+			txn_id_t txn_id = record.GetTxnId();
+			if (txn_id != INVALID_TXN_ID) {
+				next_txn_id_ = std::max(next_txn_id_, txn_id + 1);
+				if (record.GetType() == LogRecordType::COMMIT || record.GetType() == LogRecordType::ABORT) {
+					active_txns_.erase(txn_id);
+				} else {
+					active_txns_[txn_id] = lsn;
+				}
+			}
+
+			// emplace keeps the first (oldest) change of a page
+			if (record.IsPageChange()) {
+				dirty_pages_.emplace(record.GetPageId(), lsn);
+			} else if (record.GetType() == LogRecordType::NEW_PAGE) {
+				dirty_pages_.emplace(record.GetPageId(), lsn);
+				if (record.GetPrevPageId() != INVALID_PAGE_ID) {
+					dirty_pages_.emplace(record.GetPrevPageId(), lsn);
+				}
+			} else if (record.GetType() == LogRecordType::UNLINK_PAGE) {
+				// the unlinked page itself is not changed
+				dirty_pages_.emplace(record.GetPrevPageId(), lsn);
+				if (record.GetNextPageId() != INVALID_PAGE_ID) {
+					dirty_pages_.emplace(record.GetNextPageId(), lsn);
+				}
+			} else if (record.IsFreeListChange()) {
+				// the checkpoint stored the free list after begin_lsn, later changes are applied again
+				bpm_->RedoFreeList(record);
+			}
+		}
+
+		// a transaction can be in the checkpoint's table although it committed just before begin_lsn
+		for (auto it = active_txns_.begin(); it != active_txns_.end();) {
+			if (log_manager_->ReadLogRecord(it->second, &record)
+			    && (record.GetType() == LogRecordType::COMMIT || record.GetType() == LogRecordType::ABORT)) {
+				it = active_txns_.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	void LogRecovery::Redo() {
+		if (dirty_pages_.empty()) {
+			return;
+		}
+
+		lsn_t redo_lsn = INVALID_LSN;
+		for (const auto& entry : dirty_pages_) {
+			redo_lsn = std::min(redo_lsn, entry.second);
+		}
+
+		LogRecord record;
+		for (lsn_t lsn = std::max(redo_lsn, log_manager_->GetBaseLSN()); log_manager_->ReadLogRecord(lsn, &record); lsn += record.GetSize()) {
+			if (record.IsPageChange()) {
+				RedoOnPage(record.GetPageId(), record);
+			} else if (record.GetType() == LogRecordType::NEW_PAGE) {
+				RedoOnPage(record.GetPageId(), record);
+				if (record.GetPrevPageId() != INVALID_PAGE_ID) {
+					RedoOnPage(record.GetPrevPageId(), record);
+				}
+			} else if (record.GetType() == LogRecordType::UNLINK_PAGE) {
+				RedoOnPage(record.GetPrevPageId(), record);
+				if (record.GetNextPageId() != INVALID_PAGE_ID) {
+					RedoOnPage(record.GetNextPageId(), record);
+				}
+			}
+		}
+	}
+
+	void LogRecovery::RedoOnPage(page_id_t page_id, const LogRecord& record) {
+		auto it = dirty_pages_.find(page_id);
+		if (it == dirty_pages_.end() || record.GetLSN() < it->second) {
+			return; // the change reached disk before the page was last written
+		}
+
+		buffer::PageGuard guard = bpm_->FetchPageWrite(page_id);
+		if (!guard) {
+			LOG("Recovery: Page " + std::to_string(page_id) + " is missing, skipping redo of LSN " + std::to_string(record.GetLSN()));
+			return;
+		}
+		if (guard->GetLSN() >= record.GetLSN()) {
+			return; // already applied
+		}
+
+		ApplyRedo(guard.GetPage(), page_id, record);
+		guard->SetLSN(record.GetLSN());
+		guard.MarkDirty();
+		redo_count_++;
+	}
+
+	void LogRecovery::Undo() {
+		loser_count_ = active_txns_.size();
+		if (active_txns_.empty()) {
+			return;
+		}
+
+		// (next lsn to undo, txn), largest first
+		std::priority_queue<std::pair<lsn_t, txn_id_t>> to_undo;
+		std::unordered_map<txn_id_t, std::unique_ptr<concurrency::Transaction>> losers;
+		for (const auto& entry : active_txns_) {
+			auto txn = std::make_unique<concurrency::Transaction>(entry.first);
+			txn->SetPrevLSN(entry.second);
+			losers[entry.first] = std::move(txn);
+			to_undo.emplace(entry.second, entry.first);
+		}
+
+		LogRecord record;
+		while (!to_undo.empty()) {
+			auto [lsn, txn_id] = to_undo.top();
+			to_undo.pop();
+			concurrency::Transaction* txn = losers[txn_id].get();
+
+			if (!log_manager_->ReadLogRecord(lsn, &record)) {
+				throw std::runtime_error("Recovery error: Cannot read LSN " + std::to_string(lsn) + " while rolling back transaction " + std::to_string(txn_id));
+			}
+
+			lsn_t next_lsn = record.GetPrevLSN();
+			switch (record.GetType()) {
+			case LogRecordType::INSERT:
+			case LogRecordType::DELETE:
+			case LogRecordType::UPDATE:
+				UndoChange(txn, record);
+				break;
+			case LogRecordType::CLR:
+				next_lsn = record.GetUndoNextLSN(); // already undone before the crash
+				break;
+			default:
+				// an appended page stays in the chain, empty pages are harmless
+				break;
+			}
+
+			if (next_lsn == INVALID_LSN) {
+				LogRecord abort(LogRecordType::ABORT);
+				log_manager_->AppendLogRecord(txn, &abort);
+			} else {
+				to_undo.emplace(next_lsn, txn_id);
+			}
+		}
+
+		active_txns_.clear();
+	}
+
+	void LogRecovery::UndoChange(concurrency::Transaction* txn, const LogRecord& record) {
+		buffer::PageGuard guard = bpm_->FetchPageWrite(record.GetPageId());
+		if (!guard) {
+			throw std::runtime_error("Recovery error: Page " + std::to_string(record.GetPageId()) + " is missing, cannot undo LSN " + std::to_string(record.GetLSN()));
+		}
+
+		LogRecord clr(record, record.GetPrevLSN());
+		ApplyUndo(guard.GetPage(), clr);
+		guard->SetLSN(log_manager_->AppendLogRecord(txn, &clr));
+		guard.MarkDirty();
+	}
+
+} // namespace recovery
+} // namespace venus
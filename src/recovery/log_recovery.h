@@ -0,0 +1,84 @@
+// /src/recovery/log_recovery.h
+
+/**
+ * LogRecovery for VenusDB - ARIES style crash recovery, run once when a database is opened.
+ *
+ * The buffer pool is no-force / steal: committed changes may only be in the log, and pages
+ * written back by eviction may hold changes of transactions that never committed.
+ * Recovery repairs both in three passes over the log.
+ *
+ * 1. Analysis
+ *    Starts at the last checkpoint (or the start of the log) with its active transaction table
+ *    (txn -> last lsn) and dirty page table (page -> rec lsn) and scans to the end of the log.
+ *    Transactions without a COMMIT or ABORT are losers; every page changed on the way is added
+ *    to the dirty page table with the LSN of its first change.
+ *    Changes of the file's free list the stored list does not have are applied on the way.
+ *
+ * 2. Redo (repeating history)
+ *    From the smallest rec lsn, every page change is applied again unless the page already
+ *    has it: the page is not dirty, the change is older than the page's rec lsn, or
+ *    page_lsn >= lsn. Losers are redone as well, undo then runs against the exact pre-crash state.
+ *
+ * 3. Undo
+ *    Losers are rolled back together, always undoing the largest outstanding LSN first.
+ *    Each undone change writes a CLR (redo-only) whose undo_next_lsn skips past it, so a crash
+ *    during recovery never undoes anything twice. A loser ends with an ABORT record.
+ *
+ * Pages touched by recovery are written back at the end, so the next checkpoint starts clean.
+ */
+
+#pragma once
+
+#include "buffer/buffer_pool.h"
+#include "common/config.h"
+#include "concurrency/transaction_manager.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_record.h"
+
+#include <unordered_map>
+
+namespace venus {
+namespace recovery {
+
+	class LogRecovery {
+	public:
+		LogRecovery(buffer::BufferPoolManager* bpm, LogManager* log_manager, concurrency::TransactionManager* txn_manager)
+		    : bpm_(bpm)
+		    , log_manager_(log_manager)
+		    , txn_manager_(txn_manager) { }
+
+		void Recover();
+
+		// what the last Recover() did
+		lsn_t GetAnalysisStartLSN() const { return analysis_start_lsn_; }
+		size_t GetRedoCount() const { return redo_count_; }
+		size_t GetLoserCount() const { return loser_count_; }
+
+		// puts a slot back into the state before the change the CLR undoes, also used by rollback
+		static void ApplyUndo(Page* page, const LogRecord& clr);
+
+	private:
+		buffer::BufferPoolManager* bpm_;
+		LogManager* log_manager_;
+		concurrency::TransactionManager* txn_manager_;
+
+		std::unordered_map<txn_id_t, lsn_t> active_txns_; // txn -> last lsn
+		std::unordered_map<page_id_t, lsn_t> dirty_pages_; // page -> rec lsn
+		txn_id_t next_txn_id_ = 0;
+
+		lsn_t analysis_start_lsn_ = INVALID_LSN;
+		size_t redo_count_ = 0;
+		size_t loser_count_ = 0;
+
+		void Analysis();
+		void Redo();
+		void Undo();
+
+		void RedoOnPage(page_id_t page_id, const LogRecord& record);
+		void UndoChange(concurrency::Transaction* txn, const LogRecord& record);
+
+		DISALLOW_COPY_AND_MOVE(LogRecovery);
+	};
+
+} // namespace recovery
+} // namespace venus
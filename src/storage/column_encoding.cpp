@@ -0,0 +1,154 @@
+// /src/storage/column_encoding.cpp
+
+#include "storage/column_encoding.h"
+
+#include <vector>
+
+namespace venus {
+
+namespace {
+
+	uint8_t BitsFor(uint64_t max_value) {
+		uint8_t bits = 0;
+		while (bits < 64 && (max_value >> bits) != 0) {
+			bits++;
+		}
+		return bits;
+	}
+
+	uint32_t PackedSize(uint32_t rows, uint8_t bits) {
+		return static_cast<uint32_t>((static_cast<uint64_t>(rows) * bits + 7) / 8);
+	}
+
+	// out is zeroed, ENCODING_SLACK bytes past the packed ones included
+	void Pack(char* packed, uint32_t index, uint8_t bits, uint64_t value) {
+		if (bits == 0) {
+			return;
+		}
+		uint64_t position = static_cast<uint64_t>(index) * bits;
+		uint64_t word;
+		std::memcpy(&word, packed + position / 8, sizeof(word));
+		word |= value << (position % 8);
+		std::memcpy(packed + position / 8, &word, sizeof(word));
+	}
+
+	int64_t ReadInteger(const char* value, uint16_t width) {
+		if (width == sizeof(int32_t)) {
+			int32_t narrow;
+			std::memcpy(&narrow, value, sizeof(narrow));
+			return narrow;
+		}
+		int64_t wide;
+		std::memcpy(&wide, value, sizeof(wide));
+		return wide;
+	}
+
+	void WriteU16(char** pos, uint16_t value) {
+		std::memcpy(*pos, &value, sizeof(value));
+		*pos += sizeof(value);
+	}
+
+} // namespace
+
+ColumnEncoding EncodeMinipage(const char* values, uint32_t rows, uint16_t width, char* out, uint32_t limit, uint32_t* size) {
+	if (rows == 0 || width == 0) {
+		return ColumnEncoding::PLAIN;
+	}
+	auto value = [&](uint32_t row) { return values + static_cast<size_t>(row) * width; };
+
+	// distinct values, in order of first appearance, and the code of every row
+	std::vector<uint32_t> entries;
+	std::vector<uint32_t> codes(rows);
+	for (uint32_t row = 0; row < rows && entries.size() <= MAX_DICTIONARY_ENTRIES; row++) {
+		uint32_t code = 0;
+		while (code < entries.size() && std::memcmp(value(entries[code]), value(row), width) != 0) {
+			code++;
+		}
+		if (code == entries.size()) {
+			entries.push_back(row);
+		}
+		codes[row] = code;
+	}
+	uint8_t code_bits = BitsFor(entries.size() - 1);
+	bool dictionary = entries.size() <= MAX_DICTIONARY_ENTRIES;
+	uint32_t dictionary_size = sizeof(uint16_t) + sizeof(uint8_t) + static_cast<uint32_t>(entries.size()) * width + PackedSize(rows, code_bits);
+
+	uint32_t runs = 1;
+	for (uint32_t row = 1; row < rows; row++) {
+		runs += std::memcmp(value(row - 1), value(row), width) != 0;
+	}
+	uint32_t run_length_size = sizeof(uint16_t) + runs * (sizeof(uint16_t) + width);
+
+	int64_t min = 0;
+	uint8_t delta_bits = 64;
+	if (width == sizeof(int32_t) || width == sizeof(int64_t)) {
+		min = ReadInteger(value(0), width);
+		int64_t max = min;
+		for (uint32_t row = 1; row < rows; row++) {
+			int64_t current = ReadInteger(value(row), width);
+			min = current < min ? current : min;
+			max = current > max ? current : max;
+		}
+		delta_bits = BitsFor(static_cast<uint64_t>(max) - static_cast<uint64_t>(min));
+	}
+	bool frame_of_reference = delta_bits <= MAX_PACKED_BITS;
+	uint32_t frame_of_reference_size = sizeof(int64_t) + sizeof(uint8_t) + PackedSize(rows, delta_bits);
+
+	ColumnEncoding encoding = ColumnEncoding::PLAIN;
+	uint32_t best = rows * width;
+	if (dictionary && code_bits <= MAX_PACKED_BITS && dictionary_size < best) {
+		encoding = ColumnEncoding::DICTIONARY;
+		best = dictionary_size;
+	}
+	if (run_length_size < best) {
+		encoding = ColumnEncoding::RUN_LENGTH;
+		best = run_length_size;
+	}
+	if (frame_of_reference && frame_of_reference_size < best) {
+		encoding = ColumnEncoding::FRAME_OF_REFERENCE;
+		best = frame_of_reference_size;
+	}
+	if (encoding == ColumnEncoding::PLAIN || best + ENCODING_SLACK > limit) {
+		return ColumnEncoding::PLAIN;
+	}
+
+	*size = best + ENCODING_SLACK;
+	std::memset(out, 0, *size);
+	char* pos = out;
+	switch (encoding) {
+	case ColumnEncoding::DICTIONARY:
+		WriteU16(&pos, static_cast<uint16_t>(entries.size()));
+		*pos++ = static_cast<char>(code_bits);
+		for (uint32_t entry : entries) {
+			std::memcpy(pos, value(entry), width);
+			pos += width;
+		}
+		for (uint32_t row = 0; row < rows; row++) {
+			Pack(pos, row, code_bits, codes[row]);
+		}
+		break;
+	case ColumnEncoding::RUN_LENGTH: {
+		WriteU16(&pos, static_cast<uint16_t>(runs));
+		char* run_values = pos + runs * sizeof(uint16_t);
+		for (uint32_t row = 0; row < rows; row++) {
+			if (row + 1 == rows || std::memcmp(value(row), value(row + 1), width) != 0) {
+				WriteU16(&pos, static_cast<uint16_t>(row + 1));
+				std::memcpy(run_values, value(row), width);
+				run_values += width;
+			}
+		}
+		break;
+	}
+	default:
+		std::memcpy(pos, &min, sizeof(min));
+		pos += sizeof(min);
+		*pos++ = static_cast<char>(delta_bits);
+		for (uint32_t row = 0; row < rows; row++) {
+			Pack(pos, row, delta_bits, static_cast<uint64_t>(ReadInteger(value(row), width)) - static_cast<uint64_t>(min));
+		}
+		break;
+	}
+	return encoding;
+}
+
+} // namespace venus
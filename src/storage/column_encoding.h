@@ -0,0 +1,167 @@
+// /src/storage/column_encoding.h
+
+/**
+ * Lightweight encodings for the minipages of a columnar page.
+ *
+ * A minipage holds one field of rows 0..n-1, width bytes each. When a columnar page fills up each of
+ * its minipages is encoded with whichever of these is smallest, or stays plain:
+ *
+ * DICTIONARY          - the distinct values (at most 256), then a bit-packed code per row.
+ *                       A CHAR column of a few statuses or countries costs a few bits per row
+ * RUN_LENGTH          - the end row and the value of every run of equal values.
+ *                       Sorted or clustered columns, and null bitmaps that are mostly zero
+ * FRAME_OF_REFERENCE  - 4 and 8 byte fields read as signed integers: the smallest value, then the
+ *                       distance of every value from it, bit-packed. INT, BIGINT, DATE and TIMESTAMP
+ *                       values in a narrow range
+ *
+ * The encodings only see bytes, so they are lossless for every type (a FLOAT is packed as its bit
+ * pattern); what a value means is left to the reader. Dictionary entries and run values are plain
+ * values, a filter can be evaluated once per entry or run instead of once per row.
+ *
+ * Bit-packed numbers are read with one unaligned 64-bit load and a shift, so they are at most
+ * 56 bits wide and the encoded bytes need ENCODING_SLACK bytes after them.
+ *
+ * Layouts
+ * DICTIONARY:          [u16 entries][u8 bits][entries * width values][codes]
+ * RUN_LENGTH:          [u16 runs][runs * u16 end row (exclusive)][runs * width values]
+ * FRAME_OF_REFERENCE:  [i64 base][u8 bits][deltas]
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace venus {
+
+enum class ColumnEncoding : uint8_t {
+	PLAIN = 0,
+	DICTIONARY,
+	RUN_LENGTH,
+	FRAME_OF_REFERENCE,
+};
+
+constexpr uint32_t ENCODING_SLACK = sizeof(uint64_t);
+constexpr uint32_t MAX_DICTIONARY_ENTRIES = 256;
+constexpr uint8_t MAX_PACKED_BITS = 56;
+
+// encodes rows values of width bytes into out with the smallest encoding, when it and its slack fit
+// in limit bytes and are smaller than the plain values; size is set to the bytes written, slack
+// included. PLAIN (nothing written) otherwise
+ColumnEncoding EncodeMinipage(const char* values, uint32_t rows, uint16_t width, char* out, uint32_t limit, uint32_t* size);
+
+// read side of an encoded minipage, a view over its bytes
+class EncodedMinipage {
+public:
+	EncodedMinipage(const char* data, ColumnEncoding encoding, uint16_t width)
+	    : data_(data)
+	    , encoding_(encoding)
+	    , width_(width) { }
+
+	ColumnEncoding GetEncoding() const { return encoding_; }
+
+	// copies the value of a row to out
+	void Read(uint32_t row, char* out) const {
+		switch (encoding_) {
+		case ColumnEncoding::DICTIONARY:
+			std::memcpy(out, GetEntry(GetCode(row)), width_);
+			break;
+		case ColumnEncoding::RUN_LENGTH:
+			std::memcpy(out, GetRunValue(FindRun(row)), width_);
+			break;
+		case ColumnEncoding::FRAME_OF_REFERENCE:
+			WriteInteger(GetBase() + static_cast<int64_t>(Unpack(data_ + FOR_HEADER, row, static_cast<uint8_t>(data_[sizeof(int64_t)]))), out);
+			break;
+		default:
+			std::memcpy(out, data_ + static_cast<size_t>(row) * width_, width_);
+			break;
+		}
+	}
+
+	// copies the values of rows 0..rows-1 to out, back to back
+	void ReadAll(uint32_t rows, char* out) const {
+		if (encoding_ == ColumnEncoding::RUN_LENGTH) {
+			uint32_t row = 0;
+			for (uint32_t run = 0; run < GetRunCount() && row < rows; run++) {
+				for (; row < GetRunEnd(run) && row < rows; row++) {
+					std::memcpy(out + static_cast<size_t>(row) * width_, GetRunValue(run), width_);
+				}
+			}
+			return;
+		}
+		for (uint32_t row = 0; row < rows; row++) {
+			Read(row, out + static_cast<size_t>(row) * width_);
+		}
+	}
+
+	// DICTIONARY
+	uint32_t GetEntryCount() const { return ReadU16(data_); }
+	const char* GetEntry(uint32_t code) const { return data_ + DICTIONARY_HEADER + static_cast<size_t>(code) * width_; }
+	uint32_t GetCode(uint32_t row) const {
+		return static_cast<uint32_t>(Unpack(GetEntry(GetEntryCount()), row, static_cast<uint8_t>(data_[sizeof(uint16_t)])));
+	}
+
+	// RUN_LENGTH, runs are in row order
+	uint32_t GetRunCount() const { return ReadU16(data_); }
+	uint32_t GetRunEnd(uint32_t run) const { return ReadU16(data_ + sizeof(uint16_t) * (1 + run)); }
+	const char* GetRunValue(uint32_t run) const {
+		return data_ + sizeof(uint16_t) * (1 + GetRunCount()) + static_cast<size_t>(run) * width_;
+	}
+
+	// the run a row is in
+	uint32_t FindRun(uint32_t row) const {
+		uint32_t low = 0;
+		uint32_t high = GetRunCount() - 1;
+		while (low < high) {
+			uint32_t mid = (low + high) / 2;
+			if (GetRunEnd(mid) <= row) {
+				low = mid + 1;
+			} else {
+				high = mid;
+			}
+		}
+		return low;
+	}
+
+	// bit-packed numbers, packed[index] of the given width
+	static uint64_t Unpack(const char* packed, uint32_t index, uint8_t bits) {
+		if (bits == 0) {
+			return 0;
+		}
+		uint64_t position = static_cast<uint64_t>(index) * bits;
+		uint64_t word;
+		std::memcpy(&word, packed + position / 8, sizeof(word));
+		return (word >> (position % 8)) & ((uint64_t(1) << bits) - 1);
+	}
+
+private:
+	static constexpr size_t DICTIONARY_HEADER = sizeof(uint16_t) + sizeof(uint8_t);
+	static constexpr size_t FOR_HEADER = sizeof(int64_t) + sizeof(uint8_t);
+
+	const char* data_;
+	ColumnEncoding encoding_;
+	uint16_t width_;
+
+	static uint16_t ReadU16(const char* data) {
+		uint16_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	int64_t GetBase() const {
+		int64_t base;
+		std::memcpy(&base, data_, sizeof(base));
+		return base;
+	}
+
+	void WriteInteger(int64_t value, char* out) const {
+		if (width_ == sizeof(int32_t)) {
+			int32_t narrow = static_cast<int32_t>(value);
+			std::memcpy(out, &narrow, sizeof(narrow));
+		} else {
+			std::memcpy(out, &value, sizeof(value));
+		}
+	}
+};
+
+} // namespace venus
@@ -1,100 +1,626 @@
 // /src/storage/disk_manager.cpp
 
 #include "storage/disk_manager.h"
+#include "recovery/log_manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace venus {
 namespace storage {
 
-	DiskManager::DiskManager(const std::string& db_file)
+	namespace {
+		// a page of the free list, page ids follow
+		struct FreeListHeader {
+			page_id_t next; // 0 on the last page, so a page never written is an empty list
+			uint32_t count;
+			lsn_t lsn; // last logged change the list has, first page only
+		};
+
+		constexpr size_t FREE_LIST_CAPACITY = (PAGE_SIZE - sizeof(FreeListHeader)) / sizeof(page_id_t);
+	} // namespace
+
+	DiskManager::DiskManager(const std::string& db_file, DiskMode mode)
 	    : db_file_name(db_file)
+	    , fd_(-1)
 	    , next_page_id_(FIRST_USABLE_PAGE_ID)
-	    , file_size_(0) {
-		db_io_.open(db_file_name, std::ios::in | std::ios::out | std::ios::binary);
-		if (!db_io_) {
+	    , file_size_(0)
+	    , sync_on_write_(false)
+	    , list_writes_(0)
+	    , synced_list_writes_(0)
+	    , free_list_dirty_(false)
+	    , log_manager_(nullptr)
+	    , free_list_lsn_(0)
+	    , mode_(mode)
+	    , mapping_(nullptr)
+	    , mapped_size_(0) {
+		if (mode_ == DiskMode::MMAP_READ_ONLY) {
+			MapFile();
+			return;
+		}
+
+		int flags = O_RDWR | O_CLOEXEC;
+		if (mode_ == DiskMode::DIRECT) {
+			flags |= O_DIRECT;
+		}
+		fd_ = ::open(db_file_name.c_str(), flags);
+		if (fd_ < 0 && errno == ENOENT) {
 			throw std::runtime_error("DatabaseManager error: " + db_file + " does not exist");
 		}
+		if (fd_ < 0) {
+			throw std::runtime_error("DatabaseManager error: Failed to open database file: " + db_file + ": " + std::strerror(errno));
+		}
 
-		if (!db_io_.is_open()) {
+		struct stat st;
+		if (::fstat(fd_, &st) != 0) {
+			::close(fd_);
 			throw std::runtime_error("DatabaseManager error: Failed to open database file: " + db_file);
 		}
+		file_size_ = st.st_size;
 
-		db_io_.seekg(0, std::ios::end);
-		file_size_ = db_io_.tellg();
-		db_io_.seekg(0, std::ios::beg);
-		db_io_.seekp(0, std::ios::beg); // put pointer
-
-		// first 3 pages (0, 1, 2) are reserved for system tables
+		// first 3 pages (0, 1, 2) are reserved for system tables and the free list
 		if (file_size_ > 0) {
 			page_id_t calculated_page_id = static_cast<page_id_t>(file_size_ / PAGE_SIZE);
 			next_page_id_ = std::max(calculated_page_id, FIRST_USABLE_PAGE_ID);
 		}
+
+		try {
+			LoadFreeList();
+		} catch (...) {
+			::close(fd_);
+			throw;
+		}
+	}
+
+	void DiskManager::MapFile() {
+		int fd = ::open(db_file_name.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			throw std::runtime_error("DatabaseManager error: " + db_file_name + " does not exist");
+		}
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(PAGE_SIZE)) {
+			::close(fd);
+			throw std::runtime_error("DiskManager error: " + db_file_name + " is empty, it cannot be opened read only");
+		}
+
+		// a partly written last page is not mapped
+		mapped_size_ = static_cast<size_t>(st.st_size) / PAGE_SIZE * PAGE_SIZE;
+		void* mapping = ::mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd); // the mapping keeps the file open
+		if (mapping == MAP_FAILED) {
+			throw std::runtime_error("DiskManager error: Failed to map " + db_file_name + ": " + std::strerror(errno));
+		}
+
+		mapping_ = static_cast<char*>(mapping);
+		file_size_ = static_cast<long long>(mapped_size_);
+		next_page_id_ = std::max(static_cast<page_id_t>(mapped_size_ / PAGE_SIZE), FIRST_USABLE_PAGE_ID);
 	}
 
 	DiskManager::~DiskManager() {
-		if (db_io_.is_open()) {
-			db_io_.close();
+		// the log may be gone already, the list is stored without it
+		if (free_list_dirty_) {
+			try {
+				WriteFreeList();
+			} catch (const std::exception& e) {
+				LOG(std::string("DiskManager: Failed to store the free list: ") + e.what());
+			}
+		}
+
+		if (mapping_ != nullptr) {
+			::munmap(mapping_, mapped_size_);
+		}
+		if (fd_ >= 0) {
+			::close(fd_);
+		}
+	}
+
+	char* DiskManager::GetMappedPage(page_id_t page_id) const {
+		if (mapping_ == nullptr || static_cast<size_t>(page_id) >= mapped_size_ / PAGE_SIZE) {
+			return nullptr;
+		}
+		return mapping_ + static_cast<size_t>(page_id) * PAGE_SIZE;
+	}
+
+	void DiskManager::Advise(const page_id_t* page_ids, size_t count, AccessHint hint) {
+		if (mapping_ == nullptr) {
+			return;
+		}
+
+		int advice = hint == AccessHint::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_WILLNEED;
+		static const size_t os_page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		size_t num_pages = mapped_size_ / PAGE_SIZE;
+
+		size_t i = 0;
+		while (i < count) {
+			page_id_t first = page_ids[i];
+			size_t run = 1;
+			while (i + run < count && page_ids[i + run] == first + run) {
+				run++;
+			}
+			i += run;
+
+			if (first >= num_pages) {
+				continue;
+			}
+			run = std::min(run, num_pages - first);
+
+			// madvise wants an address aligned to the OS page
+			size_t begin = static_cast<size_t>(first) * PAGE_SIZE;
+			size_t aligned = begin / os_page_size * os_page_size;
+			::madvise(mapping_ + aligned, begin - aligned + run * PAGE_SIZE, advice); // only a hint, failures are ignored
 		}
 	}
 
 	void DiskManager::ReadPage(page_id_t page_id, char* page_data) {
+		if (mapping_ != nullptr) {
+			char* page = GetMappedPage(page_id);
+			if (page == nullptr) {
+				throw std::out_of_range("Page ID out of range");
+			}
+			std::memcpy(page_data, page, PAGE_SIZE);
+			return;
+		}
+
 		// allow reading system pages if not allocated
-		if (page_id >= next_page_id_ && page_id >= FIRST_USABLE_PAGE_ID) {
+		if (page_id >= GetNumberOfPages() && page_id >= FIRST_USABLE_PAGE_ID) {
 			throw std::out_of_range("Page ID out of range");
 		}
 
-		long long offset = static_cast<long long>(page_id) * PAGE_SIZE;
-		db_io_.seekg(offset);
-		if (!db_io_.read(page_data, PAGE_SIZE)) {
+		// O_DIRECT transfers need an aligned buffer, frames are, anything else goes through a bounce page
+		char* buffer = page_data;
+		if (mode_ == DiskMode::DIRECT && !IsAligned(page_data)) {
+			buffer = BouncePage();
+		}
+
+		off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+		if (!TransferPage(buffer, offset, false)) {
 			throw std::runtime_error("Failed to read page from disk");
 		}
+		if (buffer != page_data) {
+			std::memcpy(page_data, buffer, PAGE_SIZE);
+		}
 	}
 
 	void DiskManager::WritePage(page_id_t page_id, const char* page_data) {
-		if (page_id >= next_page_id_ && page_id >= FIRST_USABLE_PAGE_ID) {
+		if (IsReadOnly()) {
+			throw std::runtime_error("DiskManager error: " + db_file_name + " is opened read only");
+		}
+
+		if (page_id >= GetNumberOfPages() && page_id >= FIRST_USABLE_PAGE_ID) {
 			throw std::out_of_range("Page ID out of range");
 		}
 
-		long long offset = static_cast<long long>(page_id) * PAGE_SIZE;
+		char* buffer = const_cast<char*>(page_data); // only written from
+		if (mode_ == DiskMode::DIRECT && !IsAligned(page_data)) {
+			buffer = BouncePage();
+			std::memcpy(buffer, page_data, PAGE_SIZE);
+		}
 
-		db_io_.clear();
-		db_io_.seekp(offset);
+		off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+		if (!TransferPage(buffer, offset, true)) {
+			throw std::runtime_error("Failed to write page to disk: " + std::string(std::strerror(errno)));
+		}
 
-		if (!db_io_.good()) {
-			throw std::runtime_error("Failed to seek to write position");
+		{
+			// Update file size if page extends beyond current file size limit
+			std::lock_guard<std::mutex> lock(io_latch_);
+			if (offset + PAGE_SIZE > file_size_) {
+				file_size_ = offset + PAGE_SIZE;
+			}
 		}
 
-		if (!db_io_.write(page_data, PAGE_SIZE)) {
-			throw std::runtime_error("Failed to write page to disk");
+		// LOG("Disk Manager: WritePage - Page ID: " + std::to_string(page_id) + ", Offset: " + std::to_string(offset) + ", Size: " + std::to_string(PAGE_SIZE) + ", File Size: " + std::to_string(file_size_));
+
+		if (sync_on_write_ && ::fdatasync(fd_) != 0) {
+			throw std::runtime_error("Failed to sync database file: " + db_file_name);
 		}
+	}
 
-		// Update file size if page extends beyond current file size limit
-		if (offset + PAGE_SIZE > file_size_) {
-			file_size_ = offset + PAGE_SIZE;
+	bool DiskManager::TransferPage(char* buffer, off_t offset, bool write) {
+		size_t done = 0;
+		while (done < PAGE_SIZE) {
+			ssize_t n = write ? ::pwrite(fd_, buffer + done, PAGE_SIZE - done, offset + done)
+			                  : ::pread(fd_, buffer + done, PAGE_SIZE - done, offset + done);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				return false; // error, or a read past the end of the file
+			}
+			done += static_cast<size_t>(n);
 		}
+		return true;
+	}
 
-		// LOG("Disk Manager: WritePage - Page ID: " + std::to_string(page_id) + ", Offset: " + std::to_string(offset) + ", Size: " + std::to_string(PAGE_SIZE) + ", File Size: " + std::to_string(file_size_));
+	bool DiskManager::IsAligned(const char* data) {
+		return reinterpret_cast<uintptr_t>(data) % PAGE_SIZE == 0;
+	}
 
-		db_io_.flush(); // force policy
+	char* DiskManager::BouncePage() {
+		struct AlignedPage {
+			alignas(PAGE_SIZE) char data[PAGE_SIZE];
+		};
+		thread_local AlignedPage page;
+		return page.data;
 	}
 
-	page_id_t DiskManager::AllocatePage() {
+	page_id_t DiskManager::AllocatePage(page_id_t extent_key) {
+		if (IsReadOnly()) {
+			throw std::runtime_error("DiskManager error: " + db_file_name + " is opened read only");
+		}
+
+		std::lock_guard<std::mutex> lock(io_latch_);
+
+		if (extent_key != INVALID_PAGE_ID) {
+			Extent& extent = extents_.try_emplace(extent_key, Extent { 0, 0 }).first->second;
+			if (extent.next == extent.end) {
+				ReserveExtent(&extent);
+			}
+			// the stored list still has it as free
+			LogFreeList(true, extent.next, 1);
+			return extent.next++;
+		}
+
+		if (!free_pages_.empty()) {
+			page_id_t page_id = *free_pages_.begin();
+			free_pages_.erase(free_pages_.begin());
+			// logged before anything can use the page, so recovery never hands it out again
+			LogFreeList(true, page_id, 1);
+			return page_id;
+		}
+
 		page_id_t allocated_page_id = next_page_id_;
 		next_page_id_++;
 		file_size_ += PAGE_SIZE;
 		return allocated_page_id;
 	}
 
-	void DiskManager::DeallocatePage(page_id_t page_id) {
-		if (page_id >= next_page_id_) {
+	void DiskManager::ReserveExtent(Extent* extent) {
+		// the longest run of free pages, up to EXTENT_PAGES
+		page_id_t best_first = INVALID_PAGE_ID;
+		uint32_t best_length = 0;
+		page_id_t run_first = INVALID_PAGE_ID;
+		uint32_t run_length = 0;
+		for (page_id_t page_id : free_pages_) {
+			if (run_length > 0 && page_id == run_first + run_length) {
+				run_length++;
+			} else {
+				run_first = page_id;
+				run_length = 1;
+			}
+			if (run_length > best_length) {
+				best_first = run_first;
+				best_length = run_length;
+			}
+			if (best_length == EXTENT_PAGES) {
+				break;
+			}
+		}
+
+		if (best_length > 0) {
+			// only taken out of the list in memory, they stay free in the stored list until handed out
+			free_pages_.erase(free_pages_.lower_bound(best_first), free_pages_.lower_bound(best_first + best_length));
+			*extent = Extent { best_first, best_first + best_length };
+			return;
+		}
+
+		// new pages at the end, fallocate makes the space contiguous up front where the file system can
+		page_id_t first = next_page_id_;
+		off_t offset = static_cast<off_t>(first) * PAGE_SIZE;
+		int rc = ::posix_fallocate(fd_, offset, static_cast<off_t>(EXTENT_PAGES) * PAGE_SIZE);
+		if (rc != 0) {
+			throw std::runtime_error("DiskManager error: Failed to allocate an extent in " + db_file_name + ": " + std::strerror(rc));
+		}
+		next_page_id_ += EXTENT_PAGES;
+		file_size_ = std::max(file_size_, static_cast<long long>(next_page_id_) * PAGE_SIZE);
+		LogFreeList(false, first, EXTENT_PAGES);
+		*extent = Extent { first, next_page_id_ };
+	}
+
+	void DiskManager::ReleaseExtent(page_id_t extent_key) {
+		std::lock_guard<std::mutex> lock(io_latch_);
+
+		auto it = extents_.find(extent_key);
+		if (it == extents_.end()) {
+			return;
+		}
+
+		// never handed out, the stored list has them as free already
+		for (page_id_t page_id = it->second.next; page_id < it->second.end; page_id++) {
+			free_pages_.insert(page_id);
+		}
+		extents_.erase(it);
+	}
+
+	void DiskManager::DeallocatePage(page_id_t page_id, lsn_t freed_lsn) {
+		if (IsReadOnly()) {
+			throw std::runtime_error("DiskManager error: " + db_file_name + " is opened read only");
+		}
+
+		std::lock_guard<std::mutex> lock(io_latch_);
+
+		if (page_id >= next_page_id_ || page_id < FIRST_USABLE_PAGE_ID) {
 			throw std::out_of_range("Page ID out of range");
 		}
 
-		// mark a page as free (generally removing entire page from disk is done using a background thread)
+		if (freed_lsn != 0) {
+			pending_pages_.emplace_back(freed_lsn, page_id);
+			return;
+		}
+		if (free_pages_.insert(page_id).second) {
+			LogFreeList(false, page_id, 1);
+		}
+	}
+
+	void DiskManager::ReleasePages(lsn_t begin_lsn) {
+		std::lock_guard<std::mutex> lock(io_latch_);
+
+		std::vector<page_id_t> released;
+		auto keep = std::remove_if(pending_pages_.begin(), pending_pages_.end(), [&](const auto& pending) {
+			if (pending.first > begin_lsn) {
+				return false; // the log before begin_lsn may still describe its old contents
+			}
+			if (free_pages_.insert(pending.second).second) {
+				released.push_back(pending.second);
+			}
+			return true;
+		});
+		pending_pages_.erase(keep, pending_pages_.end());
+
+		// one record per run of consecutive pages
+		std::sort(released.begin(), released.end());
+		for (size_t i = 0; i < released.size();) {
+			size_t run = 1;
+			while (i + run < released.size() && released[i + run] == released[i] + run) {
+				run++;
+			}
+			LogFreeList(false, released[i], static_cast<uint32_t>(run));
+			i += run;
+		}
+	}
+
+	uint32_t DiskManager::TruncateFreePages() {
+		if (IsReadOnly()) {
+			throw std::runtime_error("DiskManager error: " + db_file_name + " is opened read only");
+		}
+
+		std::lock_guard<std::mutex> lock(io_latch_);
+
+		page_id_t last = next_page_id_ - 1;
+		bool last_free = free_pages_.count(last) > 0
+		    || std::find(list_pages_.begin(), list_pages_.end(), last) != list_pages_.end()
+		    || std::find(retired_list_pages_.begin(), retired_list_pages_.end(), last) != retired_list_pages_.end();
+		if (next_page_id_ <= FIRST_USABLE_PAGE_ID || !last_free) {
+			return 0;
+		}
+
+		// pages holding the list can be cut too, the list is rewritten and synced before the file shrinks
+		free_pages_.insert(list_pages_.begin(), list_pages_.end());
+		free_pages_.insert(retired_list_pages_.begin(), retired_list_pages_.end());
+		list_pages_.clear();
+		retired_list_pages_.clear();
+
+		uint32_t truncated = 0;
+		while (!free_pages_.empty() && *free_pages_.rbegin() == next_page_id_ - 1) {
+			free_pages_.erase(std::prev(free_pages_.end()));
+			next_page_id_--;
+			truncated++;
+		}
+		// the list must not name cut off pages, a crash in between only leaves them unused
+		StoreFreeList();
+		if (::fdatasync(fd_) != 0) {
+			throw std::runtime_error("Failed to sync database file: " + db_file_name);
+		}
+		synced_list_writes_ = list_writes_;
+
+		file_size_ = static_cast<long long>(next_page_id_) * PAGE_SIZE;
+		if (::ftruncate(fd_, static_cast<off_t>(file_size_)) != 0) {
+			throw std::runtime_error("DiskManager error: Failed to truncate " + db_file_name + ": " + std::strerror(errno));
+		}
+		return truncated;
+	}
+
+	size_t DiskManager::GetFreePageCount() const {
+		std::lock_guard<std::mutex> lock(io_latch_);
+		return free_pages_.size() + list_pages_.size() + retired_list_pages_.size();
+	}
+
+	void DiskManager::LoadFreeList() {
+		if (file_size_ < static_cast<long long>(FREE_LIST_PAGE_ID + 1) * PAGE_SIZE) {
+			return; // never written, a new file
+		}
+
+		char* buffer = BouncePage();
+		page_id_t list_page_id = FREE_LIST_PAGE_ID;
+		// a damaged list could loop, it has at most one page per page of the file
+		for (page_id_t pages = 0; list_page_id != 0 && pages < next_page_id_; pages++) {
+			if (!TransferPage(buffer, static_cast<off_t>(list_page_id) * PAGE_SIZE, false)) {
+				throw std::runtime_error("DiskManager error: Failed to read the free list of " + db_file_name);
+			}
+
+			FreeListHeader header;
+			std::memcpy(&header, buffer, sizeof(header));
+			if (header.count > FREE_LIST_CAPACITY) {
+				throw std::runtime_error("DiskManager error: Free list of " + db_file_name + " is corrupt");
+			}
+			if (list_page_id == FREE_LIST_PAGE_ID) {
+				free_list_lsn_ = header.lsn;
+			} else {
+				list_pages_.push_back(list_page_id);
+			}
+
+			const char* ids = buffer + sizeof(FreeListHeader);
+			for (uint32_t i = 0; i < header.count; i++) {
+				page_id_t page_id;
+				std::memcpy(&page_id, ids + i * sizeof(page_id_t), sizeof(page_id_t));
+				if (page_id >= FIRST_USABLE_PAGE_ID && page_id < next_page_id_) {
+					free_pages_.insert(page_id);
+				}
+			}
+
+			list_page_id = header.next;
+			if (list_page_id != 0 && (list_page_id < FIRST_USABLE_PAGE_ID || list_page_id >= next_page_id_)) {
+				throw std::runtime_error("DiskManager error: Free list of " + db_file_name + " is corrupt");
+			}
+		}
+
+		// free, but not handed out before a new list is stored elsewhere
+		for (page_id_t page_id : list_pages_) {
+			free_pages_.erase(page_id);
+		}
+	}
+
+	void DiskManager::WriteFreeList() {
+		// pages an older list was kept in are free once a later list is durable
+		if (synced_list_writes_ == list_writes_) {
+			free_pages_.insert(retired_list_pages_.begin(), retired_list_pages_.end());
+			retired_list_pages_.clear();
+		}
+
+		std::set<page_id_t> free_pages = free_pages_;
+		free_pages.insert(list_pages_.begin(), list_pages_.end());
+		free_pages.insert(retired_list_pages_.begin(), retired_list_pages_.end());
+		std::vector<page_id_t> hostable(free_pages.begin(), free_pages.end());
+
+		// extent pages not handed out yet are free too, a crash must not leak them
+		for (const auto& entry : extents_) {
+			for (page_id_t page_id = entry.second.next; page_id < entry.second.end; page_id++) {
+				free_pages.insert(page_id);
+			}
+		}
+		std::vector<page_id_t> ids(free_pages.begin(), free_pages.end());
+
+		// FREE_LIST_PAGE_ID, then as many free pages as the rest needs, the highest ones, which
+		// AllocatePage hands out last (never extent pages, they are handed out without a new list)
+		size_t hosts = ids.empty() ? 0 : (ids.size() - 1) / FREE_LIST_CAPACITY;
+		while (hosts > hostable.size()) {
+			// mostly extent pages, the list grows the file
+			hostable.push_back(next_page_id_);
+			ids.push_back(next_page_id_);
+			next_page_id_++;
+			hosts = (ids.size() - 1) / FREE_LIST_CAPACITY;
+		}
+		std::vector<page_id_t> list_pages = { FREE_LIST_PAGE_ID };
+		list_pages.insert(list_pages.end(), hostable.end() - hosts, hostable.end());
+
+		char* buffer = BouncePage();
+		size_t next_id = 0;
+		for (size_t i = 0; i < list_pages.size(); i++) {
+			FreeListHeader header;
+			std::memset(&header, 0, sizeof(header));
+			header.next = i + 1 < list_pages.size() ? list_pages[i + 1] : 0;
+			header.count = static_cast<uint32_t>(std::min(FREE_LIST_CAPACITY, ids.size() - next_id));
+			header.lsn = free_list_lsn_;
+
+			std::memset(buffer, 0, PAGE_SIZE);
+			std::memcpy(buffer, &header, sizeof(header));
+			if (header.count > 0) {
+				std::memcpy(buffer + sizeof(header), ids.data() + next_id, header.count * sizeof(page_id_t));
+			}
+			next_id += header.count;
+
+			if (!TransferPage(buffer, static_cast<off_t>(list_pages[i]) * PAGE_SIZE, true)) {
+				throw std::runtime_error("DiskManager error: Failed to write the free list of " + db_file_name);
+			}
+		}
+		file_size_ = std::max(file_size_, static_cast<long long>(next_page_id_) * PAGE_SIZE);
+
+		// the pages of the last list stay out of use until this one is durable
+		std::vector<page_id_t> old_list_pages;
+		old_list_pages.swap(list_pages_);
+		list_pages_.assign(list_pages.begin() + 1, list_pages.end());
+		auto in_list = [&](page_id_t page_id) {
+			return std::find(list_pages_.begin(), list_pages_.end(), page_id) != list_pages_.end();
+		};
+		retired_list_pages_.erase(std::remove_if(retired_list_pages_.begin(), retired_list_pages_.end(), in_list), retired_list_pages_.end());
+		for (page_id_t page_id : old_list_pages) {
+			if (!in_list(page_id)) {
+				retired_list_pages_.push_back(page_id);
+			}
+		}
+		for (page_id_t page_id : list_pages_) {
+			free_pages_.erase(page_id);
+		}
+
+		list_writes_++;
+		free_list_dirty_ = false;
+	}
+
+	void DiskManager::StoreFreeList() {
+		// a change the log could still lose in a crash would leak its pages
+		if (log_manager_ != nullptr && free_list_lsn_ != 0 && free_list_lsn_ < log_manager_->GetNextLSN()) {
+			log_manager_->Flush(free_list_lsn_);
+		}
+		WriteFreeList();
+	}
+
+	void DiskManager::LogFreeList(bool allocated, page_id_t first_page_id, uint32_t page_count) {
+		free_list_dirty_ = true;
+		if (log_manager_ == nullptr) {
+			return;
+		}
+
+		recovery::LogRecord record(allocated ? recovery::LogRecordType::ALLOCATE_PAGES : recovery::LogRecordType::FREE_PAGES,
+		    first_page_id, page_count);
+		free_list_lsn_ = log_manager_->AppendLogRecord(nullptr, &record);
+	}
+
+	void DiskManager::RedoFreeList(const recovery::LogRecord& record) {
+		std::lock_guard<std::mutex> lock(io_latch_);
+
+		if (record.GetLSN() <= free_list_lsn_) {
+			return; // the stored list has it
+		}
+
+		bool allocated = record.GetType() == recovery::LogRecordType::ALLOCATE_PAGES;
+		page_id_t end = record.GetPageId() + record.GetPageCount();
+		for (page_id_t page_id = record.GetPageId(); page_id < end; page_id++) {
+			if (page_id < FIRST_USABLE_PAGE_ID || page_id >= next_page_id_) {
+				continue; // the file was cut, or never grew this far on disk
+			}
+			if (allocated) {
+				free_pages_.erase(page_id);
+			} else if (std::find(list_pages_.begin(), list_pages_.end(), page_id) == list_pages_.end()) {
+				free_pages_.insert(page_id);
+			}
+		}
+		free_list_lsn_ = record.GetLSN();
+		free_list_dirty_ = true;
 	}
 
 	uint32_t DiskManager::GetNumberOfPages() const {
+		std::lock_guard<std::mutex> lock(io_latch_);
 		return next_page_id_;
 	}
 
+	void DiskManager::Sync() {
+		if (IsReadOnly()) {
+			return; // nothing was written
+		}
+
+		uint64_t list_writes;
+		{
+			std::lock_guard<std::mutex> lock(io_latch_);
+			if (free_list_dirty_) {
+				StoreFreeList();
+			}
+			list_writes = list_writes_;
+		}
+
+		// page data only, the file size is updated by fdatasync too when it grew
+		if (::fdatasync(fd_) != 0) {
+			throw std::runtime_error("Failed to sync database file: " + db_file_name);
+		}
+
+		std::lock_guard<std::mutex> lock(io_latch_);
+		synced_list_writes_ = std::max(synced_list_writes_, list_writes);
+	}
+
 } // namespace storage
 } // namespace venus
\ No newline at end of file
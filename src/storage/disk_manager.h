@@ -12,12 +12,44 @@
  *   - Use a kernel‐bypass userspace driver (e.g. SPDK) so you talk NVMe/DAS devices directly.
  *   - But in all cases the hardware’s own firmware will still schedule incoming commands on the platter or flash chips.
  *
- * For VenusDB, we will use a simple file I/O interface to read and write pages, We shift to fsync() in future for writing pages.
+ * For VenusDB, pages are read and written with pread / pwrite at their offset, so concurrent I/O on
+ * different pages needs no latch. Sync() (checkpoints) is an fdatasync.
+ *
+ * Modes
+ *   READ_WRITE     - buffered I/O, the buffer pool reads pages into its frames and writes them back
+ *   DIRECT         - like READ_WRITE with O_DIRECT: transfers go between the frames and the device,
+ *                    bypassing the page cache, so a page is not held in memory twice and I/O latency
+ *                    does not depend on writeback. Buffers must be PAGE_SIZE aligned (frames are, others
+ *                    go through a bounce page). Writes reach the device but not past its volatile
+ *                    cache, durability still needs Sync, or SetSyncOnWrite.
+ *   MMAP_READ_ONLY - for read-only replicas and snapshots: the file is mapped once, read-only, and the
+ *                    buffer pool hands out pages inside the mapping instead of copying them into frames,
+ *                    so the OS page cache is the only cache. Nothing can be written or allocated.
+ *                    Scans tell the kernel what they will read next with Advise (madvise).
  *
  * WritePage    - overwrite (or extend) an existing page
  * ReadPage     - load a page’s contents (scan)
- * AllocatePage - assign a fresh page ID (create a new page) into .db file
- * DeallocatePage - mark a page as free (generally removing entire page from disk is done using a background thread)
+ * AllocatePage - reuse a free page, or assign a fresh page ID at the end of the .db file
+ * DeallocatePage - mark a page as free
+ *
+ * Free pages
+ *   Free page ids are kept in the free list, stored in FREE_LIST_PAGE_ID: [next list page][count][lsn][ids].
+ *   When they do not fit, the list continues in the highest free pages themselves, which are not
+ *   handed out while a stored list may still name them. AllocatePage takes the lowest free page, so
+ *   pages at the end of the file stay free and TruncateFreePages (VACUUM FILE) can cut them off.
+ *   With a LogManager every change to the list is logged (ALLOCATE_PAGES / FREE_PAGES) and the list
+ *   is stored by Sync, at checkpoints, like a dirty page; allocating never writes or syncs the file.
+ *   The stored list carries the LSN of the last change it has, recovery applies the later ones
+ *   again (RedoFreeList). Without a log the list is stored by Sync and on close.
+ *   Table heaps grow by extents: AllocatePage(extent_key) hands out the pages of an extent reserved
+ *   for that heap, EXTENT_PAGES contiguous pages, so a table's pages lie in order in the file and
+ *   read ahead works on them. An extent is the longest run of free pages, up to EXTENT_PAGES, or
+ *   new pages at the end of the file allocated with posix_fallocate (logged as freed). The stored
+ *   list keeps an extent's pages as free until they are handed out, which is logged page by page,
+ *   so a crash frees the rest of every extent. Dropping the heap gives them back in memory.
+ *   The log may still describe a freed page's old contents, and redoing them onto a reused page would
+ *   corrupt it. A page freed at LSN l therefore stays pending until ReleasePages reports a durable
+ *   checkpoint that began at or after l, recovery never redoes the log before that point onto it.
  *
  * Memory refresher
  * - Memory is a sequence of bytes, each byte has an address.
@@ -31,8 +63,8 @@
  * - Pages and Page IDs
  *   * Logical page_id_t in BufferPool → index into frame table.
  *   * Disk offset calculation: offset = page_id * PAGE_SIZE.
- *   * To fetch: fstream.seekg(offset), read PAGE_SIZE bytes into buffer.
- *   * To write: populate in‐memory buffer, fstream.seekp(offset), write PAGE_SIZE.
+ *   * To fetch: pread PAGE_SIZE bytes at offset into buffer.
+ *   * To write: populate in‐memory buffer, pwrite PAGE_SIZE bytes at offset.
  *
  * - Handling Byte Data
  *   * Use std::memcpy or manual bit‐shifts to pack/unpack fields.
@@ -41,29 +73,120 @@
 
 #pragma once
 
-#include <fstream>
+#include <atomic>
+#include <mutex>
+#include <set>
 #include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 
 namespace venus {
+namespace recovery {
+	class LogManager;
+	class LogRecord;
+}
+
 namespace storage {
+	enum class DiskMode : uint8_t {
+		READ_WRITE,
+		DIRECT,
+		MMAP_READ_ONLY,
+	};
+
+	// how a scan is going to read the pages it advises
+	enum class AccessHint : uint8_t {
+		SEQUENTIAL, // in order, read ahead aggressively and drop them soon after
+		WILLNEED, // soon, in any order
+	};
+
 	class DiskManager {
 	public:
-		explicit DiskManager(const std::string& db_file);
+		explicit DiskManager(const std::string& db_file, DiskMode mode = DiskMode::READ_WRITE);
 		~DiskManager();
 
+		DiskMode GetMode() const { return mode_; }
+		bool IsReadOnly() const { return mode_ == DiskMode::MMAP_READ_ONLY; }
+
+		// the page inside the mapping, null unless mapped or past the end of the file
+		// the memory is read only, writing to it faults
+		char* GetMappedPage(page_id_t page_id) const;
+		uint32_t GetNumberOfMappedPages() const { return static_cast<uint32_t>(mapped_size_ / PAGE_SIZE); }
+
+		// no-op unless mapped, runs of consecutive page ids are advised together
+		void Advise(const page_id_t* page_ids, size_t count, AccessHint hint);
+
 		void ReadPage(page_id_t page_id, char* page_data);
 		void WritePage(page_id_t page_id, const char* page_data);
-		page_id_t AllocatePage();
-		void DeallocatePage(page_id_t page_id);
+		// extent_key: the first page of the heap the page is for, INVALID_PAGE_ID for a single page
+		page_id_t AllocatePage(page_id_t extent_key = INVALID_PAGE_ID);
+		// the rest of the heap's extent goes back to the free list
+		void ReleaseExtent(page_id_t extent_key);
+		// freed_lsn: next log position when the page was freed, 0 without a log frees it at once
+		void DeallocatePage(page_id_t page_id, lsn_t freed_lsn = 0);
 		uint32_t GetNumberOfPages() const;
 
+		// a checkpoint that began at begin_lsn is durable, pages freed before it can be reused
+		void ReleasePages(lsn_t begin_lsn);
+		// cuts free pages off the end of the file, returns how many
+		uint32_t TruncateFreePages();
+		size_t GetFreePageCount() const;
+
+		// fdatasync() the db file, pages written before the call survive a crash (checkpoints)
+		// a changed free list is stored first
+		void Sync();
+
+		// changes to the free list are logged to log_manager from now on
+		void SetLogManager(recovery::LogManager* log_manager) { log_manager_ = log_manager; }
+		// recovery: a logged free list change, ignored if the stored list already has it
+		void RedoFreeList(const recovery::LogRecord& record);
+
+		// every WritePage is followed by an fdatasync, off by default: the log makes changes durable
+		void SetSyncOnWrite(bool sync_on_write) { sync_on_write_ = sync_on_write; }
+
 	private:
 		std::string db_file_name; // independent for a database instance
-		std::fstream db_io_; // file stream
+		int fd_;
 		page_id_t next_page_id_; // next available page ID for allocation
 		long long file_size_; // size of the database file
+		mutable std::mutex io_latch_; // protects next_page_id_, file_size_ and the free pages, pread / pwrite need no latch
+		std::atomic<bool> sync_on_write_;
+
+		std::set<page_id_t> free_pages_; // in the free list, lowest first
+		std::vector<page_id_t> list_pages_; // free, but hold the stored list after FREE_LIST_PAGE_ID
+		std::vector<page_id_t> retired_list_pages_; // held the list before, free once the list is synced
+		uint64_t list_writes_; // WriteFreeList calls
+		uint64_t synced_list_writes_; // list writes an fdatasync made durable
+		bool free_list_dirty_; // changed since it was stored
+		recovery::LogManager* log_manager_;
+		lsn_t free_list_lsn_; // last logged change of the list, 0 if none
+		std::vector<std::pair<lsn_t, page_id_t>> pending_pages_; // freed, not reusable before a checkpoint after the lsn
+
+		struct Extent {
+			page_id_t next; // next page to hand out
+			page_id_t end;
+		};
+		std::unordered_map<page_id_t, Extent> extents_; // heap's first page -> its extent
+
+		DiskMode mode_;
+		char* mapping_; // MMAP_READ_ONLY: the whole file, PROT_READ
+		size_t mapped_size_;
+
+		void MapFile();
+
+		// called with io_latch_ held
+		void LoadFreeList();
+		void WriteFreeList();
+		void StoreFreeList(); // durable up to the log first, for Sync and TruncateFreePages
+		void LogFreeList(bool allocated, page_id_t first_page_id, uint32_t page_count);
+		void ReserveExtent(Extent* extent);
+
+		// one whole page at offset, false on error or a read past the end of the file
+		bool TransferPage(char* buffer, off_t offset, bool write);
+		static bool IsAligned(const char* data);
+		static char* BouncePage(); // PAGE_SIZE aligned, one per thread
 
 		DISALLOW_COPY_AND_MOVE(DiskManager);
 	};
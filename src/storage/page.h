@@ -19,21 +19,60 @@
   * - Free Space Pointer: Offset from start to begin of free space(grows downward).
   * - Tuple Start Pointer: Offset from start to the first tuple (grows upward) - end of free space.
   * - Is Dirty: If page is modified in mem by bpm
+  * - Page LSN: LSN of the last log record applied to this page, the bpm flushes the log
+  *   up to it before the page may be written back (WAL-before-data)
+  * - Dead Slots / Dead Space: slots of removed tuples and the bytes those tuples still take up.
+  *   An insert reuses a dead slot and, when the free space is too small but the dead bytes
+  *   would make room, compacts the page first. Both live in what was padding, pages written
+  *   before them read as zero (nothing reusable).
   *
   * Slot Directory Entry
   * - Slot Id: Unique identifier for the slot.
   * - Tuple Offset: Offset to the tuple in the page.
   * - Tuple Length: Length of the tuple in bytes.
   * - Status: Status of the slot (e.g., active, deleted).
+  * - xmin / xmax: transactions that created / deleted this tuple version (MVCC).
+  *   INVALID_TXN_ID as xmin means written outside a transaction, visible to everyone.
+  *   A delete only sets xmax, the version stays for older snapshots until garbage collected.
+  *
+  * Columnar Page Layout (PAX)
+   +--------------------+  ← offset 0
+   | Page Header        |
+   +--------------------+
+   | Slot Directory     |  (at most capacity slots)
+   +--------------------+  ← free_space_ptr
+   | Free Space         |
+   +--------------------+  ← tuple_start_ptr
+   | Minipage 0         |  field 0 of every slot, slot i at i * width
+   | ...                |
+   | Minipage F - 1     |  the null bitmaps
+   +--------------------+
+   | Minipage Directory |  offset, width and encoding of every minipage, then the footer
+   +--------------------+  ← offset 4096 (PAGE_SIZE)
+
+  * A columnar page holds rows of a fixed size. The fields of a row are the column slots and the
+  * null bitmap (everything but the size header), each goes to its own minipage, so a scan reading
+  * a few columns of a wide table only touches their minipages. The slots keep the row's
+  * visibility as on a row page; slot i is row i of every minipage and tuple_offset is unused.
+  * The page is sized for capacity rows when it is created, so there is nothing to compact:
+  * an insert takes a dead slot or the next one. ReadTuple and WriteTuple gather and scatter
+  * whole rows, the layout is the same for every page of a table (see Schema::GetFieldWidths).
+  *
+  * A full columnar page is compressed: each minipage is encoded in place, at the start of its
+  * region, if an encoding makes it smaller (see column_encoding.h). Scans stream the encoded
+  * bytes. The page keeps its capacity, so the next write to it simply decodes every minipage
+  * again; compression changes no row and is not logged.
 */
 
 #pragma once
 
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include "common/config.h"
 #include "common/types.h"
+#include "storage/column_encoding.h"
 #include "storage/tuple.h"
 
 namespace venus {
@@ -41,6 +80,23 @@ struct SlotDirectory {
 	uint32_t tuple_offset; // offset of tuple from the start of the page
 	uint16_t tuple_length;
 	bool is_live;
+	txn_id_t xmin; // creating transaction
+	txn_id_t xmax; // deleting transaction, INVALID_TXN_ID while the version is current
+};
+
+// where the values of one field are on a columnar page
+struct Minipage {
+	uint16_t offset; // of slot 0's value from the start of the page
+	uint16_t width;
+	ColumnEncoding encoding; // PLAIN unless the page is compressed
+};
+
+// last bytes of a columnar page, the minipage directory is right before it
+struct ColumnarFooter {
+	uint16_t num_fields;
+	uint16_t capacity; // rows the page has room for
+	uint16_t row_size; // tuple size, size header included
+	bool is_compressed; // minipages went through Compress, some may have stayed plain
 };
 
 struct PageHeader {
@@ -52,6 +108,9 @@ struct PageHeader {
 	uint32_t free_space_ptr;
 	uint32_t tuple_start_ptr;
 	bool is_dirty;
+	uint16_t dead_slots;
+	uint32_t dead_space;
+	lsn_t page_lsn;
 
 	uint32_t GetMetaSpace() const { // Page header + slot directory
 		return sizeof(PageHeader) + (num_slots * sizeof(SlotDirectory));
@@ -74,10 +133,43 @@ public:
 		header->free_space_ptr = sizeof(PageHeader); // end of page header(there are no slots during init)
 		header->tuple_start_ptr = PAGE_SIZE; // start of tuples - end of page
 		header->is_dirty = false;
+		header->dead_slots = 0;
+		header->dead_space = 0;
+		header->page_lsn = 0; // older than any log record
 		header->next_page_id = INVALID_PAGE_ID; //
 		header->prev_page_id = INVALID_PAGE_ID;
 	}
 
+	// a columnar page for rows made of fields of the given widths, see ColumnarCapacity
+	void NewColumnarPage(page_id_t page_id, const std::vector<uint16_t>& widths) {
+		NewPage(page_id, PageType::COLUMNAR_PAGE);
+
+		ColumnarFooter* footer = GetFooter();
+		footer->num_fields = static_cast<uint16_t>(widths.size());
+		footer->capacity = ColumnarCapacity(widths);
+		footer->row_size = sizeof(uint32_t);
+
+		Minipage* minipages = GetMinipages();
+		uint32_t offset = static_cast<uint32_t>(reinterpret_cast<char*>(minipages) - data_);
+		for (size_t field = widths.size(); field-- > 0;) {
+			offset -= footer->capacity * widths[field];
+			minipages[field].offset = static_cast<uint16_t>(offset);
+			minipages[field].width = widths[field];
+			footer->row_size += widths[field];
+		}
+		GetHeader()->tuple_start_ptr = offset;
+	}
+
+	// rows a columnar page with fields of the given widths has room for, 0 if not even one
+	static uint16_t ColumnarCapacity(const std::vector<uint16_t>& widths) {
+		uint32_t row_width = sizeof(SlotDirectory);
+		for (uint16_t width : widths) {
+			row_width += width;
+		}
+		uint32_t space = PAGE_SIZE - sizeof(PageHeader) - sizeof(ColumnarFooter) - widths.size() * sizeof(Minipage);
+		return static_cast<uint16_t>(space / row_width);
+	}
+
 	PageHeader* GetHeader() {
 		// A reinterpret_cast in C++ tells the compiler to treat a value (often a pointer or integer)
 		// as if it were a different type, without changing the underlying bit‐pattern
@@ -97,6 +189,89 @@ public:
 		return data_;
 	}
 
+	bool IsColumnar() const {
+		return GetHeader()->page_type == PageType::COLUMNAR_PAGE;
+	}
+
+	// field widths of a columnar page, empty for a row page
+	std::vector<uint16_t> GetFieldWidths() const {
+		std::vector<uint16_t> widths;
+		if (IsColumnar()) {
+			for (uint16_t field = 0; field < GetFooter()->num_fields; field++) {
+				widths.push_back(GetMinipages()[field].width);
+			}
+		}
+		return widths;
+	}
+
+	// columnar pages only: the values of a field, slot i's at i * width while the encoding is PLAIN
+	const Minipage& GetMinipage(uint16_t field) const {
+		return GetMinipages()[field];
+	}
+
+	// columnar pages only: a field of a slot, decoded into scratch (width bytes) if it is encoded
+	const char* GetField(slot_id_t slot_id, uint16_t field, char* scratch) const {
+		const Minipage& minipage = GetMinipages()[field];
+		if (minipage.encoding == ColumnEncoding::PLAIN) {
+			return data_ + minipage.offset + slot_id * minipage.width;
+		}
+		EncodedMinipage(data_ + minipage.offset, minipage.encoding, minipage.width).Read(slot_id, scratch);
+		return scratch;
+	}
+
+	// columnar pages only: a field of every slot, back to back, decoded into scratch if it is encoded
+	const char* GetValues(uint16_t field, std::vector<char>* scratch) const {
+		const Minipage& minipage = GetMinipages()[field];
+		if (minipage.encoding == ColumnEncoding::PLAIN) {
+			return data_ + minipage.offset;
+		}
+		scratch->resize(static_cast<size_t>(GetHeader()->num_slots) * minipage.width);
+		EncodedMinipage(data_ + minipage.offset, minipage.encoding, minipage.width).ReadAll(GetHeader()->num_slots, scratch->data());
+		return scratch->data();
+	}
+
+	bool IsCompressed() const {
+		return IsColumnar() && GetFooter()->is_compressed;
+	}
+
+	// encodes the minipages of a columnar page that get smaller, false if there is nothing to do
+	bool Compress() {
+		if (!IsColumnar() || GetFooter()->is_compressed) {
+			return false;
+		}
+		char encoded[PAGE_SIZE];
+		for (uint16_t field = 0; field < GetFooter()->num_fields; field++) {
+			Minipage& minipage = GetMinipages()[field];
+			uint32_t size;
+			minipage.encoding = EncodeMinipage(data_ + minipage.offset, GetHeader()->num_slots, minipage.width, encoded,
+			    GetFooter()->capacity * minipage.width, &size);
+			if (minipage.encoding != ColumnEncoding::PLAIN) {
+				memcpy(data_ + minipage.offset, encoded, size);
+			}
+		}
+		GetFooter()->is_compressed = true;
+		return true;
+	}
+
+	// back to plain minipages, before a row of a compressed page is written
+	void Decompress() {
+		if (!IsCompressed()) {
+			return;
+		}
+		char decoded[PAGE_SIZE];
+		uint16_t rows = GetHeader()->num_slots;
+		for (uint16_t field = 0; field < GetFooter()->num_fields; field++) {
+			Minipage& minipage = GetMinipages()[field];
+			if (minipage.encoding == ColumnEncoding::PLAIN) {
+				continue;
+			}
+			EncodedMinipage(data_ + minipage.offset, minipage.encoding, minipage.width).ReadAll(rows, decoded);
+			memcpy(data_ + minipage.offset, decoded, static_cast<size_t>(rows) * minipage.width);
+			minipage.encoding = ColumnEncoding::PLAIN;
+		}
+		GetFooter()->is_compressed = false;
+	}
+
 	SlotDirectory* GetSlotDirectory(slot_id_t slot_id) {
 		// slots are 0-indexed
 		if (slot_id >= GetHeader()->num_slots) {
@@ -105,6 +280,172 @@ public:
 		return reinterpret_cast<SlotDirectory*>(data_ + sizeof(PageHeader) + (slot_id * sizeof(SlotDirectory)));
 	}
 
+	// room for a tuple of tuple_size, counting the dead bytes a compaction gives back
+	bool HasRoomFor(uint32_t tuple_size) const {
+		const PageHeader* header = GetHeader();
+		if (IsColumnar()) {
+			return tuple_size == GetFooter()->row_size && (header->dead_slots > 0 || header->num_slots < GetFooter()->capacity);
+		}
+		uint32_t slot_space = header->dead_slots > 0 ? 0 : sizeof(SlotDirectory);
+		return tuple_size + slot_space <= header->tuple_start_ptr - header->free_space_ptr + header->dead_space;
+	}
+
+	// first dead slot, num_slots when the directory has to grow
+	slot_id_t FindFreeSlot() {
+		PageHeader* header = GetHeader();
+		if (header->dead_slots > 0) {
+			for (slot_id_t slot_id = 0; slot_id < header->num_slots; slot_id++) {
+				if (!GetSlotDirectory(slot_id)->is_live) {
+					return slot_id;
+				}
+			}
+		}
+		return header->num_slots;
+	}
+
+	// bytes inserts can still use, counting the dead ones and the slots they need
+	uint32_t GetFreeSpace() const {
+		const PageHeader* header = GetHeader();
+		if (IsColumnar()) {
+			const ColumnarFooter* footer = GetFooter();
+			return (footer->capacity - header->num_slots + header->dead_slots) * (footer->row_size + sizeof(SlotDirectory));
+		}
+		return header->tuple_start_ptr - header->free_space_ptr + header->dead_space;
+	}
+
+	// copies a tuple into slot_id, a dead slot or num_slots, compacting the page first if the free
+	// space is fragmented; nullptr if it does not fit
+	// a columnar page takes rows of its row size only, split into its minipages
+	SlotDirectory* PlaceTuple(slot_id_t slot_id, const char* data, uint32_t size) {
+		PageHeader* header = GetHeader();
+		if (slot_id > header->num_slots || (slot_id < header->num_slots && GetSlotDirectory(slot_id)->is_live)) {
+			return nullptr;
+		}
+
+		bool grows = slot_id == header->num_slots;
+		if (IsColumnar()) {
+			if (size != GetFooter()->row_size || (grows && header->num_slots >= GetFooter()->capacity)) {
+				return nullptr;
+			}
+			Decompress();
+		} else {
+			uint32_t required = size + (grows ? sizeof(SlotDirectory) : 0);
+			if (required > header->tuple_start_ptr - header->free_space_ptr) {
+				Compact();
+				if (required > header->tuple_start_ptr - header->free_space_ptr) {
+					return nullptr;
+				}
+			}
+		}
+
+		if (grows) {
+			header->num_slots++;
+			header->free_space_ptr += sizeof(SlotDirectory);
+		} else if (header->dead_slots > 0) {
+			header->dead_slots--;
+		}
+
+		SlotDirectory* slot = GetSlotDirectory(slot_id);
+		slot->is_live = true;
+		slot->tuple_length = size;
+		if (IsColumnar()) {
+			slot->tuple_offset = 0;
+		} else {
+			header->tuple_start_ptr -= size;
+			slot->tuple_offset = header->tuple_start_ptr;
+		}
+		WriteTuple(slot_id, data);
+		return slot;
+	}
+
+	// copy of the tuple in a slot, gathered from the minipages on a columnar page
+	Tuple ReadTuple(slot_id_t slot_id, const RID& rid) {
+		SlotDirectory* slot = GetSlotDirectory(slot_id);
+		if (!IsColumnar()) {
+			return Tuple(data_ + slot->tuple_offset, rid);
+		}
+
+		std::vector<char> data(slot->tuple_length);
+		uint32_t size = slot->tuple_length;
+		memcpy(data.data(), &size, sizeof(uint32_t));
+		uint32_t pos = sizeof(uint32_t);
+		for (uint16_t field = 0; field < GetFooter()->num_fields; field++) {
+			const Minipage& minipage = GetMinipages()[field];
+			if (minipage.encoding == ColumnEncoding::PLAIN) {
+				memcpy(data.data() + pos, data_ + minipage.offset + slot_id * minipage.width, minipage.width);
+			} else {
+				EncodedMinipage(data_ + minipage.offset, minipage.encoding, minipage.width).Read(slot_id, data.data() + pos);
+			}
+			pos += minipage.width;
+		}
+		return Tuple(std::move(data), rid);
+	}
+
+	// overwrites the tuple in a slot with one of the same size
+	void WriteTuple(slot_id_t slot_id, const char* data) {
+		SlotDirectory* slot = GetSlotDirectory(slot_id);
+		if (!IsColumnar()) {
+			memcpy(data_ + slot->tuple_offset, data, slot->tuple_length);
+			return;
+		}
+
+		Decompress();
+		uint32_t pos = sizeof(uint32_t);
+		for (uint16_t field = 0; field < GetFooter()->num_fields; field++) {
+			const Minipage& minipage = GetMinipages()[field];
+			memcpy(data_ + minipage.offset + slot_id * minipage.width, data + pos, minipage.width);
+			pos += minipage.width;
+		}
+	}
+
+	// the slot becomes reusable, its bytes stay until the page is compacted
+	void KillSlot(SlotDirectory* slot) {
+		if (!slot->is_live) {
+			return;
+		}
+		slot->is_live = false;
+		GetHeader()->dead_slots++;
+		GetHeader()->dead_space += slot->tuple_length;
+	}
+
+	// moves the live tuples together at the end of the page, slot ids stay the same
+	// (columnar pages have no free space to gather)
+	void Compact() {
+		if (IsColumnar()) {
+			return;
+		}
+		PageHeader* header = GetHeader();
+		char copy[PAGE_SIZE];
+		memcpy(copy + header->tuple_start_ptr, data_ + header->tuple_start_ptr, PAGE_SIZE - header->tuple_start_ptr);
+
+		uint32_t tuple_start = PAGE_SIZE;
+		uint16_t dead_slots = 0;
+		for (slot_id_t slot_id = 0; slot_id < header->num_slots; slot_id++) {
+			SlotDirectory* slot = GetSlotDirectory(slot_id);
+			if (!slot->is_live) {
+				slot->tuple_length = 0;
+				dead_slots++;
+				continue;
+			}
+			tuple_start -= slot->tuple_length;
+			memcpy(data_ + tuple_start, copy + slot->tuple_offset, slot->tuple_length);
+			slot->tuple_offset = tuple_start;
+		}
+
+		header->tuple_start_ptr = tuple_start;
+		header->dead_slots = dead_slots;
+		header->dead_space = 0;
+	}
+
+	bool HasLiveSlot() {
+		for (slot_id_t slot_id = 0; slot_id < GetHeader()->num_slots; slot_id++) {
+			if (GetSlotDirectory(slot_id)->is_live) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void SetDirty(bool is_dirty) {
 		GetHeader()->is_dirty = is_dirty;
 	}
@@ -113,6 +454,14 @@ public:
 		return GetHeader()->is_dirty;
 	}
 
+	lsn_t GetLSN() const {
+		return GetHeader()->page_lsn;
+	}
+
+	void SetLSN(lsn_t lsn) {
+		GetHeader()->page_lsn = lsn;
+	}
+
 	page_id_t GetPageId() const {
 		return GetHeader()->page_id;
 	}
@@ -122,6 +471,22 @@ public:
 	}
 
 private:
+	const ColumnarFooter* GetFooter() const {
+		return reinterpret_cast<const ColumnarFooter*>(data_ + PAGE_SIZE - sizeof(ColumnarFooter));
+	}
+
+	ColumnarFooter* GetFooter() {
+		return reinterpret_cast<ColumnarFooter*>(data_ + PAGE_SIZE - sizeof(ColumnarFooter));
+	}
+
+	const Minipage* GetMinipages() const {
+		return reinterpret_cast<const Minipage*>(reinterpret_cast<const char*>(GetFooter()) - GetFooter()->num_fields * sizeof(Minipage));
+	}
+
+	Minipage* GetMinipages() {
+		return reinterpret_cast<Minipage*>(reinterpret_cast<char*>(GetFooter()) - GetFooter()->num_fields * sizeof(Minipage));
+	}
+
 	// Pointer to the byte array representing the page
 	// size => PAGE_SIZE
 	char* data_;
@@ -11,30 +11,40 @@ void Tuple::Serialize(const std::vector<const char*>& values, const Schema* sche
 		throw std::invalid_argument("Number of values does not match schema column count");
 	}
 
-	uint32_t total_size = sizeof(uint32_t);
-	for (size_t i = 0; i < schema->GetColumnCount(); ++i) {
-		const Column& column = schema->GetColumn(i);
-		total_size += column.GetLength();
+	// VARCHAR values follow the fixed part, each with its NUL
+	uint32_t total_size = schema->GetTupleSize();
+	for (size_t i : schema->GetVariableColumns()) {
+		if (values[i] != nullptr) {
+			total_size += static_cast<uint32_t>(strnlen(values[i], schema->GetColumn(i).GetMaxLength())) + 1;
+		}
 	}
-
-	data_.resize(total_size);
+	// zero filled, NULL values and the null bitmap start as zeros
+	data_.assign(total_size, 0);
 
 	*reinterpret_cast<uint32_t*>(data_.data()) = total_size;
 
-	char* data_ptr = data_.data() + sizeof(uint32_t);
+	uint32_t var_offset = schema->GetTupleSize();
 	for (size_t i = 0; i < schema->GetColumnCount(); ++i) {
 		const Column& column = schema->GetColumn(i);
 		size_t column_size = column.GetLength();
+		char* data_ptr = data_.data() + schema->GetOffset(i);
 
-		if (column.GetType() == ColumnType::CHAR) {
+		if (values[i] == nullptr) {
+			SetNull(data_.data(), schema->GetNullBitmapOffset(), static_cast<uint32_t>(i), true);
+		} else if (column.GetType() == ColumnType::CHAR) {
 			// since char is of MAX_CHAR_LENGTH, we need to ensure data does not overflow
 			// the empty region is padded with zeros
-			std::memset(data_ptr, 0, column_size);
-			std::memcpy(data_ptr, values[i], std::strlen(values[i]));
+			std::memcpy(data_ptr, values[i], strnlen(values[i], column_size - 1));
+		} else if (column.GetType() == ColumnType::VARCHAR) {
+			VarcharSlot slot;
+			slot.offset = static_cast<uint16_t>(var_offset);
+			slot.length = static_cast<uint16_t>(strnlen(values[i], column.GetMaxLength()));
+			std::memcpy(data_ptr, &slot, sizeof(slot));
+			std::memcpy(data_.data() + var_offset, values[i], slot.length);
+			var_offset += slot.length + 1u;
 		} else {
 			std::memcpy(data_ptr, values[i], column_size);
 		}
-		data_ptr += column_size;
 	}
 }
 
@@ -59,16 +69,24 @@ const char* Tuple::GetValue(uint32_t idx, const Schema* schema) const {
 		throw std::runtime_error("Cannot get value from empty tuple");
 	}
 
-	// Skip size header
-	const char* data_ptr = data_.data() + sizeof(uint32_t);
+	if (IsNull(data_.data(), schema->GetNullBitmapOffset(), idx)) {
+		return nullptr;
+	}
 
-	// Skip to the desired column
-	for (uint32_t i = 0; i < idx; ++i) {
-		const Column& column = schema->GetColumn(i);
-		data_ptr += column.GetLength();
+	const char* field = data_.data() + schema->GetOffset(idx);
+	if (schema->GetColumn(idx).GetType() == ColumnType::VARCHAR) {
+		VarcharSlot slot;
+		std::memcpy(&slot, field, sizeof(slot));
+		return data_.data() + slot.offset;
 	}
+	return field;
+}
 
-	return data_ptr;
+bool Tuple::IsNull(uint32_t idx, const Schema* schema) const {
+	if (idx >= schema->GetColumnCount()) {
+		throw std::out_of_range("Column index out of range");
+	}
+	return !data_.empty() && IsNull(data_.data(), schema->GetNullBitmapOffset(), idx);
 }
 
 } // namespace venus
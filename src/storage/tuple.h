@@ -3,13 +3,12 @@
 /**
  * Tuple represents a row in a table.
  * Since VenusDB is a row-oriented database, a tuple stores entire column data contents of a record.
- * Currently VenusDB supports only INT, FLOAT, and CHAR(fixed length) declared at /src/common/config.h
+ * Currently VenusDB supports INT, FLOAT, CHAR(fixed length) declared at /src/common/config.h and VARCHAR(n)
  * Each tuple is identified by a Record ID (RID)
  * Tuple can be of any length based on the schema of the table
- * Assuming that all the data is not null based on schema, to avoid a null bitmap
  * We use a fixed length encoding and decoding based on the 'Schema' of the table.
  * Generally, A null bitmap is used to indicate which columns are null in a tuple.
- * No nullbitmap for VenusDB - strictly enforcing that all columns are not null.
+ * VenusDB keeps it after the column slots, so the offsets of the columns do not depend on it.
  *
  * So we have raw data in the tuple body based on 'Schema' of the table.
  *
@@ -28,8 +27,23 @@
  * But for fixed length columns, we can have a fixed size tuple.
  * For example, if we have a table with 3 columns: INT, FLOAT, CHAR(10)
  * The tuple size will be fixed as 4 + 4 + 10 = 18 bytes
- * 
- * p
+ *
+ * VARCHAR(n) columns are variable length. The fixed part keeps a VarcharSlot (offset, length) at
+ * the column's offset and the values are stored after the fixed part, NUL terminated, so a value
+ * takes its length + 1 bytes and GetValue returns a C string for CHAR and VARCHAR alike.
+ *
+ * A NULL value has its bit set in the null bitmap and GetValue returns nullptr for it. Its slot is
+ * zeroed, a NULL VARCHAR has the slot (0, 0) and no bytes after the fixed part.
+ * +------------------------------------+
+ * | Tuple Size (uint32_t)              |
+ * +------------------------------------+
+ * | fixed columns, VarcharSlot per     |
+ * | VARCHAR column                     |
+ * +------------------------------------+
+ * | Null Bitmap (ceil(num_cols/8))     |
+ * +------------------------------------+
+ * | VARCHAR values                     |
+ * +------------------------------------+
  */
 
 #pragma once
@@ -42,7 +56,6 @@
 #include <vector>
 
 #include "common/config.h"
-#include "storage/page.h"
 
 namespace venus {
 
@@ -73,6 +86,7 @@ public:
 	Tuple() = default;
 
 	// Initialize a tuple with values based on schema to serialize them to tuple byte buffer
+	// a nullptr value is NULL
 	Tuple(const std::vector<const char*>& values, const Schema* schema)
 	    : record_id_()
 	    , data_() {
@@ -91,6 +105,11 @@ public:
 		data_.assign(data, data + tuple_size);
 	}
 
+	// Take over bytes already in tuple format, size header included
+	Tuple(std::vector<char> data, RID rid)
+	    : record_id_(std::move(rid))
+	    , data_(std::move(data)) { }
+
 	const char* GetData() const {
 		return data_.data();
 	}
@@ -115,8 +134,20 @@ public:
 		record_id_ = rid;
 	}
 
+	// nullptr for NULL
 	const char* GetValue(uint32_t idx, const Schema* schema) const;
 
+	bool IsNull(uint32_t idx, const Schema* schema) const;
+
+	// bit of column idx in the null bitmap at bitmap_offset of a serialized tuple
+	static bool IsNull(const char* data, uint32_t bitmap_offset, uint32_t idx) {
+		return (data[bitmap_offset + idx / 8] >> (idx % 8)) & 1;
+	}
+	static void SetNull(char* data, uint32_t bitmap_offset, uint32_t idx, bool is_null) {
+		char mask = static_cast<char>(1 << (idx % 8));
+		data[bitmap_offset + idx / 8] = is_null ? (data[bitmap_offset + idx / 8] | mask) : (data[bitmap_offset + idx / 8] & ~mask);
+	}
+
 private:
 	mutable RID record_id_;
 	std::vector<char> data_; // tuple header + body
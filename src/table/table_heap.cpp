@@ -1,288 +1,513 @@
 // src/storage/table_heap.cpp
 
 #include "table/table_heap.h"
+#include "catalog/value.h"
+#include "concurrency/lock_manager.h"
 
 namespace venus {
 namespace table {
 
-	bool TableHeap::InsertTuple(const Tuple& tuple, RID* rid) {
+	bool TableHeap::InsertTuple(const Tuple& tuple, RID* rid, concurrency::Transaction* txn) {
 		if (tuple.GetSize() == 0 || rid == nullptr) {
 			return false;
 		}
 
-		Page* page = nullptr;
-		page_id_t curr_page_id = first_page_id_;
-		page_id_t prev_page_id = INVALID_PAGE_ID;
+		// locks are taken before any page latch, a lock wait never holds a latch
+		if (txn != nullptr && txn->GetLockManager() != nullptr && first_page_id_ != INVALID_PAGE_ID) {
+			txn->GetLockManager()->LockTable(txn, concurrency::LockMode::INTENTION_EXCLUSIVE, first_page_id_);
+		}
+
+		buffer::PageGuard guard;
+
+		if (first_page_id_ == INVALID_PAGE_ID) {
+			// heap has no page yet
+			guard = bpm_->NewPageGuarded();
+			if (!guard) {
+				return false;
+			}
+			first_page_id_ = guard.GetPageId();
+			if (zone_map_ != nullptr) {
+				zone_map_->Reset(first_page_id_);
+			}
 
-		while (true) {
-			if (curr_page_id == INVALID_PAGE_ID) {
-				// End of pages/no pages in heap -> allocate new page
+			recovery::LogRecord record(first_page_id_, INVALID_PAGE_ID);
+			LogChange(guard.GetPage(), txn, &record);
+		} else {
+			page_id_t curr_page_id = first_page_id_;
 
-				// BPM Newpage() allocates a new page in memory, disk, and lru
-				page = bpm_->NewPage();
-				page_id_t new_page_id = page->GetPageId();
-				if (page == nullptr) {
+			// latch coupling: the next page is latched before the current one is released,
+			// so two inserters can never both append a page at the end of the chain
+			while (true) {
+				guard = bpm_->FetchPageWrite(curr_page_id);
+				if (!guard) {
 					return false;
 				}
 
-				// if heap has no page yet
-				if (first_page_id_ == INVALID_PAGE_ID) {
-					first_page_id_ = new_page_id;
+				PageHeader* header = guard->GetHeader();
+				if (guard->HasRoomFor(tuple.GetSize())) {
+					break; // Enough space found, insert the tuple
+				}
+				// a full columnar page is read mostly from now on, it is encoded once;
+				// the encoding is not logged, a later write decodes the page first
+				if (guard->Compress()) {
+					guard.MarkDirty();
 				}
-				// heap is at end of pages
-				else {
-					Page* prev_page = bpm_->FetchPage(prev_page_id);
-					if (prev_page == nullptr) {
-						bpm_->SetDirtyPage(prev_page->GetPageId(), true);
-						return false;
-					}
 
-					prev_page->GetHeader()->next_page_id = new_page_id;
-					page->GetHeader()->prev_page_id = prev_page_id;
-					bpm_->SetDirtyPage(prev_page->GetPageId(), true);
+				if (header->next_page_id != INVALID_PAGE_ID) {
+					// go to next page
+					curr_page_id = header->next_page_id;
+					continue;
 				}
-				curr_page_id = new_page_id;
-				break; // got the page, now allocate tuple
-			} else {
-				page = bpm_->FetchPage(curr_page_id);
-				if (page == nullptr) {
+
+				// End of pages -> allocate new page and link it to the last one
+				// from the heap's extent, so its pages stay in order on disk
+				buffer::PageGuard new_guard = bpm_->NewPageGuarded(first_page_id_);
+				if (!new_guard) {
 					return false;
 				}
-
-				uint32_t required_space = tuple.GetSize() + sizeof(SlotDirectory);
-				uint32_t avail_space = page->GetHeader()->tuple_start_ptr - page->GetHeader()->free_space_ptr;
-
-				if (required_space > avail_space) {
-					// go to next page
-					prev_page_id = curr_page_id;
-					curr_page_id = page->GetHeader()->next_page_id;
-					bpm_->SetDirtyPage(page->GetPageId(), false);
-				} else {
-					// Enough space found, insert the tuple
-					break;
+				// a page of a columnar table is laid out like the others
+				std::vector<uint16_t> widths = guard->GetFieldWidths();
+				if (!widths.empty()) {
+					new_guard->NewColumnarPage(new_guard.GetPageId(), widths);
 				}
+				header->next_page_id = new_guard.GetPageId();
+				new_guard->GetHeader()->prev_page_id = curr_page_id;
+				// the page may have been in the chain before, its old zone is gone with its rows
+				if (zone_map_ != nullptr) {
+					zone_map_->Reset(new_guard.GetPageId());
+				}
+
+				recovery::LogRecord record(new_guard.GetPageId(), curr_page_id, widths);
+				LogChange(new_guard.GetPage(), txn, &record);
+				guard->SetLSN(new_guard->GetLSN());
+				guard.MarkDirty();
+				guard = std::move(new_guard);
+				break;
 			}
 		}
 
-		// Here we have the page
-
-		slot_id_t slot_id = page->GetHeader()->num_slots;
-
-		// create a new entry
-		SlotDirectory* slot = reinterpret_cast<SlotDirectory*>(page->GetData() + sizeof(PageHeader) + (slot_id * sizeof(SlotDirectory)));
-		slot->is_live = true;
-		slot->tuple_length = tuple.GetSize();
-
-		// offset from start of page
-		slot->tuple_offset = page->GetHeader()->tuple_start_ptr - tuple.GetSize();
-
-		// copy tuple data to page
-		memcpy(page->GetData() + slot->tuple_offset, tuple.GetData(), tuple.GetSize());
+		// Here we have the page, latched exclusively
+		return PlaceTuple(&guard, tuple, guard->FindFreeSlot(), rid, txn);
+	}
 
-		// update page
-		page->GetHeader()->num_slots++;
-		page->GetHeader()->free_space_ptr += sizeof(SlotDirectory);
-		page->GetHeader()->tuple_start_ptr -= tuple.GetSize();
+	bool TableHeap::PlaceTuple(buffer::PageGuard* guard, const Tuple& tuple, slot_id_t slot_id, RID* rid, concurrency::Transaction* txn) {
+		Page* page = guard->GetPage();
+		SlotDirectory* slot = page->PlaceTuple(slot_id, tuple.GetData(), tuple.GetSize());
+		if (slot == nullptr) {
+			return false;
+		}
+		slot->xmin = txn != nullptr ? txn->GetTxnId() : INVALID_TXN_ID;
+		slot->xmax = INVALID_TXN_ID;
+		if (zone_map_ != nullptr) {
+			zone_map_->Widen(guard->GetPageId(), tuple.GetData());
+		}
 
-		rid->page_id = page->GetPageId();
+		rid->page_id = guard->GetPageId();
 		rid->slot_id = slot_id;
 		tuple.SetRID(*rid);
 
-		bpm_->SetDirtyPage(page->GetPageId(), true);
-		bpm_->FlushPage(page->GetPageId());
+		recovery::LogRecord record(recovery::LogRecordType::INSERT, *rid, tuple);
+		LogChange(page, txn, &record);
+		guard->MarkDirty();
 
 		return true;
 	}
 
-	bool TableHeap::InsertTuple(const std::vector<std::string>& values) {
+	bool TableHeap::InsertTuple(const std::vector<std::string>& values, concurrency::Transaction* txn,
+	    const std::vector<bool>& nulls) {
 		if (values.size() != schema_->GetColumnCount()) {
 			return false;
 		}
 
-		// size of tuple to store in page
-		uint32_t total_size = sizeof(uint32_t);
-		for (size_t i = 0; i < schema_->GetColumnCount(); ++i) {
-			total_size += schema_->GetColumn(i).GetLength();
-		}
-
-		std::vector<char> tuple_data(total_size);
+		// numbers are converted into a scratch copy of the fixed part, strings are used as they are
+		std::vector<char> scratch(schema_->GetTupleSize());
+		std::vector<const char*> raw_values(values.size());
 
-		// size header
-		*reinterpret_cast<uint32_t*>(tuple_data.data()) = total_size;
-
-		char* data_ptr = tuple_data.data() + sizeof(uint32_t);
 		for (size_t i = 0; i < schema_->GetColumnCount(); ++i) {
 			const Column& column = schema_->GetColumn(i);
 			const std::string& value_str = values[i];
+			char* data_ptr = scratch.data() + schema_->GetOffset(i);
 
-			switch (column.GetType()) {
-			case ColumnType::INT: {
-				int int_value = std::stoi(value_str);
-				std::memcpy(data_ptr, &int_value, sizeof(int));
-				break;
+			if (!nulls.empty() && nulls[i]) {
+				raw_values[i] = nullptr;
+				continue;
 			}
-			case ColumnType::FLOAT: {
-				float float_value = std::stof(value_str);
-				std::memcpy(data_ptr, &float_value, sizeof(float));
+
+			switch (column.GetType()) {
+			case ColumnType::INT:
+			case ColumnType::FLOAT:
+			case ColumnType::BIGINT:
+			case ColumnType::DOUBLE:
+			case ColumnType::DATE:
+			case ColumnType::TIMESTAMP:
+				EncodeLiteral(column.GetType(), value_str, data_ptr);
+				raw_values[i] = data_ptr;
 				break;
-			}
-			case ColumnType::CHAR: {
-				std::memset(data_ptr, 0, column.GetLength()); // zero fill
-				std::memcpy(data_ptr, value_str.c_str(),
-				    std::min(value_str.length(), static_cast<size_t>(column.GetLength() - 1)));
+			case ColumnType::CHAR:
+			case ColumnType::VARCHAR:
+				// CHAR is zero filled and cut to MAX_CHAR_LENGTH - 1 characters by serialization
+				raw_values[i] = value_str.c_str();
 				break;
-			}
 			default:
 				return false; 
 			}
-			data_ptr += column.GetLength();
 		}
 
-		Tuple tuple(tuple_data.data(), RID());
+		Tuple tuple(raw_values, schema_);
 
 		RID rid;
-		return InsertTuple(tuple, &rid);
+		return InsertTuple(tuple, &rid, txn);
 	}
 
-	bool TableHeap::DeleteTuple(const RID& rid) {
+	bool TableHeap::DeleteTuple(const RID& rid, concurrency::Transaction* txn) {
 		page_id_t page_id = rid.page_id;
 		slot_id_t slot_id = rid.slot_id;
 
-		Page* page = bpm_->FetchPage(page_id);
-		if (page == nullptr) {
+		// a concurrent writer of the row holds it until it finishes, its xmax is final once granted
+		if (txn != nullptr && txn->GetLockManager() != nullptr) {
+			txn->GetLockManager()->LockRow(txn, concurrency::LockMode::EXCLUSIVE, first_page_id_, rid);
+		}
+
+		buffer::PageGuard guard = bpm_->FetchPageWrite(page_id);
+		if (!guard) {
 			return false;
 		}
 
-		if (page->GetHeader()->page_type != PageType::TABLE_PAGE) {
+		if (!IsDataPage(*guard.GetPage())) {
 			return false;
 		}
 
-		SlotDirectory* slot = page->GetSlotDirectory(slot_id);
+		SlotDirectory* slot = guard->GetSlotDirectory(slot_id);
 
 		if (slot == nullptr || !slot->is_live) {
 			return false;
 		}
 
-		slot->is_live = false;
+		if (txn == nullptr) {
+			guard->KillSlot(slot);
+		} else {
+			if (!txn->Sees(slot->xmin)) {
+				return false;
+			}
+			if (slot->xmax != INVALID_TXN_ID) {
+				if (txn->Sees(slot->xmax)) {
+					return false; // already deleted
+				}
+				throw std::runtime_error("Transaction error: Write-write conflict on tuple (" + std::to_string(page_id) + ", "
+				    + std::to_string(slot_id) + "), it was changed by a concurrent transaction");
+			}
+			slot->xmax = txn->GetTxnId();
+		}
+
+		recovery::LogRecord record(recovery::LogRecordType::DELETE, rid, guard->ReadTuple(slot_id, rid));
+		LogChange(guard.GetPage(), txn, &record);
+		guard.MarkDirty();
 
 		return true;
 	}
 
-	bool TableHeap::UpdateTuple(const Tuple& new_tuple, const RID& rid) {
+	bool TableHeap::UpdateTuple(const Tuple& new_tuple, const RID& rid, concurrency::Transaction* txn) {
 
 		// flow
 		// 1. Get the existing tuple using the RID
 		// 2. If the sizes are the same, copy the new tuple data to the existing slot
-		// 3. If the sizes are different, delete the existing tuple
-		//    and insert the new tuple, ensuring the RID remains the same
+		// 3. If the sizes are different, replace the existing tuple in its slot if the page has room,
+		//    else delete it and insert the new tuple elsewhere
 		if (new_tuple.GetSize() == 0) {
 			return false;
 		}
 
-		Tuple* existing_tuple = GetTuple(rid);
-
-		if (existing_tuple == nullptr) {
-			return false;
-		}
-
-		if (existing_tuple->GetSize() == new_tuple.GetSize()) {
-			Page* page = bpm_->FetchPage(rid.page_id);
-			if (page == nullptr) {
-				delete existing_tuple;
+		// a new version, readers with older snapshots keep the old one
+		if (txn != nullptr) {
+			RID new_rid;
+			if (!DeleteTuple(rid, txn) || !InsertTuple(new_tuple, &new_rid, txn)) {
 				return false;
 			}
+			new_tuple.SetRID(new_rid);
+			return true;
+		}
 
-			if (page->GetHeader()->page_type != PageType::TABLE_PAGE) {
-				delete existing_tuple;
+		{
+			buffer::PageGuard guard = bpm_->FetchPageWrite(rid.page_id);
+			if (!guard || !IsDataPage(*guard.GetPage())) {
 				return false;
 			}
 
-			SlotDirectory* slot = page->GetSlotDirectory(rid.slot_id);
+			SlotDirectory* slot = guard->GetSlotDirectory(rid.slot_id);
 			if (slot == nullptr || !slot->is_live) {
-				delete existing_tuple;
 				return false;
 			}
 
-			memcpy(page->GetData() + slot->tuple_offset, new_tuple.GetData(), new_tuple.GetSize());
-			bpm_->SetDirtyPage(page->GetPageId(), true);
-			existing_tuple->SetRID(rid);
-			delete existing_tuple;
-			return true;
-		} else {
-			RID new_rid;
-			bool inserted = InsertTuple(new_tuple, &new_rid);
-			if (!inserted) {
-				delete existing_tuple;
-				return false;
+			if (slot->tuple_length == new_tuple.GetSize()) {
+				recovery::LogRecord record(rid, guard->ReadTuple(rid.slot_id, rid), new_tuple);
+				guard->WriteTuple(rid.slot_id, new_tuple.GetData());
+				if (zone_map_ != nullptr) {
+					zone_map_->Widen(rid.page_id, new_tuple.GetData());
+				}
+				LogChange(guard.GetPage(), txn, &record);
+				guard.MarkDirty();
+				new_tuple.SetRID(rid);
+				return true;
 			}
 
-			bool deleted = DeleteTuple(rid);
-			if (!deleted) {
-				delete existing_tuple;
-				return false;
+			// the old bytes become dead space and the new tuple goes into the same slot, if the page
+			// has room for it once compacted
+			if (!guard->IsColumnar() && new_tuple.GetSize() <= guard->GetFreeSpace() + slot->tuple_length) {
+				recovery::LogRecord record(recovery::LogRecordType::DELETE, rid, guard->ReadTuple(rid.slot_id, rid));
+				guard->KillSlot(slot);
+				LogChange(guard.GetPage(), txn, &record);
+
+				RID new_rid;
+				return PlaceTuple(&guard, new_tuple, rid.slot_id, &new_rid, txn);
 			}
+		}
 
-			new_tuple.SetRID(new_rid);
-			delete existing_tuple;
-			return true;
+		RID new_rid;
+		if (!InsertTuple(new_tuple, &new_rid, txn)) {
+			return false;
+		}
+
+		if (!DeleteTuple(rid, txn)) {
+			return false;
+		}
+
+		new_tuple.SetRID(new_rid);
+		return true;
+	}
+
+	void TableHeap::LogChange(Page* page, concurrency::Transaction* txn, recovery::LogRecord* record) {
+		recovery::LogManager* log_manager = bpm_->GetLogManager();
+		if (log_manager != nullptr) {
+			page->SetLSN(log_manager->AppendLogRecord(txn, record));
+		}
+
+		if (txn != nullptr && record->IsPageChange()) {
+			txn->AddWriteRecord(*record);
+			if (record->GetType() == recovery::LogRecordType::DELETE) {
+				txn->AddDeletedFrom(first_page_id_);
+			}
 		}
 	}
 
-	Tuple* TableHeap::GetTuple(const RID& rid) {
+	Tuple* TableHeap::GetTuple(const RID& rid, const concurrency::Transaction* txn) {
 		page_id_t page_id = rid.page_id;
 		slot_id_t slot_id = rid.slot_id;
 
-		Page* page = bpm_->FetchPage(page_id);
-		if (page == nullptr || slot_id >= page->GetHeader()->num_slots) {
+		buffer::PageGuard guard = bpm_->FetchPageRead(page_id);
+		if (!guard || slot_id >= guard->GetHeader()->num_slots) {
 			return nullptr;
 		}
 
-		if (page->GetHeader()->page_type != PageType::TABLE_PAGE) {
+		if (!IsDataPage(*guard.GetPage())) {
 			return nullptr;
 		}
 
-		SlotDirectory* slot = page->GetSlotDirectory(slot_id);
-		if (slot == nullptr || !slot->is_live) {
+		SlotDirectory* slot = guard->GetSlotDirectory(slot_id);
+		if (slot == nullptr || !IsVisible(*slot, txn)) {
 			return nullptr;
 		}
 
-		char* data = page->GetData() + slot->tuple_offset;
-		if (data == nullptr) {
-			return nullptr;
+		Tuple* tuple = new Tuple(guard->ReadTuple(slot_id, rid));
+
+		return tuple;
+	}
+
+	std::vector<page_id_t> TableHeap::GetPageIds() {
+		std::vector<page_id_t> page_ids;
+		page_id_t curr_page_id = first_page_id_;
+
+		while (curr_page_id != INVALID_PAGE_ID) {
+			buffer::PageGuard guard = bpm_->FetchPageRead(curr_page_id);
+			if (!guard) {
+				break;
+			}
+			page_ids.push_back(curr_page_id);
+			curr_page_id = guard->GetHeader()->next_page_id;
 		}
 
-		Tuple* tuple = new Tuple(data, rid);
+		return page_ids;
+	}
 
-		return tuple;
+	size_t TableHeap::CollectGarbage(txn_id_t horizon, size_t* pending, std::vector<page_id_t>* unlinked) {
+		size_t reclaimed = 0;
+		size_t remaining = 0;
+
+		// the page before guard that stays in the chain; latches are taken in chain order like InsertTuple
+		buffer::PageGuard prev;
+		buffer::PageGuard guard = bpm_->FetchPageWrite(first_page_id_);
+
+		while (guard) {
+			// logged as physical deletes: an insert may reuse the slot, its redo needs the slot dead
+			for (slot_id_t slot_id = 0; slot_id < guard->GetHeader()->num_slots; ++slot_id) {
+				SlotDirectory* slot = guard->GetSlotDirectory(slot_id);
+				if (slot == nullptr || !slot->is_live || slot->xmax == INVALID_TXN_ID) {
+					continue;
+				}
+				if (slot->xmax < horizon) {
+					RID rid(guard.GetPageId(), slot_id);
+					recovery::LogRecord record(recovery::LogRecordType::DELETE, rid, guard->ReadTuple(slot_id, rid));
+					guard->KillSlot(slot);
+					LogChange(guard.GetPage(), nullptr, &record);
+					guard.MarkDirty();
+					reclaimed++;
+				} else {
+					remaining++;
+				}
+			}
+
+			page_id_t next_page_id = guard->GetHeader()->next_page_id;
+			buffer::PageGuard next;
+			if (next_page_id != INVALID_PAGE_ID) {
+				next = bpm_->FetchPageWrite(next_page_id);
+			}
+
+			// an empty page past the first is taken out of the chain, its own links stay intact for
+			// scans that already read the link to it
+			if (unlinked != nullptr && prev && !guard->HasLiveSlot()) {
+				prev->GetHeader()->next_page_id = next_page_id;
+				recovery::LogRecord record(guard.GetPageId(), prev.GetPageId(), next_page_id);
+				LogChange(prev.GetPage(), nullptr, &record);
+				prev.MarkDirty();
+				if (next) {
+					next->GetHeader()->prev_page_id = prev.GetPageId();
+					next->SetLSN(prev->GetLSN());
+					next.MarkDirty();
+				}
+				unlinked->push_back(guard.GetPageId());
+			} else {
+				prev = std::move(guard);
+			}
+			guard = std::move(next);
+		}
+
+		if (pending != nullptr) {
+			*pending = remaining;
+		}
+		return reclaimed;
 	}
 
-	TableHeap::Iterator TableHeap::begin() {
-		Page* page = bpm_->FetchPage(first_page_id_);
-		if (page == nullptr) {
-			return Iterator(this, RID());
+	size_t TableHeap::MergePages(concurrency::Transaction* txn) {
+		if (txn == nullptr) {
+			throw std::runtime_error("Table error: Merging pages needs a transaction");
+		}
+		if (txn->GetLockManager() != nullptr && first_page_id_ != INVALID_PAGE_ID) {
+			txn->GetLockManager()->LockTable(txn, concurrency::LockMode::INTENTION_EXCLUSIVE, first_page_id_);
 		}
 
-		// first slot in page
-		slot_id_t first_slot_id = 0;
-		RID first_rid(first_page_id_, first_slot_id);
-		SlotDirectory* first_slot = page->GetSlotDirectory(first_slot_id);
+		std::vector<page_id_t> page_ids = GetPageIds();
+		std::vector<uint32_t> room(page_ids.size(), 0);
+		for (size_t i = 0; i < page_ids.size(); i++) {
+			buffer::PageGuard guard = bpm_->FetchPageRead(page_ids[i]);
+			if (guard) {
+				room[i] = guard->GetFreeSpace();
+			}
+		}
 
-		if (first_slot == nullptr || !first_slot->is_live) {
-			// find next best slot
-			while (first_slot_id < page->GetHeader()->num_slots) {
-				first_slot = page->GetSlotDirectory(first_slot_id);
-				if (first_slot != nullptr && first_slot->is_live) {
-					break;
+		size_t moved = 0;
+		size_t target = 0; // earlier pages are full
+		size_t source = page_ids.size();
+		while (source > target + 1) {
+			source--;
+
+			// a page with a version some other transaction is still writing cannot be emptied
+			std::vector<Tuple> tuples;
+			uint32_t required = 0;
+			bool movable = true;
+			{
+				buffer::PageGuard guard = bpm_->FetchPageRead(page_ids[source]);
+				if (!guard) {
+					continue;
+				}
+				for (slot_id_t slot_id = 0; slot_id < guard->GetHeader()->num_slots && movable; ++slot_id) {
+					SlotDirectory* slot = guard->GetSlotDirectory(slot_id);
+					if (!slot->is_live || (slot->xmax != INVALID_TXN_ID && txn->Sees(slot->xmax))) {
+						continue; // dead, or deleted and left to the garbage collector
+					}
+					movable = slot->xmax == INVALID_TXN_ID && IsVisible(*slot, txn);
+					if (movable) {
+						tuples.push_back(guard->ReadTuple(slot_id, RID(page_ids[source], slot_id)));
+						required += slot->tuple_length + sizeof(SlotDirectory);
+					}
 				}
-				first_slot_id++;
 			}
-			if (first_slot_id >= page->GetHeader()->num_slots) {
-				return Iterator(this, RID());
+			if (!movable || tuples.empty()) {
+				continue;
 			}
-			first_rid.slot_id = first_slot_id;
+
+			uint32_t available = 0;
+			for (size_t i = target; i < source; i++) {
+				available += room[i];
+			}
+			if (required > available) {
+				break; // the rest of the heap is dense enough
+			}
+
+			for (Tuple& tuple : tuples) {
+				// deleted first, the row lock guarantees nobody changed it since it was read
+				if (!DeleteTuple(tuple.GetRID(), txn)) {
+					continue;
+				}
+
+				RID new_rid;
+				bool placed = false;
+				while (!placed && target < source) {
+					buffer::PageGuard guard = bpm_->FetchPageWrite(page_ids[target]);
+					if (guard && guard->HasRoomFor(tuple.GetSize())) {
+						placed = PlaceTuple(&guard, tuple, guard->FindFreeSlot(), &new_rid, txn);
+					}
+					if (placed) {
+						room[target] -= std::min<uint32_t>(room[target], tuple.GetSize() + sizeof(SlotDirectory));
+					} else {
+						target++;
+					}
+				}
+
+				// the earlier pages filled up after all, the tuple goes wherever it fits
+				if (!placed && !InsertTuple(tuple, &new_rid, txn)) {
+					throw std::runtime_error("Table error: Failed to move tuple (" + std::to_string(tuple.GetRID().page_id) + ", "
+					    + std::to_string(tuple.GetRID().slot_id) + ")");
+				}
+				moved++;
+			}
+		}
+
+		return moved;
+	}
+
+	bool TableHeap::SeekVisible(RID* rid, const concurrency::Transaction* txn, Tuple* tuple) {
+		page_id_t page_id = rid->page_id;
+		slot_id_t slot_id = rid->slot_id;
+
+		// empty pages are skipped, not treated as the end of the heap
+		while (page_id != INVALID_PAGE_ID) {
+			buffer::PageGuard guard = bpm_->FetchPageRead(page_id);
+			if (!guard) {
+				break;
+			}
+
+			Page* page = guard.GetPage();
+			for (; slot_id < page->GetHeader()->num_slots; ++slot_id) {
+				SlotDirectory* slot = page->GetSlotDirectory(slot_id);
+				if (slot != nullptr && IsVisible(*slot, txn)) {
+					*rid = RID(page_id, slot_id);
+					*tuple = page->ReadTuple(slot_id, *rid);
+					return true;
+				}
+			}
+
+			page_id = page->GetHeader()->next_page_id;
+			slot_id = 0;
 		}
 
-		return Iterator(this, first_rid);
+		*rid = RID();
+		return false;
+	}
+
+	TableHeap::Iterator TableHeap::begin(const concurrency::Transaction* txn) {
+		if (first_page_id_ == INVALID_PAGE_ID) {
+			return end();
+		}
+		return Iterator(this, RID(first_page_id_, 0), txn);
 	}
 
 	TableHeap::Iterator TableHeap::end() {
@@ -299,59 +524,12 @@ namespace table {
 	}
 
 	TableHeap::Iterator& TableHeap::Iterator::operator++() {
-		// Move to next valid tuple
-		slot_id_t next_slot_id = current_rid_.slot_id + 1;
-		page_id_t current_page_id = current_rid_.page_id;
-
-		Page* page = table_heap_->bpm_->FetchPage(current_page_id);
-		if (page == nullptr) {
-			current_rid_ = RID(); // Invalid RID to indicate end
+		// Move to next visible tuple, possibly on a later page
+		if (current_rid_.page_id == INVALID_PAGE_ID) {
 			return *this;
 		}
-
-		// Look for next valid slot in current page
-		while (next_slot_id < page->GetHeader()->num_slots) {
-			SlotDirectory* slot = page->GetSlotDirectory(next_slot_id);
-			if (slot != nullptr && slot->is_live) {
-				current_rid_.slot_id = next_slot_id;
-
-				// Update current_tuple_
-				Tuple* tuple = table_heap_->GetTuple(current_rid_);
-				if (tuple != nullptr) {
-					current_tuple_ = *tuple;
-					delete tuple;
-				}
-				return *this;
-			}
-			next_slot_id++;
-		}
-
-		// No more valid slots in current page, try next page
-		page_id_t next_page_id = page->GetHeader()->next_page_id;
-		if (next_page_id != INVALID_PAGE_ID) {
-			Page* next_page = table_heap_->bpm_->FetchPage(next_page_id);
-			if (next_page != nullptr) {
-				// Look for first valid slot in next page
-				for (slot_id_t slot_id = 0; slot_id < next_page->GetHeader()->num_slots; ++slot_id) {
-					SlotDirectory* slot = next_page->GetSlotDirectory(slot_id);
-					if (slot != nullptr && slot->is_live) {
-						current_rid_.page_id = next_page_id;
-						current_rid_.slot_id = slot_id;
-
-						// Update current_tuple_
-						Tuple* tuple = table_heap_->GetTuple(current_rid_);
-						if (tuple != nullptr) {
-							current_tuple_ = *tuple;
-							delete tuple;
-						}
-						return *this;
-					}
-				}
-			}
-		}
-
-		// No more valid tuples
-		current_rid_ = RID(); // Invalid RID to indicate end
+		current_rid_.slot_id++;
+		table_heap_->SeekVisible(&current_rid_, txn_, &current_tuple_);
 		return *this;
 	}
 
@@ -21,6 +21,35 @@
  * To Find a tuple in table heap, we need to use the RID (Record ID) of the tuple.
  * The RID is a unique identifier for a tuple in the table heap, which consists of the page ID and the slot ID.
  *
+ * Every change is logged (when the buffer pool has a LogManager) while the page is still write-latched,
+ * and the page is stamped with the record's LSN. Pages are no longer forced to disk per change,
+ * durability comes from the transaction's commit record being flushed.
+ *
+ * Versions (MVCC)
+ * Each slot carries xmin (the inserting transaction) and xmax (the deleting one).
+ * Inside a transaction a delete only sets xmax and an update deletes the old version and inserts
+ * a new one, so readers with an older snapshot keep seeing the old version without any lock.
+ * Reads and iteration with a transaction only return versions visible to its snapshot.
+ * Without a transaction (catalog, recovery) changes are applied in place as before.
+ * Versions whose xmax is older than every snapshot are reclaimed by CollectGarbage.
+ *
+ * Space
+ * Slots of removed tuples are reused by later inserts, and a page whose free space is fragmented
+ * is compacted in place before an insert (see Page). CollectGarbage also takes pages left without
+ * a live tuple out of the chain, and MergePages (VACUUM <table>) moves the tuples of sparse pages at
+ * the end of the heap into earlier pages, so a scan reads pages in proportion to the live data.
+ *
+ * Columnar tables
+ * A table created WITH (format = columnar) starts with a columnar page (see Page), and every page
+ * appended to its chain copies that page's layout. Tuples go in and come out in the row format,
+ * the pages split and gather them, so nothing above the heap depends on the layout except the
+ * parallel scan, which reads the minipages in place.
+ *
+ * Zone maps
+ * A heap given the table's ZoneMap widens the zone of a page with every row it writes there, and
+ * gives a page it appends an empty zone. Writers of a table should all pass it, a scan that skips
+ * pages by their zones relies on it.
+ *
  */
 
 #pragma once
@@ -28,8 +57,11 @@
 #include "buffer/buffer_pool.h"
 #include "catalog/schema.h"
 #include "common/types.h"
+#include "concurrency/transaction.h"
+#include "recovery/log_record.h"
 #include "storage/page.h"
 #include "storage/tuple.h"
+#include "table/zone_map.h"
 
 namespace venus {
 namespace table {
@@ -38,44 +70,81 @@ namespace table {
 		// If this is a new table, then a page is initialized
 		// TableHeap containes a pointer to the first page of the table used to access the entire table in a database
 
-		TableHeap(buffer::BufferPoolManager* bpm, const Schema* schema, page_id_t first_page_id)
+		// zone_map: the table's (see ZoneMap), kept up to date by every write through the heap
+		TableHeap(buffer::BufferPoolManager* bpm, const Schema* schema, page_id_t first_page_id, ZoneMap* zone_map = nullptr)
 		    : bpm_(bpm)
 		    , schema_(schema)
-		    , first_page_id_(first_page_id) { }
+		    , first_page_id_(first_page_id)
+		    , zone_map_(zone_map) { }
 
 		~TableHeap() = default;
 
-		bool InsertTuple(const Tuple& tuple, RID* rid);
+		bool InsertTuple(const Tuple& tuple, RID* rid, concurrency::Transaction* txn = nullptr);
 
-		bool InsertTuple(const std::vector<std::string>& values);
+		// nulls: the columns that are NULL, their values are ignored; empty if there are none
+		bool InsertTuple(const std::vector<std::string>& values, concurrency::Transaction* txn = nullptr,
+		    const std::vector<bool>& nulls = {});
 
 		// It marks the tuple as deleted -> basically unpins so lru can replace it later with needed and slot.is_live to false
-		// Actual deletion happens in a seperate process on a background thread
-		bool DeleteTuple(const RID& rid);
+		// With a transaction only xmax is set, the version is removed by the garbage collector later
+		// Throws if a concurrent transaction already deleted the version (write-write conflict)
+		bool DeleteTuple(const RID& rid, concurrency::Transaction* txn = nullptr);
 
 		// If the sizes are same, it just copies the data from new_tuple to the page
-		// If the sizes are different, it deletes the old tuple and inserts the new one ensuring the RID is same
-		bool UpdateTuple(const Tuple& new_tuple, const RID& rid);
+		// If the sizes are different, the new tuple replaces the old one in its slot when the page has room,
+		// else it is inserted elsewhere and new_tuple gets its RID
+		// With a transaction it always writes a new version, new_tuple gets its RID
+		bool UpdateTuple(const Tuple& new_tuple, const RID& rid, concurrency::Transaction* txn = nullptr);
 
 		// tuple is passed by reference, so it is not owned by the caller
-		Tuple* GetTuple(const RID& rid);
+		// nullptr if the version is not visible to txn
+		Tuple* GetTuple(const RID& rid, const concurrency::Transaction* txn = nullptr);
+
+		// a page holding rows, in the row or the columnar layout
+		static bool IsDataPage(const Page& page) {
+			return page.GetPageType() == PageType::TABLE_PAGE || page.GetPageType() == PageType::COLUMNAR_PAGE;
+		}
+
+		// without a transaction every current version (xmax not set) is visible
+		static bool IsVisible(const SlotDirectory& slot, const concurrency::Transaction* txn) {
+			if (!slot.is_live) {
+				return false;
+			}
+			if (txn == nullptr) {
+				return slot.xmax == INVALID_TXN_ID;
+			}
+			return txn->Sees(slot.xmin) && !(slot.xmax != INVALID_TXN_ID && txn->Sees(slot.xmax));
+		}
+
+		// removes versions deleted by transactions below horizon, returns how many
+		// pending counts deleted versions that some snapshot may still see
+		// with unlinked, pages without a live version (but the first) are taken out of the chain and
+		// added to it; the caller frees them once no scan can still be on them
+		size_t CollectGarbage(txn_id_t horizon, size_t* pending = nullptr, std::vector<page_id_t>* unlinked = nullptr);
+
+		// moves the tuples of sparse pages at the end of the chain into the free space of earlier pages,
+		// as new versions written by txn; the emptied pages are unlinked by the garbage collector once
+		// no snapshot sees the old versions. Returns the number of tuples moved
+		size_t MergePages(concurrency::Transaction* txn);
 
 		const Schema* GetSchema() const {
 			return schema_;
 		}
 
+		// page ids of the heap in chain order, used to split a scan into morsels
+		std::vector<page_id_t> GetPageIds();
+
 		// for sequential scans
 		class Iterator {
 		public:
-			Iterator(TableHeap* table_heap, RID rid)
+			// positions on the first version at or after rid visible to txn
+			Iterator(TableHeap* table_heap, RID rid, const concurrency::Transaction* txn = nullptr)
 			    : table_heap_(table_heap)
+			    , txn_(txn)
 			    , current_rid_(rid) {
 
-				Tuple* tuple = table_heap_->GetTuple(current_rid_);
-				if (tuple != nullptr) {
-					current_rid_ = tuple->GetRID();
-					current_tuple_ = *tuple;
-					delete tuple;
+				if (current_rid_.page_id != INVALID_PAGE_ID) {
+					table_heap_->SeekVisible(&current_rid_, txn_, &current_tuple_);
 				}
 			};
 
@@ -91,17 +160,29 @@ namespace table {
 
 		private:
 			TableHeap* table_heap_;
+			const concurrency::Transaction* txn_;
 			RID current_rid_;
 			Tuple current_tuple_;
 		};
 
-		Iterator begin(); // Returns an iterator pointing to the first tuple in the table
+		Iterator begin(const concurrency::Transaction* txn = nullptr); // Returns an iterator pointing to the first tuple in the table
 		Iterator end(); // Returns an iterator pointing to the end of the table (after the last tuple)
 
 	private:
 		buffer::BufferPoolManager* bpm_;
 		const Schema* schema_;
 		page_id_t first_page_id_; // to uniquely identify the table heap
+		ZoneMap* zone_map_; // may be null
+
+		// appends a log record for a change to a write-latched page and stamps the page with its LSN
+		// also keeps the change in the transaction's write set for rollback
+		void LogChange(Page* page, concurrency::Transaction* txn, recovery::LogRecord* record);
+
+		// writes tuple into slot_id (dead or new) of a write-latched page and logs it, false if it does not fit
+		bool PlaceTuple(buffer::PageGuard* guard, const Tuple& tuple, slot_id_t slot_id, RID* rid, concurrency::Transaction* txn);
+
+		// moves rid to the first version at or after it visible to txn, RID() at the end of the heap
+		bool SeekVisible(RID* rid, const concurrency::Transaction* txn, Tuple* tuple);
 
 		DISALLOW_COPY_AND_MOVE(TableHeap);
 	};
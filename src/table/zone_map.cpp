@@ -0,0 +1,211 @@
+// /src/table/zone_map.cpp
+
+#include "table/zone_map.h"
+
+#include <cstring>
+#include <mutex>
+
+namespace venus {
+namespace table {
+
+	namespace {
+
+		template <typename T>
+		int CompareAs(const char* lhs, const char* rhs) {
+			T a;
+			T b;
+			std::memcpy(&a, lhs, sizeof(T));
+			std::memcpy(&b, rhs, sizeof(T));
+			return a < b ? -1 : (b < a ? 1 : 0);
+		}
+
+		// the order the predicates compare values in
+		int CompareField(ColumnType type, const char* lhs, const char* rhs) {
+			switch (type) {
+			case ColumnType::INT:
+			case ColumnType::DATE:
+				return CompareAs<int32_t>(lhs, rhs);
+			case ColumnType::FLOAT:
+				return CompareAs<float>(lhs, rhs);
+			case ColumnType::BIGINT:
+			case ColumnType::TIMESTAMP:
+				return CompareAs<int64_t>(lhs, rhs);
+			case ColumnType::DOUBLE:
+				return CompareAs<double>(lhs, rhs);
+			default:
+				return std::strncmp(lhs, rhs, MAX_CHAR_LENGTH);
+			}
+		}
+
+		// 64-bit FNV-1a, then mixed so both halves are usable as hashes
+		uint64_t HashBytes(const char* data, size_t length) {
+			uint64_t hash = 14695981039346656037ULL;
+			for (size_t i = 0; i < length; i++) {
+				hash ^= static_cast<uint8_t>(data[i]);
+				hash *= 1099511628211ULL;
+			}
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdULL;
+			hash ^= hash >> 33;
+			return hash;
+		}
+
+		// bit i of a value's BLOOM_FILTER_HASHES, by double hashing
+		uint32_t BloomBit(uint64_t hash, uint32_t i) {
+			uint32_t h1 = static_cast<uint32_t>(hash);
+			uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+			return (h1 + i * h2) & (BLOOM_FILTER_BITS - 1);
+		}
+
+	} // namespace
+
+	ZoneMap::ZoneMap(const Schema& schema)
+	    : num_bloom_filters_(0)
+	    , null_bitmap_offset_(schema.GetNullBitmapOffset()) {
+		for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+			const Column& column = schema.GetColumn(i);
+			columns_.push_back({ column.GetType(), schema.GetOffset(i), static_cast<uint32_t>(column.GetLength()) });
+			bloom_filters_.push_back(column.HasBloomFilter() && !column.IsVariableLength() ? num_bloom_filters_++ : NO_BLOOM_FILTER);
+		}
+	}
+
+	uint64_t ZoneMap::HashValue(ColumnType type, const char* value) {
+		switch (type) {
+		case ColumnType::INT:
+		case ColumnType::DATE:
+			return HashBytes(value, sizeof(int32_t));
+		case ColumnType::BIGINT:
+		case ColumnType::TIMESTAMP:
+			return HashBytes(value, sizeof(int64_t));
+		case ColumnType::FLOAT: {
+			// -0.0 + 0.0 is 0.0, the two are equal
+			float number;
+			std::memcpy(&number, value, sizeof(number));
+			number += 0.0f;
+			return HashBytes(reinterpret_cast<const char*>(&number), sizeof(number));
+		}
+		case ColumnType::DOUBLE: {
+			double number;
+			std::memcpy(&number, value, sizeof(number));
+			number += 0.0;
+			return HashBytes(reinterpret_cast<const char*>(&number), sizeof(number));
+		}
+		default:
+			// CHAR, compared up to the first NUL
+			return HashBytes(value, strnlen(value, MAX_CHAR_LENGTH));
+		}
+	}
+
+	ZoneMap::PageZone ZoneMap::EmptyZone() const {
+		PageZone zone;
+		zone.columns.resize(columns_.size());
+		zone.bloom_filters.resize(static_cast<size_t>(num_bloom_filters_) * BLOOM_FILTER_WORDS);
+		return zone;
+	}
+
+	void ZoneMap::Reset(page_id_t page_id) {
+		std::unique_lock<std::shared_mutex> lock(latch_);
+		zones_[page_id] = EmptyZone();
+	}
+
+	void ZoneMap::Widen(page_id_t page_id, const char* row) {
+		std::unique_lock<std::shared_mutex> lock(latch_);
+		auto it = zones_.find(page_id);
+		if (it != zones_.end()) {
+			WidenZone(&it->second, row);
+		}
+	}
+
+	void ZoneMap::Record(page_id_t page_id, Page* page) {
+		PageZone zone = EmptyZone();
+		for (slot_id_t slot_id = 0; slot_id < page->GetHeader()->num_slots; slot_id++) {
+			SlotDirectory* slot = page->GetSlotDirectory(slot_id);
+			if (slot == nullptr || !slot->is_live) {
+				continue;
+			}
+			if (page->IsColumnar()) {
+				WidenZone(&zone, page->ReadTuple(slot_id, RID()).GetData());
+			} else {
+				WidenZone(&zone, page->GetData() + slot->tuple_offset);
+			}
+		}
+
+		std::unique_lock<std::shared_mutex> lock(latch_);
+		zones_[page_id] = std::move(zone);
+	}
+
+	bool ZoneMap::GetZone(page_id_t page_id, uint32_t column, ColumnZone* zone) const {
+		if (column >= columns_.size() || columns_[column].type == ColumnType::VARCHAR) {
+			return false;
+		}
+		std::shared_lock<std::shared_mutex> lock(latch_);
+		auto it = zones_.find(page_id);
+		if (it == zones_.end()) {
+			return false;
+		}
+		*zone = it->second.columns[column];
+		return true;
+	}
+
+	bool ZoneMap::MayContain(page_id_t page_id, uint32_t column, uint64_t hash) const {
+		if (column >= columns_.size() || bloom_filters_[column] == NO_BLOOM_FILTER) {
+			return true;
+		}
+		std::shared_lock<std::shared_mutex> lock(latch_);
+		auto it = zones_.find(page_id);
+		if (it == zones_.end()) {
+			return true;
+		}
+		const uint64_t* filter = it->second.bloom_filters.data() + bloom_filters_[column] * BLOOM_FILTER_WORDS;
+		for (uint32_t i = 0; i < BLOOM_FILTER_HASHES; i++) {
+			uint32_t bit = BloomBit(hash, i);
+			if ((filter[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ZoneMap::HasZone(page_id_t page_id) const {
+		std::shared_lock<std::shared_mutex> lock(latch_);
+		return zones_.count(page_id) > 0;
+	}
+
+	void ZoneMap::WidenZone(PageZone* page_zone, const char* row) const {
+		for (uint32_t i = 0; i < columns_.size(); i++) {
+			const ColumnInfo& column = columns_[i];
+			ColumnZone& zone = page_zone->columns[i];
+			if (column.type == ColumnType::VARCHAR) {
+				continue;
+			}
+			if (Tuple::IsNull(row, null_bitmap_offset_, i)) {
+				zone.has_nulls = true;
+				continue;
+			}
+
+			const char* value = row + column.offset;
+			if (bloom_filters_[i] != NO_BLOOM_FILTER) {
+				uint64_t* filter = page_zone->bloom_filters.data() + bloom_filters_[i] * BLOOM_FILTER_WORDS;
+				uint64_t hash = HashValue(column.type, value);
+				for (uint32_t j = 0; j < BLOOM_FILTER_HASHES; j++) {
+					uint32_t bit = BloomBit(hash, j);
+					filter[bit / 64] |= uint64_t(1) << (bit % 64);
+				}
+			}
+			if (!zone.has_values) {
+				std::memcpy(zone.min, value, column.length);
+				std::memcpy(zone.max, value, column.length);
+				zone.has_values = true;
+				continue;
+			}
+			if (CompareField(column.type, value, zone.min) < 0) {
+				std::memcpy(zone.min, value, column.length);
+			}
+			if (CompareField(column.type, value, zone.max) > 0) {
+				std::memcpy(zone.max, value, column.length);
+			}
+		}
+	}
+
+} // namespace table
+} // namespace venus
@@ -0,0 +1,100 @@
+// /src/table/zone_map.h
+
+/**
+ * ZoneMap keeps, for every page of a table, the smallest and largest value of each fixed width
+ * column and whether it has NULLs. A filtered scan checks the zone of a page before fetching it and
+ * skips the page when no value in the range can match.
+ *
+ * Zones live next to the table, in memory, and are never narrowed: an insert or an update widens
+ * the zone of its page, a delete leaves it as it is. So a zone may be wider than the page's rows
+ * but never misses one, whatever the versions' visibility. A page without a zone (the heap was
+ * loaded from disk, or the page was written before the zone map existed) is always scanned, and
+ * the scan records its zone on the way.
+ *
+ * A zone is written under its page's latch (exclusive to widen, shared to record one from the rows),
+ * so recording a page cannot miss a row being inserted into it.
+ * VARCHAR columns have no zone.
+ *
+ * Bloom filters
+ * Columns created with a Bloom filter (WITH (bloom_filter = <column>)) also get BLOOM_FILTER_BITS
+ * bits per page in the zone, BLOOM_FILTER_HASHES set for every value. A point lookup skips a page
+ * whose filter does not have all of its value's bits, which a min/max range cannot do for values
+ * that are not clustered. Values are hashed by HashValue, the same way for rows and literals.
+ */
+
+#pragma once
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/types.h"
+#include "storage/page.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace venus {
+namespace table {
+
+	struct ColumnZone {
+		bool has_values = false; // a value that is not NULL, min and max are set
+		bool has_nulls = false;
+		char min[MAX_CHAR_LENGTH];
+		char max[MAX_CHAR_LENGTH];
+	};
+
+	class ZoneMap {
+	public:
+		explicit ZoneMap(const Schema& schema);
+
+		// page_id was just added to the heap and has no rows; under its exclusive latch
+		void Reset(page_id_t page_id);
+
+		// a row written to page_id, no-op while the page has no zone; under its exclusive latch
+		void Widen(page_id_t page_id, const char* row);
+
+		// the zone of page_id from every live slot of page; under its shared latch at least
+		void Record(page_id_t page_id, Page* page);
+
+		// false if page_id has no zone yet, or column has none
+		bool GetZone(page_id_t page_id, uint32_t column, ColumnZone* zone) const;
+
+		bool HasZone(page_id_t page_id) const;
+
+		// false if the Bloom filter of column on page_id rules the value out; true without a filter
+		bool MayContain(page_id_t page_id, uint32_t column, uint64_t hash) const;
+
+		// hash of a value of a fixed width column, equal values (per the predicates) hash alike
+		static uint64_t HashValue(ColumnType type, const char* value);
+
+	private:
+		struct ColumnInfo {
+			ColumnType type;
+			uint32_t offset;
+			uint32_t length;
+		};
+
+		struct PageZone {
+			std::vector<ColumnZone> columns;
+			std::vector<uint64_t> bloom_filters; // BLOOM_FILTER_BITS for every column that has one
+		};
+
+		static constexpr uint32_t BLOOM_FILTER_WORDS = BLOOM_FILTER_BITS / 64;
+		static constexpr int32_t NO_BLOOM_FILTER = -1;
+
+		std::vector<ColumnInfo> columns_;
+		std::vector<int32_t> bloom_filters_; // column -> its filter in PageZone::bloom_filters
+		int32_t num_bloom_filters_;
+		uint32_t null_bitmap_offset_;
+
+		mutable std::shared_mutex latch_; // protects zones_
+		std::unordered_map<page_id_t, PageZone> zones_;
+
+		PageZone EmptyZone() const;
+		void WidenZone(PageZone* zone, const char* row) const;
+
+		DISALLOW_COPY_AND_MOVE(ZoneMap);
+	};
+
+} // namespace table
+} // namespace venus
@@ -1,11 +1,37 @@
 // /tests/test_suite.cpp
 
 #include "test_suite.h"
+#include "buffer/buffer_pool.h"
 #include "database/database_manager.h"
 #include "engine/execution_engine.h"
+#include "network/client.h"
+#include "network/protocol.h"
+#include "catalog/schema.h"
+#include "catalog/value.h"
+#include "common/arena.h"
+#include "concurrency/garbage_collector.h"
+#include "concurrency/lock_manager.h"
+#include "executor/tuple_accessor.h"
+#include "recovery/checkpoint_manager.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_recovery.h"
+#include "table/table_heap.h"
 
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <netinet/in.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
 
 using namespace venus::database;
 using namespace venus::engine;
@@ -13,6 +39,99 @@ using namespace venus::engine;
 namespace venus {
 namespace tests {
 
+	namespace {
+
+		// ids of the live rows of a (id INT, name CHAR) heap, in scan order, as txn sees them
+		std::vector<int> ReadIds(venus::table::TableHeap& heap, const Schema& schema, const venus::concurrency::Transaction* txn = nullptr) {
+			std::vector<int> ids;
+			for (auto it = heap.begin(txn); it != heap.end(); ++it) {
+				ids.push_back(*reinterpret_cast<const int*>(it->GetValue(0, &schema)));
+			}
+			return ids;
+		}
+
+		// what is on disk at this moment, as if the process died here
+		void CopyCrashImage(const std::string& from, const std::string& to) {
+			std::filesystem::copy_file(from + ".db", to + ".db", std::filesystem::copy_options::overwrite_existing);
+			std::filesystem::copy_file(from + ".log", to + ".log", std::filesystem::copy_options::overwrite_existing);
+		}
+
+		void RemoveDatabaseFiles(const std::string& path) {
+			std::remove((path + ".db").c_str());
+			std::remove((path + ".log").c_str());
+		}
+
+		// a minimal PostgreSQL v3 frontend, messages are written and read raw
+		struct PgMessage {
+			char type;
+			std::string body;
+		};
+
+		void PgPut16(std::string* out, uint16_t value) {
+			out->push_back(static_cast<char>(value >> 8));
+			out->push_back(static_cast<char>(value));
+		}
+
+		void PgPut32(std::string* out, uint32_t value) {
+			PgPut16(out, static_cast<uint16_t>(value >> 16));
+			PgPut16(out, static_cast<uint16_t>(value));
+		}
+
+		uint32_t PgGet32(const std::string& data, size_t pos) {
+			const auto* bytes = reinterpret_cast<const unsigned char*>(data.data() + pos);
+			return (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+		}
+
+		std::string PgCString(const std::string& value) {
+			return value + '\0';
+		}
+
+		std::string PgFrame(char type, const std::string& body) {
+			std::string frame(1, type);
+			PgPut32(&frame, static_cast<uint32_t>(body.size() + 4));
+			return frame + body;
+		}
+
+		void PgSend(int fd, const std::string& bytes) {
+			if (send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(bytes.size())) {
+				throw std::runtime_error("send failed");
+			}
+		}
+
+		void PgRecvExact(int fd, char* data, size_t size) {
+			while (size > 0) {
+				ssize_t n = recv(fd, data, size, 0);
+				if (n <= 0) {
+					throw std::runtime_error("connection closed");
+				}
+				data += n;
+				size -= static_cast<size_t>(n);
+			}
+		}
+
+		// messages up to and including ReadyForQuery
+		std::vector<PgMessage> PgReadUntilReady(int fd) {
+			std::vector<PgMessage> messages;
+			while (messages.empty() || messages.back().type != 'Z') {
+				char header[5];
+				PgRecvExact(fd, header, sizeof(header));
+				PgMessage message { header[0], std::string(PgGet32(std::string(header + 1, 4), 0) - 4, '\0') };
+				PgRecvExact(fd, message.body.data(), message.body.size());
+				messages.push_back(std::move(message));
+			}
+			return messages;
+		}
+
+		std::string PgTypes(const std::vector<PgMessage>& messages) {
+			std::string types;
+			for (const auto& message : messages) {
+				types += message.type;
+			}
+			return types;
+		}
+
+	} // namespace
+
 	TestSuite::TestSuite()
 	    : db_manager_(nullptr)
 	    , engine_(nullptr)
@@ -44,6 +163,9 @@ namespace tests {
 			RunBulkInsertTests();
 			RunErrorTests();
 			RunPerformanceTests();
+			RunRecoveryTests();
+			RunTransactionTests();
+			RunNetworkTests();
 
 		} catch (const std::exception& e) {
 			std::cout << "FAILED: Test suite failed: " << e.what() << std::endl;
@@ -72,6 +194,11 @@ namespace tests {
 		std::cout << "\nDML Tests" << std::endl;
 		RunTest("Single INSERT", &TestSuite::TestSingleInsert);
 		RunTest("SELECT Query", &TestSuite::TestSelectQuery);
+		RunTest("SELECT with WHERE", &TestSuite::TestFilteredSelect);
+		RunTest("Typed Predicates", &TestSuite::TestTypedPredicates);
+		RunTest("VARCHAR Columns", &TestSuite::TestVarcharColumns);
+		RunTest("NULL Values", &TestSuite::TestNullValues);
+		RunTest("BIGINT, DOUBLE, DATE, TIMESTAMP", &TestSuite::TestWideTypes);
 	}
 
 	void TestSuite::RunBulkInsertTests() {
@@ -87,6 +214,43 @@ namespace tests {
 	void TestSuite::RunPerformanceTests() {
 		std::cout << "\nPerformance Tests" << std::endl;
 		RunTest("Large Dataset", &TestSuite::TestLargeDataset);
+		RunTest("Parallel Scan", &TestSuite::TestParallelScan);
+		RunTest("Wide Rows", &TestSuite::TestWideRows);
+		RunTest("Columnar Tables", &TestSuite::TestColumnarTables);
+		RunTest("Column Compression", &TestSuite::TestColumnCompression);
+		RunTest("Zone Maps", &TestSuite::TestZoneMaps);
+		RunTest("Bloom Filters", &TestSuite::TestBloomFilters);
+		RunTest("Query Arena", &TestSuite::TestQueryArena);
+		RunTest("Concurrent Buffer Pool", &TestSuite::TestConcurrentBufferPool);
+		RunTest("Shared Buffer Pool", &TestSuite::TestSharedBufferPool);
+		RunTest("Memory-Mapped Reads", &TestSuite::TestMappedReads);
+		RunTest("Direct I/O", &TestSuite::TestDirectIO);
+		RunTest("Free Page Reuse", &TestSuite::TestFreePageReuse);
+		RunTest("Extent Allocation", &TestSuite::TestExtentAllocation);
+	}
+
+	void TestSuite::RunRecoveryTests() {
+		std::cout << "\nRecovery Tests" << std::endl;
+		RunTest("Write-Ahead Log", &TestSuite::TestWriteAheadLog);
+		RunTest("Group Commit", &TestSuite::TestGroupCommit);
+		RunTest("Log Truncation", &TestSuite::TestLogTruncation);
+		RunTest("Crash Recovery", &TestSuite::TestCrashRecovery);
+		RunTest("Checkpoint", &TestSuite::TestCheckpoint);
+	}
+
+	void TestSuite::RunTransactionTests() {
+		std::cout << "\nTransaction Tests" << std::endl;
+		RunTest("Transactions", &TestSuite::TestTransactions);
+		RunTest("Snapshot Isolation", &TestSuite::TestSnapshotIsolation);
+		RunTest("Page Compaction", &TestSuite::TestPageCompaction);
+		RunTest("Lock Manager", &TestSuite::TestLockManager);
+	}
+
+	void TestSuite::RunNetworkTests() {
+		std::cout << "\nNetwork Tests" << std::endl;
+		RunTest("Network Server", &TestSuite::TestNetworkServer);
+		RunTest("PostgreSQL Protocol", &TestSuite::TestPostgresProtocol);
+		RunTest("Binary Result Encoding", &TestSuite::TestBinaryResultEncoding);
 	}
 
 	void TestSuite::TestDatabaseSetup() {
@@ -131,6 +295,256 @@ namespace tests {
 		Assert(result.success_, "Failed to SELECT from products");
 	}
 
+	void TestSuite::TestFilteredSelect() {
+		auto result = engine_->Execute("SELECT * FROM users WHERE id = 2");
+		Assert(result.success_ && result.data_ && result.data_->GetSize() == 1, "Expected 1 row for id = 2");
+
+		result = engine_->Execute("SELECT name FROM users WHERE score >= 90.0");
+		Assert(result.success_ && result.data_ && result.data_->GetSize() == 1, "Expected 1 row for score >= 90.0");
+		Assert(std::string(result.data_->GetTuples()[0].GetValue(0, &result.data_->GetSchema())) == "Alice", "Expected Alice");
+
+		result = engine_->Execute("SELECT * FROM users WHERE name = 'Nobody'");
+		Assert(result.success_ && !result.data_, "Expected no rows for unmatched predicate");
+
+		result = engine_->Execute("SELECT * FROM users WHERE id = 'abc'");
+		Assert(!result.success_, "Should fail on mistyped literal");
+	}
+
+	void TestSuite::TestTypedPredicates() {
+		const int num_rows = 40;
+		Assert(engine_->Execute("CREATE TABLE typed_test (id INT, name CHAR, score FLOAT, rank INT)").success_, "Failed to create typed table");
+
+		std::string query = "INSERT INTO typed_test VALUES ";
+		for (int i = 0; i < num_rows; i++) {
+			query += (i > 0 ? ", (" : "(") + std::to_string(i) + ", 'n" + std::to_string(i % 10) + "', " + std::to_string(i * 0.25) + ", " + std::to_string(num_rows - i) + ")";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill typed table");
+
+		// every operator on every column type, counted against the same comparison in C++
+		const std::vector<std::string> ops = { "=", "!=", "<", ">", "<=", ">=" };
+		auto expected = [](const std::string& op, int cmp) {
+			return op == "=" ? cmp == 0 : op == "!=" ? cmp != 0 : op == "<" ? cmp < 0 : op == ">" ? cmp > 0 : op == "<=" ? cmp <= 0 : cmp >= 0;
+		};
+		for (const std::string& op : ops) {
+			size_t ints = 0, floats = 0, chars = 0;
+			for (int i = 0; i < num_rows; i++) {
+				ints += expected(op, (i > 17) - (i < 17));
+				floats += expected(op, (i * 0.25f > 4.5f) - (i * 0.25f < 4.5f));
+				chars += expected(op, std::strcmp(("n" + std::to_string(i % 10)).c_str(), "n4"));
+			}
+
+			const std::vector<std::pair<std::string, size_t>> cases = {
+				{ "id " + op + " 17", ints }, { "score " + op + " 4.5", floats }, { "name " + op + " 'n4'", chars }
+			};
+			for (const auto& c : cases) {
+				auto result = engine_->Execute("SELECT rank, id FROM typed_test WHERE " + c.first);
+				size_t rows = result.data_ ? result.data_->GetSize() : 0;
+				Assert(result.success_ && rows == c.second, "WHERE " + c.first + ": expected " + std::to_string(c.second) + " rows, got " + std::to_string(rows));
+				if (result.data_) {
+					const Schema& schema = result.data_->GetSchema();
+					for (const Tuple& tuple : result.data_->GetTuples()) {
+						int rank = *reinterpret_cast<const int*>(tuple.GetValue(0, &schema));
+						int id = *reinterpret_cast<const int*>(tuple.GetValue(1, &schema));
+						Assert(rank == num_rows - id, "Projected columns swapped");
+					}
+				}
+			}
+		}
+
+		// adjacent columns are copied as one run
+		Schema schema;
+		schema.AddColumn("a", ColumnType::INT, false, 0);
+		schema.AddColumn("b", ColumnType::FLOAT, false, 1);
+		schema.AddColumn("c", ColumnType::INT, false, 2);
+		int a = 7, c = 9;
+		float b = 2.5f;
+		Tuple row({ reinterpret_cast<const char*>(&a), reinterpret_cast<const char*>(&b), reinterpret_cast<const char*>(&c) }, &schema);
+		executor::RowProjector projector(schema, { 1, 2, 0 });
+		Tuple projected = projector.Project(row.GetData());
+		Assert(projected.GetSize() == schema.GetTupleSize(), "Wrong projected size");
+		Assert(executor::ReadColumn<ColumnType::FLOAT>(projected.GetData(), 4) == 2.5f, "Wrong first projected column");
+		Assert(executor::ReadColumn<ColumnType::INT>(projected.GetData(), 8) == 9, "Wrong second projected column");
+		Assert(executor::ReadColumn<ColumnType::INT>(projected.GetData(), 12) == 7, "Wrong third projected column");
+
+		Assert(engine_->Execute("DROP TABLE typed_test").success_, "Failed to drop typed table");
+	}
+
+	void TestSuite::TestVarcharColumns() {
+		const int num_rows = 1000;
+		Assert(engine_->Execute("CREATE TABLE fixed_codes (id INT, code CHAR, note CHAR)").success_, "Failed to create CHAR table");
+		Assert(engine_->Execute("CREATE TABLE var_codes (id INT, code VARCHAR(8), note VARCHAR)").success_, "Failed to create VARCHAR table");
+		Assert(!engine_->Execute("CREATE TABLE bad_codes (id INT, code VARCHAR(0))").success_, "VARCHAR(0) should be rejected");
+		Assert(!engine_->Execute("CREATE TABLE bad_codes (a VARCHAR(1024), b VARCHAR(1024), c VARCHAR(1024), d VARCHAR(1024))").success_, "Rows larger than a page should be rejected");
+
+		std::string values;
+		for (int i = 0; i < num_rows; i++) {
+			values += (i > 0 ? ", (" : "(") + std::to_string(i) + ", 'c" + std::to_string(i % 7) + "', 'n" + std::to_string(i) + "')";
+		}
+		Assert(engine_->Execute("INSERT INTO fixed_codes VALUES " + values).success_, "Failed to fill CHAR table");
+		Assert(engine_->Execute("INSERT INTO var_codes VALUES " + values).success_, "Failed to fill VARCHAR table");
+
+		// rows take their real size
+		auto page_count = [&](const std::string& table) {
+			TableRef* ref = db_manager_->GetCatalogManager()->GetTableRef(table);
+			size_t pages = venus::table::TableHeap(db_manager_->GetBufferPoolManager(), ref->GetSchema(), ref->GetFirstPageId()).GetPageIds().size();
+			delete ref->schema;
+			delete ref;
+			return pages;
+		};
+		size_t fixed_pages = page_count("fixed_codes");
+		size_t var_pages = page_count("var_codes");
+		std::cout << "    INFO: " << num_rows << " rows in " << fixed_pages << " CHAR pages, " << var_pages << " VARCHAR pages" << std::endl;
+		Assert(var_pages * 2 < fixed_pages, "VARCHAR rows should be less than half as large");
+
+		auto result = engine_->Execute("SELECT note, id FROM var_codes WHERE code = 'c3'");
+		Assert(result.success_ && result.data_ && result.data_->GetSize() == (num_rows + 3) / 7, "Wrong number of rows for code = 'c3'");
+		for (const Tuple& tuple : result.data_->GetTuples()) {
+			const Schema& schema = result.data_->GetSchema();
+			int id = *reinterpret_cast<const int*>(tuple.GetValue(1, &schema));
+			Assert(id % 7 == 3 && std::string(tuple.GetValue(0, &schema)) == "n" + std::to_string(id), "Wrong VARCHAR value");
+		}
+
+		// longer than a CHAR, no truncation; longer than the column is an error
+		std::string long_note(200, 'x');
+		Assert(engine_->Execute("UPDATE var_codes SET note = '" + long_note + "' WHERE id = 5").success_, "Failed to update VARCHAR");
+		Assert(engine_->Execute("UPDATE var_codes SET id = 5000 WHERE id = 5").success_, "Failed to update a fixed column");
+		result = engine_->Execute("SELECT * FROM var_codes WHERE id = 5000");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Updated row not found");
+		const Tuple& row = result.data_->GetTuples()[0];
+		Assert(std::string(row.GetValue(1, &result.data_->GetSchema())) == "c5", "Column before the update was changed");
+		Assert(std::string(row.GetValue(2, &result.data_->GetSchema())) == long_note, "Long VARCHAR value was cut");
+		Assert(!engine_->Execute("INSERT INTO var_codes VALUES (1, 'too long code', 'x')").success_, "Too long VARCHAR should be rejected");
+
+		// the wire format sends lengths and bytes
+		std::string frames;
+		network::EncodeResult(result, &frames, [](std::string*) { return true; });
+		uint8_t type;
+		std::string payload;
+		Assert(network::TakeFrame(&frames, &type, &payload), "Expected ROW_DESCRIPTION");
+		Assert(network::TakeFrame(&frames, &type, &payload) && type == static_cast<uint8_t>(network::ResponseType::ROW_BATCH), "Expected ROW_BATCH");
+		network::MessageReader batch(payload.data(), payload.size());
+		Assert(batch.GetU32() == 1 && *reinterpret_cast<const int*>(batch.GetBytes(sizeof(int))) == 5000, "INT column encoded incorrectly");
+		Assert(batch.GetU16() == 2 && std::string(batch.GetBytes(2), 2) == "c5", "VARCHAR column encoded incorrectly");
+		Assert(batch.GetU16() == long_note.size() && batch.GetBytes(long_note.size()) && batch.AtEnd(), "Long VARCHAR encoded incorrectly");
+
+		Assert(engine_->Execute("DROP TABLE fixed_codes").success_, "Failed to drop CHAR table");
+		Assert(engine_->Execute("DROP TABLE var_codes").success_, "Failed to drop VARCHAR table");
+	}
+
+	void TestSuite::TestNullValues() {
+		Assert(engine_->Execute("CREATE TABLE null_test (id INT PRIMARY KEY, score INT, label CHAR)").success_, "Failed to create table");
+		Assert(engine_->Execute("INSERT INTO null_test VALUES (1, 10, 'a')").success_, "Failed to insert row");
+		Assert(engine_->Execute("INSERT INTO null_test VALUES (2, NULL, 'b'), (3, 30, NULL), (4, NULL, NULL)").success_, "Failed to insert NULLs");
+		Assert(!engine_->Execute("INSERT INTO null_test VALUES (NULL, 50, 'e')").success_, "NULL primary key should be rejected");
+
+		auto count = [&](const std::string& where) {
+			auto result = engine_->Execute("SELECT * FROM null_test WHERE " + where);
+			Assert(result.success_, "Failed to select WHERE " + where);
+			return result.data_ ? result.data_->GetSize() : 0;
+		};
+		Assert(count("score IS NULL") == 2 && count("score IS NOT NULL") == 2, "Wrong IS [NOT] NULL result");
+		Assert(count("label IS NULL") == 2, "Wrong IS NULL result for CHAR");
+		// comparisons are never true for NULL, the zero bytes under it are not a value
+		Assert(count("score < 100") == 2 && count("score != 10") == 1 && count("label != 'a'") == 1, "NULL should not match a comparison");
+
+		// projections carry the null bits to their own bitmap
+		auto result = engine_->Execute("SELECT label, id FROM null_test WHERE id >= 3");
+		Assert(result.success_ && result.data_ && result.data_->GetSize() == 2, "Failed to project NULLs");
+		for (const Tuple& tuple : result.data_->GetTuples()) {
+			const Schema& schema = result.data_->GetSchema();
+			Assert(tuple.IsNull(0, &schema) && tuple.GetValue(0, &schema) == nullptr && !tuple.IsNull(1, &schema), "Projected NULL lost");
+		}
+
+		// the wire batch ends with the bitmaps of the columns holding NULLs
+		result = engine_->Execute("SELECT * FROM null_test WHERE score IS NOT NULL");
+		std::string frames;
+		network::EncodeResult(result, &frames, [](std::string*) { return true; });
+		uint8_t type;
+		std::string payload;
+		network::TakeFrame(&frames, &type, &payload);
+		Assert(network::TakeFrame(&frames, &type, &payload) && type == static_cast<uint8_t>(network::ResponseType::ROW_BATCH), "Expected ROW_BATCH");
+		network::MessageReader batch(payload.data(), payload.size());
+		Assert(batch.GetU32() == 2 && batch.GetBytes(2 * (sizeof(int) + sizeof(int) + MAX_CHAR_LENGTH)), "Wrong batch");
+		Assert(batch.GetU16() == 1 && batch.GetU16() == 2 && batch.GetU8() == 0x2 && batch.AtEnd(), "Wrong NULL trailer");
+
+		// UPDATE sets and clears NULLs, in place and for VARCHAR rows
+		Assert(engine_->Execute("UPDATE null_test SET score = NULL WHERE id = 1").success_, "Failed to set NULL");
+		Assert(engine_->Execute("UPDATE null_test SET score = 40 WHERE id = 4").success_, "Failed to clear NULL");
+		Assert(count("score IS NULL") == 2 && count("score = 40") == 1 && count("score = 10") == 0, "Wrong NULLs after UPDATE");
+		Assert(!engine_->Execute("UPDATE null_test SET id = NULL").success_, "NULL primary key should be rejected in SET");
+
+		Assert(engine_->Execute("CREATE TABLE null_names (id INT PRIMARY KEY, name VARCHAR(16), score FLOAT)").success_, "Failed to create VARCHAR table");
+		Assert(engine_->Execute("INSERT INTO null_names VALUES (1, NULL, 1.5), (2, 'two', NULL)").success_, "Failed to insert VARCHAR NULLs");
+		Assert(engine_->Execute("UPDATE null_names SET name = 'one' WHERE id = 1").success_, "Failed to update VARCHAR NULL");
+		Assert(engine_->Execute("UPDATE null_names SET name = NULL WHERE id = 2").success_, "Failed to set VARCHAR NULL");
+		result = engine_->Execute("SELECT name, score FROM null_names WHERE name IS NOT NULL");
+		Assert(result.success_ && result.data_ && result.data_->GetSize() == 1, "Wrong VARCHAR IS NOT NULL result");
+		const Schema& schema = result.data_->GetSchema();
+		Assert(std::string(result.data_->GetTuples()[0].GetValue(0, &schema)) == "one" && !result.data_->GetTuples()[0].IsNull(1, &schema), "Wrong VARCHAR row");
+		result = engine_->Execute("SELECT * FROM null_names WHERE id = 2");
+		Assert(result.data_ && result.data_->GetTuples()[0].IsNull(1, &result.data_->GetSchema()) && result.data_->GetTuples()[0].IsNull(2, &result.data_->GetSchema()), "VARCHAR NULL lost");
+
+		Assert(engine_->Execute("DROP TABLE null_test").success_, "Failed to drop table");
+		Assert(engine_->Execute("DROP TABLE null_names").success_, "Failed to drop VARCHAR table");
+	}
+
+	void TestSuite::TestWideTypes() {
+		// literals and their integer encodings
+		Assert(ParseDate("1970-01-01") == 0 && ParseDate("1969-12-31") == -1 && ParseDate("2000-03-01") == 11017, "Wrong DATE encoding");
+		Assert(FormatDate(ParseDate("2024-02-29")) == "2024-02-29", "DATE does not round trip");
+		Assert(ParseTimestamp("1970-01-02") == 86400LL * 1000000 && ParseTimestamp("1970-01-01 00:00:00.25") == 250000, "Wrong TIMESTAMP encoding");
+		Assert(FormatTimestamp(ParseTimestamp("1969-12-31 23:59:59.000001")) == "1969-12-31 23:59:59.000001", "TIMESTAMP does not round trip");
+		for (const char* bad : { "2023-02-29", "2024-13-01", "2024-1-01", "2024-01-01 24:00:00", "2024-01-01 10:00" }) {
+			bool rejected = false;
+			try {
+				ParseTimestamp(bad);
+			} catch (const std::invalid_argument&) {
+				rejected = true;
+			}
+			Assert(rejected, std::string("Invalid TIMESTAMP accepted: ") + bad);
+		}
+
+		Assert(engine_->Execute("CREATE TABLE events (id BIGINT PRIMARY KEY, amount DOUBLE, day DATE, at TIMESTAMP)").success_, "Failed to create table");
+		std::string values;
+		for (int i = 0; i < 100; i++) {
+			char row[128];
+			std::snprintf(row, sizeof(row), "%s(%lld, %d.125, '2024-01-%02d', '2024-01-%02d %02d:30:00')", i > 0 ? ", " : "",
+			    5000000000LL + i, i, i % 28 + 1, i % 28 + 1, i % 24);
+			values += row;
+		}
+		Assert(engine_->Execute("INSERT INTO events VALUES " + values).success_, "Failed to insert rows");
+		Assert(!engine_->Execute("INSERT INTO events VALUES (1, 1.0, '2024-02-30', '2024-01-01')").success_, "Invalid DATE should be rejected");
+
+		TableRef* ref = db_manager_->GetCatalogManager()->GetTableRef("events");
+		Assert(ref->GetSchema()->GetTupleSize() == sizeof(uint32_t) + 8 + 8 + 4 + 8 + 1, "Wrong row size");
+		Assert(ref->GetSchema()->GetColumn(3).GetType() == ColumnType::TIMESTAMP, "Column type not kept by the catalog");
+		delete ref->schema;
+		delete ref;
+
+		auto select = [&](const std::string& where) {
+			auto result = engine_->Execute("SELECT id, amount, day, at FROM events WHERE " + where);
+			Assert(result.success_, "Failed to select WHERE " + where);
+			return result;
+		};
+		Assert(select("id >= 5000000090").data_->GetSize() == 10, "Wrong BIGINT range");
+		Assert(select("amount = 7.125").data_->GetSize() == 1, "Wrong DOUBLE match");
+		Assert(select("day < '2024-01-03'").data_->GetSize() == 8, "Wrong DATE range");
+		Assert(select("at >= '2024-01-28 00:00:00'").data_->GetSize() == 3, "Wrong TIMESTAMP range");
+
+		auto result = select("id = 5000000042");
+		const Schema& schema = result.data_->GetSchema();
+		const Tuple& row = result.data_->GetTuples()[0];
+		Assert(executor::ReadColumn<ColumnType::BIGINT>(row.GetData(), schema.GetOffset(0)) == 5000000042LL, "Wrong BIGINT value");
+		Assert(executor::ReadColumn<ColumnType::DOUBLE>(row.GetData(), schema.GetOffset(1)) == 42.125, "Wrong DOUBLE value");
+		Assert(FormatDate(executor::ReadColumn<ColumnType::DATE>(row.GetData(), schema.GetOffset(2))) == "2024-01-15", "Wrong DATE value");
+		Assert(FormatTimestamp(executor::ReadColumn<ColumnType::TIMESTAMP>(row.GetData(), schema.GetOffset(3))) == "2024-01-15 18:30:00", "Wrong TIMESTAMP value");
+
+		Assert(engine_->Execute("UPDATE events SET at = '1999-12-31 23:59:59' WHERE id = 5000000042").success_, "Failed to update TIMESTAMP");
+		Assert(select("at < '2000-01-01'").data_->GetSize() == 1, "TIMESTAMP not updated");
+
+		Assert(engine_->Execute("DROP TABLE events").success_, "Failed to drop table");
+	}
+
 	void TestSuite::TestInvalidQueries() {
 		auto result = engine_->Execute("SELEKT * FROM users"); 
 		Assert(!result.success_, "Should fail on syntax error");
@@ -169,6 +583,1866 @@ namespace tests {
 		Assert(result.success_, "Failed to select large dataset");
 	}
 
+	void TestSuite::TestParallelScan() {
+		auto result = engine_->Execute("CREATE TABLE scan_test (id INT, data CHAR, value FLOAT)");
+		Assert(result.success_, "Failed to create scan test table");
+
+		const int num_rows = 3000;
+		std::string query = "INSERT INTO scan_test VALUES ";
+		for (int i = 1; i <= num_rows; i++) {
+			if (i > 1)
+				query += ", ";
+			query += "(" + std::to_string(i) + ", 'row" + std::to_string(i) + "', " + std::to_string(i * 0.5) + ")";
+		}
+		result = engine_->Execute(query);
+		Assert(result.success_, "Failed to insert scan dataset");
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		result = engine_->Execute("SELECT id, value FROM scan_test WHERE id > 1000");
+		auto end_time = std::chrono::high_resolution_clock::now();
+
+		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+		std::cout << "    TIME: Filtered " << num_rows << " records in " << duration.count() << "μs" << std::endl;
+
+		Assert(result.success_ && result.data_, "Failed to scan dataset");
+		Assert(result.data_->GetSize() == 2000, "Expected 2000 rows, got " + std::to_string(result.data_->GetSize()));
+
+		// merged output keeps heap order
+		const Schema& schema = result.data_->GetSchema();
+		const auto& tuples = result.data_->GetTuples();
+		for (size_t i = 0; i < tuples.size(); i++) {
+			int id = *reinterpret_cast<const int*>(tuples[i].GetValue(0, &schema));
+			Assert(id == static_cast<int>(i) + 1001, "Parallel scan returned rows out of order");
+		}
+	}
+
+	void TestSuite::TestWideRows() {
+		const int num_columns = 64;
+		const int num_rows = 2000;
+
+		std::string create = "CREATE TABLE wide_test (";
+		for (int c = 0; c < num_columns; c++) {
+			create += (c > 0 ? ", c" : "c") + std::to_string(c) + (c == num_columns - 1 ? " FLOAT" : " INT");
+		}
+		Assert(engine_->Execute(create + ")").success_, "Failed to create wide table");
+
+		std::string query = "INSERT INTO wide_test VALUES ";
+		for (int i = 0; i < num_rows; i++) {
+			query += i > 0 ? ", (" : "(";
+			for (int c = 0; c < num_columns; c++) {
+				query += (c > 0 ? ", " : "") + std::to_string(i * num_columns + c);
+			}
+			query += ")";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill wide table");
+
+		// offsets come from the schema, the last columns cost as much as the first
+		auto start_time = std::chrono::high_resolution_clock::now();
+		auto result = engine_->Execute("SELECT c0, c62, c63 FROM wide_test WHERE c62 >= 64000");
+		auto end_time = std::chrono::high_resolution_clock::now();
+		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+		std::cout << "    TIME: Filtered " << num_rows << " rows of " << num_columns << " columns in " << duration.count() << "μs" << std::endl;
+
+		Assert(result.success_ && result.data_, "Failed to scan wide table");
+		Assert(result.data_->GetSize() == 1000, "Expected 1000 rows, got " + std::to_string(result.data_->GetSize()));
+
+		const Schema& schema = result.data_->GetSchema();
+		// 3 columns and their null bitmap byte
+		Assert(schema.GetTupleSize() == sizeof(uint32_t) + 2 * sizeof(int) + sizeof(float) + 1, "Wrong projected tuple size");
+		for (const Tuple& tuple : result.data_->GetTuples()) {
+			int first = *reinterpret_cast<const int*>(tuple.GetValue(0, &schema));
+			Assert(*reinterpret_cast<const int*>(tuple.GetValue(1, &schema)) == first + 62, "Wrong value in column c62");
+			Assert(*reinterpret_cast<const float*>(tuple.GetValue(2, &schema)) == static_cast<float>(first + 63), "Wrong value in column c63");
+		}
+
+		Assert(engine_->Execute("UPDATE wide_test SET c63 = 1.5 WHERE c0 = 0").success_, "Failed to update the last column");
+		result = engine_->Execute("SELECT c63 FROM wide_test WHERE c0 = 0");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Updated row not found");
+		Assert(*reinterpret_cast<const float*>(result.data_->GetTuples()[0].GetValue(0, &result.data_->GetSchema())) == 1.5f, "Update wrote the wrong column");
+
+		Assert(engine_->Execute("DROP TABLE wide_test").success_, "Failed to drop wide table");
+	}
+
+	void TestSuite::TestColumnarTables() {
+		const int num_columns = 40;
+		const int num_rows = 2000;
+
+		std::string create = "CREATE TABLE pax_test (";
+		for (int c = 0; c < num_columns; c++) {
+			create += (c > 0 ? ", c" : "c") + std::to_string(c) + (c == 1 ? " DATE" : " INT");
+		}
+		Assert(engine_->Execute(create + ") WITH (format = columnar)").success_, "Failed to create columnar table");
+		Assert(!engine_->Execute("CREATE TABLE pax_bad (id INT, note VARCHAR(10)) WITH (format = columnar)").success_, "VARCHAR should be rejected");
+		Assert(!engine_->Execute("CREATE TABLE pax_bad (id INT) WITH (format = rows)").success_, "Unknown format should be rejected");
+
+		// every tenth row has a NULL in c2
+		std::string query = "INSERT INTO pax_test VALUES ";
+		for (int i = 0; i < num_rows; i++) {
+			query += i > 0 ? ", (" : "(";
+			for (int c = 0; c < num_columns; c++) {
+				std::string value = std::to_string(i * num_columns + c);
+				if (c == 1) {
+					value = "'2024-01-01'";
+				} else if (c == 2 && i % 10 == 0) {
+					value = "NULL";
+				}
+				query += (c > 0 ? ", " : "") + value;
+			}
+			query += ")";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill columnar table");
+
+		TableRef* ref = db_manager_->GetCatalogManager()->GetTableRef("pax_test");
+		std::vector<page_id_t> page_ids = venus::table::TableHeap(db_manager_->GetBufferPoolManager(), ref->GetSchema(), ref->GetFirstPageId()).GetPageIds();
+		Assert(page_ids.size() > 1, "Rows should span several pages");
+		for (page_id_t page_id : page_ids) {
+			venus::buffer::PageGuard guard = db_manager_->GetBufferPoolManager()->FetchPageRead(page_id);
+			Assert(guard && guard->IsColumnar(), "Page " + std::to_string(page_id) + " is not columnar");
+			Assert(guard->GetFieldWidths() == ref->GetSchema()->GetFieldWidths(), "Page " + std::to_string(page_id) + " has the wrong layout");
+		}
+		delete ref->schema;
+		delete ref;
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		auto result = engine_->Execute("SELECT c0, c2, c39 FROM pax_test WHERE c39 >= 40000");
+		auto end_time = std::chrono::high_resolution_clock::now();
+		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+		std::cout << "    TIME: Filtered " << num_rows << " rows of " << num_columns << " columns in " << duration.count() << "μs" << std::endl;
+
+		Assert(result.success_ && result.data_ && result.data_->GetSize() == 1000, "Wrong number of rows for c39 >= 40000");
+		const Schema& schema = result.data_->GetSchema();
+		for (const Tuple& tuple : result.data_->GetTuples()) {
+			int first = *reinterpret_cast<const int*>(tuple.GetValue(0, &schema));
+			Assert(tuple.IsNull(1, &schema) == (first / num_columns % 10 == 0), "Wrong NULL in column c2");
+			Assert(*reinterpret_cast<const int*>(tuple.GetValue(2, &schema)) == first + 39, "Wrong value in column c39");
+		}
+
+		auto count = [&](const std::string& where) {
+			auto rows = engine_->Execute("SELECT * FROM pax_test WHERE " + where);
+			Assert(rows.success_, "Failed to select WHERE " + where);
+			return rows.data_ ? rows.data_->GetSize() : 0;
+		};
+		Assert(count("c2 IS NULL") == num_rows / 10, "Wrong number of NULLs");
+		Assert(count("c1 = '2024-01-01'") == num_rows, "Wrong DATE match");
+
+		// whole rows are gathered from the minipages
+		result = engine_->Execute("SELECT * FROM pax_test WHERE c0 = 400");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Row not found");
+		const Tuple& row = result.data_->GetTuples()[0];
+		Assert(*reinterpret_cast<const int*>(row.GetValue(20, &result.data_->GetSchema())) == 420, "Wrong value in a gathered row");
+
+		Assert(engine_->Execute("UPDATE pax_test SET c39 = 7 WHERE c0 = 400").success_, "Failed to update columnar row");
+		Assert(count("c39 = 7") == 1, "Update not visible");
+		Assert(engine_->Execute("DELETE FROM pax_test WHERE c3 < 4000").success_, "Failed to delete columnar rows");
+		Assert(count("c0 >= 0") == num_rows - 100, "Wrong number of rows after delete");
+
+		Assert(engine_->Execute("DROP TABLE pax_test").success_, "Failed to drop columnar table");
+	}
+
+	void TestSuite::TestColumnCompression() {
+		const int num_rows = 1000;
+		const std::string statuses[] = { "open", "paid", "shipped", "closed" };
+
+		Assert(engine_->Execute("CREATE TABLE pack_test (id INT, status CHAR, day DATE, amount INT) WITH (format = columnar)").success_,
+		    "Failed to create columnar table");
+
+		// a few distinct statuses, days in order, small amounts and every seventh amount NULL
+		std::string query = "INSERT INTO pack_test VALUES ";
+		for (int i = 0; i < num_rows; i++) {
+			int day_of_month = 1 + i / 40;
+			std::string day = std::string("'2024-01-") + (day_of_month < 10 ? "0" : "") + std::to_string(day_of_month) + "'";
+			std::string amount = i % 7 == 0 ? "NULL" : std::to_string(i % 100);
+			query += (i > 0 ? ", (" : "(") + std::to_string(i) + ", '" + statuses[i % 4] + "', " + day + ", " + amount + ")";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill columnar table");
+
+		TableRef* ref = db_manager_->GetCatalogManager()->GetTableRef("pack_test");
+		std::vector<page_id_t> page_ids = venus::table::TableHeap(db_manager_->GetBufferPoolManager(), ref->GetSchema(), ref->GetFirstPageId()).GetPageIds();
+		delete ref->schema;
+		delete ref;
+		Assert(page_ids.size() > 2, "Rows should span several pages");
+		{
+			// every page but the last one filled up
+			venus::buffer::PageGuard guard = db_manager_->GetBufferPoolManager()->FetchPageRead(page_ids[0]);
+			Assert(guard && guard->IsCompressed(), "Full page is not compressed");
+			Assert(guard->GetMinipage(0).encoding == ColumnEncoding::FRAME_OF_REFERENCE, "id should be frame of reference encoded");
+			Assert(guard->GetMinipage(1).encoding == ColumnEncoding::DICTIONARY, "status should be dictionary encoded");
+			Assert(guard->GetMinipage(2).encoding == ColumnEncoding::RUN_LENGTH, "day should be run-length encoded");
+			guard = db_manager_->GetBufferPoolManager()->FetchPageRead(page_ids.back());
+			Assert(guard && !guard->IsCompressed(), "Last page should still be plain");
+		}
+
+		auto count = [&](const std::string& where) {
+			auto rows = engine_->Execute("SELECT * FROM pack_test WHERE " + where);
+			Assert(rows.success_, "Failed to select WHERE " + where);
+			return rows.data_ ? rows.data_->GetSize() : 0;
+		};
+		Assert(count("status = 'paid'") == num_rows / 4, "Wrong dictionary match");
+		Assert(count("status != 'paid'") == num_rows - num_rows / 4, "Wrong dictionary mismatch");
+		Assert(count("day >= '2024-01-11'") == 600, "Wrong run match");
+		Assert(count("id < 500") == 500, "Wrong frame of reference match");
+		Assert(count("amount IS NULL") == (num_rows + 6) / 7, "Wrong number of NULLs");
+		Assert(count("amount < 10") == 86, "Wrong match on a column with NULLs");
+
+		auto result = engine_->Execute("SELECT status, day, amount FROM pack_test WHERE id = 13");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Row not found");
+		const Schema& schema = result.data_->GetSchema();
+		const Tuple& row = result.data_->GetTuples()[0];
+		Assert(std::string(row.GetValue(0, &schema)) == "paid", "Wrong decoded CHAR");
+		Assert(*reinterpret_cast<const int*>(row.GetValue(2, &schema)) == 13, "Wrong decoded INT");
+
+		// a write decodes the page first
+		Assert(engine_->Execute("UPDATE pack_test SET amount = 5000 WHERE id = 13").success_, "Failed to update compressed row");
+		Assert(count("amount = 5000") == 1, "Update not visible");
+		Assert(count("status = 'paid'") == num_rows / 4, "Neighbouring rows changed by the update");
+		Assert(engine_->Execute("DELETE FROM pack_test WHERE status = 'open'").success_, "Failed to delete compressed rows");
+		Assert(count("id >= 0") == num_rows - num_rows / 4, "Wrong number of rows after delete");
+
+		Assert(engine_->Execute("DROP TABLE pack_test").success_, "Failed to drop columnar table");
+	}
+
+	void TestSuite::TestZoneMaps() {
+		const int num_rows = 3000;
+
+		Assert(engine_->Execute("CREATE TABLE zone_test (id INT, kind CHAR, score FLOAT)").success_, "Failed to create table");
+
+		// ids grow with the insert order, as in an event log
+		std::string query = "INSERT INTO zone_test VALUES ";
+		for (int i = 0; i < num_rows; i++) {
+			std::string score = i % 10 == 0 ? "NULL" : std::to_string(i % 50) + ".5";
+			query += (i > 0 ? ", (" : "(") + std::to_string(i) + ", 'kind" + std::to_string(i % 3) + "', " + score + ")";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill table");
+
+		auto count = [&](const std::string& where) {
+			auto rows = engine_->Execute("SELECT id FROM zone_test WHERE " + where);
+			Assert(rows.success_, "Failed to select WHERE " + where);
+			return rows.data_ ? rows.data_->GetSize() : 0;
+		};
+
+		// the first filtered scan records the zones of the pages written before the zone map existed
+		Assert(count("id >= 2900") == 100, "Wrong number of recent rows");
+
+		TableRef* ref = db_manager_->GetCatalogManager()->GetTableRef("zone_test");
+		std::vector<page_id_t> page_ids = venus::table::TableHeap(db_manager_->GetBufferPoolManager(), ref->GetSchema(), ref->GetFirstPageId()).GetPageIds();
+		Assert(page_ids.size() > 10, "Rows should span many pages");
+		venus::table::ZoneMap* zone_map = ref->GetZoneMap();
+		size_t candidates = 0;
+		for (page_id_t page_id : page_ids) {
+			venus::table::ColumnZone zone;
+			Assert(zone_map->GetZone(page_id, 0, &zone) && zone.has_values, "Page " + std::to_string(page_id) + " has no zone");
+			int max;
+			std::memcpy(&max, zone.max, sizeof(max));
+			candidates += max >= 2900;
+		}
+		Assert(candidates <= 3, "Recent rows should be on the last pages only");
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		Assert(count("id >= 2900") == 100, "Wrong number of recent rows with zones");
+		auto end_time = std::chrono::high_resolution_clock::now();
+		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+		std::cout << "    TIME: Scanned " << candidates << " of " << page_ids.size() << " pages in " << duration.count() << "μs" << std::endl;
+
+		Assert(count("id = 1500") == 1, "Point lookup failed");
+		Assert(count("kind = 'kind1'") == num_rows / 3, "Wrong CHAR match");
+		Assert(count("kind > 'kind9'") == 0, "CHAR out of range");
+		Assert(count("score < 0.0") == 0, "FLOAT out of range");
+		Assert(count("score IS NULL") == num_rows / 10, "Wrong number of NULLs");
+
+		// writes after the zones are recorded widen them
+		Assert(engine_->Execute("INSERT INTO zone_test VALUES (-5, 'late', -1.0)").success_, "Failed to insert");
+		Assert(count("id < 0") == 1, "Inserted row skipped");
+		Assert(count("score < 0.0") == 1, "Inserted FLOAT skipped");
+		Assert(engine_->Execute("UPDATE zone_test SET kind = 'zzz' WHERE id = 10").success_, "Failed to update");
+		Assert(count("kind = 'zzz'") == 1, "Updated row skipped");
+		Assert(engine_->Execute("DELETE FROM zone_test WHERE id < 100").success_, "Failed to delete");
+		Assert(count("id < 100") == 0, "Deleted rows returned");
+
+		delete ref->schema;
+		delete ref;
+		Assert(engine_->Execute("DROP TABLE zone_test").success_, "Failed to drop table");
+	}
+
+	void TestSuite::TestBloomFilters() {
+		const int num_rows = 3000;
+
+		Assert(engine_->Execute("CREATE TABLE bloom_test (id INT, user_id INT, name CHAR) WITH (bloom_filter = user_id, bloom_filter = name)").success_,
+		    "Failed to create table with Bloom filters");
+		Assert(!engine_->Execute("CREATE TABLE bloom_bad (id INT) WITH (bloom_filter = missing)").success_, "Unknown column should be rejected");
+		Assert(!engine_->Execute("CREATE TABLE bloom_bad (id INT, note VARCHAR(10)) WITH (bloom_filter = note)").success_, "VARCHAR should be rejected");
+
+		// user ids are scattered over the pages, their min/max zones span almost everything
+		auto user_id = [](int i) { return (i * 7919) % 100000; };
+		std::string query = "INSERT INTO bloom_test VALUES ";
+		for (int i = 0; i < num_rows; i++) {
+			query += (i > 0 ? ", (" : "(") + std::to_string(i) + ", " + std::to_string(user_id(i)) + ", 'user" + std::to_string(user_id(i)) + "')";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill table");
+
+		auto count = [&](const std::string& where) {
+			auto rows = engine_->Execute("SELECT id FROM bloom_test WHERE " + where);
+			Assert(rows.success_, "Failed to select WHERE " + where);
+			return rows.data_ ? rows.data_->GetSize() : 0;
+		};
+		Assert(count("user_id = " + std::to_string(user_id(1234))) == 1, "Point lookup failed");
+
+		TableRef* ref = db_manager_->GetCatalogManager()->GetTableRef("bloom_test");
+		Assert(ref->GetSchema()->GetColumn(1).HasBloomFilter() && ref->GetSchema()->GetColumn(2).HasBloomFilter(), "Bloom filters not kept in the catalog");
+		Assert(!ref->GetSchema()->GetColumn(0).HasBloomFilter(), "Column without a Bloom filter has one");
+		std::vector<page_id_t> page_ids = venus::table::TableHeap(db_manager_->GetBufferPoolManager(), ref->GetSchema(), ref->GetFirstPageId()).GetPageIds();
+		int value = user_id(1234);
+		uint64_t hash = venus::table::ZoneMap::HashValue(ColumnType::INT, reinterpret_cast<const char*>(&value));
+		size_t candidates = 0;
+		for (page_id_t page_id : page_ids) {
+			candidates += ref->GetZoneMap()->MayContain(page_id, 1, hash);
+		}
+		delete ref->schema;
+		delete ref;
+		Assert(candidates >= 1 && candidates <= 3, "Bloom filters should rule out almost every page, " + std::to_string(candidates) + " left");
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < 100; i++) {
+			Assert(count("user_id = " + std::to_string(user_id(i * 29))) == 1, "Point lookup failed");
+		}
+		auto end_time = std::chrono::high_resolution_clock::now();
+		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+		std::cout << "    TIME: 100 point lookups over " << page_ids.size() << " pages in " << duration.count() << "μs" << std::endl;
+
+		Assert(count("name = 'user" + std::to_string(user_id(2999)) + "'") == 1, "CHAR point lookup failed");
+		Assert(count("user_id = 3") == 0, "Missing value found");
+		Assert(count("user_id != 3") == num_rows, "Only equality uses the Bloom filters");
+
+		// values written after the filters were built
+		Assert(engine_->Execute("INSERT INTO bloom_test VALUES (-1, 3, 'late')").success_, "Failed to insert");
+		Assert(count("user_id = 3") == 1, "Inserted row skipped");
+		Assert(engine_->Execute("UPDATE bloom_test SET name = 'renamed' WHERE id = 10").success_, "Failed to update");
+		Assert(count("name = 'renamed'") == 1, "Updated row skipped");
+
+		Assert(engine_->Execute("DROP TABLE bloom_test").success_, "Failed to drop table");
+	}
+
+	void TestSuite::TestQueryArena() {
+		venus::common::Arena arena(4096);
+		int destroyed = 0;
+		struct Counted {
+			explicit Counted(int* counter)
+			    : destroyed(counter) { }
+			~Counted() { (*destroyed)++; }
+			int* destroyed;
+		};
+		for (int i = 0; i < 100; i++) {
+			arena.New<Counted>(&destroyed);
+		}
+		Assert(arena.GetBlockCount() == 1, "Small objects should share a block");
+		double* wide = arena.New<double>(1.5);
+		Assert(reinterpret_cast<uintptr_t>(wide) % alignof(double) == 0 && *wide == 1.5, "Misaligned allocation");
+		char* large = static_cast<char*>(arena.Allocate(8192));
+		std::memset(large, 'x', 8192);
+		Assert(arena.GetBlockCount() == 2, "A large allocation gets a block of its own");
+
+		arena.Reset();
+		Assert(destroyed == 100, "Reset should run every destructor, ran " + std::to_string(destroyed));
+		Assert(arena.GetAllocatedBytes() == 0 && arena.GetBlockCount() == 1, "Reset should keep only the first block");
+
+		// every statement gives its memory back when it ends, failed ones included
+		Assert(engine_->Execute("CREATE TABLE arena_test (id INT, name CHAR)").success_, "Failed to create table");
+		Assert(engine_->Execute("INSERT INTO arena_test VALUES (1, 'a'), (2, 'b')").success_, "Failed to insert");
+		Assert(engine_->GetQueryArena()->GetAllocatedBytes() == 0, "Insert left memory in the arena");
+		auto rows = engine_->Execute("SELECT name FROM arena_test WHERE id = 2");
+		Assert(rows.success_ && rows.data_ && rows.data_->GetSize() == 1, "Select failed");
+		Assert(engine_->GetQueryArena()->GetAllocatedBytes() == 0, "Select left memory in the arena");
+		Assert(!engine_->Execute("SELECT missing FROM arena_test").success_, "Unknown column should fail");
+		Assert(engine_->GetQueryArena()->GetAllocatedBytes() == 0, "Failed statement left memory in the arena");
+		Assert(engine_->Execute("SHOW TABLES").success_, "Failed to show tables");
+		Assert(engine_->GetQueryArena()->GetBlockCount() <= 1, "Arena kept more than its first block");
+
+		Assert(engine_->Execute("UPDATE arena_test SET name = 'c' WHERE id = 1").success_, "Failed to update");
+		Assert(engine_->GetQueryArena()->GetAllocatedBytes() == 0, "Update left memory in the arena");
+		Assert(engine_->Execute("DELETE FROM arena_test WHERE id = 2").success_, "Failed to delete");
+		Assert(engine_->GetQueryArena()->GetAllocatedBytes() == 0, "Delete left memory in the arena");
+
+		Assert(engine_->Execute("DROP TABLE arena_test").success_, "Failed to drop table");
+
+		// USE replaces the executor's context, the arena the statement resets must outlive it
+		Assert(engine_->Execute("CREATE DATABASE arena_db").success_, "Failed to create database");
+		Assert(engine_->Execute("USE arena_db").success_, "Failed to switch database");
+		Assert(engine_->Execute("USE test_db").success_, "Failed to switch back");
+		Assert(engine_->GetQueryArena()->GetAllocatedBytes() == 0, "USE left memory in the arena");
+		rows = engine_->Execute("SHOW TABLES");
+		Assert(rows.success_, "Statement after USE failed");
+		Assert(engine_->GetQueryArena()->GetAllocatedBytes() == 0, "Statement after USE left memory in the arena");
+		Assert(engine_->Execute("DROP DATABASE arena_db").success_, "Failed to drop database");
+	}
+
+	void TestSuite::TestConcurrentBufferPool() {
+		const std::string db_file = std::string(DATABASE_DIRECTORY) + "/bpm_stress.db";
+		std::ofstream(db_file, std::ios::binary).close();
+
+		// twice as many pages as frames so workers keep evicting each other's pages
+		const int num_pages = MAX_BUFFER_POOL_SIZE * 2;
+		const int num_threads = 8;
+		const int increments = 4000;
+		std::vector<page_id_t> page_ids;
+
+		{
+			venus::storage::DiskManager disk_manager(db_file);
+			venus::buffer::BufferPoolManager bpm(&disk_manager);
+
+			for (int i = 0; i < num_pages; i++) {
+				venus::buffer::PageGuard guard = bpm.NewPageGuarded();
+				Assert(guard.IsValid(), "Failed to allocate page");
+				page_ids.push_back(guard.GetPageId());
+			}
+
+			std::atomic<bool> failed(false);
+			std::vector<std::thread> threads;
+			for (int t = 0; t < num_threads; t++) {
+				threads.emplace_back([&, t]() {
+					try {
+						uint32_t seed = t * 7919 + 1;
+						for (int i = 0; i < increments; i++) {
+							seed = seed * 1103515245 + 12345;
+							page_id_t page_id = page_ids[(seed >> 16) % num_pages];
+
+							venus::buffer::PageGuard guard = bpm.FetchPageWrite(page_id);
+							uint32_t* counter = reinterpret_cast<uint32_t*>(guard->GetData() + PAGE_SIZE - sizeof(uint32_t));
+							(*counter)++;
+							guard.MarkDirty();
+						}
+					} catch (const std::exception&) {
+						failed = true;
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			Assert(!failed, "Worker thread failed while fetching pages");
+			// bpm flushes dirty frames on destruction
+		}
+
+		// every increment must have survived eviction
+		venus::storage::DiskManager disk_manager(db_file);
+		std::vector<char> page_data(PAGE_SIZE);
+		uint64_t total = 0;
+		for (page_id_t page_id : page_ids) {
+			disk_manager.ReadPage(page_id, page_data.data());
+			total += *reinterpret_cast<const uint32_t*>(page_data.data() + PAGE_SIZE - sizeof(uint32_t));
+		}
+		std::remove(db_file.c_str());
+
+		Assert(total == static_cast<uint64_t>(num_threads) * increments,
+		    "Lost updates: expected " + std::to_string(num_threads * increments) + ", got " + std::to_string(total));
+	}
+
+	void TestSuite::TestSharedBufferPool() {
+		const std::string files[2] = { std::string(DATABASE_DIRECTORY) + "/shared_a.db", std::string(DATABASE_DIRECTORY) + "/shared_b.db" };
+		for (const auto& file : files) {
+			std::ofstream(file, std::ios::binary).close();
+		}
+
+		// two databases, each with more pages than the whole pool, the same page ids in both
+		const size_t pool_size = 16;
+		const int num_pages = pool_size * 2;
+		venus::buffer::BufferPool pool(pool_size);
+		{
+			venus::storage::DiskManager disk_a(files[0]);
+			venus::storage::DiskManager disk_b(files[1]);
+			venus::buffer::BufferPoolManager bpm_a(&pool, &disk_a);
+			venus::buffer::BufferPoolManager* bpm_b = new venus::buffer::BufferPoolManager(&pool, &disk_b);
+
+			std::vector<page_id_t> page_ids;
+			for (int i = 0; i < num_pages; i++) {
+				for (auto* bpm : { &bpm_a, bpm_b }) {
+					venus::buffer::PageGuard guard = bpm->NewPageGuarded();
+					*reinterpret_cast<uint32_t*>(guard->GetData() + PAGE_SIZE - sizeof(uint32_t)) = (bpm == &bpm_a ? 1000 : 2000) + i;
+					guard.MarkDirty();
+					if (bpm == &bpm_a) {
+						page_ids.push_back(guard.GetPageId());
+					}
+				}
+			}
+			Assert(bpm_a.GetResidentPageCount() + bpm_b->GetResidentPageCount() == pool_size, "Databases do not share the pool budget");
+
+			// pages come back from the database that wrote them, through each other's evictions
+			for (int i = 0; i < num_pages; i++) {
+				for (auto* bpm : { &bpm_a, bpm_b }) {
+					venus::buffer::PageGuard guard = bpm->FetchPageRead(page_ids[i]);
+					uint32_t value = *reinterpret_cast<const uint32_t*>(guard->GetData() + PAGE_SIZE - sizeof(uint32_t));
+					Assert(value == static_cast<uint32_t>((bpm == &bpm_a ? 1000 : 2000) + i), "Page read from the wrong database");
+				}
+			}
+
+			// a closed database leaves its frames to the others
+			delete bpm_b;
+			Assert(bpm_a.GetResidentPageCount() < pool_size, "Closed database kept its frames");
+			for (int i = 0; i < static_cast<int>(pool_size); i++) {
+				bpm_a.FetchPageRead(page_ids[i]);
+			}
+			Assert(bpm_a.GetResidentPageCount() == pool_size, "Frames of the closed database were not reused");
+		}
+
+		for (const auto& file : files) {
+			std::remove(file.c_str());
+		}
+	}
+
+	void TestSuite::TestMappedReads() {
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/mapped_test";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, true, 0);
+		schema.AddColumn("name", ColumnType::CHAR, false, 1);
+		page_id_t first_page_id;
+		std::vector<int> expected;
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::buffer::BufferPoolManager bpm(&disk_manager);
+			first_page_id = bpm.NewPageGuarded().GetPageId();
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+			for (int i = 0; i < 2000; i++) {
+				Assert(heap.InsertTuple({ std::to_string(i), "mapped" }), "Failed to insert row");
+				expected.push_back(i);
+			}
+			Assert(bpm.FlushAllPages(), "Failed to flush pages");
+		}
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db", venus::storage::DiskMode::MMAP_READ_ONLY);
+			venus::buffer::BufferPoolManager bpm(&disk_manager);
+			Assert(bpm.IsMapped(), "Read-only database is not mapped");
+
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+			std::vector<page_id_t> page_ids = heap.GetPageIds();
+			Assert(page_ids.size() > 1, "Table should span several pages");
+			bpm.AdvisePages(page_ids.data(), page_ids.size(), venus::storage::AccessHint::SEQUENTIAL);
+			Assert(ReadIds(heap, schema) == expected, "Rows read from the mapping differ");
+
+			// pages are the file's bytes in place, none was copied into the pool
+			venus::buffer::PageGuard guard = bpm.FetchPageRead(first_page_id);
+			Assert(guard && guard->GetData() == disk_manager.GetMappedPage(first_page_id), "Page was copied out of the mapping");
+			Assert(guard.GetPageId() == first_page_id, "Mapped guard has the wrong page id");
+			Assert(bpm.GetResidentPageCount() == 0, "Mapped reads used buffer pool frames");
+
+			bool refused = false;
+			try {
+				bpm.FetchPageWrite(first_page_id);
+			} catch (const std::exception&) {
+				refused = true;
+			}
+			Assert(refused, "Write latch granted on a read-only database");
+			refused = false;
+			try {
+				bpm.NewPageGuarded();
+			} catch (const std::exception&) {
+				refused = true;
+			}
+			Assert(refused, "Page allocated in a read-only database");
+		}
+
+		RemoveDatabaseFiles(path);
+
+		// a database opened read only has its log read, never written
+		const std::string db_path = std::string(DATABASE_DIRECTORY) + "/mapped_db";
+		auto read_log = [&]() {
+			std::ifstream in(db_path + ".log", std::ios::binary);
+			return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+		};
+		{
+			DatabaseManager writer;
+			ExecutionEngine* engine = writer.GetExecutionEngine();
+			Assert(engine->Execute("CREATE DATABASE mapped_db").success_ && engine->Execute("USE mapped_db").success_,
+			    "Failed to create database");
+			Assert(engine->Execute("CREATE TABLE mapped (id INT)").success_ && engine->Execute("INSERT INTO mapped VALUES (1), (2)").success_,
+			    "Failed to fill database");
+		}
+		std::string log = read_log();
+		{
+			DatabaseManager reader(venus::storage::DiskMode::MMAP_READ_ONLY);
+			ExecutionEngine* engine = reader.GetExecutionEngine();
+			Assert(engine->Execute("USE mapped_db").success_, "Cleanly closed database did not open read only");
+			Assert(reader.GetLogManager() == nullptr, "Read-only database has a log manager");
+			auto rows = engine->Execute("SELECT * FROM mapped");
+			Assert(rows.success_ && rows.data_ && rows.data_->GetSize() == 2, "Read-only select failed");
+		}
+		Assert(read_log() == log, "Read-only open changed the log");
+
+		// a record after the last checkpoint needs recovery, which a read-only open must not run
+		{
+			venus::recovery::LogManager log_manager(db_path + ".log");
+			venus::recovery::LogRecord record(venus::recovery::LogRecordType::BEGIN);
+			log_manager.AppendLogRecord(nullptr, &record);
+			log_manager.FlushAll();
+		}
+		log = read_log();
+		{
+			DatabaseManager reader(venus::storage::DiskMode::MMAP_READ_ONLY);
+			Assert(!reader.GetExecutionEngine()->Execute("USE mapped_db").success_, "Database that needs recovery opened read only");
+		}
+		Assert(read_log() == log, "Refused read-only open changed the log");
+		Assert(!std::filesystem::exists(db_path + ".log.tmp"), "Read-only open created a file");
+		RemoveDatabaseFiles(db_path);
+	}
+
+	void TestSuite::TestDirectIO() {
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/direct_test";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		const int num_pages = 32;
+		std::vector<page_id_t> page_ids;
+		{
+			// a pool smaller than the table, so pages are written back and read again with O_DIRECT
+			venus::buffer::BufferPool pool(8);
+			venus::storage::DiskManager disk_manager(path + ".db", venus::storage::DiskMode::DIRECT);
+			venus::buffer::BufferPoolManager bpm(&pool, &disk_manager);
+			for (int i = 0; i < num_pages; i++) {
+				venus::buffer::PageGuard guard = bpm.NewPageGuarded();
+				*reinterpret_cast<uint32_t*>(guard->GetData() + PAGE_SIZE - sizeof(uint32_t)) = 3000 + i;
+				guard.MarkDirty();
+				page_ids.push_back(guard.GetPageId());
+			}
+			for (int i = 0; i < num_pages; i++) {
+				venus::buffer::PageGuard guard = bpm.FetchPageRead(page_ids[i]);
+				uint32_t value = *reinterpret_cast<const uint32_t*>(guard->GetData() + PAGE_SIZE - sizeof(uint32_t));
+				Assert(value == static_cast<uint32_t>(3000 + i), "Page read back wrong with O_DIRECT");
+			}
+
+			// buffers that are not page aligned go through the bounce page
+			std::vector<char> unaligned(PAGE_SIZE + 1);
+			std::memset(unaligned.data() + 1, 'd', PAGE_SIZE);
+			disk_manager.SetSyncOnWrite(true);
+			disk_manager.WritePage(page_ids[0], unaligned.data() + 1);
+			std::memset(unaligned.data() + 1, 0, PAGE_SIZE);
+			disk_manager.ReadPage(page_ids[0], unaligned.data() + 1);
+			Assert(unaligned[1] == 'd' && unaligned[PAGE_SIZE] == 'd', "Unaligned page transfer failed");
+			Assert(bpm.FlushAllPages(), "Failed to flush pages");
+		}
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			std::vector<char> data(PAGE_SIZE);
+			for (int i = 1; i < num_pages; i++) {
+				disk_manager.ReadPage(page_ids[i], data.data());
+				uint32_t value = *reinterpret_cast<const uint32_t*>(data.data() + PAGE_SIZE - sizeof(uint32_t));
+				Assert(value == static_cast<uint32_t>(3000 + i), "Page written with O_DIRECT is not on disk");
+			}
+		}
+
+		RemoveDatabaseFiles(path);
+	}
+
+	void TestSuite::TestFreePageReuse() {
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/free_test";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		// more free pages than the first list page holds
+		const int num_pages = 1500;
+		std::vector<page_id_t> page_ids;
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::buffer::BufferPoolManager bpm(&disk_manager);
+			for (int i = 0; i < num_pages; i++) {
+				page_ids.push_back(bpm.NewPageGuarded().GetPageId());
+			}
+			for (int i = 1; i < num_pages; i++) {
+				Assert(bpm.DeletePage(page_ids[i]), "Failed to delete page");
+			}
+			Assert(disk_manager.GetFreePageCount() == num_pages - 1, "Deleted pages are not free");
+			Assert(bpm.NewPageGuarded().GetPageId() == page_ids[1], "Lowest free page was not reused");
+		}
+
+		{
+			// a frame a freed page was read into again is dropped when the page is handed out, not
+			// evicted over it
+			venus::buffer::BufferPool pool(4);
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::buffer::BufferPoolManager bpm(&pool, &disk_manager);
+			Assert(bpm.DeletePage(page_ids[1]), "Failed to delete page");
+			{
+				venus::buffer::PageGuard stale = bpm.FetchPageWrite(page_ids[1]);
+				stale->GetData()[PAGE_SIZE - 1] = 'x';
+				stale.MarkDirty();
+			}
+			Assert(bpm.NewPageGuarded().GetPageId() == page_ids[1], "Freed page was not reused");
+			for (int i = 2; i < 10; i++) {
+				bpm.FetchPageRead(page_ids[i]);
+			}
+			std::vector<char> data(PAGE_SIZE);
+			disk_manager.ReadPage(page_ids[1], data.data());
+			Assert(data[PAGE_SIZE - 1] != 'x', "Stale frame was written over the reused page");
+		}
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			Assert(disk_manager.GetFreePageCount() == num_pages - 2, "Free list was not persisted");
+			Assert(disk_manager.AllocatePage() == page_ids[2], "Free list lost its order");
+
+			uint32_t pages = disk_manager.GetNumberOfPages();
+			Assert(disk_manager.TruncateFreePages() == num_pages - 3, "Trailing free pages were not truncated");
+			Assert(disk_manager.GetNumberOfPages() == pages - (num_pages - 3), "Page count did not shrink");
+			Assert(std::filesystem::file_size(path + ".db") == static_cast<uintmax_t>(page_ids[2] + 1) * PAGE_SIZE, "File was not truncated");
+		}
+
+		// with a log, taking a free page only logs it and recovery knows the page is in use
+		const std::string image = std::string(DATABASE_DIRECTORY) + "/free_image";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+		auto read_stored_list = [](const std::string& file) {
+			std::vector<char> page(PAGE_SIZE);
+			std::ifstream in(file, std::ios::binary);
+			in.seekg(static_cast<std::streamoff>(FREE_LIST_PAGE_ID) * PAGE_SIZE);
+			in.read(page.data(), PAGE_SIZE);
+			return page;
+		};
+		std::vector<page_id_t> logged_ids;
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::recovery::LogManager log_manager(path + ".log");
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+			for (int i = 0; i < 8; i++) {
+				logged_ids.push_back(bpm.NewPageGuarded().GetPageId());
+			}
+			for (page_id_t page_id : logged_ids) {
+				Assert(bpm.DeletePage(page_id), "Failed to delete page");
+			}
+			disk_manager.ReleasePages(log_manager.GetNextLSN());
+			disk_manager.Sync();
+
+			std::vector<char> stored = read_stored_list(path + ".db");
+			for (int i = 0; i < 3; i++) {
+				Assert(bpm.NewPageGuarded().GetPageId() == logged_ids[i], "Free page was not reused");
+			}
+			Assert(read_stored_list(path + ".db") == stored, "Allocating rewrote the stored free list");
+			log_manager.FlushAll();
+			CopyCrashImage(path, image);
+		}
+		{
+			venus::storage::DiskManager disk_manager(image + ".db");
+			Assert(disk_manager.GetFreePageCount() == 8, "Stored free list is wrong");
+			venus::recovery::LogManager log_manager(image + ".log");
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+			venus::recovery::LogRecovery(&bpm, &log_manager, nullptr).Recover();
+			Assert(disk_manager.GetFreePageCount() == 5, "Recovery did not apply the logged allocations");
+			Assert(disk_manager.AllocatePage() == logged_ids[3], "A page in use was handed out again");
+		}
+		RemoveDatabaseFiles(image);
+
+		// dropped tables are reused once a checkpoint makes it safe
+		auto result = engine_->Execute("CREATE TABLE churn (id INT, name CHAR)");
+		Assert(result.success_, "Failed to create churn table");
+		std::string query = "INSERT INTO churn VALUES ";
+		for (int i = 0; i < 1000; i++) {
+			query += (i > 0 ? ", (" : "(") + std::to_string(i) + ", 'churn')";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill churn table");
+
+		TableRef* ref = db_manager_->GetCatalogManager()->GetTableRef("churn");
+		page_id_t held_page_id = ref->GetFirstPageId();
+		delete ref->schema;
+		delete ref;
+
+		// a page a running scan still holds is freed once the scan lets go of it
+		venus::concurrency::GarbageCollector* gc = db_manager_->GetGarbageCollector();
+		{
+			venus::buffer::PageGuard held = db_manager_->GetBufferPoolManager()->FetchPageRead(held_page_id);
+			Assert(engine_->Execute("DROP TABLE churn").success_, "Failed to drop churn table");
+			gc->CollectGarbage();
+			Assert(gc->GetUnlinkedPageCount() >= 1, "Pinned page of the dropped table was not kept");
+		}
+		// the background checkpoint may pin a page for a moment too
+		for (int round = 0; round < 100 && gc->GetUnlinkedPageCount() > 0; round++) {
+			gc->CollectGarbage();
+		}
+		Assert(gc->GetUnlinkedPageCount() == 0, "Pinned page of the dropped table was never freed");
+
+		venus::storage::DiskManager* disk_manager = db_manager_->GetDiskManager();
+		db_manager_->GetCheckpointManager()->Checkpoint();
+		size_t free_pages = disk_manager->GetFreePageCount();
+		Assert(free_pages > 1, "Dropped table did not free its pages");
+
+		uint32_t pages = disk_manager->GetNumberOfPages();
+		Assert(engine_->Execute("CREATE TABLE churn (id INT, name CHAR)").success_, "Failed to recreate churn table");
+		Assert(engine_->Execute(query).success_, "Failed to refill churn table");
+		Assert(disk_manager->GetNumberOfPages() == pages, "File grew although free pages were left");
+		Assert(engine_->Execute("SELECT * FROM churn").data_->GetSize() == 1000, "Rows lost on reused pages");
+
+		result = engine_->Execute("VACUUM FILE");
+		Assert(result.success_, "VACUUM FILE failed: " + result.message_);
+		// nothing resident belongs to a page that was cut off
+		bool flushed = true;
+		try {
+			db_manager_->FlushAllPages();
+		} catch (const std::exception&) {
+			flushed = false;
+		}
+		Assert(flushed, "Pages were written after VACUUM FILE cut them off");
+		Assert(engine_->Execute("SELECT * FROM churn").data_->GetSize() == 1000, "Rows lost after VACUUM FILE");
+		Assert(engine_->Execute("DROP TABLE churn").success_, "Failed to drop churn table");
+
+		RemoveDatabaseFiles(path);
+
+		// a dropped table with dead versions is not visited by the collector anymore, its pages
+		// may already belong to another table
+		const std::string db_path = std::string(DATABASE_DIRECTORY) + "/free_db";
+		RemoveDatabaseFiles(db_path);
+		std::string values = query.substr(query.find(" VALUES "));
+		{
+			DatabaseManager manager;
+			ExecutionEngine* engine = manager.GetExecutionEngine();
+			Assert(engine->Execute("CREATE DATABASE free_db").success_ && engine->Execute("USE free_db").success_, "Failed to create database");
+			Assert(engine->Execute("CREATE TABLE kept (id INT, name CHAR)").success_, "Failed to create kept table");
+			Assert(engine->Execute("INSERT INTO kept" + values).success_, "Failed to fill kept table");
+			Assert(engine->Execute("CREATE TABLE dead (id INT, name CHAR)").success_, "Failed to create dead table");
+			Assert(engine->Execute("INSERT INTO dead" + values).success_, "Failed to fill dead table");
+			Assert(engine->Execute("DELETE FROM dead WHERE id < 500").success_, "Failed to delete from dead table");
+			// on disk, a round that walks the dropped chain finds the old rows
+			manager.FlushAllPages();
+			Assert(engine->Execute("DROP TABLE dead").success_, "Failed to drop dead table");
+
+			venus::concurrency::GarbageCollector* collector = manager.GetGarbageCollector();
+			collector->CollectGarbage();
+			for (int round = 0; round < 100 && collector->GetUnlinkedPageCount() > 0; round++) {
+				collector->CollectGarbage();
+			}
+			// the freed pages are at the end of the file and cut off
+			manager.GetCheckpointManager()->Checkpoint();
+			result = engine->Execute("VACUUM FILE");
+			Assert(result.success_, "VACUUM FILE failed: " + result.message_);
+
+			flushed = true;
+			try {
+				manager.FlushAllPages();
+			} catch (const std::exception&) {
+				flushed = false;
+			}
+			Assert(flushed, "Pages of the dropped table were written after it was dropped");
+
+			// closing reports its errors on stderr
+			std::ostringstream errors;
+			std::streambuf* cerr_buffer = std::cerr.rdbuf(errors.rdbuf());
+			manager.Close();
+			std::cerr.rdbuf(cerr_buffer);
+			Assert(errors.str().empty(), "Database did not close cleanly: " + errors.str());
+		}
+		{
+			DatabaseManager manager;
+			ExecutionEngine* engine = manager.GetExecutionEngine();
+			Assert(engine->Execute("USE free_db").success_, "Failed to reopen database");
+			auto rows = engine->Execute("SELECT * FROM kept");
+			Assert(rows.success_ && rows.data_ && rows.data_->GetSize() == 1000, "Rows lost after VACUUM FILE");
+		}
+		RemoveDatabaseFiles(db_path);
+	}
+
+	void TestSuite::TestExtentAllocation() {
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/extent_test";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, true, 0);
+		schema.AddColumn("name", ColumnType::CHAR, false, 1);
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::buffer::BufferPoolManager bpm(&disk_manager);
+			venus::table::TableHeap heap_a(&bpm, &schema, bpm.NewPageGuarded().GetPageId());
+			venus::table::TableHeap heap_b(&bpm, &schema, bpm.NewPageGuarded().GetPageId());
+
+			// two tables growing at the same time still get pages in order
+			for (int i = 0; i < 1500; i++) {
+				Assert(heap_a.InsertTuple({ std::to_string(i), "a" }), "Failed to insert into heap a");
+				Assert(heap_b.InsertTuple({ std::to_string(i), "b" }), "Failed to insert into heap b");
+			}
+			for (auto* heap : { &heap_a, &heap_b }) {
+				std::vector<page_id_t> page_ids = heap->GetPageIds();
+				Assert(page_ids.size() > 4, "Heap should span several pages");
+				for (size_t i = 2; i < page_ids.size(); i++) {
+					Assert(page_ids[i] == page_ids[i - 1] + 1, "Heap pages are not contiguous");
+				}
+			}
+			Assert(disk_manager.GetNumberOfPages() >= FIRST_USABLE_PAGE_ID + 2 + 2 * EXTENT_PAGES, "Extents were not reserved");
+		}
+
+		// reserved pages nobody used are free after closing
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			Assert(disk_manager.GetFreePageCount() > 0, "Unused extent pages leaked");
+			Assert(disk_manager.TruncateFreePages() > 0, "Unused extent at the end was not truncated");
+		}
+
+		// and after a crash
+		const std::string image = std::string(DATABASE_DIRECTORY) + "/extent_image";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+		size_t used_pages;
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::recovery::LogManager log_manager(path + ".log");
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+			venus::table::TableHeap heap(&bpm, &schema, bpm.NewPageGuarded().GetPageId());
+			for (int i = 0; i < 1500; i++) {
+				Assert(heap.InsertTuple({ std::to_string(i), "crash" }), "Failed to insert into heap");
+			}
+			used_pages = heap.GetPageIds().size() - 1; // the first page is not in the extent
+			Assert(used_pages > 1 && used_pages < EXTENT_PAGES, "Heap should use part of one extent");
+			log_manager.FlushAll();
+			CopyCrashImage(path, image);
+		}
+		{
+			venus::storage::DiskManager disk_manager(image + ".db");
+			venus::recovery::LogManager log_manager(image + ".log");
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+			venus::recovery::LogRecovery(&bpm, &log_manager, nullptr).Recover();
+			Assert(disk_manager.GetFreePageCount() == EXTENT_PAGES - used_pages, "Unused extent pages leaked in a crash");
+		}
+
+		RemoveDatabaseFiles(image);
+		RemoveDatabaseFiles(path);
+	}
+
+	void TestSuite::TestWriteAheadLog() {
+		using venus::recovery::LogRecord;
+		using venus::recovery::LogRecordType;
+
+		venus::recovery::LogManager* log_manager = db_manager_->GetLogManager();
+		Assert(log_manager != nullptr, "Database has no log manager");
+
+		auto result = engine_->Execute("CREATE TABLE wal_test (id INT, name CHAR)");
+		Assert(result.success_, "Failed to create wal test table");
+
+		lsn_t start_lsn = log_manager->GetNextLSN();
+		result = engine_->Execute("INSERT INTO wal_test VALUES (7, 'seven')");
+		Assert(result.success_, "Failed to insert into wal test table");
+
+		// commit returned, so BEGIN, INSERT and COMMIT must already be durable
+		std::vector<LogRecord> records;
+		LogRecord record;
+		for (lsn_t lsn = start_lsn; log_manager->ReadLogRecord(lsn, &record); lsn += record.GetSize()) {
+			records.push_back(record);
+		}
+		Assert(records.size() == 3, "Expected 3 log records, got " + std::to_string(records.size()));
+		Assert(records[0].GetType() == LogRecordType::BEGIN
+		        && records[1].GetType() == LogRecordType::INSERT
+		        && records[2].GetType() == LogRecordType::COMMIT,
+		    "Unexpected log record types for an insert statement");
+
+		// records of a transaction are chained backwards
+		Assert(records[1].GetTxnId() == records[0].GetTxnId() && records[2].GetTxnId() == records[0].GetTxnId(),
+		    "Log records belong to different transactions");
+		Assert(records[1].GetPrevLSN() == records[0].GetLSN() && records[2].GetPrevLSN() == records[1].GetLSN(),
+		    "Log records are not chained by prev_lsn");
+
+		// insert record carries the tuple image
+		const Tuple& logged = records[1].GetTuple();
+		Assert(*reinterpret_cast<const int*>(logged.GetData() + sizeof(uint32_t)) == 7, "Logged tuple image is wrong");
+
+		// reads stay off the log
+		lsn_t before_select = log_manager->GetNextLSN();
+		result = engine_->Execute("SELECT * FROM wal_test");
+		Assert(result.success_ && log_manager->GetNextLSN() == before_select, "SELECT wrote to the log");
+	}
+
+	void TestSuite::TestGroupCommit() {
+		using venus::recovery::LogRecord;
+		using venus::recovery::LogRecordType;
+
+		const std::string log_file = std::string(DATABASE_DIRECTORY) + "/group_commit.log";
+		std::remove(log_file.c_str());
+
+		const int num_threads = 8;
+		const int commits_per_thread = 50;
+		uint64_t num_syncs;
+
+		{
+			venus::recovery::LogManager log_manager(log_file);
+			uint64_t syncs_before = log_manager.GetNumSyncs();
+
+			std::atomic<bool> failed(false);
+			std::vector<std::thread> threads;
+			for (int t = 0; t < num_threads; t++) {
+				threads.emplace_back([&, t]() {
+					try {
+						for (int i = 0; i < commits_per_thread; i++) {
+							venus::concurrency::Transaction txn(t * commits_per_thread + i);
+							char image[sizeof(uint32_t) + sizeof(int)];
+							uint32_t image_size = sizeof(image);
+							std::memcpy(image, &image_size, sizeof(uint32_t));
+							std::memcpy(image + sizeof(uint32_t), &i, sizeof(int));
+							LogRecord insert(LogRecordType::INSERT, RID(FIRST_USABLE_PAGE_ID, 0), Tuple(image, RID()));
+							log_manager.AppendLogRecord(&txn, &insert);
+
+							LogRecord commit(LogRecordType::COMMIT);
+							lsn_t commit_lsn = log_manager.AppendLogRecord(&txn, &commit);
+							log_manager.Flush(commit_lsn);
+							if (log_manager.GetPersistentLSN() < commit_lsn) {
+								failed = true;
+							}
+						}
+					} catch (const std::exception&) {
+						failed = true;
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			Assert(!failed, "A commit returned before its record was durable");
+			num_syncs = log_manager.GetNumSyncs() - syncs_before;
+		}
+
+		// reopen, every commit must be readable
+		int commits = 0;
+		{
+			venus::recovery::LogManager log_manager(log_file);
+			LogRecord record;
+			for (lsn_t lsn = venus::recovery::FIRST_LSN; log_manager.ReadLogRecord(lsn, &record); lsn += record.GetSize()) {
+				if (record.GetType() == LogRecordType::COMMIT) {
+					commits++;
+				}
+			}
+		}
+		std::remove(log_file.c_str());
+
+		std::cout << "    INFO: " << num_threads * commits_per_thread << " commits in " << num_syncs << " log syncs" << std::endl;
+		Assert(commits == num_threads * commits_per_thread, "Expected every commit in the log, got " + std::to_string(commits));
+		Assert(num_syncs < static_cast<uint64_t>(num_threads * commits_per_thread), "Commits were not grouped into shared log syncs");
+	}
+
+	void TestSuite::TestLogTruncation() {
+		using venus::recovery::FIRST_LSN;
+		using venus::recovery::LogRecord;
+		using venus::recovery::LogRecordType;
+
+		const std::string log_file = std::string(DATABASE_DIRECTORY) + "/truncate_test.log";
+		std::remove(log_file.c_str());
+
+		const int num_records = 20000;
+		lsn_t cut = INVALID_LSN;
+		lsn_t end;
+
+		{
+			venus::recovery::LogManager log_manager(log_file);
+			for (int i = 0; i < num_records; i++) {
+				LogRecord record(LogRecordType::COMMIT);
+				lsn_t lsn = log_manager.AppendLogRecord(nullptr, &record);
+				if (i == num_records * 3 / 4) {
+					cut = lsn;
+				}
+			}
+			log_manager.FlushAll();
+			end = log_manager.GetNextLSN();
+			Assert(std::filesystem::file_size(log_file) == end, "Log file does not end at the next LSN");
+
+			// too little to gain, the log is left as it is
+			log_manager.Truncate(FIRST_LSN + 1024);
+			Assert(log_manager.GetBaseLSN() == FIRST_LSN && std::filesystem::file_size(log_file) == end, "Small prefix was truncated");
+
+			log_manager.Truncate(cut);
+			Assert(log_manager.GetBaseLSN() == cut, "Log was not truncated");
+			Assert(std::filesystem::file_size(log_file) == FIRST_LSN + (end - cut), "Log file did not shrink");
+
+			LogRecord record;
+			Assert(log_manager.ReadLogRecord(cut, &record) && record.GetLSN() == cut, "Record at the cut is not readable");
+			Assert(!log_manager.ReadLogRecord(FIRST_LSN, &record), "Truncated record is still readable");
+
+			// LSNs carry on where they were
+			LogRecord last(LogRecordType::COMMIT);
+			Assert(log_manager.AppendLogRecord(nullptr, &last) == end, "Truncation changed the next LSN");
+			log_manager.FlushAll();
+			end = log_manager.GetNextLSN();
+		}
+
+		{
+			venus::recovery::LogManager log_manager(log_file);
+			Assert(log_manager.GetBaseLSN() == cut && log_manager.GetNextLSN() == end, "Reopened log lost its base or end");
+
+			int records = 0;
+			LogRecord record;
+			for (lsn_t lsn = cut; log_manager.ReadLogRecord(lsn, &record); lsn += record.GetSize()) {
+				records++;
+			}
+			Assert(records == num_records / 4 + 1, "Expected every record after the cut, got " + std::to_string(records));
+		}
+		std::remove(log_file.c_str());
+	}
+
+	void TestSuite::TestCrashRecovery() {
+		using venus::recovery::LogRecovery;
+
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/crash_test";
+		const std::string image = std::string(DATABASE_DIRECTORY) + "/crash_image";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, true, 0);
+		schema.AddColumn("name", ColumnType::CHAR, false, 1);
+		page_id_t first_page_id;
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::recovery::LogManager log_manager(path + ".log");
+			venus::concurrency::TransactionManager txn_manager(&log_manager);
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+
+			first_page_id = bpm.NewPageGuarded().GetPageId();
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+
+			// committed, but only in the log
+			venus::concurrency::Transaction* winner = txn_manager.Begin();
+			for (int i = 0; i < 200; i++) {
+				Assert(heap.InsertTuple({ std::to_string(i), "row" }, winner), "Failed to insert committed row");
+			}
+			txn_manager.Commit(winner);
+
+			// never commits: inserts, deletes and updates that must all be rolled back
+			venus::concurrency::Transaction* loser = txn_manager.Begin();
+			for (int i = 0; i < 50; i++) {
+				Assert(heap.InsertTuple({ std::to_string(1000 + i), "loser" }, loser), "Failed to insert uncommitted row");
+			}
+			int n = 0;
+			for (auto it = heap.begin(); it != heap.end(); ++it, n++) {
+				RID rid = it->GetRID();
+				if (n % 10 == 0) {
+					Assert(heap.DeleteTuple(rid, loser), "Failed to delete row");
+				} else if (n % 10 == 5) {
+					std::vector<char> data(it->GetData(), it->GetData() + it->GetSize());
+					int changed = -1;
+					std::memcpy(data.data() + sizeof(uint32_t), &changed, sizeof(int));
+					Assert(heap.UpdateTuple(Tuple(data.data(), rid), rid, loser), "Failed to update row");
+				}
+			}
+
+			// the loser's changes to the first page are stolen to disk, its log records are durable
+			bpm.FlushPage(first_page_id);
+			log_manager.FlushAll();
+			CopyCrashImage(path, image);
+		}
+
+		std::vector<int> expected(200);
+		for (int i = 0; i < 200; i++) {
+			expected[i] = i;
+		}
+
+		{
+			venus::storage::DiskManager disk_manager(image + ".db");
+			venus::recovery::LogManager log_manager(image + ".log");
+			venus::concurrency::TransactionManager txn_manager(&log_manager);
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+
+			LogRecovery recovery(&bpm, &log_manager, &txn_manager);
+			recovery.Recover();
+			Assert(recovery.GetRedoCount() > 0, "Recovery redid nothing");
+			Assert(recovery.GetLoserCount() == 1, "Expected one loser, got " + std::to_string(recovery.GetLoserCount()));
+			Assert(txn_manager.GetNextTxnId() >= 2, "Transaction ids are reused after recovery");
+
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+			Assert(ReadIds(heap, schema) == expected, "Recovered table does not match the committed rows");
+		}
+
+		// undo logged CLRs and an ABORT, so recovering the same log again changes nothing
+		{
+			venus::storage::DiskManager disk_manager(image + ".db");
+			venus::recovery::LogManager log_manager(image + ".log");
+			venus::concurrency::TransactionManager txn_manager(&log_manager);
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+
+			LogRecovery recovery(&bpm, &log_manager, &txn_manager);
+			recovery.Recover();
+			Assert(recovery.GetRedoCount() == 0 && recovery.GetLoserCount() == 0, "Second recovery repeated work");
+
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+			Assert(ReadIds(heap, schema) == expected, "Second recovery changed the table");
+		}
+
+		RemoveDatabaseFiles(path);
+		RemoveDatabaseFiles(image);
+	}
+
+	void TestSuite::TestCheckpoint() {
+		using venus::recovery::LogRecord;
+		using venus::recovery::LogRecordType;
+
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/checkpoint_test";
+		const std::string image = std::string(DATABASE_DIRECTORY) + "/checkpoint_image";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, true, 0);
+		schema.AddColumn("name", ColumnType::CHAR, false, 1);
+		page_id_t first_page_id;
+		lsn_t last_begin_lsn;
+		const int bulk_rows = 5000;
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::recovery::LogManager log_manager(path + ".log");
+			venus::concurrency::TransactionManager txn_manager(&log_manager);
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+			venus::recovery::CheckpointManager checkpoint_manager(&bpm, &disk_manager, &log_manager, &txn_manager);
+
+			first_page_id = bpm.NewPageGuarded().GetPageId();
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+
+			lsn_t previous = INVALID_LSN;
+			lsn_t previous_begin = venus::recovery::FIRST_LSN;
+			for (int round = 0; round < 3; round++) {
+				venus::concurrency::Transaction* txn = txn_manager.Begin();
+				for (int i = 0; i < 100; i++) {
+					Assert(heap.InsertTuple({ std::to_string(round * 100 + i), "row" }, txn), "Failed to insert row");
+				}
+				txn_manager.Commit(txn);
+
+				lsn_t checkpoint_lsn = checkpoint_manager.Checkpoint();
+				Assert(log_manager.GetCheckpointLSN() == checkpoint_lsn, "Master record does not point at the checkpoint");
+				Assert(previous == INVALID_LSN || checkpoint_lsn > previous, "Checkpoint did not advance");
+
+				// pages dirty since before the previous checkpoint were written back
+				LogRecord record;
+				Assert(log_manager.ReadLogRecord(checkpoint_lsn, &record) && record.GetType() == LogRecordType::CHECKPOINT,
+				    "Checkpoint record is not readable");
+				for (const auto& entry : record.GetDirtyPages()) {
+					Assert(entry.second >= previous_begin, "Checkpoint kept a page dirty since before the previous checkpoint");
+				}
+				previous = checkpoint_lsn;
+				previous_begin = record.GetBeginLSN();
+			}
+
+			auto insert_committed = [&](int from) {
+				venus::concurrency::Transaction* txn = txn_manager.Begin();
+				for (int i = 0; i < bulk_rows; i++) {
+					Assert(heap.InsertTuple({ std::to_string(from + i), "bulk" }, txn), "Failed to insert row");
+				}
+				txn_manager.Commit(txn);
+			};
+
+			// the second checkpoint wrote the pages back, nothing before its begin_lsn is needed
+			insert_committed(1000);
+			uintmax_t log_size = std::filesystem::file_size(path + ".log");
+			checkpoint_manager.Checkpoint();
+			lsn_t checkpoint_lsn = checkpoint_manager.Checkpoint();
+			LogRecord record;
+			Assert(log_manager.ReadLogRecord(checkpoint_lsn, &record), "Checkpoint record is not readable");
+			Assert(log_manager.GetBaseLSN() == record.GetBeginLSN(), "Checkpoint did not truncate the log");
+			Assert(std::filesystem::file_size(path + ".log") < log_size / 10, "Log did not shrink after the checkpoint");
+
+			// a transaction in flight at the checkpoint is in its active transaction table
+			venus::concurrency::Transaction* open_txn = txn_manager.Begin();
+			Assert(heap.InsertTuple({ "-1", "open" }, open_txn), "Failed to insert uncommitted row");
+
+			// and keeps its records in the log, however much is logged after them
+			insert_committed(1000 + bulk_rows);
+			checkpoint_manager.Checkpoint();
+			checkpoint_lsn = checkpoint_manager.Checkpoint();
+			Assert(log_manager.GetBaseLSN() <= open_txn->GetFirstLSN(), "Log truncated below an active transaction");
+
+			log_manager.ReadLogRecord(checkpoint_lsn, &record);
+			bool found = false;
+			for (const auto& entry : record.GetActiveTxns()) {
+				found = found || entry.first == open_txn->GetTxnId();
+			}
+			Assert(found, "Active transaction missing from the checkpoint");
+			last_begin_lsn = record.GetBeginLSN();
+
+			log_manager.FlushAll();
+			CopyCrashImage(path, image);
+		}
+
+		{
+			venus::storage::DiskManager disk_manager(image + ".db");
+			venus::recovery::LogManager log_manager(image + ".log");
+			venus::concurrency::TransactionManager txn_manager(&log_manager);
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+
+			venus::recovery::LogRecovery recovery(&bpm, &log_manager, &txn_manager);
+			recovery.Recover();
+			Assert(recovery.GetAnalysisStartLSN() == last_begin_lsn, "Recovery did not start at the last checkpoint");
+			Assert(recovery.GetLoserCount() == 1, "Transaction open at the checkpoint was not rolled back");
+
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+			Assert(ReadIds(heap, schema).size() == static_cast<size_t>(300 + 2 * bulk_rows), "Recovered table lost committed rows");
+		}
+
+		RemoveDatabaseFiles(path);
+		RemoveDatabaseFiles(image);
+	}
+
+	void TestSuite::TestTransactions() {
+		auto result = engine_->Execute("CREATE TABLE accounts (id INT, owner CHAR, balance FLOAT)");
+		Assert(result.success_, "Failed to create accounts table");
+		result = engine_->Execute("INSERT INTO accounts VALUES (1, 'ann', 100.0), (2, 'ben', 50.0), (3, 'cat', 10.0)");
+		Assert(result.success_, "Failed to insert accounts");
+
+		result = engine_->Execute("UPDATE accounts SET balance = 75.0 WHERE id = 2");
+		Assert(result.success_ && result.message_ == "Updated 1 rows in accounts", "Unexpected UPDATE result: " + result.message_);
+		result = engine_->Execute("SELECT * FROM accounts WHERE balance = 75.0");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Updated row not found");
+
+		result = engine_->Execute("DELETE FROM accounts WHERE id = 3");
+		Assert(result.success_ && result.message_ == "Deleted 1 rows from accounts", "Unexpected DELETE result: " + result.message_);
+
+		// changes of an explicit transaction are visible to itself and undone by ROLLBACK
+		Assert(engine_->Execute("BEGIN").success_, "BEGIN failed");
+		result = engine_->Execute("DELETE FROM accounts");
+		Assert(result.message_ == "Deleted 2 rows from accounts", "Unexpected DELETE result: " + result.message_);
+		result = engine_->Execute("SELECT * FROM accounts");
+		Assert(result.success_ && !result.data_, "Transaction still sees its deleted rows");
+		Assert(engine_->Execute("ROLLBACK").success_, "ROLLBACK failed");
+
+		result = engine_->Execute("SELECT * FROM accounts");
+		Assert(result.data_ && result.data_->GetSize() == 2, "ROLLBACK did not restore the rows");
+
+		Assert(engine_->Execute("BEGIN").success_, "BEGIN failed");
+		Assert(engine_->Execute("UPDATE accounts SET owner = 'dan' WHERE id = 1").success_, "UPDATE in transaction failed");
+		Assert(engine_->Execute("COMMIT").success_, "COMMIT failed");
+
+		result = engine_->Execute("SELECT * FROM accounts WHERE owner = 'dan'");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Committed UPDATE is not visible");
+		result = engine_->Execute("SELECT * FROM accounts");
+		Assert(result.data_ && result.data_->GetSize() == 2, "UPDATE left the old version visible");
+
+		Assert(!engine_->Execute("COMMIT").success_, "COMMIT without a transaction should fail");
+	}
+
+	void TestSuite::TestSnapshotIsolation() {
+		using venus::concurrency::Transaction;
+
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/mvcc_test";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, true, 0);
+		schema.AddColumn("name", ColumnType::CHAR, false, 1);
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::recovery::LogManager log_manager(path + ".log");
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+			venus::concurrency::TransactionManager txn_manager(&log_manager, &bpm);
+			venus::concurrency::GarbageCollector gc(&bpm, &txn_manager);
+
+			venus::table::TableHeap heap(&bpm, &schema, bpm.NewPageGuarded().GetPageId());
+			auto find = [&](int id, Transaction* txn) {
+				for (auto it = heap.begin(txn); it != heap.end(); ++it) {
+					if (*reinterpret_cast<const int*>(it->GetValue(0, &schema)) == id) {
+						return it->GetRID();
+					}
+				}
+				return RID();
+			};
+
+			Transaction* setup = txn_manager.Begin();
+			for (int i = 0; i < 10; i++) {
+				Assert(heap.InsertTuple({ std::to_string(i), "row" }, setup), "Failed to insert row");
+			}
+			txn_manager.Commit(setup);
+
+			Transaction* reader = txn_manager.Begin();
+			Transaction* writer = txn_manager.Begin();
+			Assert(heap.InsertTuple({ "100", "new" }, writer), "Failed to insert row");
+			Assert(heap.DeleteTuple(find(0, writer), writer), "Failed to delete row");
+
+			RID rid = find(1, writer);
+			std::unique_ptr<Tuple> old_version(heap.GetTuple(rid, writer));
+			std::vector<char> data(old_version->GetData(), old_version->GetData() + old_version->GetSize());
+			std::memcpy(data.data() + sizeof(uint32_t) + sizeof(int), "moved", 6);
+			Assert(heap.UpdateTuple(Tuple(data.data(), RID()), rid, writer), "Failed to update row");
+
+			// a second writer on the same version loses
+			Transaction* other = txn_manager.Begin();
+			bool conflict = false;
+			try {
+				heap.DeleteTuple(find(0, reader), other);
+			} catch (const std::runtime_error&) {
+				conflict = true;
+			}
+			Assert(conflict, "Concurrent delete of the same version did not conflict");
+			txn_manager.Abort(other);
+
+			std::vector<int> before = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+			Assert(ReadIds(heap, schema, reader) == before, "Reader sees uncommitted changes");
+			txn_manager.Commit(writer);
+			Assert(ReadIds(heap, schema, reader) == before, "Reader sees changes committed after its snapshot");
+
+			Transaction* later = txn_manager.Begin();
+			std::vector<int> after = ReadIds(heap, schema, later);
+			std::sort(after.begin(), after.end());
+			Assert(after == std::vector<int>({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 100 }), "New snapshot misses committed changes");
+			std::unique_ptr<Tuple> new_version(heap.GetTuple(find(1, later), later));
+			Assert(std::string(new_version->GetValue(1, &schema)) == "moved", "New snapshot sees the old version");
+			txn_manager.Commit(later);
+
+			// the old versions are kept while the reader can still see them
+			Assert(gc.CollectGarbage() == 0, "Collected versions visible to a running snapshot");
+			txn_manager.Commit(reader);
+			Assert(gc.CollectGarbage() == 2, "Expected the deleted and the updated version to be collected");
+
+			// rolled back deletes are visible again
+			Transaction* rollback = txn_manager.Begin();
+			for (int i = 1; i < 10; i++) {
+				Assert(heap.DeleteTuple(find(i, rollback), rollback), "Failed to delete row");
+			}
+			Assert(ReadIds(heap, schema, rollback) == std::vector<int>({ 100 }), "Deletes are not visible to their transaction");
+			txn_manager.Abort(rollback);
+			Assert(ReadIds(heap, schema).size() == 10, "Rollback did not restore the deleted rows");
+		}
+
+		RemoveDatabaseFiles(path);
+	}
+
+	void TestSuite::TestPageCompaction() {
+		using venus::concurrency::Transaction;
+		using venus::recovery::LogRecovery;
+
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/compact_test";
+		const std::string image = std::string(DATABASE_DIRECTORY) + "/compact_image";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, true, 0);
+		schema.AddColumn("name", ColumnType::CHAR, false, 1);
+		page_id_t first_page_id;
+		std::vector<int> expected;
+		size_t pages_after_vacuum;
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::recovery::LogManager log_manager(path + ".log");
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+			venus::concurrency::TransactionManager txn_manager(&log_manager, &bpm);
+			venus::concurrency::GarbageCollector gc(&bpm, &txn_manager);
+
+			first_page_id = bpm.NewPageGuarded().GetPageId();
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+
+			Transaction* txn = txn_manager.Begin();
+			for (int i = 0; i < 2000; i++) {
+				Assert(heap.InsertTuple({ std::to_string(i), "row" }, txn), "Failed to insert row");
+			}
+			txn_manager.Commit(txn);
+			size_t pages = heap.GetPageIds().size();
+
+			// three of four rows go, their slots and bytes are reused by new rows
+			txn = txn_manager.Begin();
+			for (auto it = heap.begin(txn); it != heap.end(); ++it) {
+				if (*reinterpret_cast<const int*>(it->GetValue(0, &schema)) % 4 != 0) {
+					Assert(heap.DeleteTuple(it->GetRID(), txn), "Failed to delete row");
+				}
+			}
+			txn_manager.Commit(txn);
+			Assert(gc.CollectGarbage() == 1500, "Deleted versions were not collected");
+
+			txn = txn_manager.Begin();
+			for (int i = 2000; i < 2500; i++) {
+				Assert(heap.InsertTuple({ std::to_string(i), "new" }, txn), "Failed to insert row");
+			}
+			txn_manager.Commit(txn);
+			Assert(heap.GetPageIds().size() == pages, "Heap grew although dead slots were free");
+
+			// the rows of the tail pages move forward, the emptied pages leave the chain
+			txn = txn_manager.Begin();
+			Assert(heap.MergePages(txn) > 0, "No rows were moved");
+			txn_manager.Commit(txn);
+			// began before the unlink, so it may have listed the pages already (a parallel scan)
+			Transaction* reader = txn_manager.Begin();
+			gc.CollectGarbage();
+			pages_after_vacuum = heap.GetPageIds().size();
+			Assert(pages_after_vacuum <= pages / 2 + 1, "Sparse pages were not merged, " + std::to_string(pages_after_vacuum) + " of " + std::to_string(pages) + " pages left");
+			Assert(gc.GetUnlinkedPageCount() > 0, "Empty pages were not unlinked");
+			gc.CollectGarbage();
+			Assert(gc.GetUnlinkedPageCount() > 0, "Unlinked pages were freed while an older transaction runs");
+			txn_manager.Commit(reader);
+			gc.CollectGarbage();
+			Assert(gc.GetUnlinkedPageCount() == 0, "Unlinked pages were not freed");
+
+			for (int i = 0; i < 2500; i++) {
+				if (i >= 2000 || i % 4 == 0) {
+					expected.push_back(i);
+				}
+			}
+			std::vector<int> ids = ReadIds(heap, schema);
+			std::sort(ids.begin(), ids.end());
+			Assert(ids == expected, "Rows changed while compacting");
+
+			// pages stay in the buffer pool, recovery has to rebuild them from the log
+			log_manager.FlushAll();
+			CopyCrashImage(path, image);
+		}
+
+		{
+			venus::storage::DiskManager disk_manager(image + ".db");
+			venus::recovery::LogManager log_manager(image + ".log");
+			venus::concurrency::TransactionManager txn_manager(&log_manager);
+			venus::buffer::BufferPoolManager bpm(&disk_manager, &log_manager);
+
+			LogRecovery recovery(&bpm, &log_manager, &txn_manager);
+			recovery.Recover();
+
+			venus::table::TableHeap heap(&bpm, &schema, first_page_id);
+			std::vector<int> ids = ReadIds(heap, schema);
+			std::sort(ids.begin(), ids.end());
+			Assert(ids == expected, "Recovered table does not match the compacted one");
+			Assert(heap.GetPageIds().size() == pages_after_vacuum, "Recovered chain still has the unlinked pages");
+		}
+
+		// VACUUM <table> through SQL
+		Assert(engine_->Execute("CREATE TABLE sparse (id INT, name CHAR)").success_, "Failed to create sparse table");
+		std::string query = "INSERT INTO sparse VALUES ";
+		for (int i = 0; i < 1000; i++) {
+			query += (i > 0 ? ", (" : "(") + std::to_string(i) + ", 'sparse')";
+		}
+		Assert(engine_->Execute(query).success_, "Failed to fill sparse table");
+		Assert(engine_->Execute("DELETE FROM sparse WHERE id > 99").success_, "Failed to delete rows");
+		auto result = engine_->Execute("VACUUM sparse");
+		Assert(result.success_, "VACUUM sparse failed: " + result.message_);
+		Assert(engine_->Execute("SELECT * FROM sparse").data_->GetSize() == 100, "VACUUM changed the rows");
+		Assert(engine_->Execute("DROP TABLE sparse").success_, "Failed to drop sparse table");
+
+		RemoveDatabaseFiles(path);
+		RemoveDatabaseFiles(image);
+	}
+
+	void TestSuite::TestLockManager() {
+		using venus::concurrency::LockManager;
+		using venus::concurrency::LockMode;
+		using venus::concurrency::Transaction;
+
+		Assert(LockManager::Compatible(LockMode::INTENTION_EXCLUSIVE, LockMode::INTENTION_EXCLUSIVE), "IX should be compatible with IX");
+		Assert(!LockManager::Compatible(LockMode::SHARED, LockMode::INTENTION_EXCLUSIVE), "S should conflict with IX");
+
+		{
+			LockManager lock_manager;
+			venus::concurrency::TransactionManager txn_manager(nullptr, nullptr, &lock_manager);
+			const RID row(1, 0);
+
+			// shared locks are held together, exclusive waits for both
+			Transaction* reader1 = txn_manager.Begin();
+			Transaction* reader2 = txn_manager.Begin();
+			lock_manager.LockRow(reader1, LockMode::SHARED, 0, row);
+			lock_manager.LockRow(reader2, LockMode::SHARED, 0, row);
+
+			Transaction* writer = txn_manager.Begin();
+			std::atomic<bool> granted(false);
+			std::thread waiter([&]() {
+				lock_manager.LockRow(writer, LockMode::EXCLUSIVE, 0, row);
+				granted = true;
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			Assert(!granted, "Exclusive lock granted while shared locks are held");
+			txn_manager.Commit(reader1);
+			txn_manager.Commit(reader2);
+			waiter.join();
+			Assert(granted, "Exclusive lock not granted after release");
+			txn_manager.Commit(writer);
+
+			// two transactions waiting for each other, the younger one is the victim
+			Transaction* older = txn_manager.Begin();
+			Transaction* younger = txn_manager.Begin();
+			lock_manager.LockRow(older, LockMode::EXCLUSIVE, 0, RID(1, 1));
+			lock_manager.LockRow(younger, LockMode::EXCLUSIVE, 0, RID(1, 2));
+
+			std::atomic<bool> younger_failed(false);
+			std::thread t1([&]() {
+				try {
+					lock_manager.LockRow(younger, LockMode::EXCLUSIVE, 0, RID(1, 1));
+				} catch (const std::runtime_error&) {
+					younger_failed = true;
+				}
+				if (younger_failed) {
+					txn_manager.Abort(younger);
+				}
+			});
+			std::thread t2([&]() { lock_manager.LockRow(older, LockMode::EXCLUSIVE, 0, RID(1, 2)); });
+
+			size_t victims = 0;
+			for (int i = 0; i < 200 && victims == 0; i++) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				victims = lock_manager.DetectDeadlocks();
+			}
+			t1.join();
+			t2.join();
+			Assert(victims == 1 && younger_failed, "Deadlock was not resolved by aborting the younger transaction");
+			txn_manager.Commit(older);
+		}
+
+		const std::string path = std::string(DATABASE_DIRECTORY) + "/lock_test";
+		RemoveDatabaseFiles(path);
+		std::ofstream(path + ".db", std::ios::binary).close();
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, true, 0);
+
+		{
+			venus::storage::DiskManager disk_manager(path + ".db");
+			venus::buffer::BufferPoolManager bpm(&disk_manager);
+			LockManager lock_manager;
+			lock_manager.Start();
+			venus::concurrency::TransactionManager txn_manager(nullptr, &bpm, &lock_manager);
+
+			venus::table::TableHeap heap(&bpm, &schema, bpm.NewPageGuarded().GetPageId());
+			for (int i = 0; i < 3; i++) {
+				Assert(heap.InsertTuple({ std::to_string(i) }, nullptr), "Failed to insert row");
+			}
+			std::vector<RID> rids;
+			for (auto it = heap.begin(); it != heap.end(); ++it) {
+				rids.push_back(it->GetRID());
+			}
+
+			// writers of disjoint rows do not wait for each other
+			Transaction* a = txn_manager.Begin();
+			Transaction* b = txn_manager.Begin();
+			std::atomic<int> deleted(0);
+			std::thread ta([&]() { deleted += heap.DeleteTuple(rids[0], a); });
+			std::thread tb([&]() { deleted += heap.DeleteTuple(rids[1], b); });
+			ta.join();
+			tb.join();
+			Assert(deleted == 2, "Deletes of disjoint rows failed");
+
+			// a writer of the same row waits until the holder finishes
+			std::atomic<bool> done(false);
+			bool result = false;
+			Transaction* c = txn_manager.Begin();
+			std::thread tc([&]() {
+				result = heap.DeleteTuple(rids[0], c);
+				done = true;
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			Assert(!done, "Delete of a locked row did not wait");
+			txn_manager.Abort(a);
+			tc.join();
+			Assert(result, "Delete after the holder rolled back failed");
+
+			txn_manager.Commit(b);
+			txn_manager.Commit(c);
+			Assert(ReadIds(heap, schema).size() == 1, "Expected one row left");
+		}
+
+		RemoveDatabaseFiles(path);
+	}
+
+	void TestSuite::TestNetworkServer() {
+		using venus::network::Client;
+
+		uint16_t port = db_manager_->Serve(0, true);
+
+		Client admin;
+		admin.Connect("127.0.0.1", port);
+		Assert(admin.Query("USE test_db").success_, "USE over the network failed");
+		auto result = admin.Query("CREATE TABLE net_items (id INT, name CHAR)");
+		Assert(result.success_, "CREATE TABLE over the network failed: " + result.message_);
+
+		// clients insert through prepared statements at the same time
+		const int clients = 4;
+		const int rows_per_client = 100;
+		std::atomic<int> failures(0);
+		std::vector<std::thread> threads;
+		for (int c = 0; c < clients; c++) {
+			threads.emplace_back([&, c]() {
+				try {
+					Client client;
+					client.Connect("127.0.0.1", port);
+					bool ok = client.Query("USE test_db").success_;
+					ok = ok && client.Prepare("add", "INSERT INTO net_items VALUES (?, ?)").success_;
+					for (int i = 0; ok && i < rows_per_client; i++) {
+						ok = client.Execute("add", { std::to_string(c * rows_per_client + i), "client" + std::to_string(c) }).success_;
+					}
+					failures += ok ? 0 : 1;
+				} catch (const std::exception&) {
+					failures++;
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		Assert(failures == 0, "Concurrent clients failed to insert");
+
+		// more rows than one batch
+		result = admin.Query("SELECT * FROM net_items");
+		Assert(result.success_ && result.data_ && result.data_->GetSize() == clients * rows_per_client,
+		    "Expected " + std::to_string(clients * rows_per_client) + " rows over the network");
+		result = admin.Query("SELECT * FROM net_items WHERE id = 123");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Filtered SELECT over the network failed");
+		const Schema& schema = result.data_->GetSchema();
+		const Tuple& row = result.data_->GetTuples()[0];
+		Assert(*reinterpret_cast<const int*>(row.GetValue(0, &schema)) == 123 && std::string(row.GetValue(1, &schema)) == "client1",
+		    "Row decoded incorrectly");
+
+		// errors and session state
+		Assert(!admin.Query("SELECT * FROM missing_table").success_, "Query on a missing table should fail");
+		Assert(!admin.Execute("missing", {}).success_, "Unknown prepared statement should fail");
+		Assert(admin.Query("BEGIN").success_ && admin.InTransaction(), "Session is not in a transaction after BEGIN");
+		Assert(admin.Query("ROLLBACK").success_ && !admin.InTransaction(), "Session is still in a transaction after ROLLBACK");
+
+		// every session has its own current database
+		Client other;
+		other.Connect("127.0.0.1", port);
+		Assert(!other.Query("USE missing_db").success_, "USE of a missing database should fail");
+		Assert(other.Query("CREATE DATABASE net_other_db").success_ && other.Query("USE net_other_db").success_,
+		    "USE of a second database failed");
+		Assert(other.Query("CREATE TABLE other_items (id INT)").success_, "CREATE TABLE in the second database failed");
+		Assert(!admin.Query("SELECT * FROM other_items").success_, "Table of the second database seen from the first");
+		Assert(admin.Query("SELECT * FROM net_items WHERE id = 7").success_, "First session lost its database");
+		Assert(!admin.Query("DROP DATABASE net_other_db").success_, "Dropped a database in use");
+		Assert(other.Query("USE test_db").success_ && other.Query("SELECT * FROM net_items WHERE id = 7").success_,
+		    "Switching back to an open database failed");
+		Assert(admin.Query("DROP DATABASE net_other_db").success_, "DROP DATABASE of an unused database failed");
+		other.Query("EXIT");
+		Assert(!other.IsConnected(), "EXIT did not end the session");
+
+		admin.Disconnect();
+		db_manager_->GetNetworkManager()->Stop();
+	}
+
+	void TestSuite::TestPostgresProtocol() {
+		uint16_t port = db_manager_->Serve(0, true, venus::network::Protocol::POSTGRES);
+
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		Assert(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0, "Failed to connect");
+
+		try {
+			// SSL is declined with a single byte, then the startup packet
+			std::string ssl;
+			PgPut32(&ssl, 8);
+			PgPut32(&ssl, 80877103);
+			PgSend(fd, ssl);
+			char answer = 0;
+			PgRecvExact(fd, &answer, 1);
+			Assert(answer == 'N', "SSL request was not declined");
+
+			std::string startup;
+			PgPut32(&startup, 196608);
+			startup += PgCString("user") + PgCString("venus") + PgCString("database") + PgCString("test_db") + PgCString("");
+			std::string packet;
+			PgPut32(&packet, static_cast<uint32_t>(startup.size() + 4));
+			PgSend(fd, packet + startup);
+			auto messages = PgReadUntilReady(fd);
+			Assert(messages.front().type == 'R' && PgGet32(messages.front().body, 0) == 0, "Expected AuthenticationOk");
+			Assert(messages.back().body == "I", "Expected an idle session after startup");
+
+			// simple query, two statements, the second has no rows
+			PgSend(fd, PgFrame('Q', PgCString("SELECT * FROM net_items WHERE id = 7; SELECT * FROM net_items WHERE id = -1")));
+			messages = PgReadUntilReady(fd);
+			Assert(PgTypes(messages) == "TDCTCZ", "Unexpected simple query response " + PgTypes(messages));
+			Assert(PgGet32(messages[1].body, 2) == 1 && messages[1].body[6] == '7', "Row sent incorrectly in text format");
+			Assert(std::string(messages[2].body.data()) == "SELECT 1" && std::string(messages[4].body.data()) == "SELECT 0",
+			    "Unexpected command tags");
+
+			PgSend(fd, PgFrame('Q', PgCString("SELECT * FROM missing_table")));
+			messages = PgReadUntilReady(fd);
+			Assert(PgTypes(messages) == "EZ" && messages[0].body.find("42P01") != std::string::npos, "Expected an undefined table error");
+
+			// extended query: a binary int4 parameter and binary results
+			std::string parse = PgCString("") + PgCString("SELECT * FROM net_items WHERE id = $1");
+			PgPut16(&parse, 1);
+			PgPut32(&parse, 23);
+			std::string bind = PgCString("") + PgCString("");
+			PgPut16(&bind, 1);
+			PgPut16(&bind, 1);
+			PgPut16(&bind, 1);
+			PgPut32(&bind, 4);
+			PgPut32(&bind, 123);
+			PgPut16(&bind, 1);
+			PgPut16(&bind, 1);
+			std::string execute = PgCString("");
+			PgPut32(&execute, 0);
+			PgSend(fd, PgFrame('P', parse) + PgFrame('B', bind) + PgFrame('D', "P" + PgCString("")) + PgFrame('E', execute) + PgFrame('S', ""));
+			messages = PgReadUntilReady(fd);
+			Assert(PgTypes(messages) == "12TDCZ", "Unexpected extended query response " + PgTypes(messages));
+			const std::string& row = messages[3].body;
+			Assert(PgGet32(row, 2) == 4 && PgGet32(row, 6) == 123, "Int column sent incorrectly in binary format");
+			Assert(PgGet32(row, 10) == 7 && row.substr(14) == "client1", "Char column sent incorrectly");
+
+			// text parameters, and an error skips to Sync
+			parse = PgCString("ins") + PgCString("INSERT INTO net_items VALUES ($1, $2)");
+			PgPut16(&parse, 0);
+			bind = PgCString("") + PgCString("ins");
+			PgPut16(&bind, 0);
+			PgPut16(&bind, 2);
+			PgPut32(&bind, 4);
+			bind += "1000";
+			PgPut32(&bind, 2);
+			bind += "pg";
+			PgPut16(&bind, 0);
+			std::string missing = PgCString("") + PgCString("nope");
+			PgPut16(&missing, 0);
+			PgPut16(&missing, 0);
+			PgPut16(&missing, 0);
+			PgSend(fd, PgFrame('P', parse) + PgFrame('B', bind) + PgFrame('E', execute) + PgFrame('B', missing) + PgFrame('E', execute) + PgFrame('S', ""));
+			messages = PgReadUntilReady(fd);
+			Assert(PgTypes(messages) == "12CEZ", "Unexpected response to an insert and a failed bind " + PgTypes(messages));
+			Assert(std::string(messages[2].body.data()) == "INSERT 0 1", "Unexpected insert tag");
+
+			PgSend(fd, PgFrame('X', ""));
+		} catch (...) {
+			close(fd);
+			db_manager_->GetNetworkManager()->Stop();
+			throw;
+		}
+
+		close(fd);
+		auto result = engine_->Execute("SELECT * FROM net_items WHERE id = 1000");
+		Assert(result.data_ && result.data_->GetSize() == 1, "Row inserted over the PostgreSQL protocol is missing");
+		db_manager_->GetNetworkManager()->Stop();
+	}
+
+	void TestSuite::TestBinaryResultEncoding() {
+		using namespace venus::network;
+
+		Schema schema;
+		schema.AddColumn("id", ColumnType::INT, false, 0);
+		schema.AddColumn("name", ColumnType::CHAR, false, 1);
+		executor::ResultSet result(true);
+		result.data_ = std::make_unique<executor::TupleSet>(schema);
+		const int rows = NETWORK_ROW_BATCH_SIZE + 3;
+		for (int i = 0; i < rows; i++) {
+			std::string name = "row" + std::to_string(i);
+			result.data_->AddTuple(Tuple({ reinterpret_cast<const char*>(&i), name.c_str() }, &schema));
+		}
+
+		std::string frames;
+		int emits = 0;
+		EncodeResult(result, &frames, [&](std::string*) {
+			emits++;
+			return true;
+		});
+		Assert(emits == 3, "Expected an emit per row batch and one for COMPLETE");
+
+		uint8_t type;
+		std::string payload;
+		Assert(TakeFrame(&frames, &type, &payload) && type == static_cast<uint8_t>(ResponseType::ROW_DESCRIPTION), "Expected ROW_DESCRIPTION");
+		MessageReader description(payload.data(), payload.size());
+		Assert(description.GetU16() == 2 && description.GetString() == "id", "Unexpected row description");
+		Assert(description.GetU8() == static_cast<uint8_t>(ColumnType::INT) && description.GetU16() == sizeof(int), "Unexpected INT column");
+
+		// the first batch is the ids as an int array, then the names as MAX_CHAR_LENGTH wide slots
+		Assert(TakeFrame(&frames, &type, &payload) && type == static_cast<uint8_t>(ResponseType::ROW_BATCH), "Expected ROW_BATCH");
+		MessageReader batch(payload.data(), payload.size());
+		uint32_t count = batch.GetU32();
+		Assert(count == NETWORK_ROW_BATCH_SIZE, "First batch is not full");
+		const int* ids = reinterpret_cast<const int*>(batch.GetBytes(count * sizeof(int)));
+		const char* names = batch.GetBytes(count * MAX_CHAR_LENGTH);
+		Assert(batch.AtEnd(), "Unexpected bytes after the columns");
+		Assert(ids[0] == 0 && ids[count - 1] == static_cast<int>(count) - 1, "INT column encoded incorrectly");
+		Assert(std::string(names + 5 * MAX_CHAR_LENGTH) == "row5", "CHAR column encoded incorrectly");
+
+		Assert(TakeFrame(&frames, &type, &payload) && MessageReader(payload.data(), payload.size()).GetU32() == 3, "Expected the remaining rows");
+		Assert(TakeFrame(&frames, &type, &payload) && type == static_cast<uint8_t>(ResponseType::COMPLETE) && frames.empty(), "Expected COMPLETE last");
+	}
+
 	void TestSuite::RunTest(const std::string& name, void (TestSuite::*test)()) {
 		total_tests_++;
 
@@ -31,6 +31,9 @@ namespace tests {
 		void RunBulkInsertTests();
 		void RunErrorTests();
 		void RunPerformanceTests();
+		void RunRecoveryTests();
+		void RunTransactionTests();
+		void RunNetworkTests();
 		
 		// Test methods
 		void TestDatabaseSetup();
@@ -38,8 +41,38 @@ namespace tests {
 		void TestSingleInsert();
 		void TestBulkInsert();
 		void TestSelectQuery();
+		void TestFilteredSelect();
+		void TestTypedPredicates();
+		void TestVarcharColumns();
+		void TestNullValues();
+		void TestWideTypes();
 		void TestInvalidQueries();
 		void TestLargeDataset();
+		void TestParallelScan();
+		void TestWideRows();
+		void TestColumnarTables();
+		void TestColumnCompression();
+		void TestZoneMaps();
+		void TestBloomFilters();
+		void TestQueryArena();
+		void TestConcurrentBufferPool();
+		void TestSharedBufferPool();
+		void TestMappedReads();
+		void TestDirectIO();
+		void TestFreePageReuse();
+		void TestExtentAllocation();
+		void TestWriteAheadLog();
+		void TestGroupCommit();
+		void TestLogTruncation();
+		void TestCrashRecovery();
+		void TestCheckpoint();
+		void TestTransactions();
+		void TestSnapshotIsolation();
+		void TestPageCompaction();
+		void TestLockManager();
+		void TestNetworkServer();
+		void TestPostgresProtocol();
+		void TestBinaryResultEncoding();
 		
 		// Simple utilities
 		void RunTest(const std::string& name, void (TestSuite::*test)());